@@ -0,0 +1,133 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#include "ActionSequenceFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+RamAi::ActionSequenceFile::Record::Record()
+{
+	m_header = nullptr;
+	m_runs = nullptr;
+}
+
+bool RamAi::ActionSequenceFile::Record::Read(const uint8_t *data, const size_t size)
+{
+	m_header = nullptr;
+	m_runs = nullptr;
+
+	if (!data || size < sizeof(RecordHeader))
+	{
+		return false;
+	}
+
+	const RecordHeader *header = reinterpret_cast<const RecordHeader*>(data);
+
+	if (header->magic != Magic || header->version != Version || header->recordSize > size ||
+		header->recordSize != sizeof(RecordHeader) + static_cast<size_t>(header->numberOfRuns) * sizeof(Run))
+	{
+		return false;
+	}
+
+	m_header = header;
+	m_runs = reinterpret_cast<const Run*>(data + sizeof(RecordHeader));
+
+	return true;
+}
+
+void RamAi::ActionSequenceFile::Record::GetFrameInputs(std::vector<ButtonSet> &outInputs, const bool includeInitialisation) const
+{
+	outInputs.clear();
+
+	if (!m_header)
+	{
+		return;
+	}
+
+	outInputs.reserve(m_header->numberOfFrames);
+
+	for (size_t i = 0; i < m_header->numberOfRuns; ++i)
+	{
+		outInputs.insert(outInputs.end(), m_runs[i].frames, ButtonSet(m_runs[i].buttons));
+	}
+
+	if (!includeInitialisation)
+	{
+		const size_t initialisationFrames = std::min<size_t>(m_header->initialisationFrames, outInputs.size());
+		outInputs.erase(outInputs.begin(), outInputs.begin() + initialisationFrames);
+	}
+}
+
+void RamAi::ActionSequenceFile::AddFrames(std::vector<Run> &runs, const ButtonSet &buttonSet, const uint32_t frames)
+{
+	const uint32_t buttons = buttonSet.GetBitfield().GetValue();
+
+	if (frames == 0)
+	{
+		return;
+	}
+
+	if (!runs.empty() && runs.back().buttons == buttons)
+	{
+		runs.back().frames += frames;
+	}
+	else
+	{
+		Run run;
+		run.buttons = buttons;
+		run.frames = frames;
+
+		runs.push_back(run);
+	}
+}
+
+void RamAi::ActionSequenceFile::AppendRecord(const RecordHeader &header, const std::vector<Run> &runs, std::string &buffer)
+{
+	RecordHeader recordHeader = header;
+	recordHeader.magic = Magic;
+	recordHeader.version = Version;
+	recordHeader.numberOfRuns = static_cast<uint32_t>(runs.size());
+	recordHeader.recordSize = static_cast<uint32_t>(sizeof(RecordHeader) + runs.size() * sizeof(Run));
+	recordHeader.numberOfFrames = 0;
+
+	for (auto it = runs.cbegin(); it != runs.cend(); ++it)
+	{
+		recordHeader.numberOfFrames += it->frames;
+	}
+
+	buffer.append(reinterpret_cast<const char*>(&recordHeader), sizeof(recordHeader));
+	buffer.append(reinterpret_cast<const char*>(runs.data()), runs.size() * sizeof(Run));
+}
+
+bool RamAi::ActionSequenceFile::ReadLastRecord(const uint8_t *data, const size_t size, Record &outRecord)
+{
+	bool foundRecord = false;
+	Record record;
+
+	for (size_t offset = 0; offset < size && record.Read(data + offset, size - offset); offset += record.GetRecordSize())
+	{
+		outRecord = record;
+		foundRecord = true;
+	}
+
+	return foundRecord;
+}
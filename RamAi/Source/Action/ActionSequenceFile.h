@@ -0,0 +1,101 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ButtonSet.h"
+
+
+namespace RamAi
+{
+	//A compact form of the best path through the tree, so progress can be saved without recording a movie.
+	//A file is a sequence of records, one per save. Each record is a header followed by runs of
+	//identical buttons, so the latest path is simply the last complete record.
+	class ActionSequenceFile
+	{
+	public:
+		struct RecordHeader
+		{
+			uint32_t magic;
+			uint16_t version;
+			uint16_t frameRate;
+			uint32_t recordSize;			//Including the header.
+			uint32_t numberOfRuns;
+			uint32_t iteration;				//The score log iteration the path was saved on.
+			uint32_t macroActionLength;
+			uint32_t initialisationFrames;	//The frames before the root of the tree, which the runs start with.
+			uint32_t numberOfFrames;
+			uint64_t rootStateHash;			//Savestate::CalculateHash() of the root, or 0 if it had none.
+			double bestAverageScore;
+		};
+
+		//The buttons held on pad 1 for a number of frames.
+		struct Run
+		{
+			uint32_t buttons;
+			uint32_t frames;
+		};
+
+		static const uint32_t Magic = 0x51534152; //"RASQ"
+		static const uint16_t Version = 1;
+
+		//A view of a single record within a buffer.
+		class Record
+		{
+		public:
+			Record();
+
+		public:
+			//Reads the record at the start of the buffer. Returns false if it isn't a complete, valid record.
+			bool Read(const uint8_t *data, const size_t size);
+
+		public:
+			const RecordHeader *GetHeader() const					{ return m_header; }
+			const Run *GetRuns() const								{ return m_runs; }
+			size_t GetNumberOfRuns() const							{ return m_header ? m_header->numberOfRuns : 0; }
+			size_t GetRecordSize() const							{ return m_header ? m_header->recordSize : 0; }
+
+			//Expands the runs into one button set per frame, optionally leaving out the initialisation frames.
+			void GetFrameInputs(std::vector<ButtonSet> &outInputs, const bool includeInitialisation) const;
+
+		private:
+			const RecordHeader *m_header;
+			const Run *m_runs;
+		};
+
+	public:
+		ActionSequenceFile() = delete;
+		~ActionSequenceFile() = delete;
+
+	public:
+		//Adds frames of the given buttons, extending the last run if it holds the same buttons.
+		static void AddFrames(std::vector<Run> &runs, const ButtonSet &buttonSet, const uint32_t frames);
+
+		//Appends a record of the runs to the buffer. The header's magic, version and sizes are filled in.
+		static void AppendRecord(const RecordHeader &header, const std::vector<Run> &runs, std::string &buffer);
+
+		//Finds the last complete record in a buffer, which may end with a partly written one.
+		static bool ReadLastRecord(const uint8_t *data, const size_t size, Record &outRecord);
+	};
+};
@@ -57,22 +57,18 @@ RamAi::Api &RamAi::Api::operator= (Api &&other)
 }
 
 void RamAi::Api::InitialiseGame(const GameSettings &gameSettings,
-	const StateMachine::SaveStateHandleSignature &saveStateHandle,
-	const StateMachine::LoadStateHandleSignature &loadStateHandle,
+	EmulatorBackend &backend,
 	const ScoreLog::SaveLogToFileSignature &saveLogToFileHandle,
-	const StateMachine::StartRecordingHandleSignature &startRecordingHandle,
-	const StateMachine::FinishRecordingHandleSignature &finishRecordingHandle)
+	const ScoreLog::SpillLogToFileSignature &spillLogToFileHandle,
+	const StateMachine::SaveBestPathHandleSignature &saveBestPathHandle)
 {
 	Debug::ClearScreen();
 
 	GameSettings::SetInstance(gameSettings);
 
 	//Create a new state machine.
-	m_stateMachine = std::make_unique<StateMachine>(saveLogToFileHandle);
-	m_stateMachine->GetSaveStateHandle() = saveStateHandle;
-	m_stateMachine->GetLoadStateHandle() = loadStateHandle;
-	m_stateMachine->GetStartRecordingHandle() = startRecordingHandle;
-	m_stateMachine->GetFinishRecordingHandle() = finishRecordingHandle;
+	m_stateMachine = std::make_unique<StateMachine>(backend, saveLogToFileHandle, spillLogToFileHandle);
+	m_stateMachine->GetSaveBestPathHandle() = saveBestPathHandle;
 
 	//Log any errors.
 	if (!gameSettings.IsValid())
@@ -91,6 +87,47 @@ void RamAi::Api::ImportAiSettings(char *settingsFile)
 	AiSettings::SetData(AiSettings::Import(settingsFile));
 }
 
+bool RamAi::Api::EnableTreeCheckpoints(const TreeCheckpoint::WriteTableHandleSignature &writeTableHandle,
+	const TreeCheckpoint::WriteBlobHandleSignature &writeBlobHandle, const uint64_t romHash)
+{
+	assert(m_stateMachine);
+
+	if (m_stateMachine && AiSettings::GetData().checkpointFrequency > 0)
+	{
+		const bool includeSavestates = AiSettings::GetData().checkpointSavestates;
+		m_stateMachine->SetTreeCheckpoint(std::make_unique<TreeCheckpoint>(writeTableHandle, writeBlobHandle, includeSavestates, romHash));
+
+		return true;
+	}
+
+	return false;
+}
+
+void RamAi::Api::DisableTreeCheckpoints()
+{
+	if (m_stateMachine)
+	{
+		//Destroying the checkpoint waits for its thread to finish writing.
+		m_stateMachine->SetTreeCheckpoint(nullptr);
+	}
+}
+
+bool RamAi::Api::ResumeTreeCheckpoint(const uint8_t *table, const size_t tableSize, const uint64_t blobSize, const TreeCheckpoint::ReadBlobHandleSignature &readBlobHandle)
+{
+	if (m_stateMachine && m_stateMachine->GetTreeCheckpoint())
+	{
+		if (m_stateMachine->GetTreeCheckpoint()->Resume(table, tableSize, blobSize, readBlobHandle, m_stateMachine->GetTree()))
+		{
+			Debug::OutLine("Resumed search tree from checkpoint.", Colour::Green);
+			return true;
+		}
+
+		Debug::OutLine("Couldn't resume search tree from checkpoint.", Colour::Red);
+	}
+
+	return false;
+}
+
 RamAi::ButtonSet RamAi::Api::CalculateInput(const Ram &ram)
 {
 	ButtonSet returnValue;
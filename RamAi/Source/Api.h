@@ -25,6 +25,7 @@
 #include "Action\ButtonSet.h"
 #include "Settings\ConsoleSettings.h"
 #include "Settings\GameSettings.h"
+#include "StateMachine\EmulatorBackend.h"
 #include "StateMachine\StateMachine.h"
 #include "Debug.h"
 
@@ -49,14 +50,25 @@ namespace RamAi
 	public:
 		//Initialises the AI with a new game's settings.
 		void InitialiseGame(const GameSettings &gameSettings,
-			const StateMachine::SaveStateHandleSignature &saveStateHandle,
-			const StateMachine::LoadStateHandleSignature &loadStateHandle,
+			EmulatorBackend &backend,
 			const ScoreLog::SaveLogToFileSignature &saveLogToFileHandle,
-			const StateMachine::StartRecordingHandleSignature &startRecordingHandle,
-			const StateMachine::FinishRecordingHandleSignature &finishRecordingHandle);
+			const ScoreLog::SpillLogToFileSignature &spillLogToFileHandle,
+			const StateMachine::SaveBestPathHandleSignature &saveBestPathHandle);
 
 		void ImportAiSettings(char *settingsFile);
 
+		//Starts checkpointing the current game's search tree, if the AI settings ask for it.
+		//The ROM hash identifies the game, so a checkpoint of another ROM is never resumed.
+		//Returns false if checkpoints are disabled.
+		bool EnableTreeCheckpoints(const TreeCheckpoint::WriteTableHandleSignature &writeTableHandle,
+			const TreeCheckpoint::WriteBlobHandleSignature &writeBlobHandle, const uint64_t romHash);
+
+		//Finishes writing any queued checkpoint and stops checkpointing.
+		void DisableTreeCheckpoints();
+
+		//Rebuilds the search tree from a checkpoint. Checkpoints must be enabled, and the game just initialised.
+		bool ResumeTreeCheckpoint(const uint8_t *table, const size_t tableSize, const uint64_t blobSize, const TreeCheckpoint::ReadBlobHandleSignature &readBlobHandle);
+
 	public:
 		ButtonSet CalculateInput(const Ram &ram);
 
@@ -0,0 +1,248 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#include "Metrics.h"
+
+#include <cstdio>
+
+
+namespace
+{
+	//Phases of the search, in the order of their counters.
+	const RamAi::Metrics::Counter s_phaseCounters[] =
+	{
+		RamAi::Metrics::Counter::SelectionNanoseconds,
+		RamAi::Metrics::Counter::ExpansionNanoseconds,
+		RamAi::Metrics::Counter::SimulationNanoseconds,
+		RamAi::Metrics::Counter::BackpropagationNanoseconds,
+		RamAi::Metrics::Counter::PlaybackNanoseconds
+	};
+
+	const char *const s_phaseNames[] =
+	{
+		"selection",
+		"expansion",
+		"simulation",
+		"backpropagation",
+		"playback"
+	};
+
+	const size_t s_numberOfPhases = sizeof(s_phaseCounters) / sizeof(s_phaseCounters[0]);
+
+	void AppendHeader(const char *name, const char *type, const char *help, std::string &buffer)
+	{
+		buffer += "# HELP ";
+		buffer += name;
+		buffer += ' ';
+		buffer += help;
+		buffer += "\n# TYPE ";
+		buffer += name;
+		buffer += ' ';
+		buffer += type;
+		buffer += '\n';
+	}
+
+	void AppendValue(const char *name, const char *phase, const double value, std::string &buffer)
+	{
+		char valueBuffer[32];
+		snprintf(valueBuffer, sizeof(valueBuffer), "%.17g", value);
+
+		buffer += name;
+
+		if (phase)
+		{
+			buffer += "{phase=\"";
+			buffer += phase;
+			buffer += "\"}";
+		}
+
+		buffer += ' ';
+		buffer += valueBuffer;
+		buffer += '\n';
+	}
+
+	void AppendMetric(const char *name, const char *type, const char *help, const double value, std::string &buffer)
+	{
+		AppendHeader(name, type, help, buffer);
+		AppendValue(name, nullptr, value, buffer);
+	}
+}
+
+RamAi::Metrics::ScopedTimer::ScopedTimer(const Counter counter)
+	: m_counter(counter)
+	, m_start(std::chrono::steady_clock::now())
+{
+}
+
+RamAi::Metrics::ScopedTimer::~ScopedTimer()
+{
+	const auto elapsed = std::chrono::steady_clock::now() - m_start;
+	Add(m_counter, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+void RamAi::Metrics::Add(const Counter counter, const uint64_t amount)
+{
+	//Only this thread writes to its shard, so a load and store is enough - no locked add is needed.
+	std::atomic<uint64_t> &value = GetShard().counters[counter];
+	value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void RamAi::Metrics::RaiseGauge(const Gauge gauge, const int64_t value)
+{
+	if (s_gauges[gauge].load(std::memory_order_relaxed) < value)
+	{
+		s_gauges[gauge].store(value, std::memory_order_relaxed);
+	}
+}
+
+RamAi::Metrics::Snapshot RamAi::Metrics::TakeSnapshot()
+{
+	Snapshot snapshot;
+	snapshot.time = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < Counter::MaxCounter; ++i)
+	{
+		snapshot.counters[i] = 0;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_shardsMutex);
+
+		for (auto it = s_shards.cbegin(); it != s_shards.cend(); ++it)
+		{
+			for (size_t i = 0; i < Counter::MaxCounter; ++i)
+			{
+				snapshot.counters[i] += (*it)->counters[i].load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < Gauge::MaxGauge; ++i)
+	{
+		snapshot.gauges[i] = s_gauges[i].load(std::memory_order_relaxed);
+	}
+
+	return snapshot;
+}
+
+void RamAi::Metrics::AppendPrometheusText(const Snapshot &snapshot, const Snapshot *previousSnapshot, std::string &buffer)
+{
+	const uint64_t *counters = snapshot.counters;
+
+	AppendMetric("ramai_iterations_total", "counter", "Search iterations completed.", static_cast<double>(counters[Counter::Iterations]), buffer);
+	AppendMetric("ramai_emulated_frames_total", "counter", "Frames emulated for the search.", static_cast<double>(counters[Counter::EmulatedFrames]), buffer);
+
+	AppendHeader("ramai_phase_seconds_total", "counter", "Time spent in each phase of the search, including emulation.", buffer);
+
+	for (size_t i = 0; i < s_numberOfPhases; ++i)
+	{
+		AppendValue("ramai_phase_seconds_total", s_phaseNames[i], static_cast<double>(counters[s_phaseCounters[i]]) * 1e-9, buffer);
+	}
+
+	AppendMetric("ramai_tree_nodes", "gauge", "Nodes in the search tree.", static_cast<double>(snapshot.gauges[Gauge::TreeNodes]), buffer);
+	AppendMetric("ramai_tree_max_depth", "gauge", "Depth of the deepest node in the search tree.", static_cast<double>(snapshot.gauges[Gauge::TreeMaxDepth]), buffer);
+	AppendMetric("ramai_savestate_bytes", "gauge", "Bytes allocated for savestate pages.", static_cast<double>(snapshot.gauges[Gauge::SavestateBytes]), buffer);
+	AppendMetric("ramai_savestate_pool_bytes", "gauge", "Bytes of freed savestate memory kept for reuse.", static_cast<double>(snapshot.gauges[Gauge::SavestatePoolBytes]), buffer);
+
+	const uint64_t pagesShared = counters[Counter::SavestatePagesShared];
+	const uint64_t pagesChecked = pagesShared + counters[Counter::SavestatePagesUnshared];
+
+	AppendMetric("ramai_savestate_page_hits_total", "counter", "Savestate pages shared with the parent's instead of stored again.", static_cast<double>(pagesShared), buffer);
+	AppendMetric("ramai_savestate_page_hit_ratio", "gauge", "Fraction of savestate pages shared with the parent's.", pagesChecked ? static_cast<double>(pagesShared) / pagesChecked : 0.0, buffer);
+
+	const uint64_t poolHits = counters[Counter::SavestatePoolHits];
+	const uint64_t poolAllocations = poolHits + counters[Counter::SavestatePoolMisses];
+
+	AppendMetric("ramai_savestate_pool_hits_total", "counter", "Savestate allocations served from recycled memory.", static_cast<double>(poolHits), buffer);
+	AppendMetric("ramai_savestate_pool_misses_total", "counter", "Savestate allocations that went to the heap.", static_cast<double>(counters[Counter::SavestatePoolMisses]), buffer);
+	AppendMetric("ramai_savestate_pool_hit_ratio", "gauge", "Fraction of savestate allocations served from recycled memory.", poolAllocations ? static_cast<double>(poolHits) / poolAllocations : 0.0, buffer);
+
+	const uint64_t compressionInputBytes = counters[Counter::SavestateCompressionInputBytes];
+	const uint64_t compressionOutputBytes = counters[Counter::SavestateCompressionOutputBytes];
+	const uint64_t compressionNanoseconds = counters[Counter::SavestateCompressionNanoseconds];
+	const uint64_t decompressedBytes = counters[Counter::SavestateDecompressedBytes];
+	const uint64_t decompressionNanoseconds = counters[Counter::SavestateDecompressionNanoseconds];
+
+	AppendMetric("ramai_savestate_compressed_bytes", "gauge", "Bytes holding compressed savestate pages.", static_cast<double>(snapshot.gauges[Gauge::SavestateCompressedBytes]), buffer);
+	AppendMetric("ramai_savestate_compression_input_bytes_total", "counter", "Bytes of savestate pages compressed.", static_cast<double>(compressionInputBytes), buffer);
+	AppendMetric("ramai_savestate_compression_output_bytes_total", "counter", "Bytes the compressed savestate pages came to.", static_cast<double>(compressionOutputBytes), buffer);
+	AppendMetric("ramai_savestate_compression_ratio", "gauge", "Uncompressed bytes per compressed byte of savestate pages.", compressionOutputBytes ? static_cast<double>(compressionInputBytes) / compressionOutputBytes : 0.0, buffer);
+	AppendMetric("ramai_savestate_compression_bytes_per_second", "gauge", "Bytes of savestate pages compressed per second spent compressing.", compressionNanoseconds ? compressionInputBytes / (compressionNanoseconds * 1e-9) : 0.0, buffer);
+	AppendMetric("ramai_savestate_decompression_bytes_per_second", "gauge", "Bytes of savestate pages decompressed per second spent decompressing.", decompressionNanoseconds ? decompressedBytes / (decompressionNanoseconds * 1e-9) : 0.0, buffer);
+
+	//Rates need two snapshots. A dashboard can work them out itself, but a plain file reader can't.
+	if (previousSnapshot)
+	{
+		const double seconds = std::chrono::duration<double>(snapshot.time - previousSnapshot->time).count();
+		const uint64_t *previousCounters = previousSnapshot->counters;
+
+		if (seconds > 0.0)
+		{
+			AppendMetric("ramai_iterations_per_second", "gauge", "Search iterations per second since the last update.", (counters[Counter::Iterations] - previousCounters[Counter::Iterations]) / seconds, buffer);
+			AppendMetric("ramai_emulated_frames_per_second", "gauge", "Frames emulated per second since the last update.", (counters[Counter::EmulatedFrames] - previousCounters[Counter::EmulatedFrames]) / seconds, buffer);
+		}
+
+		uint64_t totalPhaseNanoseconds = 0;
+
+		for (size_t i = 0; i < s_numberOfPhases; ++i)
+		{
+			totalPhaseNanoseconds += counters[s_phaseCounters[i]] - previousCounters[s_phaseCounters[i]];
+		}
+
+		if (totalPhaseNanoseconds > 0)
+		{
+			AppendHeader("ramai_phase_share", "gauge", "Fraction of the time since the last update spent in each phase.", buffer);
+
+			for (size_t i = 0; i < s_numberOfPhases; ++i)
+			{
+				const uint64_t phaseNanoseconds = counters[s_phaseCounters[i]] - previousCounters[s_phaseCounters[i]];
+				AppendValue("ramai_phase_share", s_phaseNames[i], static_cast<double>(phaseNanoseconds) / totalPhaseNanoseconds, buffer);
+			}
+		}
+	}
+}
+
+RamAi::Metrics::Shard &RamAi::Metrics::GetShard()
+{
+	//Shards are never freed, so counts from threads that have finished still add up.
+	thread_local Shard *shard = nullptr;
+
+	if (!shard)
+	{
+		std::unique_ptr<Shard> newShard = std::make_unique<Shard>();
+
+		for (size_t i = 0; i < Counter::MaxCounter; ++i)
+		{
+			newShard->counters[i].store(0, std::memory_order_relaxed);
+		}
+
+		std::lock_guard<std::mutex> lock(s_shardsMutex);
+
+		shard = newShard.get();
+		s_shards.push_back(std::move(newShard));
+	}
+
+	return *shard;
+}
+
+
+std::mutex RamAi::Metrics::s_shardsMutex;
+std::vector<std::unique_ptr<RamAi::Metrics::Shard>> RamAi::Metrics::s_shards;
+std::atomic<int64_t> RamAi::Metrics::s_gauges[RamAi::Metrics::Gauge::MaxGauge];
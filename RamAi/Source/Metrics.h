@@ -0,0 +1,126 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace RamAi
+{
+	//Static class that holds counters and gauges describing the search, which can be read from any thread.
+	//Each thread adds to its own copy of the counters, which are only summed when a snapshot is taken,
+	//so counting is a relaxed atomic add to memory that no other thread writes to.
+	class Metrics
+	{
+	public:
+		//Totals that only ever go up.
+		enum Counter
+		{
+			Iterations,
+			EmulatedFrames,
+			SelectionNanoseconds,
+			ExpansionNanoseconds,
+			SimulationNanoseconds,
+			BackpropagationNanoseconds,
+			PlaybackNanoseconds,
+			SavestatePagesShared,		//Pages found identical to the parent's when a savestate is stored.
+			SavestatePagesUnshared,
+			SavestatePoolHits,			//Savestate allocations served from recycled memory.
+			SavestatePoolMisses,
+			SavestateCompressionInputBytes,		//Bytes of pages given to the savestate codec, and the bytes it produced.
+			SavestateCompressionOutputBytes,
+			SavestateCompressionNanoseconds,
+			SavestateDecompressedBytes,
+			SavestateDecompressionNanoseconds,
+			MaxCounter
+		};
+
+		//Current values, each set by a single thread.
+		enum Gauge
+		{
+			TreeNodes,
+			TreeMaxDepth,
+			SavestateBytes,
+			SavestatePoolBytes,			//Freed savestate memory kept for reuse.
+			SavestateCompressedBytes,	//Memory holding compressed savestate pages.
+			MaxGauge
+		};
+
+		struct Snapshot
+		{
+			uint64_t counters[Counter::MaxCounter];
+			int64_t gauges[Gauge::MaxGauge];
+			std::chrono::steady_clock::time_point time;
+		};
+
+		//Adds the time between its construction and destruction to a counter.
+		class ScopedTimer
+		{
+		public:
+			ScopedTimer(const Counter counter);
+			ScopedTimer(const ScopedTimer &other) = delete;
+			~ScopedTimer();
+
+		public:
+			ScopedTimer &operator= (const ScopedTimer &other) = delete;
+
+		private:
+			Counter m_counter;
+			std::chrono::steady_clock::time_point m_start;
+		};
+
+	public:
+		Metrics() = delete;
+		~Metrics() = delete;
+
+	public:
+		static void Add(const Counter counter, const uint64_t amount = 1);
+
+		static void SetGauge(const Gauge gauge, const int64_t value)		{ s_gauges[gauge].store(value, std::memory_order_relaxed); }
+		static void AddToGauge(const Gauge gauge, const int64_t amount)		{ s_gauges[gauge].fetch_add(amount, std::memory_order_relaxed); }
+		static void RaiseGauge(const Gauge gauge, const int64_t value);
+
+		static Snapshot TakeSnapshot();
+
+		//Appends the snapshot in the Prometheus text exposition format.
+		//Rates and time shares are worked out against the previous snapshot, if there is one.
+		static void AppendPrometheusText(const Snapshot &snapshot, const Snapshot *previousSnapshot, std::string &buffer);
+
+	private:
+		struct Shard
+		{
+			std::atomic<uint64_t> counters[Counter::MaxCounter];
+		};
+
+		static Shard &GetShard();
+
+	private:
+		static std::mutex s_shardsMutex;
+		static std::vector<std::unique_ptr<Shard>> s_shards;
+		static std::atomic<int64_t> s_gauges[Gauge::MaxGauge];
+	};
+};
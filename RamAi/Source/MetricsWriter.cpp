@@ -0,0 +1,76 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#include "MetricsWriter.h"
+
+
+RamAi::MetricsWriter::MetricsWriter(const WriteHandleSignature &writeHandle, const std::chrono::milliseconds interval)
+{
+	m_writeHandle = writeHandle;
+	m_interval = interval;
+	m_stopping = false;
+
+	m_thread = std::thread(&MetricsWriter::ThreadMain, this);
+}
+
+RamAi::MetricsWriter::~MetricsWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_stoppingCondition.notify_one();
+	m_thread.join();
+}
+
+void RamAi::MetricsWriter::ThreadMain()
+{
+	std::string buffer;
+	Metrics::Snapshot previousSnapshot = Metrics::TakeSnapshot();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stoppingCondition.wait_for(lock, m_interval, [this]() { return m_stopping; }))
+	{
+		lock.unlock();
+
+		const Metrics::Snapshot snapshot = Metrics::TakeSnapshot();
+
+		buffer.clear();
+		Metrics::AppendPrometheusText(snapshot, &previousSnapshot, buffer);
+
+		try
+		{
+			if (m_writeHandle)
+			{
+				m_writeHandle(buffer.data(), buffer.size());
+			}
+		}
+		catch (...)
+		{
+			//The next update will try again.
+		}
+
+		previousSnapshot = snapshot;
+
+		lock.lock();
+	}
+}
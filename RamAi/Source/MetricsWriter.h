@@ -0,0 +1,66 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Metrics.h"
+
+
+namespace RamAi
+{
+	//Periodically formats the metrics and hands them to a write handle from a background thread,
+	//so long runs can be watched without the search doing any of the work.
+	class MetricsWriter
+	{
+	public:
+		//Called on the writer's thread with the whole of the latest metrics text, which should replace the last.
+		typedef std::function<void(const char *data, const size_t size)> WriteHandleSignature;
+
+	public:
+		MetricsWriter(const WriteHandleSignature &writeHandle, const std::chrono::milliseconds interval);
+		MetricsWriter(const MetricsWriter &other) = delete;
+		MetricsWriter(MetricsWriter &&other) = delete;
+		~MetricsWriter();
+
+	public:
+		MetricsWriter &operator= (const MetricsWriter &other) = delete;
+		MetricsWriter &operator= (MetricsWriter &&other) = delete;
+
+	private:
+		void ThreadMain();
+
+	private:
+		WriteHandleSignature m_writeHandle;
+		std::chrono::milliseconds m_interval;
+
+		std::mutex m_mutex;
+		std::condition_variable m_stoppingCondition;
+		bool m_stopping;
+
+		std::thread m_thread;
+	};
+};
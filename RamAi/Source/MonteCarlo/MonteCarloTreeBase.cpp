@@ -25,6 +25,7 @@
 
 #include "Settings\AiSettings.h"
 #include "BestScoreCollection.h"
+#include "Trace.h"
 
 
 RamAi::MonteCarloTreeException::MonteCarloTreeException()
@@ -77,6 +78,8 @@ RamAi::MonteCarloTreeBase &RamAi::MonteCarloTreeBase::operator= (MonteCarloTreeB
 
 RamAi::TreeNode &RamAi::MonteCarloTreeBase::Select()
 {
+	RAMAI_TRACE_SCOPE("MonteCarloTreeBase::Select");
+
 	TreeNode *currentNode = &m_root;
 
 	int attemptsRemaining = 50000;
@@ -182,6 +185,8 @@ double RamAi::MonteCarloTreeBase::CalculateUcbScore(const TreeNode &parent, cons
 
 RamAi::TreeNode &RamAi::MonteCarloTreeBase::Expand(TreeNode &nodeToBeExpanded)
 {
+	RAMAI_TRACE_SCOPE("MonteCarloTreeBase::Expand");
+
 	PerformExpansion(nodeToBeExpanded);
 
 	//If expansion resulted in more children, select one of them.
@@ -210,6 +215,8 @@ RamAi::TreeNode &RamAi::MonteCarloTreeBase::Expand(TreeNode &nodeToBeExpanded)
 
 void RamAi::MonteCarloTreeBase::Backpropagate(TreeNode &nodeToBackpropagateFrom, const ScoreType score)
 {
+	RAMAI_TRACE_SCOPE("MonteCarloTreeBase::Backpropagate");
+
 	//Traverse backwards through the tree, adding the score to each one.
 	TreeNode *currentNode = &nodeToBackpropagateFrom;
 
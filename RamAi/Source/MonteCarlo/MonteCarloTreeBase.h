@@ -58,6 +58,7 @@ namespace RamAi
 		void SetBias(const double bias)				{ m_bias = bias; }
 
 		const TreeNode *GetBestScoringNode() const	{ return m_bestScoringNode; }
+		void SetBestScoringNode(const TreeNode *node)	{ m_bestScoringNode = node; }
 
 	public:
 		TreeNode &Select();
@@ -0,0 +1,124 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "SavestateCompressor.h"
+
+#include <cassert>
+
+
+const size_t RamAi::SavestateCompressor::MaximumPendingJobs;
+
+RamAi::SavestateCompressor::SavestateCompressor(const SavestateCodec::Type codec)
+{
+	m_codec = codec;
+	m_stopping = false;
+
+	m_thread = std::thread(&SavestateCompressor::ThreadMain, this);
+}
+
+RamAi::SavestateCompressor::~SavestateCompressor()
+{
+	//Anything still queued is dropped; those nodes keep their uncompressed savestates.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_queuedCondition.notify_one();
+	m_thread.join();
+}
+
+bool RamAi::SavestateCompressor::Enqueue(TreeNode &node)
+{
+	assert(node.HasSavestate());
+
+	if (!node.HasSavestate() || !node.GetSavestate()->HasUncompressedPages())
+	{
+		return false;
+	}
+
+	//Copies only share pages, so they're cheap to take here and safe to read on the other thread.
+	Job job;
+	job.node = &node;
+	job.savestate = *node.GetSavestate();
+	job.hasParent = node.GetParent() && node.GetParent()->HasSavestate();
+
+	if (job.hasParent)
+	{
+		job.parentSavestate = *node.GetParent()->GetSavestate();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_pendingJobs.size() >= MaximumPendingJobs)
+		{
+			return false;
+		}
+
+		m_pendingJobs.push_back(std::move(job));
+	}
+
+	m_queuedCondition.notify_one();
+	return true;
+}
+
+void RamAi::SavestateCompressor::InstallFinished()
+{
+	std::deque<Job> finishedJobs;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		finishedJobs.swap(m_finishedJobs);
+	}
+
+	for (Job &job : finishedJobs)
+	{
+		job.node->SetSavestate(std::move(job.savestate));
+	}
+}
+
+void RamAi::SavestateCompressor::ThreadMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_queuedCondition.wait(lock, [this]() { return !m_pendingJobs.empty() || m_stopping; });
+
+		if (m_stopping)
+		{
+			break;
+		}
+
+		Job job = std::move(m_pendingJobs.front());
+		m_pendingJobs.pop_front();
+
+		lock.unlock();
+
+		job.savestate = job.savestate.CompressAgainst(job.hasParent ? &job.parentSavestate : nullptr, m_codec);
+
+		//The parent's pages are no longer needed, so don't keep them alive until the job is installed.
+		job.parentSavestate = Savestate();
+
+		lock.lock();
+
+		m_finishedJobs.push_back(std::move(job));
+	}
+}
@@ -0,0 +1,83 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "TreeNode.h"
+#include "State/SavestateCodec.h"
+
+
+namespace RamAi
+{
+	//Compresses the savestates of tree nodes on a background thread, so the search doesn't wait for it.
+	//The compressed savestates are handed back to their nodes on the search thread, as nodes aren't thread-safe.
+	class SavestateCompressor
+	{
+	public:
+		SavestateCompressor(const SavestateCodec::Type codec);
+		SavestateCompressor(const SavestateCompressor &other) = delete;
+		SavestateCompressor(SavestateCompressor &&other) = delete;
+		~SavestateCompressor();
+
+	public:
+		SavestateCompressor &operator= (const SavestateCompressor &other) = delete;
+		SavestateCompressor &operator= (SavestateCompressor &&other) = delete;
+
+	public:
+		//Queues the node's savestate to be compressed against its parent's. The node must outlive this object.
+		//Returns false without doing anything if too many savestates are already waiting.
+		bool Enqueue(TreeNode &node);
+
+		//Gives any compressed savestates to their nodes. Must be called on the thread that owns the tree.
+		void InstallFinished();
+
+	private:
+		struct Job
+		{
+			TreeNode *node;
+			Savestate savestate;
+			Savestate parentSavestate;
+			bool hasParent;
+		};
+
+	private:
+		void ThreadMain();
+
+	private:
+		SavestateCodec::Type m_codec;
+
+		std::deque<Job> m_pendingJobs;
+		std::deque<Job> m_finishedJobs;
+
+		std::mutex m_mutex;
+		std::condition_variable m_queuedCondition;
+		bool m_stopping;
+
+		std::thread m_thread;
+
+	private:
+		//Savestates stay uncompressed if the thread falls this far behind.
+		static const size_t MaximumPendingJobs = 4096;
+	};
+};
@@ -0,0 +1,445 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#include "TreeCheckpoint.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <string>
+
+#include "Settings/AiSettings.h"
+#include "Settings/ConsoleSettings.h"
+
+
+const uint32_t RamAi::TreeCheckpoint::Magic;
+const uint16_t RamAi::TreeCheckpoint::Version;
+const uint32_t RamAi::TreeCheckpoint::NoIndex;
+
+RamAi::TreeCheckpoint::TreeCheckpoint(const WriteTableHandleSignature &writeTableHandle, const WriteBlobHandleSignature &writeBlobHandle, const bool includeSavestates, const uint64_t romHash)
+{
+	m_writeTableHandle = writeTableHandle;
+	m_writeBlobHandle = writeBlobHandle;
+	m_includeSavestates = includeSavestates;
+	m_romHash = romHash;
+	m_settingsHash = CalculateSettingsHash();
+
+	m_resumed = false;
+	m_resumedRootStateHash = 0;
+
+	m_blobSize = 0;
+	m_pendingBlobSize = 0;
+	memset(&m_header, 0, sizeof(m_header));
+
+	m_queued = false;
+	m_writing = false;
+	m_blobWritten = false;
+	m_writeFailed = false;
+	m_stopping = false;
+
+	m_thread = std::thread(&TreeCheckpoint::ThreadMain, this);
+}
+
+RamAi::TreeCheckpoint::~TreeCheckpoint()
+{
+	//A queued checkpoint is still written before the thread exits.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_queuedCondition.notify_one();
+	m_thread.join();
+}
+
+bool RamAi::TreeCheckpoint::Capture(const MonteCarloTreeBase &tree)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_queued || m_writing)
+	{
+		return false;
+	}
+
+	lock.unlock();
+
+	//The thread is idle, so the buffers can be filled without holding the lock.
+	CommitPendingSavestates();
+
+	m_records.clear();
+	m_newSavestates.clear();
+
+	m_header.magic = Magic;
+	m_header.version = Version;
+	m_header.flags = m_includeSavestates ? Flags::HasSavestates : 0;
+	m_header.bestScoringNodeIndex = NoIndex;
+	m_header.romHash = m_romHash;
+	m_header.settingsHash = m_settingsHash;
+	m_header.rootStateHash = tree.GetRoot().HasSavestate() ? tree.GetRoot().GetSavestate()->CalculateHash() : 0;
+	m_header.bias = tree.GetBias();
+
+	//New savestates go after the ones already written, and are only counted as written once they are.
+	m_pendingBlobSize = m_blobSize;
+
+	std::deque<std::pair<const TreeNode*, uint32_t>> nodesToVisit;
+	nodesToVisit.push_back(std::make_pair(&tree.GetRoot(), NoIndex));
+
+	while (!nodesToVisit.empty())
+	{
+		const TreeNode *node = nodesToVisit.front().first;
+		const uint32_t parentIndex = nodesToVisit.front().second;
+		nodesToVisit.pop_front();
+
+		const uint32_t index = static_cast<uint32_t>(m_records.size());
+
+		NodeRecord record;
+		memset(&record, 0, sizeof(record));
+
+		record.parentIndex = parentIndex;
+		record.depth = node->GetDepth();
+		record.totalScore = node->GetScore().GetTotalScore();
+		record.visits = node->GetScore().GetVisits();
+
+		ButtonSet action;
+
+		if (node->GetParent() && node->GetParent()->GetActionLeadingToChild(*node, action))
+		{
+			record.action = action.GetBitfield().GetValue();
+		}
+
+		if (m_includeSavestates && node->HasSavestate())
+		{
+			auto it = m_writtenSavestates.find(node->GetIdNumber());
+
+			if (it != m_writtenSavestates.end())
+			{
+				record.savestateOffset = it->second.savestateOffset;
+				record.savestateSize = it->second.savestateSize;
+			}
+			else
+			{
+				//New savestates are copied, which only shares their pages, and written after the ones before them.
+				const Savestate &savestate = *node->GetSavestate();
+
+				record.savestateOffset = m_pendingBlobSize;
+				record.savestateSize = static_cast<uint32_t>(savestate.GetSize());
+
+				m_pendingSavestates.push_back(std::make_pair(node->GetIdNumber(), record));
+
+				m_newSavestates.push_back(savestate);
+				m_pendingBlobSize += savestate.GetSize();
+			}
+		}
+
+		if (node == tree.GetBestScoringNode())
+		{
+			m_header.bestScoringNodeIndex = index;
+		}
+
+		m_records.push_back(record);
+
+		for (auto it = node->GetIteratorBegin(); it != node->GetIteratorEnd(); ++it)
+		{
+			nodesToVisit.push_back(std::make_pair(&it->second, index));
+		}
+	}
+
+	m_header.numberOfNodes = static_cast<uint32_t>(m_records.size());
+	m_header.blobSize = m_pendingBlobSize;
+
+	lock.lock();
+	m_queued = true;
+	m_blobWritten = false;
+	lock.unlock();
+
+	m_queuedCondition.notify_one();
+	return true;
+}
+
+void RamAi::TreeCheckpoint::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_writtenCondition.wait(lock, [this]() { return !m_queued && !m_writing; });
+}
+
+bool RamAi::TreeCheckpoint::PopWriteFailed()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const bool writeFailed = m_writeFailed;
+	m_writeFailed = false;
+
+	return writeFailed;
+}
+
+bool RamAi::TreeCheckpoint::Resume(const uint8_t *table, const size_t tableSize, const uint64_t blobSize, const ReadBlobHandleSignature &readBlobHandle, MonteCarloTreeBase &tree)
+{
+	if (!table || tableSize < sizeof(Header))
+	{
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, table, sizeof(header));
+
+	if (header.magic != Magic || header.version != Version || header.numberOfNodes == 0 ||
+		tableSize < sizeof(Header) + static_cast<size_t>(header.numberOfNodes) * sizeof(NodeRecord) || header.blobSize > blobSize)
+	{
+		return false;
+	}
+
+	//A tree searched on another ROM or with other settings would be resumed without complaint, and be meaningless.
+	if (header.romHash != m_romHash || header.settingsHash != m_settingsHash)
+	{
+		return false;
+	}
+
+	assert(tree.GetRoot().IsLeaf());
+
+	//The records are fixed-size and used where they lie; the only work is linking each node to its parent.
+	const NodeRecord *records = reinterpret_cast<const NodeRecord*>(table + sizeof(Header));
+
+	//Check the links first, so a damaged table leaves the tree untouched.
+	//Each parent must come before its children, and no parent can have the same action twice, or adding the child would fail.
+	std::vector<uint64_t> links;
+	links.reserve(header.numberOfNodes - 1);
+
+	for (uint32_t i = 1; i < header.numberOfNodes; ++i)
+	{
+		if (records[i].parentIndex >= i)
+		{
+			return false;
+		}
+
+		links.push_back(static_cast<uint64_t>(records[i].parentIndex) << 32 | records[i].action);
+	}
+
+	std::sort(links.begin(), links.end());
+
+	if (std::adjacent_find(links.begin(), links.end()) != links.end())
+	{
+		return false;
+	}
+
+	std::vector<TreeNode*> nodes(header.numberOfNodes, nullptr);
+
+	Flush();
+
+	m_writtenSavestates.clear();
+	m_pendingSavestates.clear();
+
+	for (uint32_t i = 0; i < header.numberOfNodes; ++i)
+	{
+		const NodeRecord &record = records[i];
+		TreeNode *node = nullptr;
+
+		if (i == 0)
+		{
+			node = &tree.GetRoot();
+		}
+		else
+		{
+			node = nodes[record.parentIndex]->AddChild(ButtonSet(record.action));
+		}
+
+		assert(node);
+
+		node->GetScore() = Score(record.totalScore, record.visits);
+
+		const uint8_t *savestateData = nullptr;
+
+		if ((header.flags & Flags::HasSavestates) && record.savestateSize > 0 && record.savestateOffset + record.savestateSize <= header.blobSize && readBlobHandle)
+		{
+			savestateData = readBlobHandle(record.savestateOffset, record.savestateSize);
+		}
+
+		if (savestateData)
+		{
+			Savestate savestate(savestateData, record.savestateSize);
+
+			//Share unchanged pages with the parent, as expansion does.
+			if (const TreeNode *parent = node->GetParent())
+			{
+				if (parent->HasSavestate())
+				{
+					savestate.SharePagesWith(*parent->GetSavestate());
+				}
+			}
+
+			node->SetSavestate(std::move(savestate));
+
+			//Later checkpoints point at the savestate already in the blob.
+			m_writtenSavestates.insert(std::make_pair(node->GetIdNumber(), record));
+		}
+
+		nodes[i] = node;
+	}
+
+	if (header.bestScoringNodeIndex < header.numberOfNodes)
+	{
+		tree.SetBestScoringNode(nodes[header.bestScoringNodeIndex]);
+	}
+
+	//Anything past the end of the table's blob was never referenced, and will be written over.
+	m_blobSize = header.blobSize;
+
+	m_resumed = true;
+	m_resumedRootStateHash = header.rootStateHash;
+
+	return true;
+}
+
+bool RamAi::TreeCheckpoint::MatchesResumedRoot(const uint64_t rootStateHash) const
+{
+	return !m_resumed || m_resumedRootStateHash == rootStateHash;
+}
+
+void RamAi::TreeCheckpoint::Discard()
+{
+	Flush();
+
+	m_writtenSavestates.clear();
+	m_pendingSavestates.clear();
+	m_blobSize = 0;
+
+	m_resumed = false;
+	m_resumedRootStateHash = 0;
+}
+
+uint64_t RamAi::TreeCheckpoint::CalculateSettingsHash()
+{
+	//Only the settings that change which state a node stands for, or how its score was counted.
+	const AiSettings::Data &aiSettings = AiSettings::GetData();
+	const GameSettings &gameSettings = GameSettings::GetInstance();
+	const ConsoleSettings::Specs &specs = ConsoleSettings::GetSpecs();
+
+	const uint64_t values[] =
+	{
+		aiSettings.macroActionLength,
+		gameSettings.initialisationStartButtonFrames,
+		gameSettings.initialisationTotalFrames,
+		gameSettings.scoreOffset,
+		gameSettings.scoreSize,
+		static_cast<uint64_t>(gameSettings.scoreEndianness),
+		gameSettings.scoreTwoDigitsPerByte,
+		gameSettings.scoreUpperDigitInHighNibble,
+		specs.frameRate,
+		specs.initialisationButtonSet.GetBitfield().GetValue()
+	};
+
+	return CalculateHash(values, sizeof(values));
+}
+
+uint64_t RamAi::TreeCheckpoint::CalculateHash(const void *data, const size_t size, uint64_t hash)
+{
+	const uint8_t *bytes = static_cast<const uint8_t*>(data);
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+void RamAi::TreeCheckpoint::CommitPendingSavestates()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const bool blobWritten = m_blobWritten;
+	lock.unlock();
+
+	//Resuming or discarding drops the pending savestates, along with the write they were waiting on.
+	if (blobWritten && !m_pendingSavestates.empty())
+	{
+		m_writtenSavestates.insert(m_pendingSavestates.cbegin(), m_pendingSavestates.cend());
+		m_blobSize = m_pendingBlobSize;
+	}
+
+	m_pendingSavestates.clear();
+}
+
+void RamAi::TreeCheckpoint::ThreadMain()
+{
+	std::string buffer;
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_queuedCondition.wait(lock, [this]() { return m_queued || m_stopping; });
+
+		if (!m_queued)
+		{
+			break;
+		}
+
+		m_queued = false;
+		m_writing = true;
+
+		lock.unlock();
+
+		bool blobWritten = false;
+		bool writeFailed = false;
+
+		try
+		{
+			//The savestates go first, so the table never refers to data that isn't there.
+			if (m_writeBlobHandle && !m_newSavestates.empty())
+			{
+				buffer.clear();
+
+				for (auto it = m_newSavestates.cbegin(); it != m_newSavestates.cend(); ++it)
+				{
+					const size_t offset = buffer.size();
+					buffer.resize(offset + it->GetSize());
+					it->CopyTo(reinterpret_cast<uint8_t*>(&buffer[offset]));
+				}
+
+				//They were placed so they end where the table's blob does.
+				m_writeBlobHandle(m_header.blobSize - buffer.size(), buffer.data(), buffer.size());
+			}
+
+			blobWritten = true;
+
+			if (m_writeTableHandle)
+			{
+				buffer.assign(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+				buffer.append(reinterpret_cast<const char*>(m_records.data()), m_records.size() * sizeof(NodeRecord));
+
+				m_writeTableHandle(buffer.data(), buffer.size());
+			}
+		}
+		catch (...)
+		{
+			writeFailed = true;
+		}
+
+		//Release the shared pages now rather than at the next capture.
+		m_newSavestates.clear();
+
+		lock.lock();
+
+		m_writing = false;
+		m_blobWritten = blobWritten;
+		m_writeFailed = m_writeFailed || writeFailed;
+
+		m_writtenCondition.notify_all();
+	}
+}
@@ -0,0 +1,170 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "MonteCarloTreeBase.h"
+
+
+namespace RamAi
+{
+	//Writes checkpoints of a search tree in the background, and resumes a tree from one.
+	//A checkpoint is made of two files: a table of fixed-size node records that is replaced each time,
+	//and a blob of savestates that is only appended to. A node's savestate never changes once set,
+	//so each one is written once and later checkpoints refer to it by offset.
+	//A checkpoint is only resumed for the same ROM, the same settings and the same root state it was taken from.
+	class TreeCheckpoint
+	{
+	public:
+		struct Header
+		{
+			uint32_t magic;
+			uint16_t version;
+			uint16_t flags;
+			uint32_t numberOfNodes;
+			uint32_t bestScoringNodeIndex;
+			uint64_t blobSize;					//The size of the blob when this table was written.
+			uint64_t romHash;					//Whatever the backend identifies the ROM by; see the constructor.
+			uint64_t settingsHash;				//CalculateSettingsHash() of the settings the tree was searched with.
+			uint64_t rootStateHash;				//Savestate::CalculateHash() of the root, or 0 if it had none.
+			double bias;
+		};
+
+		//Nodes are stored breadth-first, so a parent always comes before its children.
+		struct NodeRecord
+		{
+			uint32_t parentIndex;
+			uint32_t action;
+			uint32_t depth;
+			uint32_t savestateSize;
+			uint64_t savestateOffset;
+			uint64_t totalScore;
+			uint64_t visits;
+		};
+
+		enum Flags
+		{
+			HasSavestates = 1 << 0
+		};
+
+		static const uint32_t Magic = 0x4B435452; //"RTCK"
+		static const uint16_t Version = 2;
+		static const uint32_t NoIndex = 0xFFFFFFFF;
+
+	public:
+		//Called on the writer's thread. The table handle must replace the whole table; the blob handle writes at the given offset.
+		//Either may throw, in which case the checkpoint is counted as failed and its savestates are written again next time.
+		typedef std::function<void(const char *data, const size_t size)> WriteTableHandleSignature;
+		typedef std::function<void(const uint64_t offset, const char *data, const size_t size)> WriteBlobHandleSignature;
+
+		//Returns the blob's bytes at the given offset, or null if they can't be read.
+		//The pointer only needs to stay valid until the next call, so the blob can be mapped a window at a time.
+		typedef std::function<const uint8_t*(const uint64_t offset, const size_t size)> ReadBlobHandleSignature;
+
+	public:
+		TreeCheckpoint(const WriteTableHandleSignature &writeTableHandle, const WriteBlobHandleSignature &writeBlobHandle, const bool includeSavestates, const uint64_t romHash);
+		TreeCheckpoint(const TreeCheckpoint &other) = delete;
+		TreeCheckpoint(TreeCheckpoint &&other) = delete;
+		~TreeCheckpoint();
+
+	public:
+		TreeCheckpoint &operator= (const TreeCheckpoint &other) = delete;
+		TreeCheckpoint &operator= (TreeCheckpoint &&other) = delete;
+
+	public:
+		//Copies the tree's statistics and queues them to be written.
+		//Returns false without doing anything if the previous checkpoint is still being written.
+		bool Capture(const MonteCarloTreeBase &tree);
+
+		//Blocks until the queued checkpoint has been written.
+		void Flush();
+
+		//Returns true if a write handle has thrown since the last call.
+		bool PopWriteFailed();
+
+		//Rebuilds a tree that only has a root from a checkpoint's table, which would usually be memory-mapped, and its blob.
+		//Returns false without touching the tree if the checkpoint is damaged, or was taken with a different ROM or different settings.
+		//Savestates already in the blob aren't written again by later checkpoints.
+		bool Resume(const uint8_t *table, const size_t tableSize, const uint64_t blobSize, const ReadBlobHandleSignature &readBlobHandle, MonteCarloTreeBase &tree);
+
+		//Returns false if a tree was resumed from a root state other than this one.
+		//The root can only be saved once the game has been initialised, so this is checked after resuming.
+		bool MatchesResumedRoot(const uint64_t rootStateHash) const;
+
+		//Forgets the resumed tree's savestates, so the next checkpoint starts the blob again.
+		void Discard();
+
+		//A hash of the settings that decide what the tree's nodes mean.
+		static uint64_t CalculateSettingsHash();
+
+		//A 64-bit FNV-1a hash, as Savestate::CalculateHash() uses.
+		static uint64_t CalculateHash(const void *data, const size_t size, const uint64_t hash = 0xCBF29CE484222325ULL);
+
+	private:
+		void ThreadMain();
+
+		//Keeps the locations of the last checkpoint's new savestates if they reached the blob, or drops them so they're written again.
+		void CommitPendingSavestates();
+
+	private:
+		WriteTableHandleSignature m_writeTableHandle;
+		WriteBlobHandleSignature m_writeBlobHandle;
+		bool m_includeSavestates;
+		uint64_t m_romHash;
+		uint64_t m_settingsHash;
+
+		//The root state hash of the resumed checkpoint, if there was one.
+		bool m_resumed;
+		uint64_t m_resumedRootStateHash;
+
+		//Where each node's savestate lives in the blob, by node ID, and the size of the blob they fill.
+		//Only used on the search thread, and only updated once the savestates have been written.
+		std::unordered_map<size_t, NodeRecord> m_writtenSavestates;
+		uint64_t m_blobSize;
+
+		//The same for the savestates of the checkpoint being written.
+		std::vector<std::pair<size_t, NodeRecord>> m_pendingSavestates;
+		uint64_t m_pendingBlobSize;
+
+		//The checkpoint being handed to the writer's thread.
+		Header m_header;
+		std::vector<NodeRecord> m_records;
+		std::vector<Savestate> m_newSavestates;
+
+		std::mutex m_mutex;
+		std::condition_variable m_queuedCondition;
+		std::condition_variable m_writtenCondition;
+		bool m_queued;
+		bool m_writing;
+		bool m_blobWritten;
+		bool m_writeFailed;
+		bool m_stopping;
+
+		std::thread m_thread;
+	};
+};
@@ -19,10 +19,13 @@
 
 #include "TreeNode.h"
 
+#include "Metrics.h"
+
 
 RamAi::TreeNode::TreeNode()
 {
 	m_parent = nullptr;
+	m_depth = 0;
 
 	m_idNumber = s_nextIdNumber;
 	++s_nextIdNumber;
@@ -54,6 +57,7 @@ RamAi::TreeNode::TreeNode(TreeNode *parent)
 	: TreeNode()
 {
 	m_parent = parent;
+	m_depth = parent ? parent->m_depth + 1 : 0;
 }
 
 RamAi::TreeNode &RamAi::TreeNode::operator= (const TreeNode &other)
@@ -89,29 +93,24 @@ bool RamAi::TreeNode::GetActionLeadingToChild(const TreeNode &child, ButtonSet &
 	return false;
 }
 
-uint32_t RamAi::TreeNode::CalculateDepth() const
-{
-	uint32_t depth = 0;
-	const TreeNode *currentNode = this;
-
-	while (currentNode = currentNode->GetParent())
-	{
-		++depth;
-	}
-
-	return depth;
-}
-
 RamAi::TreeNode *RamAi::TreeNode::AddChild(const ButtonSet &buttonSet)
 {
 	auto result = m_children.insert({buttonSet, std::move(TreeNode(this))});
-	return result.second ? &(result.first->second) : nullptr;
+	return result.second ? OnChildAdded(result.first->second) : nullptr;
 }
 
 RamAi::TreeNode *RamAi::TreeNode::AddChild(ButtonSet &&buttonSet)
 {
 	auto result = m_children.insert({std::move(buttonSet), std::move(TreeNode(this))});
-	return result.second ? &(result.first->second) : nullptr;
+	return result.second ? OnChildAdded(result.first->second) : nullptr;
+}
+
+RamAi::TreeNode *RamAi::TreeNode::OnChildAdded(TreeNode &child)
+{
+	Metrics::AddToGauge(Metrics::Gauge::TreeNodes, 1);
+	Metrics::RaiseGauge(Metrics::Gauge::TreeMaxDepth, child.GetDepth());
+
+	return &child;
 }
 
 void RamAi::TreeNode::Copy(const TreeNode &other)
@@ -119,6 +118,7 @@ void RamAi::TreeNode::Copy(const TreeNode &other)
 	m_children = other.m_children;
 	m_parent = other.m_parent;
 	m_score = other.m_score;
+	m_depth = other.m_depth;
 	m_idNumber = other.m_idNumber; //We shouldn't allow copying IDs, but whatever. It's just for debugging.
 
 	if (Savestate *otherSavestate = other.m_savestate.get())
@@ -141,6 +141,7 @@ void RamAi::TreeNode::Move(TreeNode &&other)
 	m_savestate = std::move(other.m_savestate);
 
 	m_score = std::move(other.m_score);
+	m_depth = other.m_depth;
 	m_idNumber = other.m_idNumber;
 }
 
@@ -72,13 +72,17 @@ namespace RamAi
 
 		size_t GetIdNumber() const									{ return m_idNumber; }
 
-		uint32_t CalculateDepth() const;
+		//The number of edges between this node and the root, set when the node is created.
+		uint32_t GetDepth() const									{ return m_depth; }
 
 	public:
 		TreeNode *AddChild(const ButtonSet &buttonSet);
 		TreeNode *AddChild(ButtonSet &&buttonSet);
 
 	private:
+		//Updates the tree's metrics, and returns the child.
+		TreeNode *OnChildAdded(TreeNode &child);
+
 		void Copy(const TreeNode &other);
 		void Move(TreeNode &&other);
 
@@ -88,6 +92,8 @@ namespace RamAi
 		std::unique_ptr<Savestate> m_savestate;
 		Score m_score;
 
+		uint32_t m_depth;
+
 		size_t m_idNumber;
 		static size_t s_nextIdNumber;
 	};
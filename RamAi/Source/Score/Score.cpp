@@ -31,6 +31,12 @@ RamAi::Score::Score()
 	m_visits = 0;
 }
 
+RamAi::Score::Score(const uint64_t totalScore, const uint64_t visits)
+{
+	m_totalScore = totalScore;
+	m_visits = visits;
+}
+
 RamAi::Score::Score(const Score &other)
 {
 	Copy(other);
@@ -31,6 +31,7 @@ namespace RamAi
 	{
 	public:
 		Score();
+		Score(const uint64_t totalScore, const uint64_t visits);
 		Score(const Score &other);
 		Score(Score &&other);
 		~Score();
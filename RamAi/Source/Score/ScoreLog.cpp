@@ -19,7 +19,9 @@
 
 #include "ScoreLog.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <ctime>
 
 
@@ -35,7 +37,7 @@ RamAi::ScoreLog::Item::Node::Node(const GameMonteCarloTree &tree, const TreeNode
 {
 	uctScore = tree.CalculateUcbScore(node);
 	averageScore = node.GetScore().GetAverageScore();
-	depth = node.CalculateDepth();
+	depth = node.GetDepth();
 }
 
 std::string RamAi::ScoreLog::Item::Node::GetItemHeadings(const std::string &name, const std::string &delimiter) const
@@ -45,7 +47,28 @@ std::string RamAi::ScoreLog::Item::Node::GetItemHeadings(const std::string &name
 
 std::string RamAi::ScoreLog::Item::Node::GetItemValues(const std::string &delimiter) const
 {
-	return std::to_string(uctScore) + delimiter + std::to_string(averageScore) + delimiter + std::to_string(depth);
+	std::string values;
+	AppendItemValues(values, delimiter);
+	return values;
+}
+
+void RamAi::ScoreLog::Item::Node::AppendItemValues(std::string &buffer, const std::string &delimiter) const
+{
+	//Same formatting as std::to_string(), without the temporary strings.
+	static const size_t valuesSize = 128;
+	char values[valuesSize];
+
+	const int length = snprintf(values, valuesSize, "%f%s%f%s%u", uctScore, delimiter.c_str(), averageScore, delimiter.c_str(), depth);
+
+	if (length >= 0 && static_cast<size_t>(length) < valuesSize)
+	{
+		buffer.append(values, static_cast<size_t>(length));
+	}
+	else
+	{
+		//Only huge scores don't fit.
+		buffer += std::to_string(uctScore) + delimiter + std::to_string(averageScore) + delimiter + std::to_string(depth);
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -67,7 +90,22 @@ std::string RamAi::ScoreLog::Item::GetItemHeadings(const MonteCarloTreeBase &tre
 
 std::string RamAi::ScoreLog::Item::GetItemValues() const
 {
-	return std::to_string(iterationNumber) + s_delimiter + bestNode.GetItemValues(s_delimiter) + s_delimiter + simulatedNode.GetItemValues(s_delimiter) + s_lineTerminator;
+	std::string values;
+	AppendItemValues(values);
+	return values;
+}
+
+void RamAi::ScoreLog::Item::AppendItemValues(std::string &buffer) const
+{
+	static const size_t iterationSize = 16;
+	char iteration[iterationSize];
+
+	buffer.append(iteration, static_cast<size_t>(snprintf(iteration, iterationSize, "%u", iterationNumber)));
+	buffer += s_delimiter;
+	bestNode.AppendItemValues(buffer, s_delimiter);
+	buffer += s_delimiter;
+	simulatedNode.AppendItemValues(buffer, s_delimiter);
+	buffer += s_lineTerminator;
 }
 
 const std::string RamAi::ScoreLog::Item::s_delimiter = "\t";
@@ -75,13 +113,17 @@ const std::string RamAi::ScoreLog::Item::s_lineTerminator = "\r\n";
 
 ////////////////////////////////////////////////////////////////////////////////
 
-RamAi::ScoreLog::ScoreLog(const GameSettings &gameSettings, const SaveLogToFileSignature &saveLogToFileHandle)
+RamAi::ScoreLog::ScoreLog(const GameSettings &gameSettings, const SaveLogToFileSignature &saveLogToFileHandle, const SpillLogToFileSignature &spillLogToFileHandle)
 {
 	m_fileName = std::move(ConstructFileName(gameSettings));
 
 	m_saveLogToFileHandle = saveLogToFileHandle;
+	m_spillLogToFileHandle = spillLogToFileHandle;
+
+	m_items.resize(std::max<size_t>(AiSettings::GetData().scoreLogMemoryItems, 2));
+	m_firstItemIndex = 0;
+	m_numberOfItems = 0;
 
-	m_items.reserve(100);
 	m_currentIteration = 0;
 }
 
@@ -89,6 +131,12 @@ RamAi::ScoreLog::~ScoreLog()
 {
 }
 
+const RamAi::ScoreLog::Item &RamAi::ScoreLog::GetItem(const size_t index) const
+{
+	assert(index >= m_firstItemIndex && index < m_numberOfItems);
+	return m_items[index % m_items.size()];
+}
+
 void RamAi::ScoreLog::UpdateLog(const GameMonteCarloTree &tree, const TreeNode &simulatedNode)
 {
 	++m_currentIteration;
@@ -128,7 +176,33 @@ void RamAi::ScoreLog::AddItem(const GameMonteCarloTree &tree, const TreeNode &si
 
 	item.simulatedNode = Item::Node(tree, simulatedNode);
 
-	m_items.push_back(std::move(item));
+	//Make room in the ring if it's full.
+	if (m_numberOfItems - m_firstItemIndex == m_items.size())
+	{
+		SpillOldestItems(tree);
+	}
+
+	m_items[m_numberOfItems % m_items.size()] = std::move(item);
+	++m_numberOfItems;
+}
+
+void RamAi::ScoreLog::SpillOldestItems(const GameMonteCarloTree &tree)
+{
+	//Give the text log a chance to catch up before any items are discarded.
+	if (m_saveLogToFileHandle)
+	{
+		m_saveLogToFileHandle(*this, tree);
+	}
+
+	//Half the ring is spilled at a time, so it happens rarely and in large blocks.
+	const size_t numberOfItemsToSpill = m_items.size() / 2;
+
+	if (m_spillLogToFileHandle)
+	{
+		m_spillLogToFileHandle(*this, m_firstItemIndex, numberOfItemsToSpill);
+	}
+
+	m_firstItemIndex += numberOfItemsToSpill;
 }
 
 bool RamAi::ScoreLog::ShouldSaveLogToFile(const AiSettings::Data &aiSettings) const
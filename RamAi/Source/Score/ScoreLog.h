@@ -53,6 +53,7 @@ namespace RamAi
 			public:
 				virtual std::string GetItemHeadings(const std::string &name, const std::string &delimiter) const;
 				virtual std::string GetItemValues(const std::string &delimiter) const;
+				virtual void AppendItemValues(std::string &buffer, const std::string &delimiter) const;
 			};
 
 		public:
@@ -70,6 +71,7 @@ namespace RamAi
 			std::string GetItemHeadings(const MonteCarloTreeBase &tree) const; //Ugh.
 
 			virtual std::string GetItemValues() const;
+			virtual void AppendItemValues(std::string &buffer) const;
 
 		protected:
 			static const std::string s_delimiter;
@@ -79,8 +81,11 @@ namespace RamAi
 	public:
 		typedef std::function<void(const ScoreLog&, const MonteCarloTreeBase&)> SaveLogToFileSignature;
 
+		//Called with the oldest items in memory just before they are discarded.
+		typedef std::function<void(const ScoreLog&, const size_t firstItemIndex, const size_t numberOfItems)> SpillLogToFileSignature;
+
 	public:
-		ScoreLog(const GameSettings &gameSettings, const SaveLogToFileSignature &saveLogToFileHandle);
+		ScoreLog(const GameSettings &gameSettings, const SaveLogToFileSignature &saveLogToFileHandle, const SpillLogToFileSignature &spillLogToFileHandle);
 		~ScoreLog();
 
 	public:
@@ -89,22 +94,32 @@ namespace RamAi
 	public:
 		const std::string &GetFileName() const		{ return m_fileName; }
 
-		const std::vector<Item> &GetItems() const	{ return m_items; }
+		//Items are indexed from the start of the log. Only those from GetFirstItemIndex() onwards are still in memory.
+		const Item &GetItem(const size_t index) const;
+		size_t GetFirstItemIndex() const			{ return m_firstItemIndex; }
+		size_t GetNumberOfItems() const				{ return m_numberOfItems; }
+
 		uint32_t GetCurrentIteration() const		{ return m_currentIteration; }
 
 	protected:
 		virtual std::string ConstructFileName(const GameSettings &gameSettings) const;
 
 		void AddItem(const GameMonteCarloTree &tree, const TreeNode &simulatedNode);
+		void SpillOldestItems(const GameMonteCarloTree &tree);
 
 		bool ShouldSaveLogToFile(const AiSettings::Data &aiSettings) const;
 
 	private:
 		std::string m_fileName;
 
+		//A ring of the most recent items.
 		std::vector<Item> m_items;
+		size_t m_firstItemIndex;
+		size_t m_numberOfItems;
+
 		uint32_t m_currentIteration;
 
 		SaveLogToFileSignature m_saveLogToFileHandle;
+		SpillLogToFileSignature m_spillLogToFileHandle;
 	};
 };
\ No newline at end of file
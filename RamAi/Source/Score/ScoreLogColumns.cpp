@@ -0,0 +1,149 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#include "ScoreLogColumns.h"
+
+#include <cassert>
+#include <cstring>
+
+
+RamAi::ScoreLogColumns::Block::Block()
+{
+	m_header = nullptr;
+
+	for (size_t i = 0; i < Column::Max; ++i)
+	{
+		m_columns[i] = nullptr;
+	}
+}
+
+bool RamAi::ScoreLogColumns::Block::Read(const uint8_t *data, const size_t size)
+{
+	m_header = nullptr;
+
+	if (!data || size < sizeof(BlockHeader))
+	{
+		return false;
+	}
+
+	const BlockHeader *header = reinterpret_cast<const BlockHeader*>(data);
+
+	if (header->magic != Magic || header->version != Version || header->numberOfColumns != Column::Max || header->blockSize > size)
+	{
+		return false;
+	}
+
+	size_t offset = sizeof(BlockHeader);
+
+	for (size_t i = 0; i < Column::Max; ++i)
+	{
+		m_columns[i] = data + offset;
+		offset += GetColumnSize(static_cast<Column>(i), header->numberOfItems);
+	}
+
+	if (offset != header->blockSize)
+	{
+		return false;
+	}
+
+	m_header = header;
+	return true;
+}
+
+const uint32_t *RamAi::ScoreLogColumns::Block::GetUint32Column(const Column column) const
+{
+	assert(!IsDoubleColumn(column));
+	return m_header ? reinterpret_cast<const uint32_t*>(m_columns[column]) : nullptr;
+}
+
+const double *RamAi::ScoreLogColumns::Block::GetDoubleColumn(const Column column) const
+{
+	assert(IsDoubleColumn(column));
+	return m_header ? reinterpret_cast<const double*>(m_columns[column]) : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RamAi::ScoreLogColumns::AppendBlock(const ScoreLog &scoreLog, const size_t firstItemIndex, const size_t numberOfItems, std::string &buffer)
+{
+	size_t blockSize = sizeof(BlockHeader);
+
+	for (size_t i = 0; i < Column::Max; ++i)
+	{
+		blockSize += GetColumnSize(static_cast<Column>(i), numberOfItems);
+	}
+
+	//Zero-filled, so the padding is deterministic.
+	const size_t blockOffset = buffer.size();
+	buffer.resize(blockOffset + blockSize, '\0');
+
+	uint8_t *block = reinterpret_cast<uint8_t*>(&buffer[blockOffset]);
+
+	BlockHeader header;
+	header.magic = Magic;
+	header.version = Version;
+	header.numberOfColumns = Column::Max;
+	header.numberOfItems = static_cast<uint32_t>(numberOfItems);
+	header.blockSize = static_cast<uint32_t>(blockSize);
+
+	memcpy(block, &header, sizeof(header));
+
+	size_t offset = sizeof(BlockHeader);
+
+	for (size_t i = 0; i < Column::Max; ++i)
+	{
+		const Column column = static_cast<Column>(i);
+		uint8_t *columnData = block + offset;
+
+		for (size_t j = 0; j < numberOfItems; ++j)
+		{
+			const ScoreLog::Item &item = scoreLog.GetItem(firstItemIndex + j);
+
+			switch (column)
+			{
+			case Column::Iteration:			memcpy(columnData + j * sizeof(uint32_t), &item.iterationNumber, sizeof(uint32_t)); break;
+			case Column::BestUct:			memcpy(columnData + j * sizeof(double), &item.bestNode.uctScore, sizeof(double)); break;
+			case Column::BestAverage:		memcpy(columnData + j * sizeof(double), &item.bestNode.averageScore, sizeof(double)); break;
+			case Column::BestDepth:			memcpy(columnData + j * sizeof(uint32_t), &item.bestNode.depth, sizeof(uint32_t)); break;
+			case Column::SimulatedUct:		memcpy(columnData + j * sizeof(double), &item.simulatedNode.uctScore, sizeof(double)); break;
+			case Column::SimulatedAverage:	memcpy(columnData + j * sizeof(double), &item.simulatedNode.averageScore, sizeof(double)); break;
+			case Column::SimulatedDepth:	memcpy(columnData + j * sizeof(uint32_t), &item.simulatedNode.depth, sizeof(uint32_t)); break;
+			default:						assert(false); break;
+			}
+		}
+
+		offset += GetColumnSize(column, numberOfItems);
+	}
+
+	assert(offset == blockSize);
+}
+
+bool RamAi::ScoreLogColumns::IsDoubleColumn(const Column column)
+{
+	return column != Column::Iteration && column != Column::BestDepth && column != Column::SimulatedDepth;
+}
+
+size_t RamAi::ScoreLogColumns::GetColumnSize(const Column column, const size_t numberOfItems)
+{
+	const size_t size = numberOfItems * (IsDoubleColumn(column) ? sizeof(double) : sizeof(uint32_t));
+
+	//Pad to 8 bytes so the next column stays aligned.
+	return (size + 7) & ~static_cast<size_t>(7);
+}
@@ -0,0 +1,94 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "ScoreLog.h"
+
+
+namespace RamAi
+{
+	//A compact binary form of score log items, used for items spilled out of memory.
+	//A file is a sequence of blocks. Each block is a header followed by one typed array per column,
+	//each padded to 8 bytes, so a memory-mapped file can be read in place.
+	class ScoreLogColumns
+	{
+	public:
+		enum Column
+		{
+			Iteration,			//uint32_t
+			BestUct,			//double
+			BestAverage,		//double
+			BestDepth,			//uint32_t
+			SimulatedUct,		//double
+			SimulatedAverage,	//double
+			SimulatedDepth,		//uint32_t
+			Max
+		};
+
+		struct BlockHeader
+		{
+			uint32_t magic;
+			uint16_t version;
+			uint16_t numberOfColumns;
+			uint32_t numberOfItems;
+			uint32_t blockSize;			//Including the header.
+		};
+
+		static const uint32_t Magic = 0x434C5352; //"RSLC"
+		static const uint16_t Version = 1;
+
+		//A view of a single block within a buffer.
+		class Block
+		{
+		public:
+			Block();
+
+		public:
+			//Reads the block at the start of the buffer. Returns false if it isn't a complete, valid block.
+			bool Read(const uint8_t *data, const size_t size);
+
+		public:
+			size_t GetNumberOfItems() const							{ return m_header ? m_header->numberOfItems : 0; }
+			size_t GetBlockSize() const								{ return m_header ? m_header->blockSize : 0; }
+
+			const uint32_t *GetUint32Column(const Column column) const;
+			const double *GetDoubleColumn(const Column column) const;
+
+		private:
+			const BlockHeader *m_header;
+			const uint8_t *m_columns[Column::Max];
+		};
+
+	public:
+		ScoreLogColumns() = delete;
+		~ScoreLogColumns() = delete;
+
+	public:
+		//Appends a block holding the given items to the buffer.
+		static void AppendBlock(const ScoreLog &scoreLog, const size_t firstItemIndex, const size_t numberOfItems, std::string &buffer);
+
+		static bool IsDoubleColumn(const Column column);
+		static size_t GetColumnSize(const Column column, const size_t numberOfItems);
+	};
+};
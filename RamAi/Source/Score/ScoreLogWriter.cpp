@@ -0,0 +1,149 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#include "ScoreLogWriter.h"
+
+#include <algorithm>
+
+
+RamAi::ScoreLogWriter::ScoreLogWriter(const WriteHandleSignature &writeHandle)
+{
+	m_writeHandle = writeHandle;
+
+	m_itemsWritten = 0;
+
+	m_writing = false;
+	m_writeFailed = false;
+	m_stopping = false;
+
+	m_thread = std::thread(&ScoreLogWriter::ThreadMain, this);
+}
+
+RamAi::ScoreLogWriter::~ScoreLogWriter()
+{
+	//Anything still queued is written before the thread exits.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_queuedCondition.notify_one();
+	m_thread.join();
+}
+
+void RamAi::ScoreLogWriter::Append(const ScoreLog &scoreLog, const MonteCarloTreeBase &tree)
+{
+	//Items that have already left memory can't be written any more.
+	const size_t firstItemIndex = std::max(m_itemsWritten, scoreLog.GetFirstItemIndex());
+	const size_t numberOfItems = scoreLog.GetNumberOfItems();
+
+	if (firstItemIndex >= numberOfItems)
+	{
+		return;
+	}
+
+	//Format outside the lock, into a buffer that keeps its capacity between calls.
+	m_formatBuffer.clear();
+
+	if (m_itemsWritten == 0)
+	{
+		m_formatBuffer += scoreLog.GetItem(firstItemIndex).GetItemHeadings(tree);
+	}
+
+	for (size_t i = firstItemIndex; i < numberOfItems; ++i)
+	{
+		scoreLog.GetItem(i).AppendItemValues(m_formatBuffer);
+	}
+
+	m_itemsWritten = numberOfItems;
+
+	AppendData(m_formatBuffer.data(), m_formatBuffer.size());
+}
+
+void RamAi::ScoreLogWriter::AppendData(const char *data, const size_t size)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queued.append(data, size);
+	}
+
+	m_queuedCondition.notify_one();
+}
+
+void RamAi::ScoreLogWriter::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_writtenCondition.wait(lock, [this]() { return m_queued.empty() && !m_writing; });
+}
+
+bool RamAi::ScoreLogWriter::PopWriteFailed()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const bool writeFailed = m_writeFailed;
+	m_writeFailed = false;
+
+	return writeFailed;
+}
+
+void RamAi::ScoreLogWriter::ThreadMain()
+{
+	std::string writeBuffer;
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_queuedCondition.wait(lock, [this]() { return !m_queued.empty() || m_stopping; });
+
+		if (m_queued.empty())
+		{
+			break;
+		}
+
+		//Take the queued text and write it without holding the lock.
+		writeBuffer.swap(m_queued);
+		m_writing = true;
+
+		lock.unlock();
+
+		bool writeFailed = false;
+
+		try
+		{
+			if (m_writeHandle)
+			{
+				m_writeHandle(writeBuffer.data(), writeBuffer.size());
+			}
+		}
+		catch (...)
+		{
+			writeFailed = true;
+		}
+
+		writeBuffer.clear();
+
+		lock.lock();
+
+		m_writing = false;
+		m_writeFailed = m_writeFailed || writeFailed;
+
+		m_writtenCondition.notify_all();
+	}
+}
@@ -0,0 +1,85 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ScoreLog.h"
+
+
+namespace RamAi
+{
+	//Streams a score log to disk. Only the items added since the last call are formatted, and
+	//they are written by a background thread so the search never waits on the disk.
+	//It can also be used to stream any other data, such as spilled items.
+	class ScoreLogWriter
+	{
+	public:
+		//Called on the writer's thread with each block of text to be appended to the file.
+		typedef std::function<void(const char *data, const size_t size)> WriteHandleSignature;
+
+	public:
+		ScoreLogWriter(const WriteHandleSignature &writeHandle);
+		ScoreLogWriter(const ScoreLogWriter &other) = delete;
+		ScoreLogWriter(ScoreLogWriter &&other) = delete;
+		~ScoreLogWriter();
+
+	public:
+		ScoreLogWriter &operator= (const ScoreLogWriter &other) = delete;
+		ScoreLogWriter &operator= (ScoreLogWriter &&other) = delete;
+
+	public:
+		//Queues the header (on the first call) and every item not yet written.
+		void Append(const ScoreLog &scoreLog, const MonteCarloTreeBase &tree);
+
+		//Queues raw bytes to be written as they are.
+		void AppendData(const char *data, const size_t size);
+
+		//Blocks until everything queued so far has been written.
+		void Flush();
+
+		//Returns true if the write handle has thrown since the last call.
+		bool PopWriteFailed();
+
+	private:
+		void ThreadMain();
+
+	private:
+		WriteHandleSignature m_writeHandle;
+
+		size_t m_itemsWritten;
+		std::string m_formatBuffer;
+
+		std::mutex m_mutex;
+		std::condition_variable m_queuedCondition;
+		std::condition_variable m_writtenCondition;
+		std::string m_queued;
+		bool m_writing;
+		bool m_writeFailed;
+		bool m_stopping;
+
+		std::thread m_thread;
+	};
+};
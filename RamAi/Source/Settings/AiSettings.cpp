@@ -30,7 +30,13 @@ RamAi::AiSettings::Data::Data()
 	simulationMacroActionLength = 1;
 	maximumSimulationTime = 120.0f;
 	scoreLogSaveFrequency = 10;
+	scoreLogMemoryItems = 8192;
 	movieFileSaveFrequency = 1000;
+	bestPathSaveFrequency = 10;
+	metricsFileInterval = 0.0f;
+	checkpointFrequency = 0;
+	checkpointSavestates = true;
+	savestateCompression = SavestateCodec::Type::None;
 }
 
 size_t RamAi::AiSettings::Data::GetMaximumSimulationFrames(const size_t frameRate) const
@@ -73,11 +79,41 @@ RamAi::AiSettings::Data RamAi::AiSettings::Import(char *settingsFile)
 		data.scoreLogSaveFrequency = static_cast<uint32_t>(std::stoi(settingsImporter["ScoreLogSaveFrequency"]));
 	}
 
+	if (settingsImporter.ContainsKey("ScoreLogMemoryItems"))
+	{
+		data.scoreLogMemoryItems = static_cast<uint32_t>(std::stoi(settingsImporter["ScoreLogMemoryItems"]));
+	}
+
 	if (settingsImporter.ContainsKey("MovieFileSaveFrequency"))
 	{
 		data.movieFileSaveFrequency = static_cast<uint32_t>(std::stoi(settingsImporter["MovieFileSaveFrequency"]));
 	}
 
+	if (settingsImporter.ContainsKey("BestPathSaveFrequency"))
+	{
+		data.bestPathSaveFrequency = static_cast<uint32_t>(std::stoi(settingsImporter["BestPathSaveFrequency"]));
+	}
+
+	if (settingsImporter.ContainsKey("MetricsFileInterval"))
+	{
+		data.metricsFileInterval = std::stof(settingsImporter["MetricsFileInterval"]);
+	}
+
+	if (settingsImporter.ContainsKey("CheckpointFrequency"))
+	{
+		data.checkpointFrequency = static_cast<uint32_t>(std::stoi(settingsImporter["CheckpointFrequency"]));
+	}
+
+	if (settingsImporter.ContainsKey("CheckpointSavestates"))
+	{
+		data.checkpointSavestates = (settingsImporter["CheckpointSavestates"] == "True");
+	}
+
+	if (settingsImporter.ContainsKey("SavestateCompression"))
+	{
+		data.savestateCompression = SavestateCodec::FromString(settingsImporter["SavestateCompression"]);
+	}
+
 	return data;
 }
 
@@ -21,6 +21,8 @@
 
 #include <cstdint>
 
+#include "State/SavestateCodec.h"
+
 
 namespace RamAi
 {
@@ -53,9 +55,27 @@ namespace RamAi
 			//How often the score log is saved to disk.
 			uint32_t scoreLogSaveFrequency;
 
+			//The number of score log items kept in memory. Older items are spilled to disk in blocks.
+			uint32_t scoreLogMemoryItems;
+
 			//How often the movie file is saved to disk.
 			uint32_t movieFileSaveFrequency;
 
+			//How often the best path is saved to disk as an action sequence, if it has changed. 0 disables it.
+			uint32_t bestPathSaveFrequency;
+
+			//How often the metrics file is rewritten, in seconds. 0 disables it.
+			float metricsFileInterval;
+
+			//How often the search tree is checkpointed to disk, in iterations. 0 disables checkpoints.
+			uint32_t checkpointFrequency;
+
+			//Whether checkpoints include each node's savestate, so a resumed search can expand old nodes.
+			bool checkpointSavestates;
+
+			//How node savestates are compressed in the background once they're stored. None leaves them uncompressed.
+			SavestateCodec::Type savestateCompression;
+
 		public:
 			size_t GetMaximumSimulationFrames(const size_t frameRate) const;
 		};
@@ -19,19 +19,51 @@
 
 #include "Savestate.h"
 
-RamAi::Savestate::Savestate()
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "Metrics.h"
+#include "Trace.h"
+
+
+namespace
 {
+	//Allocates pages along with their reference counts from the pool, keeping the savestate bytes gauge up to date.
+	template<typename T>
+	struct PageAllocator
+	{
+		typedef T value_type;
+
+		PageAllocator() {}
+		template<typename U> PageAllocator(const PageAllocator<U> &) {}
+
+		T *allocate(const size_t n)
+		{
+			RamAi::Metrics::AddToGauge(RamAi::Metrics::Gauge::SavestateBytes, static_cast<int64_t>(n * sizeof(T)));
+			return static_cast<T*>(RamAi::SavestatePool::Allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T *pointer, const size_t n)
+		{
+			RamAi::Metrics::AddToGauge(RamAi::Metrics::Gauge::SavestateBytes, -static_cast<int64_t>(n * sizeof(T)));
+			RamAi::SavestatePool::Deallocate(pointer, n * sizeof(T));
+		}
+
+		template<typename U> bool operator== (const PageAllocator<U> &) const	{ return true; }
+		template<typename U> bool operator!= (const PageAllocator<U> &) const	{ return false; }
+	};
 }
 
-RamAi::Savestate::Savestate(std::unique_ptr<uint8_t[]> &&data, const size_t size)
-	: m_data(std::move(data))
-	, m_size(size)
+const size_t RamAi::Savestate::PageSize;
+
+RamAi::Savestate::Savestate()
+	: m_size(0)
 {
 }
 
 RamAi::Savestate::Savestate(const uint8_t *data, const size_t size)
-	: m_data(std::make_unique<uint8_t[]>(size))
-	, m_size(size)
+	: m_size(0)
 {
 	CopyBytes(data, size);
 }
@@ -62,24 +94,304 @@ RamAi::Savestate &RamAi::Savestate::operator= (Savestate &&other)
 	return *this;
 }
 
-void RamAi::Savestate::CopyBytes(const uint8_t *bytes, const size_t size)
+size_t RamAi::Savestate::GetNumberOfSharedPages() const
+{
+	size_t sharedPages = 0;
+
+	for (size_t i = 0; i < m_pages.size(); ++i)
+	{
+		if ((m_pages[i] && m_pages[i].use_count() > 1) || (IsCompressed() && m_compressedPages[i] && m_compressedPages[i].use_count() > 1))
+		{
+			++sharedPages;
+		}
+	}
+
+	return sharedPages;
+}
+
+bool RamAi::Savestate::HasUncompressedPages() const
+{
+	return std::any_of(m_pages.begin(), m_pages.end(), [](const std::shared_ptr<Page> &page) { return page != nullptr; });
+}
+
+void RamAi::Savestate::CopyTo(uint8_t *destination) const
+{
+	assert(destination || m_size == 0);
+
+	Page buffer;
+
+	for (size_t i = 0, remaining = m_size; i < m_pages.size(); ++i, remaining -= PageSize)
+	{
+		std::memcpy(destination + i * PageSize, GetPageBytes(i, buffer), std::min(remaining, PageSize));
+	}
+}
+
+uint64_t RamAi::Savestate::CalculateHash() const
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+
+	Page buffer;
+
+	for (size_t i = 0, remaining = m_size; i < m_pages.size(); ++i, remaining -= PageSize)
+	{
+		hash = CalculatePageHash(GetPageBytes(i, buffer), std::min(remaining, PageSize), hash);
+	}
+
+	return hash;
+}
+
+void RamAi::Savestate::Write(const size_t offset, const uint8_t *bytes, const size_t size)
+{
+	assert(offset + size <= m_size);
+
+	Uncompress();
+
+	for (size_t position = offset, end = std::min(offset + size, m_size); position < end;)
+	{
+		std::shared_ptr<Page> &page = m_pages[position / PageSize];
+
+		//Copy-on-write: never modify a page another savestate can see.
+		if (page.use_count() > 1)
+		{
+			page = std::allocate_shared<Page>(PageAllocator<Page>(), *page);
+		}
+
+		const size_t pageOffset = position % PageSize;
+		const size_t length = std::min(PageSize - pageOffset, end - position);
+
+		std::memcpy(page->data() + pageOffset, bytes + (position - offset), length);
+		position += length;
+	}
+}
+
+void RamAi::Savestate::SharePagesWith(const Savestate &other)
+{
+	RAMAI_TRACE_SCOPE("Savestate::SharePagesWith");
+
+	const size_t numberOfPages = std::min(m_pages.size(), other.m_pages.size());
+	size_t pagesShared = 0;
+
+	for (size_t i = 0; i < numberOfPages; ++i)
+	{
+		const std::shared_ptr<const CompressedPage> *compressedPage = IsCompressed() ? &m_compressedPages[i] : nullptr;
+		const std::shared_ptr<const CompressedPage> *otherCompressedPage = other.IsCompressed() ? &other.m_compressedPages[i] : nullptr;
+
+		if (!m_pages[i])
+		{
+			//Already compressed, so it can only be shared if it's the same page.
+			if (otherCompressedPage && *compressedPage == *otherCompressedPage)
+			{
+				++pagesShared;
+			}
+		}
+		else if (other.m_pages[i])
+		{
+			if (m_pages[i] == other.m_pages[i])
+			{
+				++pagesShared;
+			}
+			else if (*m_pages[i] == *other.m_pages[i])
+			{
+				m_pages[i] = other.m_pages[i];
+				++pagesShared;
+			}
+		}
+		else if ((*otherCompressedPage)->Matches(*m_pages[i], CalculatePageHash(m_pages[i]->data(), PageSize)))
+		{
+			SetCompressedPage(i, *otherCompressedPage);
+			++pagesShared;
+		}
+	}
+
+	Metrics::Add(Metrics::Counter::SavestatePagesShared, pagesShared);
+	Metrics::Add(Metrics::Counter::SavestatePagesUnshared, m_pages.size() - pagesShared);
+}
+
+RamAi::Savestate RamAi::Savestate::CompressAgainst(const Savestate *parent, const SavestateCodec::Type codec) const
+{
+	RAMAI_TRACE_SCOPE("Savestate::CompressAgainst");
+
+	Savestate compressed(*this);
+
+	if (codec == SavestateCodec::Type::None)
+	{
+		return compressed;
+	}
+
+	size_t inputBytes = 0;
+	size_t outputBytes = 0;
+
+	//Each page is compressed into the same buffer, and only copied out if it's kept.
+	std::vector<uint8_t> buffer;
+	buffer.reserve(PageSize * 2);
+
+	Metrics::ScopedTimer timer(Metrics::Counter::SavestateCompressionNanoseconds);
+
+	for (size_t i = 0; i < m_pages.size(); ++i)
+	{
+		if (!m_pages[i])
+		{
+			continue;
+		}
+
+		const bool inParent = parent && i < parent->m_pages.size();
+
+		if (inParent && m_pages[i] == parent->m_pages[i])
+		{
+			continue;
+		}
+
+		const uint64_t pageHash = CalculatePageHash(m_pages[i]->data(), PageSize);
+
+		//The parent may have compressed this page since the child shared it, so reuse its compressed copy.
+		if (inParent && parent->IsCompressed() && parent->m_compressedPages[i] && parent->m_compressedPages[i]->Matches(*m_pages[i], pageHash))
+		{
+			compressed.SetCompressedPage(i, parent->m_compressedPages[i]);
+			continue;
+		}
+
+		buffer.clear();
+		SavestateCodec::Compress(codec, m_pages[i]->data(), PageSize, buffer);
+
+		inputBytes += PageSize;
+		outputBytes += buffer.size();
+
+		//Pages that don't compress are cheaper to keep as they are.
+		if (buffer.size() < PageSize)
+		{
+			compressed.SetCompressedPage(i, std::make_shared<const CompressedPage>(codec, std::vector<uint8_t>(buffer.begin(), buffer.end()), pageHash));
+		}
+	}
+
+	Metrics::Add(Metrics::Counter::SavestateCompressionInputBytes, inputBytes);
+	Metrics::Add(Metrics::Counter::SavestateCompressionOutputBytes, outputBytes);
+
+	return compressed;
+}
+
+RamAi::Savestate::CompressedPage::CompressedPage(const SavestateCodec::Type codec, std::vector<uint8_t> &&data, const uint64_t hash)
+	: codec(codec)
+	, data(std::move(data))
+	, hash(hash)
+{
+	Metrics::AddToGauge(Metrics::Gauge::SavestateCompressedBytes, static_cast<int64_t>(this->data.capacity()));
+}
+
+RamAi::Savestate::CompressedPage::~CompressedPage()
+{
+	Metrics::AddToGauge(Metrics::Gauge::SavestateCompressedBytes, -static_cast<int64_t>(data.capacity()));
+}
+
+void RamAi::Savestate::CompressedPage::Decompress(Page &outPage) const
+{
+	{
+		Metrics::ScopedTimer timer(Metrics::Counter::SavestateDecompressionNanoseconds);
+
+		const bool decompressed = SavestateCodec::Decompress(codec, data.data(), data.size(), outPage.data(), PageSize);
+		assert(decompressed);
+		(void)decompressed;
+	}
+
+	Metrics::Add(Metrics::Counter::SavestateDecompressedBytes, PageSize);
+}
+
+bool RamAi::Savestate::CompressedPage::Matches(const Page &page, const uint64_t pageHash) const
+{
+	if (hash != pageHash)
+	{
+		return false;
+	}
+
+	Page decompressed;
+	Decompress(decompressed);
+
+	return decompressed == page;
+}
+
+const uint8_t *RamAi::Savestate::GetPageBytes(const size_t index, Page &buffer) const
+{
+	if (m_pages[index])
+	{
+		return m_pages[index]->data();
+	}
+
+	m_compressedPages[index]->Decompress(buffer);
+	return buffer.data();
+}
+
+void RamAi::Savestate::SetCompressedPage(const size_t index, const std::shared_ptr<const CompressedPage> &page)
+{
+	if (!IsCompressed())
+	{
+		m_compressedPages.resize(m_pages.size());
+	}
+
+	m_compressedPages[index] = page;
+	m_pages[index].reset();
+}
+
+void RamAi::Savestate::Uncompress()
+{
+	if (!IsCompressed())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_pages.size(); ++i)
+	{
+		if (!m_pages[i])
+		{
+			m_pages[i] = std::allocate_shared<Page>(PageAllocator<Page>());
+			m_compressedPages[i]->Decompress(*m_pages[i]);
+		}
+	}
+
+	m_compressedPages.clear();
+	m_compressedPages.shrink_to_fit();
+}
+
+uint64_t RamAi::Savestate::CalculatePageHash(const uint8_t *bytes, const size_t size, uint64_t hash)
 {
 	for (size_t i = 0; i < size; ++i)
 	{
-		m_data[i] = bytes[i];
+		hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+void RamAi::Savestate::CopyBytes(const uint8_t *bytes, const size_t size)
+{
+	m_size = size;
+	m_pages.clear();
+	m_compressedPages.clear();
+	m_pages.reserve((size + PageSize - 1) / PageSize);
+
+	for (size_t offset = 0; offset < size; offset += PageSize)
+	{
+		std::shared_ptr<Page> page = std::allocate_shared<Page>(PageAllocator<Page>());
+		const size_t length = std::min(PageSize, size - offset);
+
+		std::memcpy(page->data(), bytes + offset, length);
+		std::fill(page->begin() + length, page->end(), 0);
+
+		m_pages.push_back(std::move(page));
 	}
 }
 
 void RamAi::Savestate::Copy(const Savestate &other)
 {
+	//Pages are shared rather than duplicated; see Write().
+	m_pages = other.m_pages;
+	m_compressedPages = other.m_compressedPages;
 	m_size = other.m_size;
-
-	m_data = std::make_unique<uint8_t[]>(m_size);
-	CopyBytes(other.GetData().get(), m_size);
 }
 
 void RamAi::Savestate::Move(Savestate &&other)
 {
-	m_data = std::move(other.m_data);
+	m_pages = std::move(other.m_pages);
+	m_compressedPages = std::move(other.m_compressedPages);
 	m_size = other.m_size;
+
+	other.m_size = 0;
 }
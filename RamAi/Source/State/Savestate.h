@@ -19,17 +19,31 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <vector>
+
+#include "SavestateCodec.h"
+#include "SavestatePool.h"
 
 
 namespace RamAi
 {
 	//Holds space for a savestate, which is given to or recieved from the emulator.
+	//The bytes are stored in reference-counted pages. Copies share their pages and only
+	//duplicate the ones they write to, so a child's stored state can share its parent's storage.
+	//Only the stored bytes are shared; the emulator itself is never forked, so every restore is a full load.
+	//Pages can also be compressed one by one. A compressed page is shared the same way, so compressing a parent doesn't
+	//stop its children sharing with it, and reading one page never decompresses more than that page.
 	class Savestate
 	{
+	public:
+		static const size_t PageSize = 256;
+		typedef std::array<uint8_t, PageSize> Page;
+
 	public:
 		Savestate();
-		Savestate(std::unique_ptr<uint8_t[]> &&data, const size_t size);
 		Savestate(const uint8_t *data, const size_t size);
 		Savestate(const Savestate &other);
 		Savestate(Savestate &&other);
@@ -40,19 +54,75 @@ namespace RamAi
 		Savestate &operator= (Savestate &&other);
 
 	public:
-		const std::unique_ptr<uint8_t[]> &GetData() const	{ return m_data; }
-		std::unique_ptr<uint8_t[]> &GetData()				{ return m_data; }
+		//Tree nodes allocate their savestates on the heap, so take them from the pool too.
+		static void *operator new(const size_t size)						{ return SavestatePool::Allocate(size); }
+		static void operator delete(void *pointer, const size_t size)		{ SavestatePool::Deallocate(pointer, size); }
 
+	public:
 		size_t GetSize() const								{ return m_size; }
+		size_t GetNumberOfPages() const						{ return m_pages.size(); }
+		size_t GetNumberOfSharedPages() const;
+
+		bool IsCompressed() const							{ return !m_compressedPages.empty(); }
+		bool HasUncompressedPages() const;
+
+		void CopyTo(uint8_t *destination) const;
+
+		//A 64-bit FNV-1a hash of the bytes, used to tell whether two savestates hold the same state.
+		uint64_t CalculateHash() const;
+		void Write(const size_t offset, const uint8_t *bytes, const size_t size);
+
+		//Points any pages identical to the other savestate's at its storage instead, whether or not it's compressed.
+		void SharePagesWith(const Savestate &other);
+
+		//Returns a copy with its pages compressed, except for those it shares with the parent (if given),
+		//which stay shared even if the parent has been compressed since. This is safe to call from any thread.
+		Savestate CompressAgainst(const Savestate *parent, const SavestateCodec::Type codec) const;
 
 	private:
+		//A page compressed on its own, along with the hash of its bytes so it can be compared without decompressing it.
+		struct CompressedPage
+		{
+			CompressedPage(const SavestateCodec::Type codec, std::vector<uint8_t> &&data, const uint64_t hash);
+			CompressedPage(const CompressedPage &other) = delete;
+			~CompressedPage();
+
+			CompressedPage &operator= (const CompressedPage &other) = delete;
+
+			void Decompress(Page &outPage) const;
+
+			//Only decompresses the page if the hashes match, to be sure of it.
+			bool Matches(const Page &page, const uint64_t pageHash) const;
+
+			SavestateCodec::Type codec;
+			std::vector<uint8_t> data;
+			uint64_t hash;
+		};
+
+	private:
+		//Returns the page's bytes, decompressing them into the buffer if it's compressed.
+		const uint8_t *GetPageBytes(const size_t index, Page &buffer) const;
+
+		//Stores the page in the slot in place of its uncompressed page.
+		void SetCompressedPage(const size_t index, const std::shared_ptr<const CompressedPage> &page);
+
+		//Turns any compressed pages back into ordinary ones, so they can be written to.
+		void Uncompress();
+
+		static uint64_t CalculatePageHash(const uint8_t *bytes, const size_t size, const uint64_t hash = 0xCBF29CE484222325ULL);
+
 		void CopyBytes(const uint8_t *bytes, const size_t size);
 
 		void Copy(const Savestate &other);
 		void Move(Savestate &&other);
 
 	private:
-		std::unique_ptr<uint8_t[]> m_data;
+		//Compressed pages are left null here.
+		std::vector<std::shared_ptr<Page>, SavestatePool::Allocator<std::shared_ptr<Page>>> m_pages;
+
+		//Empty if no page is compressed. Otherwise there's one for each page, which is null if the page isn't compressed.
+		std::vector<std::shared_ptr<const CompressedPage>, SavestatePool::Allocator<std::shared_ptr<const CompressedPage>>> m_compressedPages;
+
 		size_t m_size;
 	};
 };
@@ -0,0 +1,388 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "SavestateCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+	void AppendVarint(size_t value, std::vector<uint8_t> &output)
+	{
+		while (value >= 0x80)
+		{
+			output.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+
+		output.push_back(static_cast<uint8_t>(value));
+	}
+
+	bool ReadVarint(const uint8_t *&source, const uint8_t *end, size_t &outValue)
+	{
+		outValue = 0;
+
+		for (size_t shift = 0; source < end && shift < sizeof(size_t) * 8; shift += 7)
+		{
+			const uint8_t byte = *source++;
+			outValue |= static_cast<size_t>(byte & 0x7F) << shift;
+
+			if (!(byte & 0x80))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//LZ4 stores lengths of 15 or more as 15 in the token, followed by bytes of 255 and a final remainder.
+	void AppendLz4Length(size_t length, std::vector<uint8_t> &output)
+	{
+		while (length >= 255)
+		{
+			output.push_back(255);
+			length -= 255;
+		}
+
+		output.push_back(static_cast<uint8_t>(length));
+	}
+
+	bool ReadLz4Length(const uint8_t *&source, const uint8_t *end, size_t &length)
+	{
+		uint8_t byte;
+
+		do
+		{
+			if (source >= end)
+			{
+				return false;
+			}
+
+			byte = *source++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	uint32_t Read32(const uint8_t *source)
+	{
+		uint32_t value;
+		std::memcpy(&value, source, sizeof(value));
+
+		return value;
+	}
+}
+
+RamAi::SavestateCodec::Type RamAi::SavestateCodec::FromString(const std::string &name)
+{
+	for (size_t i = 0; i < Type::Max; ++i)
+	{
+		if (name == ToString(static_cast<Type>(i)))
+		{
+			return static_cast<Type>(i);
+		}
+	}
+
+	return Type::None;
+}
+
+const char *RamAi::SavestateCodec::ToString(const Type type)
+{
+	switch (type)
+	{
+	case Type::ZeroRun:		return "ZeroRun";
+	case Type::Lz4:			return "Lz4";
+	default:				return "None";
+	}
+}
+
+void RamAi::SavestateCodec::Compress(const Type type, const uint8_t *source, const size_t sourceSize, std::vector<uint8_t> &output)
+{
+	switch (type)
+	{
+	case Type::ZeroRun:
+		CompressZeroRun(source, sourceSize, output);
+		break;
+
+	case Type::Lz4:
+		CompressLz4(source, sourceSize, output);
+		break;
+
+	default:
+		output.insert(output.end(), source, source + sourceSize);
+		break;
+	}
+}
+
+bool RamAi::SavestateCodec::Decompress(const Type type, const uint8_t *source, const size_t sourceSize, uint8_t *destination, const size_t destinationSize)
+{
+	switch (type)
+	{
+	case Type::ZeroRun:
+		return DecompressZeroRun(source, sourceSize, destination, destinationSize);
+
+	case Type::Lz4:
+		return DecompressLz4(source, sourceSize, destination, destinationSize);
+
+	default:
+		if (sourceSize != destinationSize)
+		{
+			return false;
+		}
+
+		std::memcpy(destination, source, sourceSize);
+		return true;
+	}
+}
+
+void RamAi::SavestateCodec::CompressZeroRun(const uint8_t *source, const size_t sourceSize, std::vector<uint8_t> &output)
+{
+	//Each run is stored as the number of zeros, the number of literal bytes, then the literals themselves.
+	size_t position = 0;
+
+	while (position < sourceSize)
+	{
+		const size_t zerosStart = position;
+
+		while (position < sourceSize && source[position] == 0)
+		{
+			++position;
+		}
+
+		const size_t literalsStart = position;
+
+		//Literals carry on until the next zero run that's long enough to be worth breaking for.
+		while (position < sourceSize)
+		{
+			if (source[position] != 0)
+			{
+				++position;
+				continue;
+			}
+
+			size_t zeroRunEnd = position;
+
+			while (zeroRunEnd < sourceSize && source[zeroRunEnd] == 0 && zeroRunEnd - position < MinimumZeroRun)
+			{
+				++zeroRunEnd;
+			}
+
+			if (zeroRunEnd - position >= MinimumZeroRun || zeroRunEnd == sourceSize)
+			{
+				break;
+			}
+
+			position = zeroRunEnd;
+		}
+
+		AppendVarint(literalsStart - zerosStart, output);
+		AppendVarint(position - literalsStart, output);
+		output.insert(output.end(), source + literalsStart, source + position);
+	}
+}
+
+bool RamAi::SavestateCodec::DecompressZeroRun(const uint8_t *source, const size_t sourceSize, uint8_t *destination, const size_t destinationSize)
+{
+	const uint8_t *end = source + sourceSize;
+	size_t position = 0;
+
+	while (source < end)
+	{
+		size_t zeros, literals;
+
+		if (!ReadVarint(source, end, zeros) || !ReadVarint(source, end, literals))
+		{
+			return false;
+		}
+
+		if (zeros > destinationSize - position || literals > destinationSize - position - zeros || literals > static_cast<size_t>(end - source))
+		{
+			return false;
+		}
+
+		std::memset(destination + position, 0, zeros);
+		position += zeros;
+
+		std::memcpy(destination + position, source, literals);
+		position += literals;
+		source += literals;
+	}
+
+	return position == destinationSize;
+}
+
+void RamAi::SavestateCodec::CompressLz4(const uint8_t *source, const size_t sourceSize, std::vector<uint8_t> &output)
+{
+	//A greedy single-pass matcher: each position is hashed on its next four bytes and checked against the last position with that hash.
+	//Positions are stored plus one, so zero means empty.
+	//The table has about one entry per input byte, up to its full size.
+	size_t hashBits = Lz4MinimumHashBits;
+
+	while (hashBits < Lz4HashBits && (static_cast<size_t>(1) << hashBits) < sourceSize)
+	{
+		++hashBits;
+	}
+
+	uint32_t hashTable[1 << Lz4HashBits];
+	std::fill(hashTable, hashTable + (static_cast<size_t>(1) << hashBits), 0);
+
+	const size_t matchFindEnd = (sourceSize > Lz4MatchFindLimit) ? sourceSize - Lz4MatchFindLimit : 0;
+	const size_t matchEnd = (sourceSize > Lz4LastLiterals) ? sourceSize - Lz4LastLiterals : 0;
+
+	size_t anchor = 0;
+	size_t position = 0;
+
+	while (position < matchFindEnd)
+	{
+		const uint32_t sequence = Read32(source + position);
+		const uint32_t hash = (sequence * 2654435761U) >> (32 - hashBits);
+
+		const size_t candidate = hashTable[hash];
+		hashTable[hash] = static_cast<uint32_t>(position + 1);
+
+		if (candidate == 0 || position - (candidate - 1) > Lz4MaximumOffset || Read32(source + candidate - 1) != sequence)
+		{
+			++position;
+			continue;
+		}
+
+		const size_t matchStart = candidate - 1;
+		size_t matchLength = Lz4MinimumMatch;
+
+		while (position + matchLength < matchEnd && source[matchStart + matchLength] == source[position + matchLength])
+		{
+			++matchLength;
+		}
+
+		//Token, then literals, then the offset and the rest of the match length.
+		const size_t literalLength = position - anchor;
+		const size_t extraMatchLength = matchLength - Lz4MinimumMatch;
+
+		output.push_back(static_cast<uint8_t>(((literalLength < 15) ? literalLength : 15) << 4 | ((extraMatchLength < 15) ? extraMatchLength : 15)));
+
+		if (literalLength >= 15)
+		{
+			AppendLz4Length(literalLength - 15, output);
+		}
+
+		output.insert(output.end(), source + anchor, source + position);
+
+		const size_t offset = position - matchStart;
+		output.push_back(static_cast<uint8_t>(offset));
+		output.push_back(static_cast<uint8_t>(offset >> 8));
+
+		if (extraMatchLength >= 15)
+		{
+			AppendLz4Length(extraMatchLength - 15, output);
+		}
+
+		position += matchLength;
+		anchor = position;
+	}
+
+	//The block always ends with a sequence of literals only.
+	const size_t literalLength = sourceSize - anchor;
+	output.push_back(static_cast<uint8_t>(((literalLength < 15) ? literalLength : 15) << 4));
+
+	if (literalLength >= 15)
+	{
+		AppendLz4Length(literalLength - 15, output);
+	}
+
+	output.insert(output.end(), source + anchor, source + sourceSize);
+}
+
+bool RamAi::SavestateCodec::DecompressLz4(const uint8_t *source, const size_t sourceSize, uint8_t *destination, const size_t destinationSize)
+{
+	const uint8_t *end = source + sourceSize;
+	size_t position = 0;
+
+	while (source < end)
+	{
+		const uint8_t token = *source++;
+
+		size_t literalLength = token >> 4;
+
+		if (literalLength == 15 && !ReadLz4Length(source, end, literalLength))
+		{
+			return false;
+		}
+
+		if (literalLength > static_cast<size_t>(end - source) || literalLength > destinationSize - position)
+		{
+			return false;
+		}
+
+		std::memcpy(destination + position, source, literalLength);
+		position += literalLength;
+		source += literalLength;
+
+		//The last sequence has no match.
+		if (source == end)
+		{
+			break;
+		}
+
+		if (end - source < 2)
+		{
+			return false;
+		}
+
+		const size_t offset = source[0] | (static_cast<size_t>(source[1]) << 8);
+		source += 2;
+
+		size_t matchLength = token & 0x0F;
+
+		if (matchLength == 15 && !ReadLz4Length(source, end, matchLength))
+		{
+			return false;
+		}
+
+		matchLength += Lz4MinimumMatch;
+
+		if (offset == 0 || offset > position || matchLength > destinationSize - position)
+		{
+			return false;
+		}
+
+		//Matches can overlap the bytes they produce, so copy forwards one byte at a time.
+		const uint8_t *match = destination + position - offset;
+
+		for (size_t i = 0; i < matchLength; ++i)
+		{
+			destination[position + i] = match[i];
+		}
+
+		position += matchLength;
+	}
+
+	return position == destinationSize;
+}
+
+const size_t RamAi::SavestateCodec::MinimumZeroRun;
+const size_t RamAi::SavestateCodec::Lz4MinimumMatch;
+const size_t RamAi::SavestateCodec::Lz4LastLiterals;
+const size_t RamAi::SavestateCodec::Lz4MatchFindLimit;
+const size_t RamAi::SavestateCodec::Lz4MaximumOffset;
+const size_t RamAi::SavestateCodec::Lz4HashBits;
+const size_t RamAi::SavestateCodec::Lz4MinimumHashBits;
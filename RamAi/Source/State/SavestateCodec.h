@@ -0,0 +1,79 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace RamAi
+{
+	//Static class of the codecs that can compress savestate pages.
+	//They are chosen for speed over ratio, since every expansion produces a savestate.
+	class SavestateCodec
+	{
+	public:
+		enum Type
+		{
+			None,
+			ZeroRun,		//Runs of zero bytes are stored as their length. Most of a savestate is zero.
+			Lz4,			//The LZ4 block format.
+			Max
+		};
+
+	public:
+		SavestateCodec() = delete;
+		~SavestateCodec() = delete;
+
+	public:
+		//Parses the name used in aiSettings.xml. Unknown names give None.
+		static Type FromString(const std::string &name);
+		static const char *ToString(const Type type);
+
+		//Appends the compressed bytes to the output.
+		static void Compress(const Type type, const uint8_t *source, const size_t sourceSize, std::vector<uint8_t> &output);
+
+		//Returns false if the data is corrupt or doesn't decompress to exactly the destination size.
+		static bool Decompress(const Type type, const uint8_t *source, const size_t sourceSize, uint8_t *destination, const size_t destinationSize);
+
+	private:
+		static void CompressZeroRun(const uint8_t *source, const size_t sourceSize, std::vector<uint8_t> &output);
+		static bool DecompressZeroRun(const uint8_t *source, const size_t sourceSize, uint8_t *destination, const size_t destinationSize);
+
+		static void CompressLz4(const uint8_t *source, const size_t sourceSize, std::vector<uint8_t> &output);
+		static bool DecompressLz4(const uint8_t *source, const size_t sourceSize, uint8_t *destination, const size_t destinationSize);
+
+	private:
+		//Zero runs shorter than this are cheaper to store as literals.
+		static const size_t MinimumZeroRun = 4;
+
+		//LZ4 block format limits.
+		static const size_t Lz4MinimumMatch = 4;
+		static const size_t Lz4LastLiterals = 5;
+		static const size_t Lz4MatchFindLimit = 12;
+		static const size_t Lz4MaximumOffset = 65535;
+		static const size_t Lz4HashBits = 12;
+
+		//Smaller inputs use a smaller hash table, so clearing it doesn't cost more than compressing them. Pages are 256 bytes.
+		static const size_t Lz4MinimumHashBits = 8;
+	};
+};
@@ -0,0 +1,133 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#include "SavestatePool.h"
+
+#include <new>
+
+#include "Metrics.h"
+
+
+namespace
+{
+	//Set once a thread's cache has been destroyed. A bool has no destructor, so this can still be read afterwards.
+	thread_local bool s_isCacheDestroyed = false;
+}
+
+RamAi::SavestatePool::Cache::Cache()
+{
+	for (size_t i = 0; i < NumberOfSizeClasses; ++i)
+	{
+		freeLists[i] = nullptr;
+		cachedBytes[i] = 0;
+	}
+}
+
+RamAi::SavestatePool::Cache::~Cache()
+{
+	//Savestates freed after this, such as those in static trees, go straight back to the heap.
+	s_isCacheDestroyed = true;
+
+	for (size_t i = 0; i < NumberOfSizeClasses; ++i)
+	{
+		while (FreeBlock *block = freeLists[i])
+		{
+			freeLists[i] = block->next;
+			::operator delete(block);
+		}
+
+		Metrics::AddToGauge(Metrics::Gauge::SavestatePoolBytes, -static_cast<int64_t>(cachedBytes[i]));
+	}
+}
+
+void *RamAi::SavestatePool::Allocate(const size_t size)
+{
+	if (size <= MaximumPooledSize)
+	{
+		if (Cache *cache = GetCache())
+		{
+			const size_t sizeClass = GetSizeClass(size);
+
+			if (FreeBlock *block = cache->freeLists[sizeClass])
+			{
+				cache->freeLists[sizeClass] = block->next;
+				cache->cachedBytes[sizeClass] -= (sizeClass + 1) * SizeClassGranularity;
+
+				Metrics::AddToGauge(Metrics::Gauge::SavestatePoolBytes, -static_cast<int64_t>((sizeClass + 1) * SizeClassGranularity));
+				Metrics::Add(Metrics::Counter::SavestatePoolHits);
+
+				return block;
+			}
+		}
+
+		//Allocate the whole size class, so the block can be reused for any size in it.
+		Metrics::Add(Metrics::Counter::SavestatePoolMisses);
+		return ::operator new((GetSizeClass(size) + 1) * SizeClassGranularity);
+	}
+
+	Metrics::Add(Metrics::Counter::SavestatePoolMisses);
+	return ::operator new(size);
+}
+
+void RamAi::SavestatePool::Deallocate(void *pointer, const size_t size)
+{
+	if (!pointer)
+	{
+		return;
+	}
+
+	if (size <= MaximumPooledSize)
+	{
+		const size_t sizeClass = GetSizeClass(size);
+		const size_t blockSize = (sizeClass + 1) * SizeClassGranularity;
+
+		Cache *cache = GetCache();
+
+		if (cache && cache->cachedBytes[sizeClass] + blockSize <= MaximumCachedBytesPerSizeClass)
+		{
+			FreeBlock *block = static_cast<FreeBlock*>(pointer);
+			block->next = cache->freeLists[sizeClass];
+
+			cache->freeLists[sizeClass] = block;
+			cache->cachedBytes[sizeClass] += blockSize;
+
+			Metrics::AddToGauge(Metrics::Gauge::SavestatePoolBytes, static_cast<int64_t>(blockSize));
+			return;
+		}
+	}
+
+	//Every block was allocated on its own, so any of them can be handed back to the heap.
+	::operator delete(pointer);
+}
+
+RamAi::SavestatePool::Cache *RamAi::SavestatePool::GetCache()
+{
+	if (s_isCacheDestroyed)
+	{
+		return nullptr;
+	}
+
+	thread_local Cache cache;
+	return &cache;
+}
+
+const size_t RamAi::SavestatePool::SizeClassGranularity;
+const size_t RamAi::SavestatePool::MaximumPooledSize;
+const size_t RamAi::SavestatePool::NumberOfSizeClasses;
+const size_t RamAi::SavestatePool::MaximumCachedBytesPerSizeClass;
@@ -0,0 +1,86 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace RamAi
+{
+	//Static class that recycles the memory used by savestates.
+	//Every savestate of a game is about the same size and made of the same size pages, so freed blocks are kept
+	//in lists by size class and handed straight back out. Each thread keeps its own lists, so no locks are taken.
+	class SavestatePool
+	{
+	public:
+		//A standard allocator that takes its memory from the pool.
+		template<typename T>
+		struct Allocator
+		{
+			typedef T value_type;
+
+			Allocator()																	{}
+			template<typename U> Allocator(const Allocator<U> &)							{}
+
+			T *allocate(const size_t n)													{ return static_cast<T*>(Allocate(n * sizeof(T))); }
+			void deallocate(T *pointer, const size_t n)									{ Deallocate(pointer, n * sizeof(T)); }
+
+			template<typename U> bool operator== (const Allocator<U> &) const			{ return true; }
+			template<typename U> bool operator!= (const Allocator<U> &) const			{ return false; }
+		};
+
+	public:
+		SavestatePool() = delete;
+		~SavestatePool() = delete;
+
+	public:
+		//Blocks larger than the biggest size class come straight from the heap and count as misses.
+		static void *Allocate(const size_t size);
+		static void Deallocate(void *pointer, const size_t size);
+
+	public:
+		static const size_t SizeClassGranularity = 64;
+		static const size_t MaximumPooledSize = 4096;
+		static const size_t NumberOfSizeClasses = MaximumPooledSize / SizeClassGranularity;
+
+		//Beyond this, freed blocks of a size class go back to the heap, so a thread that only frees can't hoard memory.
+		static const size_t MaximumCachedBytesPerSizeClass = 8 * 1024 * 1024;
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock *next;
+		};
+
+		struct Cache
+		{
+			Cache();
+			~Cache();
+
+			FreeBlock *freeLists[NumberOfSizeClasses];
+			size_t cachedBytes[NumberOfSizeClasses];
+		};
+
+		static size_t GetSizeClass(const size_t size)			{ return (size > 0) ? (size - 1) / SizeClassGranularity : 0; }
+
+		static Cache *GetCache();
+	};
+};
@@ -0,0 +1,56 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Action/ButtonSet.h"
+#include "Score/ScoreLog.h"
+#include "State/Savestate.h"
+
+
+namespace RamAi
+{
+	//The emulator that the state machine drives, implemented once by the front-end.
+	//There's nothing here to step frames or read RAM: the emulator calls CalculateInput once per frame with its RAM.
+	class EmulatorBackend
+	{
+	public:
+		virtual ~EmulatorBackend()															{}
+
+	public:
+		//Writes the emulator's current state into the savestate. Returns false if it couldn't be saved.
+		virtual bool SaveInto(Savestate &savestate) = 0;
+
+		//Restores the emulator's state from the contiguous bytes of a savestate.
+		virtual void LoadFrom(const uint8_t *data, const size_t size) = 0;
+
+		virtual void StartRecording(const ScoreLog &scoreLog) = 0;
+		virtual void FinishRecording() = 0;
+
+		//Whether movies can be recorded without the searching emulator. If not, the search stops to play the best path back.
+		virtual bool CanRecordMovies() const = 0;
+
+		//Records a movie of the given per-frame inputs, starting from a reset.
+		virtual void RecordMovie(const ScoreLog &scoreLog, std::vector<ButtonSet> &&inputs) = 0;
+	};
+};
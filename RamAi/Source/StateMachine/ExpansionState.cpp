@@ -22,7 +22,9 @@
 
 #include <cassert>
 
+#include "Metrics.h"
 #include "Settings/AiSettings.h"
+#include "Trace.h"
 
 
 RamAi::ExpansionState::ExpansionState(StateMachine &stateMachine)
@@ -57,6 +59,8 @@ RamAi::ExpansionState &RamAi::ExpansionState::operator= (ExpansionState &&other)
 
 void RamAi::ExpansionState::OnStateEntered(const std::weak_ptr<State>& oldState, const Type oldStateType)
 {
+	RAMAI_TRACE_SCOPE("ExpansionState::OnStateEntered");
+
 	State::OnStateEntered(oldState, oldStateType);
 
 	m_expandedNode = nullptr;
@@ -68,6 +72,8 @@ void RamAi::ExpansionState::OnStateEntered(const std::weak_ptr<State>& oldState,
 	if (m_stateMachine)
 	{
 		//Select the most urgent node from the tree and load its state.
+		Metrics::ScopedTimer selectionTimer(Metrics::Counter::SelectionNanoseconds);
+
 		GameMonteCarloTree &tree = m_stateMachine->GetTree();
 		
 		TreeNode &selectedNode = tree.Select();
@@ -75,12 +81,9 @@ void RamAi::ExpansionState::OnStateEntered(const std::weak_ptr<State>& oldState,
 
 		if (selectedNode.HasSavestate())
 		{
-			assert(m_stateMachine->GetLoadStateHandle());
-
-			if (m_stateMachine->GetLoadStateHandle())
-			{
-				m_stateMachine->GetLoadStateHandle()(*selectedNode.GetSavestate());
-			}
+			//This is a full restore into the one live emulator. Forking the machine, so several rollouts
+			//could branch from this node at once, isn't supported; only the stored savestates are shared.
+			m_stateMachine->LoadState(*selectedNode.GetSavestate());
 
 			//Expand the node and store it.
 			m_expandedNode = &tree.Expand(selectedNode);
@@ -109,13 +112,21 @@ RamAi::StateMachine::State::Type RamAi::ExpansionState::GetDesiredStateType(cons
 
 			if (m_stateMachine)
 			{
-				assert(m_stateMachine->GetSaveStateHandle());
+				Savestate savestate;
 
-				if (m_stateMachine->GetSaveStateHandle())
+				const bool savedState = m_stateMachine->SaveState(savestate);
+				assert(savedState);
+
+				//Most of the state is unchanged after a single macro-action, so share storage with the parent.
+				const TreeNode *parent = m_expandedNode->GetParent();
+
+				if (parent && parent->HasSavestate())
 				{
-					Savestate savestate = m_stateMachine->GetSaveStateHandle()();
-					m_expandedNode->SetSavestate(std::move(savestate));
+					savestate.SharePagesWith(*parent->GetSavestate());
 				}
+
+				m_expandedNode->SetSavestate(std::move(savestate));
+				m_stateMachine->CompressSavestate(*m_expandedNode);
 			}
 		}
 
@@ -140,6 +151,8 @@ RamAi::ButtonSet RamAi::ExpansionState::CalculateInput(const Ram &ram)
 
 void RamAi::ExpansionState::OnStateExited(const std::weak_ptr<State> &newState, const Type newStateType)
 {
+	RAMAI_TRACE_SCOPE("ExpansionState::OnStateExited");
+
 	State::OnStateExited(newState, newStateType);
 
 	//Check the node has a savestate before exiting.
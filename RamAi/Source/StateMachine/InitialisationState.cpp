@@ -24,6 +24,7 @@
 
 #include "Settings\ConsoleSettings.h"
 #include "Settings\GameSettings.h"
+#include "Trace.h"
 
 
 RamAi::InitialisationState::InitialisationState(StateMachine &stateMachine)
@@ -54,6 +55,8 @@ RamAi::InitialisationState &RamAi::InitialisationState::operator= (Initialisatio
 
 void RamAi::InitialisationState::OnStateEntered(const std::weak_ptr<State>& oldState, const Type oldStateType)
 {
+	RAMAI_TRACE_SCOPE("InitialisationState::OnStateEntered");
+
 	State::OnStateEntered(oldState, oldStateType);
 
 	m_numberOfFramesExecuted = 0;
@@ -67,30 +70,14 @@ void RamAi::InitialisationState::OnStateEntered(const std::weak_ptr<State>& oldS
 
 		if (m_stateMachine)
 		{
-			assert(m_stateMachine->GetStartRecordingHandle());
-
-			if (m_stateMachine->GetStartRecordingHandle())
-			{
-				m_stateMachine->StartRecording();
-			}
+			m_stateMachine->StartRecording();
 		}
 	}
 }
 
 RamAi::ButtonSet RamAi::InitialisationState::CalculateInput(const Ram &ram)
 {
-	ButtonSet returnValue;
-
-	if (m_numberOfFramesExecuted < GameSettings::GetInstance().initialisationStartButtonFrames)
-	{
-		//Return the pause button on even frames, and the empty button set on odd frames.
-		//This will cause the pause button to be mashed as fast as possible!
-		if ((m_numberOfFramesExecuted % 2) == 0)
-		{
-			//TODO: Get actual pause value.
-			returnValue = ConsoleSettings::GetSpecs().initialisationButtonSet;
-		}
-	}
+	ButtonSet returnValue = GetInitialisationInput(m_numberOfFramesExecuted);
 
 	++m_numberOfFramesExecuted;
 	return returnValue;
@@ -108,8 +95,28 @@ RamAi::StateMachine::State::Type RamAi::InitialisationState::GetDesiredStateType
 	return m_numberOfFramesExecuted >= initialisationFrames ? nextStateType : Type::Initialisation;
 }
 
+RamAi::ButtonSet RamAi::InitialisationState::GetInitialisationInput(const size_t frame)
+{
+	ButtonSet returnValue;
+
+	if (frame < GameSettings::GetInstance().initialisationStartButtonFrames)
+	{
+		//Return the pause button on even frames, and the empty button set on odd frames.
+		//This will cause the pause button to be mashed as fast as possible!
+		if ((frame % 2) == 0)
+		{
+			//TODO: Get actual pause value.
+			returnValue = ConsoleSettings::GetSpecs().initialisationButtonSet;
+		}
+	}
+
+	return returnValue;
+}
+
 void RamAi::InitialisationState::OnStateExited(const std::weak_ptr<State> &newState, const Type newStateType)
 {
+	RAMAI_TRACE_SCOPE("InitialisationState::OnStateExited");
+
 	State::OnStateExited(newState, newStateType);
 
 	//Save the current state into the root of the tree.
@@ -117,15 +124,11 @@ void RamAi::InitialisationState::OnStateExited(const std::weak_ptr<State> &newSt
 
 	if (m_stateMachine)
 	{
-		//TODO: Improve interface here? Should there be a common function on the state machine that throws exceptions, etc?
-		assert(m_stateMachine->GetSaveStateHandle());
+		Savestate savestate;
 
-		if (m_stateMachine->GetSaveStateHandle())
-		{
-			Savestate savestate = std::move(m_stateMachine->GetSaveStateHandle()());
+		const bool savedState = m_stateMachine->SaveState(savestate);
+		assert(savedState);
 
-			TreeNode &treeRoot = m_stateMachine->GetTree().GetRoot();
-			treeRoot.SetSavestate(std::move(savestate));
-		}
+		m_stateMachine->SetRootSavestate(std::move(savestate));
 	}
 }
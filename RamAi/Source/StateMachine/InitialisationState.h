@@ -46,6 +46,10 @@ namespace RamAi
 
 		virtual void OnStateExited(const std::weak_ptr<State> &newState, const Type newStateType) override;
 
+	public:
+		//Returns the input given on a frame of initialisation.
+		static ButtonSet GetInitialisationInput(const size_t frame);
+
 	private:
 		size_t m_numberOfFramesExecuted;
 		
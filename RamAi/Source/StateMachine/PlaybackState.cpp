@@ -22,6 +22,8 @@
 
 #include <cassert>
 
+#include "Trace.h"
+
 
 RamAi::PlaybackState::PlaybackState(StateMachine &stateMachine)
 	: State(stateMachine)
@@ -52,6 +54,8 @@ RamAi::PlaybackState &RamAi::PlaybackState::operator= (PlaybackState &&other)
 
 void RamAi::PlaybackState::OnStateEntered(const std::weak_ptr<State>& oldState, const Type oldStateType)
 {
+	RAMAI_TRACE_SCOPE("PlaybackState::OnStateEntered");
+
 	State::OnStateEntered(oldState, oldStateType);
 
 	m_numberOfFramesExecuted = 0;
@@ -63,28 +67,7 @@ void RamAi::PlaybackState::OnStateEntered(const std::weak_ptr<State>& oldState,
 
 	if (m_stateMachine)
 	{
-		if (const TreeNode *bestNode = m_stateMachine->GetTree().GetBestScoringNode())
-		{
-			const TreeNode *childNode = bestNode;
-			const TreeNode *parentNode = bestNode->GetParent();
-
-			//Iterate up the tree and build the sequence of actions.
-			while (parentNode && childNode)
-			{
-				assert(childNode);
-
-				ButtonSet parentToChildAction;
-				const bool gotAction = parentNode->GetActionLeadingToChild(*childNode, parentToChildAction);
-				assert(gotAction);
-
-				//The actions will be in last-to-first order, so push them to the front (which reverses them).
-				m_actionSequence.push_front(parentToChildAction);
-
-				//Progress up the tree.
-				childNode = parentNode;
-				parentNode = childNode->GetParent();
-			}
-		}
+		m_stateMachine->GetBestActionSequence(m_actionSequence);
 	}
 }
 
@@ -114,6 +97,8 @@ RamAi::StateMachine::State::Type RamAi::PlaybackState::GetDesiredStateType(const
 
 void RamAi::PlaybackState::OnStateExited(const std::weak_ptr<State> &newState, const Type newStateType)
 {
+	RAMAI_TRACE_SCOPE("PlaybackState::OnStateExited");
+
 	State::OnStateExited(newState, newStateType);
 
 	assert(m_stateMachine);
@@ -121,12 +106,7 @@ void RamAi::PlaybackState::OnStateExited(const std::weak_ptr<State> &newState, c
 	if (m_stateMachine)
 	{
 		//Finish recording.
-		assert(m_stateMachine->GetFinishRecordingHandle());
-
-		if (m_stateMachine->GetFinishRecordingHandle())
-		{
-			m_stateMachine->GetFinishRecordingHandle()();
-		}
+		m_stateMachine->FinishRecording();
 	}
 }
 
@@ -26,6 +26,8 @@
 #include "Settings\ConsoleSettings.h"
 #include "Settings\GameSettings.h"
 #include "ExpansionState.h"
+#include "Metrics.h"
+#include "Trace.h"
 
 
 RamAi::SimulationState::SimulationState(StateMachine &stateMachine)
@@ -60,6 +62,8 @@ RamAi::SimulationState &RamAi::SimulationState::operator= (SimulationState &&oth
 
 void RamAi::SimulationState::OnStateEntered(const std::weak_ptr<State>& oldState, const Type oldStateType)
 {
+	RAMAI_TRACE_SCOPE("SimulationState::OnStateEntered");
+
 	State::OnStateEntered(oldState, oldStateType);
 
 	//Get the node we're currently on from the previous state.
@@ -107,22 +111,18 @@ RamAi::StateMachine::State::Type RamAi::SimulationState::GetDesiredStateType(con
 	const size_t frameRate = ConsoleSettings::GetSpecs().frameRate;
 	const size_t targetNumberOfFrames = AiSettings::GetData().GetMaximumSimulationFrames(frameRate);
 
-	//Check if we need to record a playback movie.
-	bool needsToRecordPlaybackMovie = false;
-
-	if (m_stateMachine)
-	{
-		const uint32_t currentIteration = m_stateMachine->GetScoreLog().GetCurrentIteration();
-		const uint32_t movieFileSaveFrequency = AiSettings::GetData().movieFileSaveFrequency;
-		needsToRecordPlaybackMovie = currentIteration > 0 && (currentIteration % movieFileSaveFrequency) == 0;
-	}
+	//Playback movies are recorded in the background if possible. Otherwise, the search stops to play the best path back.
+	const bool recordsInBackground = m_stateMachine && m_stateMachine->CanRecordMovies();
+	const bool needsToPlayBack = NeedsToRecordPlaybackMovie() && !recordsInBackground;
 
-	const Type nextStateType = needsToRecordPlaybackMovie ? Type::Initialisation : Type::Expansion;
+	const Type nextStateType = needsToPlayBack ? Type::Initialisation : Type::Expansion;
 	return m_numberOfFramesExecuted >= targetNumberOfFrames ? nextStateType : Type::Simulation;
 }
 
 void RamAi::SimulationState::OnStateExited(const std::weak_ptr<State> &newState, const Type newStateType)
 {
+	RAMAI_TRACE_SCOPE("SimulationState::OnStateExited");
+
 	State::OnStateExited(newState, newStateType);
 
 	//Backpropagate the result back up the tree.
@@ -130,20 +130,43 @@ void RamAi::SimulationState::OnStateExited(const std::weak_ptr<State> &newState,
 
 	if (m_stateMachine)
 	{
+		//Checked before the log moves on to the next iteration.
+		const bool needsToRecordPlaybackMovie = NeedsToRecordPlaybackMovie();
+
 		assert(m_simulatedNode);
 
 		if (m_simulatedNode)
 		{
 			GameMonteCarloTree &tree = m_stateMachine->GetTree();
 
+			Metrics::ScopedTimer backpropagationTimer(Metrics::Counter::BackpropagationNanoseconds);
 			tree.Backpropagate(*m_simulatedNode, m_currentScore);
 		}
 
+		if (needsToRecordPlaybackMovie && newStateType == Type::Expansion && m_stateMachine->CanRecordMovies())
+		{
+			m_stateMachine->RecordMovie();
+		}
+
 		//Update the log.
 		m_stateMachine->UpdateScoreLog(*m_simulatedNode);
 	}
 }
 
+bool RamAi::SimulationState::NeedsToRecordPlaybackMovie() const
+{
+	bool needsToRecordPlaybackMovie = false;
+
+	if (m_stateMachine)
+	{
+		const uint32_t currentIteration = m_stateMachine->GetScoreLog().GetCurrentIteration();
+		const uint32_t movieFileSaveFrequency = AiSettings::GetData().movieFileSaveFrequency;
+		needsToRecordPlaybackMovie = currentIteration > 0 && movieFileSaveFrequency > 0 && (currentIteration % movieFileSaveFrequency) == 0;
+	}
+
+	return needsToRecordPlaybackMovie;
+}
+
 void RamAi::SimulationState::UpdateCurrentScore(const Ram &ram)
 {
 	assert(m_stateMachine);
@@ -49,6 +49,8 @@ namespace RamAi
 	protected:
 		void UpdateCurrentScore(const Ram &ram);
 
+		bool NeedsToRecordPlaybackMovie() const;
+
 	protected:
 		TreeNode *m_simulatedNode;
 		size_t m_numberOfFramesExecuted;
@@ -20,11 +20,19 @@
 #include "StateMachine.h"
 
 #include <cassert>
+#include <cstring>
 
 #include "InitialisationState.h"
 #include "ExpansionState.h"
 #include "PlaybackState.h"
 #include "SimulationState.h"
+#include "Action/ActionSequenceFile.h"
+#include "Debug.h"
+#include "Metrics.h"
+#include "Settings/AiSettings.h"
+#include "Settings/ConsoleSettings.h"
+#include "Settings/GameSettings.h"
+#include "Trace.h"
 
 
 RamAi::StateMachine::State::State(StateMachine &stateMachine)
@@ -63,12 +71,25 @@ void RamAi::StateMachine::State::Move(State &&other)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-RamAi::StateMachine::StateMachine(const ScoreLog::SaveLogToFileSignature &saveLogToFileHandle)
-	: m_tree()
+RamAi::StateMachine::StateMachine(EmulatorBackend &backend, const ScoreLog::SaveLogToFileSignature &saveLogToFileHandle, const ScoreLog::SpillLogToFileSignature &spillLogToFileHandle)
+	: m_backend(backend)
+	, m_tree()
 	, m_currentStateType(State::Type::Initialisation)
-	, m_scoreLog(GameSettings::GetInstance(), saveLogToFileHandle)
+	, m_scoreLog(GameSettings::GetInstance(), saveLogToFileHandle, spillLogToFileHandle)
+	, m_lastInputStateType(State::Type::Max)
+	, m_savedBestPathNodeId(0)
+	, m_hasSavedBestPath(false)
 {
 	InitialiseStates();
+
+	if (AiSettings::GetData().savestateCompression != SavestateCodec::Type::None)
+	{
+		m_savestateCompressor = std::make_unique<SavestateCompressor>(AiSettings::GetData().savestateCompression);
+	}
+
+	//The tree starts with only its root.
+	Metrics::SetGauge(Metrics::Gauge::TreeNodes, 1);
+	Metrics::SetGauge(Metrics::Gauge::TreeMaxDepth, 0);
 }
 
 RamAi::StateMachine::~StateMachine()
@@ -77,8 +98,19 @@ RamAi::StateMachine::~StateMachine()
 
 RamAi::ButtonSet RamAi::StateMachine::CalculateInput(const Ram &ram)
 {
+	RAMAI_TRACE_SCOPE("StateMachine::CalculateInput");
+
 	ButtonSet returnValue;
 
+	//The time since the last input was spent emulating that frame, so it belongs to the state that gave it.
+	if (m_lastInputStateType != State::Type::Max)
+	{
+		const auto elapsed = std::chrono::steady_clock::now() - m_lastInputTime;
+		Metrics::Add(GetFrameTimeCounter(m_lastInputStateType), static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+	}
+
+	Metrics::Add(Metrics::Counter::EmulatedFrames);
+
 	{
 		State *currentState = nullptr;
 		State::Type desiredStateType = m_currentStateType;
@@ -108,12 +140,207 @@ RamAi::ButtonSet RamAi::StateMachine::CalculateInput(const Ram &ram)
 		}
 	}
 
+	m_lastInputTime = std::chrono::steady_clock::now();
+	m_lastInputStateType = m_currentStateType;
+
 	return returnValue;
 }
 
 void RamAi::StateMachine::UpdateScoreLog(const TreeNode &simulatedNode)
 {
+	RAMAI_TRACE_SCOPE("StateMachine::UpdateScoreLog");
+
 	m_scoreLog.UpdateLog(m_tree, simulatedNode);
+
+	if (m_savestateCompressor)
+	{
+		m_savestateCompressor->InstallFinished();
+	}
+
+	Metrics::Add(Metrics::Counter::Iterations);
+
+	const uint32_t bestPathSaveFrequency = AiSettings::GetData().bestPathSaveFrequency;
+
+	if (m_saveBestPathHandle && bestPathSaveFrequency > 0 && (m_scoreLog.GetCurrentIteration() % bestPathSaveFrequency) == 0)
+	{
+		SaveBestPath();
+	}
+
+	const uint32_t checkpointFrequency = AiSettings::GetData().checkpointFrequency;
+
+	if (m_treeCheckpoint && checkpointFrequency > 0 && (m_scoreLog.GetCurrentIteration() % checkpointFrequency) == 0)
+	{
+		if (m_treeCheckpoint->PopWriteFailed())
+		{
+			Debug::OutLine("Error writing checkpoint before iteration " + std::to_string(m_scoreLog.GetCurrentIteration()), Colour::Red);
+		}
+
+		//If the last checkpoint is still being written, this one is skipped rather than stalling the search.
+		m_treeCheckpoint->Capture(m_tree);
+	}
+}
+
+void RamAi::StateMachine::GetBestActionSequence(std::deque<ButtonSet> &outActionSequence) const
+{
+	outActionSequence.clear();
+
+	if (const TreeNode *bestNode = m_tree.GetBestScoringNode())
+	{
+		const TreeNode *childNode = bestNode;
+		const TreeNode *parentNode = bestNode->GetParent();
+
+		//Iterate up the tree and build the sequence of actions.
+		while (parentNode && childNode)
+		{
+			assert(childNode);
+
+			ButtonSet parentToChildAction;
+			const bool gotAction = parentNode->GetActionLeadingToChild(*childNode, parentToChildAction);
+			assert(gotAction);
+
+			//The actions will be in last-to-first order, so push them to the front (which reverses them).
+			outActionSequence.push_front(parentToChildAction);
+
+			//Progress up the tree.
+			childNode = parentNode;
+			parentNode = childNode->GetParent();
+		}
+	}
+}
+
+void RamAi::StateMachine::LoadState(const Savestate &savestate)
+{
+	//Every savestate of a game is about the same size, so after the first load this doesn't allocate.
+	m_loadStateBuffer.resize(savestate.GetSize());
+	savestate.CopyTo(m_loadStateBuffer.data());
+
+	m_backend.LoadFrom(m_loadStateBuffer.data(), m_loadStateBuffer.size());
+}
+
+void RamAi::StateMachine::SetRootSavestate(Savestate &&savestate)
+{
+	if (m_treeCheckpoint && !m_treeCheckpoint->MatchesResumedRoot(savestate.CalculateHash()))
+	{
+		Debug::OutLine("The checkpoint was taken from a different root state - starting a new search tree.", Colour::Red);
+
+		m_treeCheckpoint->Discard();
+
+		m_tree.GetRoot() = TreeNode();
+		m_tree.SetBestScoringNode(nullptr);
+
+		Metrics::SetGauge(Metrics::Gauge::TreeNodes, 1);
+		Metrics::SetGauge(Metrics::Gauge::TreeMaxDepth, 0);
+	}
+
+	m_tree.GetRoot().SetSavestate(std::move(savestate));
+}
+
+void RamAi::StateMachine::CompressSavestate(TreeNode &node)
+{
+	if (m_savestateCompressor)
+	{
+		m_savestateCompressor->Enqueue(node);
+	}
+}
+
+void RamAi::StateMachine::RecordMovie()
+{
+	assert(m_backend.CanRecordMovies());
+
+	if (!m_backend.CanRecordMovies())
+	{
+		return;
+	}
+
+	std::vector<ButtonSet> inputs;
+
+	GetBestPathInputs([&inputs](const ButtonSet &buttonSet, const size_t frames)
+	{
+		inputs.insert(inputs.end(), frames, buttonSet);
+	});
+
+	m_backend.RecordMovie(m_scoreLog, std::move(inputs));
+}
+
+void RamAi::StateMachine::SaveBestPath()
+{
+	const TreeNode *bestNode = m_tree.GetBestScoringNode();
+
+	//Most of the time the best node hasn't changed, so there's nothing to do.
+	if (!bestNode || (m_hasSavedBestPath && bestNode->GetIdNumber() == m_savedBestPathNodeId) || !m_saveBestPathHandle)
+	{
+		return;
+	}
+
+	std::vector<ActionSequenceFile::Run> runs;
+
+	const size_t initialisationFrames = GetBestPathInputs([&runs](const ButtonSet &buttonSet, const size_t frames)
+	{
+		ActionSequenceFile::AddFrames(runs, buttonSet, static_cast<uint32_t>(frames));
+	});
+
+	ActionSequenceFile::RecordHeader header;
+	memset(&header, 0, sizeof(header));
+
+	header.frameRate = static_cast<uint16_t>(ConsoleSettings::GetSpecs().frameRate);
+	header.iteration = m_scoreLog.GetCurrentIteration();
+	header.macroActionLength = static_cast<uint32_t>(GetFramesPerAction());
+	header.initialisationFrames = static_cast<uint32_t>(initialisationFrames);
+	header.rootStateHash = m_tree.GetRoot().HasSavestate() ? m_tree.GetRoot().GetSavestate()->CalculateHash() : 0;
+	header.bestAverageScore = bestNode->GetScore().GetAverageScore();
+
+	m_bestPathBuffer.clear();
+	ActionSequenceFile::AppendRecord(header, runs, m_bestPathBuffer);
+
+	m_saveBestPathHandle(m_scoreLog, m_bestPathBuffer);
+
+	m_savedBestPathNodeId = bestNode->GetIdNumber();
+	m_hasSavedBestPath = true;
+}
+
+size_t RamAi::StateMachine::GetBestPathInputs(const AddFramesHandleSignature &addFrames) const
+{
+	//Start with the same inputs the initialisation state gives after a reset...
+	const size_t initialisationFrames = GameSettings::GetInstance().GetMaximumInitialisationFrames();
+
+	for (size_t frame = 0; frame < initialisationFrames; ++frame)
+	{
+		addFrames(InitialisationState::GetInitialisationInput(frame), 1);
+	}
+
+	//...then each action of the best path, held for as long as the playback state would hold it.
+	std::deque<ButtonSet> actionSequence;
+	GetBestActionSequence(actionSequence);
+
+	const size_t framesPerAction = GetFramesPerAction();
+
+	for (auto it = actionSequence.cbegin(); it != actionSequence.cend(); ++it)
+	{
+		addFrames(*it, framesPerAction);
+	}
+
+	return initialisationFrames;
+}
+
+size_t RamAi::StateMachine::GetFramesPerAction()
+{
+	const uint32_t macroActionLength = AiSettings::GetData().macroActionLength;
+	return (macroActionLength > 0) ? macroActionLength : 1;
+}
+
+RamAi::Metrics::Counter RamAi::StateMachine::GetFrameTimeCounter(const State::Type stateType)
+{
+	switch (stateType)
+	{
+	case State::Type::Expansion:
+		return Metrics::Counter::ExpansionNanoseconds;
+
+	case State::Type::Simulation:
+		return Metrics::Counter::SimulationNanoseconds;
+
+	default:
+		return Metrics::Counter::PlaybackNanoseconds;
+	}
 }
 
 void RamAi::StateMachine::InitialiseStates()
@@ -126,6 +353,8 @@ void RamAi::StateMachine::InitialiseStates()
 
 void RamAi::StateMachine::ChangeState(const State::Type newStateType)
 {
+	RAMAI_TRACE_SCOPE("StateMachine::ChangeState");
+
 	assert(newStateType != m_currentStateType);
 
 	if (newStateType != m_currentStateType)
@@ -19,11 +19,19 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "Data/Ram.h"
+#include "EmulatorBackend.h"
+#include "Metrics.h"
 #include "MonteCarlo/GameMonteCarloTree.h"
+#include "MonteCarlo/SavestateCompressor.h"
+#include "MonteCarlo/TreeCheckpoint.h"
 #include "Score/ScoreLog.h"
 #include "State/Savestate.h"
 
@@ -78,13 +86,11 @@ namespace RamAi
 		};
 
 	public:
-		typedef std::function<Savestate()> SaveStateHandleSignature;
-		typedef std::function<void(const Savestate&)> LoadStateHandleSignature;
-		typedef std::function<void(const RamAi::ScoreLog &scoreLog)> StartRecordingHandleSignature;
-		typedef std::function<void()> FinishRecordingHandleSignature;
+		//Saves an ActionSequenceFile record of the best path.
+		typedef std::function<void(const RamAi::ScoreLog &scoreLog, const std::string &record)> SaveBestPathHandleSignature;
 
 	public:
-		StateMachine(const ScoreLog::SaveLogToFileSignature &saveLogToFileHandle);
+		StateMachine(EmulatorBackend &backend, const ScoreLog::SaveLogToFileSignature &saveLogToFileHandle, const ScoreLog::SpillLogToFileSignature &spillLogToFileHandle);
 		~StateMachine();
 
 	public:
@@ -102,12 +108,35 @@ namespace RamAi
 		const ScoreLog &GetScoreLog() const									{ return m_scoreLog; }
 
 	public:
-		SaveStateHandleSignature &GetSaveStateHandle()						{ return m_saveStateHandle; }
-		LoadStateHandleSignature &GetLoadStateHandle()						{ return m_loadStateHandle; }
-		StartRecordingHandleSignature &GetStartRecordingHandle()			{ return m_startRecordingHandle; }
-		FinishRecordingHandleSignature &GetFinishRecordingHandle()			{ return m_finishRecordingHandle; }
+		EmulatorBackend &GetBackend()										{ return m_backend; }
+		SaveBestPathHandleSignature &GetSaveBestPathHandle()				{ return m_saveBestPathHandle; }
 
-		void StartRecording()												{ m_startRecordingHandle(m_scoreLog); }
+		//Saves the emulator's current state. Returns false if it couldn't be saved.
+		bool SaveState(Savestate &outSavestate)								{ return m_backend.SaveInto(outSavestate); }
+
+		//Loads a savestate into the emulator, through a buffer that is kept between loads.
+		void LoadState(const Savestate &savestate);
+
+		//Stores the state the search starts from in the root of the tree.
+		//A tree resumed from a checkpoint is thrown away if it grew from a different root state.
+		void SetRootSavestate(Savestate &&savestate);
+
+		//Compresses the node's savestate in the background, if savestate compression is enabled.
+		void CompressSavestate(TreeNode &node);
+
+		void StartRecording()												{ m_backend.StartRecording(m_scoreLog); }
+		void FinishRecording()												{ m_backend.FinishRecording(); }
+
+		bool CanRecordMovies() const										{ return m_backend.CanRecordMovies(); }
+
+		//Hands the inputs that reach the best scoring node to the backend to record. The search carries on meanwhile.
+		void RecordMovie();
+
+		//Hands a compact record of the best path to the save best path handle, if the best node has changed.
+		void SaveBestPath();
+
+		TreeCheckpoint *GetTreeCheckpoint()									{ return m_treeCheckpoint.get(); }
+		void SetTreeCheckpoint(std::unique_ptr<TreeCheckpoint> &&checkpoint)	{ m_treeCheckpoint = std::move(checkpoint); }
 
 	public:
 		bool IsCurrentStateValid() const									{ return IsStateValid(m_currentStateType); }
@@ -119,26 +148,56 @@ namespace RamAi
 
 		void UpdateScoreLog(const TreeNode &simulatedNode);
 
+		//Gets the actions leading from the root to the best scoring node, in order.
+		void GetBestActionSequence(std::deque<ButtonSet> &outActionSequence) const;
+
 	protected:
 		void InitialiseStates();
 
+		//Passes the inputs that reach the best scoring node from a reset to the handle, as runs of identical buttons,
+		//so movies and best path records are built from the same frames. Returns the number of initialisation frames.
+		typedef std::function<void(const ButtonSet &buttonSet, const size_t frames)> AddFramesHandleSignature;
+		size_t GetBestPathInputs(const AddFramesHandleSignature &addFrames) const;
+
+		//The number of frames the playback state holds each action for.
+		static size_t GetFramesPerAction();
+
+		static Metrics::Counter GetFrameTimeCounter(const State::Type stateType);
+
 		const std::shared_ptr<State> &GetCurrentStateInternal() const		{ return m_states[m_currentStateType]; }
 		std::shared_ptr<State> &GetCurrentStateInternal()					{ return m_states[m_currentStateType]; }
 
 		void ChangeState(const State::Type newStateType);
 
 	protected:
+		EmulatorBackend &m_backend;
+
+		//Savestates are stored in pages, so they're copied into this to be loaded.
+		std::vector<uint8_t> m_loadStateBuffer;
+
 		GameMonteCarloTree m_tree;
 
+		//Declared after the tree, so it stops before the nodes it refers to are destroyed.
+		std::unique_ptr<SavestateCompressor> m_savestateCompressor;
+
 		std::shared_ptr<State> m_states[State::Type::Max];
 		State::Type m_currentStateType;
 
 		ScoreLog m_scoreLog;
 
+		//Checkpoints the tree every few iterations, if enabled.
+		std::unique_ptr<TreeCheckpoint> m_treeCheckpoint;
+
+		//When the last input was returned and which state returned it, so the frame's time can be put down to that state.
+		std::chrono::steady_clock::time_point m_lastInputTime;
+		State::Type m_lastInputStateType;
+
+		//The ID of the best node when the best path was last saved, so an unchanged path isn't saved again.
+		size_t m_savedBestPathNodeId;
+		bool m_hasSavedBestPath;
+		std::string m_bestPathBuffer;
+
 	protected:
-		SaveStateHandleSignature m_saveStateHandle;
-		LoadStateHandleSignature m_loadStateHandle;
-		StartRecordingHandleSignature m_startRecordingHandle;
-		FinishRecordingHandleSignature m_finishRecordingHandle;
+		SaveBestPathHandleSignature m_saveBestPathHandle;
 	};
 };
\ No newline at end of file
@@ -0,0 +1,148 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+
+uint64_t RamAi::Trace::Now()
+{
+	const auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count());
+}
+
+void RamAi::Trace::Record(const char *name, const uint64_t start)
+{
+	const uint64_t end = Now();
+	Buffer &buffer = GetBuffer();
+
+	//Only this thread writes to its buffer, so the count needs no locked add. Releasing it publishes the event.
+	const uint64_t count = buffer.count.load(std::memory_order_relaxed);
+	Event &event = buffer.events[static_cast<size_t>(count % BufferCapacity)];
+
+	event.name.store(name, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.end.store(end, std::memory_order_relaxed);
+
+	buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void RamAi::Trace::AppendChromeTrace(std::string &buffer)
+{
+	struct CopiedEvent
+	{
+		const char *name;
+		uint64_t start;
+		uint64_t end;
+		uint32_t threadId;
+	};
+
+	std::vector<CopiedEvent> copiedEvents;
+
+	{
+		std::lock_guard<std::mutex> lock(s_buffersMutex);
+
+		for (auto it = s_buffers.cbegin(); it != s_buffers.cend(); ++it)
+		{
+			const Buffer &threadBuffer = **it;
+			const uint64_t count = threadBuffer.count.load(std::memory_order_acquire);
+			const uint64_t first = (count > BufferCapacity) ? count - BufferCapacity : 0;
+			const size_t firstCopiedIndex = copiedEvents.size();
+
+			for (uint64_t i = first; i < count; ++i)
+			{
+				const Event &event = threadBuffer.events[static_cast<size_t>(i % BufferCapacity)];
+
+				CopiedEvent copiedEvent;
+				copiedEvent.name = event.name.load(std::memory_order_relaxed);
+				copiedEvent.start = event.start.load(std::memory_order_relaxed);
+				copiedEvent.end = event.end.load(std::memory_order_relaxed);
+				copiedEvent.threadId = threadBuffer.threadId;
+
+				copiedEvents.push_back(copiedEvent);
+			}
+
+			//The thread carries on recording while it's copied, so drop any events it may have overwritten since.
+			//That includes the slot of the event after the last one published, which may be half written.
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			const uint64_t countAfterCopy = threadBuffer.count.load(std::memory_order_relaxed);
+			const uint64_t firstIntact = (countAfterCopy + 1 > BufferCapacity) ? countAfterCopy + 1 - BufferCapacity : 0;
+			const size_t numberOverwritten = static_cast<size_t>(std::min(count, std::max(first, firstIntact)) - first);
+
+			copiedEvents.erase(copiedEvents.begin() + firstCopiedIndex, copiedEvents.begin() + firstCopiedIndex + numberOverwritten);
+		}
+	}
+
+	//Timestamps are in microseconds, relative to the earliest event.
+	uint64_t earliestStart = UINT64_MAX;
+
+	for (auto it = copiedEvents.cbegin(); it != copiedEvents.cend(); ++it)
+	{
+		earliestStart = std::min(earliestStart, it->start);
+	}
+
+	buffer += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+	char eventBuffer[256];
+
+	for (auto it = copiedEvents.cbegin(); it != copiedEvents.cend(); ++it)
+	{
+		const double timestamp = static_cast<double>(it->start - earliestStart) / 1000.0;
+		const double duration = static_cast<double>(it->end - it->start) / 1000.0;
+
+		snprintf(eventBuffer, sizeof(eventBuffer), "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			(it == copiedEvents.cbegin()) ? "" : ",", it->name, it->threadId, timestamp, duration);
+
+		buffer += eventBuffer;
+	}
+
+	buffer += "\n]}\n";
+}
+
+RamAi::Trace::Buffer &RamAi::Trace::GetBuffer()
+{
+	//Buffers are never freed, so events from threads that have finished can still be written out.
+	thread_local Buffer *buffer = nullptr;
+
+	if (!buffer)
+	{
+		std::unique_ptr<Buffer> newBuffer = std::make_unique<Buffer>();
+		newBuffer->events = std::make_unique<Event[]>(BufferCapacity);
+		newBuffer->count.store(0, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(s_buffersMutex);
+
+		newBuffer->threadId = static_cast<uint32_t>(s_buffers.size() + 1);
+
+		buffer = newBuffer.get();
+		s_buffers.push_back(std::move(newBuffer));
+	}
+
+	return *buffer;
+}
+
+const size_t RamAi::Trace::BufferCapacity;
+
+std::mutex RamAi::Trace::s_buffersMutex;
+std::vector<std::unique_ptr<RamAi::Trace::Buffer>> RamAi::Trace::s_buffers;
@@ -0,0 +1,104 @@
+/*
+	RamAi - A general game-playing AI that uses RAM states as input to a value function
+	Copyright (C) 2016 Sean Latham
+
+	This program is free software; you can redistribute it and / or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with this program; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110 - 1301 USA.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+//Define RAMAI_TRACE to compile the trace scopes in. Without it they expand to nothing.
+#ifdef RAMAI_TRACE
+#define RAMAI_TRACE_CONCATENATE_INNER(a, b) a##b
+#define RAMAI_TRACE_CONCATENATE(a, b) RAMAI_TRACE_CONCATENATE_INNER(a, b)
+#define RAMAI_TRACE_SCOPE(name) const RamAi::Trace::Scope RAMAI_TRACE_CONCATENATE(traceScope, __LINE__)(name)
+#else
+#define RAMAI_TRACE_SCOPE(name)
+#endif
+
+
+namespace RamAi
+{
+	//Static class that records timed events into a ring buffer for each thread.
+	//The buffers can be written out at any time as Chrome trace JSON, for chrome://tracing or Perfetto.
+	class Trace
+	{
+	public:
+		//Records an event lasting from its construction to its destruction. The name must be a string literal.
+		class Scope
+		{
+		public:
+			Scope(const char *name) : m_name(name), m_start(Now())		{}
+			Scope(const Scope &other) = delete;
+			~Scope()													{ Record(m_name, m_start); }
+
+		public:
+			Scope &operator= (const Scope &other) = delete;
+
+		private:
+			const char *m_name;
+			uint64_t m_start;
+		};
+
+	public:
+		Trace() = delete;
+		~Trace() = delete;
+
+	public:
+		//Returns the current time in nanoseconds.
+		static uint64_t Now();
+
+		//Records an event that started at the given time and ends now. The name must be a string literal.
+		static void Record(const char *name, const uint64_t start);
+
+		//Appends the most recent events of every thread as a Chrome trace JSON object.
+		static void AppendChromeTrace(std::string &buffer);
+
+	public:
+		//Older events are overwritten once a thread has recorded this many.
+		static const size_t BufferCapacity = 1 << 16;
+
+	private:
+		//Written by its own thread and read by the thread writing the trace out, so each field is atomic.
+		struct Event
+		{
+			std::atomic<const char*> name;
+			std::atomic<uint64_t> start;
+			std::atomic<uint64_t> end;
+		};
+
+		struct Buffer
+		{
+			std::unique_ptr<Event[]> events;
+			std::atomic<uint64_t> count;
+			uint32_t threadId;
+		};
+
+		static Buffer &GetBuffer();
+
+	private:
+		static std::mutex s_buffersMutex;
+		static std::vector<std::unique_ptr<Buffer>> s_buffers;
+	};
+};
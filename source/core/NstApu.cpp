@@ -27,6 +27,9 @@
 #include "NstState.hpp"
 #include "api/NstApiSound.hpp"
 #include "NstSoundRenderer.inl"
+//[SLBEGIN]: Block sound output.
+#include "NstSimd.hpp"
+//[SLEND]
 
 namespace Nes
 {
@@ -234,7 +237,9 @@ namespace Nes
 			noise.Reset( cpu.GetModel() );
 			dmc.Reset( cpu.GetModel() );
 
-			dcBlocker.Reset();
+			//[SLBEGIN]: Block sound output.
+			mixer.Reset();
+			//[SLEND]
 
 			stream = NULL;
 
@@ -403,7 +408,9 @@ namespace Nes
 		{
 			cycles.Update( settings.rate, settings.speed, cpu );
 			synchronizer.Reset( settings.speed, settings.rate, cpu );
-			dcBlocker.Reset();
+			//[SLBEGIN]: Block sound output.
+			mixer.Reset();
+			//[SLEND]
 			buffer.Reset( settings.bits );
 
 			Cycle rate; uint fixed;
@@ -638,7 +645,10 @@ namespace Nes
 
 				do
 				{
-					buffer << GetSample();
+					//[SLBEGIN]: Block sound output.
+					if (RenderSample())
+						FlushMixer();
+					//[SLEND]
 
 					if (cycles.frameCounter <= rateCounter)
 						ClockFrameCounter();
@@ -669,7 +679,10 @@ namespace Nes
 
 				do
 				{
-					buffer << GetSample();
+					//[SLBEGIN]: Block sound output.
+					if (RenderSample())
+						FlushMixer();
+					//[SLEND]
 
 					if (extCounter <= rateCounter)
 						extCounter = extChannel->Clock( extCounter, cycles.fixed, rateCounter );
@@ -754,6 +767,11 @@ namespace Nes
 		{
 			NST_ASSERT( (stream && settings.audible) && (cycles.rate && cycles.fixed) );
 
+			//[SLBEGIN]: Block sound output.
+			if (mixer.Size())
+				FlushMixer();
+			//[SLEND]
+
 			for (uint i=0; i < 2; ++i)
 			{
 				if (stream->length[i] && stream->samples[i])
@@ -761,6 +779,10 @@ namespace Nes
 					Sound::Buffer::Block block( stream->length[i] );
 					buffer >> block;
 
+					//[SLBEGIN]: Block sound output.
+					uint remaining = stream->length[i] - block.length;
+					//[SLEND]
+
 					Sound::Buffer::Renderer<T,STEREO> output( stream->samples[i], stream->length[i], buffer.history );
 
 					if (output << block)
@@ -773,7 +795,13 @@ namespace Nes
 
 							do
 							{
-								output << GetSample();
+								//[SLBEGIN]: Block sound output.
+								if (RenderSample())
+								{
+									mixer >> block;
+									output << block;
+								}
+								//[SLEND]
 
 								if (cycles.frameCounter <= rateCounter)
 									ClockFrameCounter();
@@ -783,12 +811,15 @@ namespace Nes
 
 								rateCounter += cycles.rate;
 							}
-							while (rateCounter < target && output);
+							//[SLBEGIN]: Block sound output.
+							while (--remaining && rateCounter < target);
+							//[SLEND]
 
 							cycles.rateCounter = rateCounter;
 						}
 
-						if (output)
+						//[SLBEGIN]: Block sound output.
+						if (remaining)
 						{
 							if (cycles.frameCounter < target)
 								ClockFrameCounter();
@@ -798,10 +829,23 @@ namespace Nes
 
 							do
 							{
-								output << GetSample();
+								if (RenderSample())
+								{
+									mixer >> block;
+									output << block;
+								}
 							}
-							while (output);
+							while (--remaining);
 						}
+
+						if (mixer.Size())
+						{
+							mixer >> block;
+							output << block;
+						}
+
+						NST_VERIFY( !output );
+						//[SLEND]
 					}
 				}
 			}
@@ -1134,6 +1178,159 @@ namespace Nes
 			return next;
 		}
 
+		//[SLBEGIN]: Block sound output.
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("s", on)
+		#endif
+
+		Apu::Mixer::Mixer()
+		: length(0)
+		{
+			NST_VERIFY( Verify() );
+		}
+
+		void Apu::Mixer::Reset()
+		{
+			length = 0;
+			dcBlocker.Reset();
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("", on)
+		#endif
+
+		NST_FORCE_INLINE bool Apu::Mixer::Push(dword square,dword tnd,Channel::Sample sample)
+		{
+			NST_ASSERT( length < SIZE );
+
+			dac[0][length] = square;
+			dac[1][length] = tnd;
+			ext[length] = sample;
+
+			return ++length == SIZE;
+		}
+
+	#ifdef NST_SSE2
+
+		// Exact integer a / (b / dac + c) for four DACs at a time, 0 where the DAC is 0.
+		// The quotients fit in a double's mantissa and a correctly rounded division
+		// truncates to the same value as the integer one, so only b / dac needs a
+		// floor; it may not fit in an int so it's converted biased by 2^31.
+
+		template<dword A,dword B,dword C>
+		static NST_FORCE_INLINE __m128i MixNonLinear(const __m128i dac)
+		{
+			const __m128i zero = _mm_cmpeq_epi32( dac, _mm_setzero_si128() );
+			const __m128i nonzero = _mm_sub_epi32( dac, zero );
+
+			__m128d q[2] =
+			{
+				_mm_div_pd( _mm_set1_pd( double(B) ), _mm_cvtepi32_pd( nonzero ) ),
+				_mm_div_pd( _mm_set1_pd( double(B) ), _mm_cvtepi32_pd( _mm_shuffle_epi32( nonzero, _MM_SHUFFLE(1,0,3,2) ) ) )
+			};
+
+			for (uint i=0; i < 2; ++i)
+			{
+				const __m128d bias = _mm_set1_pd( 2147483648.0 );
+				const __m128d n = _mm_add_pd( _mm_cvtepi32_pd( _mm_cvttpd_epi32( _mm_sub_pd( q[i], bias ) ) ), bias );
+
+				q[i] = _mm_div_pd
+				(
+					_mm_set1_pd( double(A) ),
+					_mm_add_pd( _mm_sub_pd( n, _mm_and_pd( _mm_cmpgt_pd( n, q[i] ), _mm_set1_pd( 1.0 ) ) ), _mm_set1_pd( double(C) ) )
+				);
+			}
+
+			return _mm_andnot_si128
+			(
+				zero,
+				_mm_unpacklo_epi64( _mm_cvttpd_epi32( q[0] ), _mm_cvttpd_epi32( q[1] ) )
+			);
+		}
+
+	#endif
+
+	#ifdef NST_DEBUG
+
+		bool Apu::Mixer::Verify()
+		{
+			// compares the vector mix with the integer one over the DAC range
+
+		#ifdef NST_SSE2
+			if (Simd::GetLevel() >= Simd::LEVEL_SSE2)
+			{
+				for (dword i=0; i < 0x40000; i += 4)
+				{
+					dword square[4], tnd[4];
+
+					_mm_storeu_si128( reinterpret_cast<__m128i*>(square), MixNonLinear<NLN_SQ_0,NLN_SQ_1,NLN_SQ_2>( _mm_setr_epi32( i+0, i+1, i+2, i+3 ) ) );
+					_mm_storeu_si128( reinterpret_cast<__m128i*>(tnd), MixNonLinear<NLN_TND_0,NLN_TND_1,NLN_TND_2>( _mm_setr_epi32( i+0, i+1, i+2, i+3 ) ) );
+
+					for (uint j=0; j < 4; ++j)
+					{
+						if
+						(
+							square[j] != ((i+j) ? NLN_SQ_0 / (NLN_SQ_1 / (i+j) + NLN_SQ_2) : 0) ||
+							tnd[j] != ((i+j) ? NLN_TND_0 / (NLN_TND_1 / (i+j) + NLN_TND_2) : 0)
+						)
+							return false;
+					}
+				}
+			}
+		#endif
+
+			return true;
+		}
+
+	#endif
+
+		void Apu::Mixer::operator >> (Sound::Buffer::Block& block)
+		{
+			NST_ASSERT( length <= SIZE );
+
+			// the nonlinear mix of each block goes into dac[0] first, the DC blocker
+			// is recursive and runs over the mixed samples afterwards
+
+			uint i = 0;
+
+		#ifdef NST_SSE2
+			if (Simd::GetLevel() >= Simd::LEVEL_SSE2)
+			{
+				for (; i + 4 <= length; i += 4)
+				{
+					_mm_storeu_si128
+					(
+						reinterpret_cast<__m128i*>(dac[0] + i),
+						_mm_add_epi32
+						(
+							MixNonLinear<NLN_SQ_0,NLN_SQ_1,NLN_SQ_2>( _mm_loadu_si128( reinterpret_cast<const __m128i*>(dac[0] + i) ) ),
+							MixNonLinear<NLN_TND_0,NLN_TND_1,NLN_TND_2>( _mm_loadu_si128( reinterpret_cast<const __m128i*>(dac[1] + i) ) )
+						)
+					);
+				}
+			}
+		#endif
+
+			for (; i < length; ++i)
+			{
+				dac[0][i] =
+				(
+					(dac[0][i] ? NLN_SQ_0 / (NLN_SQ_1 / dac[0][i] + NLN_SQ_2) : 0) +
+					(dac[1][i] ? NLN_TND_0 / (NLN_TND_1 / dac[1][i] + NLN_TND_2) : 0)
+				);
+			}
+
+			for (i=0; i < length; ++i)
+				output[i] = Clamp<Channel::OUTPUT_MIN,Channel::OUTPUT_MAX>( dcBlocker.Apply( dac[0][i] ) + ext[i] );
+
+			block.data = output;
+			block.start = 0;
+			block.length = length;
+
+			length = 0;
+		}
+		//[SLEND]
+
 		#ifdef NST_MSVC_OPTIMIZE
 		#pragma optimize("s", on)
 		#endif
@@ -2249,7 +2446,9 @@ namespace Nes
 			noise.ClearAmp();
 			dmc.ClearAmp();
 
-			dcBlocker.Reset();
+			//[SLBEGIN]: Block sound output.
+			mixer.Reset();
+			//[SLEND]
 
 			buffer.Reset( settings.bits, false );
 		}
@@ -2340,20 +2539,25 @@ namespace Nes
 			cycles.frameIrqRepeat = repeat;
 		}
 
-		NST_NO_INLINE Apu::Channel::Sample Apu::GetSample()
+		//[SLBEGIN]: Block sound output.
+		NST_NO_INLINE bool Apu::RenderSample()
 		{
-			dword dac[2];
-
-			return Clamp<Channel::OUTPUT_MIN,Channel::OUTPUT_MAX>
+			return mixer.Push
 			(
-				dcBlocker.Apply
-				(
-					(0 != (dac[0] = square[0].GetSample() + square[1].GetSample()) ? NLN_SQ_0 / (NLN_SQ_1 / dac[0] + NLN_SQ_2) : 0) +
-					(0 != (dac[1] = triangle.GetSample() + noise.GetSample() + dmc.GetSample()) ? NLN_TND_0 / (NLN_TND_1 / dac[1] + NLN_TND_2) : 0)
-				) + (extChannel ? extChannel->GetSample() : 0)
+				square[0].GetSample() + square[1].GetSample(),
+				triangle.GetSample() + noise.GetSample() + dmc.GetSample(),
+				extChannel ? extChannel->GetSample() : 0
 			);
 		}
 
+		NST_NO_INLINE void Apu::FlushMixer()
+		{
+			Sound::Buffer::Block block( 0 );
+			mixer >> block;
+			buffer << block;
+		}
+		//[SLEND]
+
 		NES_POKE_AD(Apu,4000)
 		{
 			UpdateLatency();
@@ -293,7 +293,10 @@ namespace Nes
 			NES_DECL_PEEK( 4015 );
 			NES_DECL_PEEK( 40xx );
 
-			NST_NO_INLINE Channel::Sample GetSample();
+			//[SLBEGIN]: Block sound output.
+			NST_NO_INLINE bool RenderSample();
+			NST_NO_INLINE void FlushMixer();
+			//[SLEND]
 
 			void NST_FASTCALL SyncOn    (Cycle);
 			void NST_FASTCALL SyncOnExt (Cycle);
@@ -347,6 +350,41 @@ namespace Nes
 				NST_SINGLE_CALL dword Clock(dword,dword,const Cpu&);
 			};
 
+			//[SLBEGIN]: Block sound output.
+			class Mixer
+			{
+			public:
+
+				Mixer();
+
+				enum
+				{
+					SIZE = 0x200
+				};
+
+				void Reset();
+				NST_FORCE_INLINE bool Push(dword,dword,Channel::Sample);
+				void operator >> (Sound::Buffer::Block&);
+
+				uint Size() const
+				{
+					return length;
+				}
+
+			private:
+
+				#ifdef NST_DEBUG
+				static bool Verify();
+				#endif
+
+				uint length;
+				Channel::DcBlocker dcBlocker;
+				dword dac[2][SIZE];
+				Channel::Sample ext[SIZE];
+				iword output[SIZE];
+			};
+			//[SLEND]
+
 			class Oscillator
 			{
 				enum
@@ -614,7 +652,9 @@ namespace Nes
 			Noise noise;
 			Dmc dmc;
 			Channel* extChannel;
-			Channel::DcBlocker dcBlocker;
+			//[SLBEGIN]: Block sound output.
+			Mixer mixer;
+			//[SLEND]
 			Sound::Output* stream;
 			Sound::Buffer buffer;
 			Settings settings;
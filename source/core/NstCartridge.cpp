@@ -390,6 +390,13 @@ namespace Nes
 			state.End();
 		}
 
+		//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+		void Cartridge::SetDirtyPages(bool dirty)
+		{
+			board->SetDirtyPages( dirty );
+		}
+		//[SLEND]
+
 		void Cartridge::LoadState(State::Loader& state)
 		{
 			while (const dword chunk = state.Begin())
@@ -103,6 +103,9 @@ namespace Nes
 			bool PowerOff();
 			void LoadState(State::Loader&);
 			void SaveState(State::Saver&,dword) const;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			void SetDirtyPages(bool);
+			//[SLEND]
 			void Destroy();
 			void VSync();
 
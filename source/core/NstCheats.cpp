@@ -220,7 +220,12 @@ namespace Nes
 					const uint address = it->address & (Cpu::RAM_SIZE-1);
 
 					if (!it->useCompare || cpu.GetRam()[address] == it->compare)
+					{
 						cpu.GetRam()[address] = it->data;
+						//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+						cpu.MarkRam( address );
+						//[SLEND]
+					}
 				}
 			}
 		}
@@ -128,6 +128,12 @@
    #define NST_REGCALL __attribute__((regparm(2)))
    #endif
 
+   //[SLBEGIN]: SIMD video filter kernels.
+   #if !defined(NST_MM_INTRINSICS) && defined(__SSE2__) && (defined(__i386__) || defined(__x86_64__))
+   #define NST_MM_INTRINSICS
+   #endif
+   //[SLEND]
+
   #endif
 
  #endif
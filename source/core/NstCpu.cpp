@@ -154,6 +154,9 @@ namespace Nes
 		map   ( this, &Cpu::Peek_Overflow, &Cpu::Poke_Overflow )
 		{
 			cycles.UpdateTable( GetModel() );
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			ram.dirty.Attach( ram.mem, RAM_SIZE );
+			//[SLEND]
 			Reset( false, false );
 		}
 
@@ -341,7 +344,9 @@ namespace Nes
 				state.Begin( AsciiId<'R','E','G'>::V ).Write( data ).End();
 			}
 
-			state.Begin( AsciiId<'R','A','M'>::V ).Compress( ram.mem ).End();
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			state.Begin( AsciiId<'R','A','M'>::V ).Compress( ram.mem, ram.dirty ).End();
+			//[SLEND]
 
 			{
 				const byte data[5] =
@@ -368,6 +373,13 @@ namespace Nes
 			apu.SaveState( state, apuChunk );
 		}
 
+		//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+		void Cpu::SetDirtyPages(bool dirty)
+		{
+			ram.dirty.Set( dirty );
+		}
+		//[SLEND]
+
 		void Cpu::LoadState(State::Loader& state,const dword cpuChunk,const dword apuChunk,const dword baseChunk)
 		{
 			if (baseChunk == cpuChunk)
@@ -764,6 +776,10 @@ namespace Nes
 
 		void Cpu::Ram::Reset(const CpuModel model)
 		{
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			dirty.Set( true );
+			//[SLEND]
+
 			if (model == CPU_DENDY)
 			{
 				std::memset( mem, 0x00, sizeof(mem) );
@@ -788,10 +804,12 @@ namespace Nes
 		NES_PEEK_A(Cpu::Ram,Ram_2) { return mem[address - 0x1000]; }
 		NES_PEEK_A(Cpu::Ram,Ram_3) { return mem[address - 0x1800]; }
 
-		NES_POKE_AD(Cpu::Ram,Ram_0) { mem[address - 0x0000] = data; }
-		NES_POKE_AD(Cpu::Ram,Ram_1) { mem[address - 0x0800] = data; }
-		NES_POKE_AD(Cpu::Ram,Ram_2) { mem[address - 0x1000] = data; }
-		NES_POKE_AD(Cpu::Ram,Ram_3) { mem[address - 0x1800] = data; }
+		//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+		NES_POKE_AD(Cpu::Ram,Ram_0) { mem[address - 0x0000] = data; dirty.Mark( address - 0x0000 ); }
+		NES_POKE_AD(Cpu::Ram,Ram_1) { mem[address - 0x0800] = data; dirty.Mark( address - 0x0800 ); }
+		NES_POKE_AD(Cpu::Ram,Ram_2) { mem[address - 0x1000] = data; dirty.Mark( address - 0x1000 ); }
+		NES_POKE_AD(Cpu::Ram,Ram_3) { mem[address - 0x1800] = data; dirty.Mark( address - 0x1800 ); }
+		//[SLEND]
 
 		NES_PEEK_A(Cpu,Nop)
 		{
@@ -812,6 +830,9 @@ namespace Nes
 		{
 			pc &= 0xFFFF;
 			ram.mem[address & 0x7FF] = data;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			ram.dirty.Mark( address & 0x7FF );
+			//[SLEND]
 		}
 
 		NES_PEEK(Cpu,Jam_1)
@@ -1146,6 +1167,9 @@ namespace Nes
 		inline void Cpu::StoreZpg(const uint address,const uint data)
 		{
 			ram.mem[address] = data;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			ram.dirty.Mark( address );
+			//[SLEND]
 		}
 
 		////////////////////////////////////////////////////////////////////////////////////////
@@ -1160,6 +1184,9 @@ namespace Nes
 			sp = (sp - 1) & 0xFF;
 
 			ram.mem[0x100+p] = data;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			ram.dirty.Mark( 0x100 );
+			//[SLEND]
 		}
 
 		NST_FORCE_INLINE void Cpu::Push16(const uint data)
@@ -1172,6 +1199,9 @@ namespace Nes
 
 			ram.mem[0x100+p1] = data & 0xFF;
 			ram.mem[0x100+p0] = data >> 8;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			ram.dirty.Mark( 0x100 );
+			//[SLEND]
 		}
 
 		inline uint Cpu::Pull8()
@@ -28,6 +28,9 @@
 #include "NstAssert.hpp"
 #include "NstIoMap.hpp"
 #include "NstApu.hpp"
+//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+#include "NstDirtyPages.hpp"
+//[SLEND]
 
 #ifdef NST_PRAGMA_ONCE
 #pragma once
@@ -92,6 +95,10 @@ namespace Nes
 			void SaveState(State::Saver&,dword,dword) const;
 			void LoadState(State::Loader&,dword,dword,dword);
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			void SetDirtyPages(bool);
+			//[SLEND]
+
 		private:
 
 			static void NotifyOp(const char (&)[4],dword);
@@ -433,6 +440,9 @@ namespace Nes
 				NES_DECL_POKE( Ram_3 );
 
 				byte mem[RAM_SIZE];
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				DirtyPages dirty;
+				//[SLEND]
 			};
 
 			struct IoMap : Io::Map<SIZE_64K>
@@ -570,6 +580,13 @@ namespace Nes
 				return ram.mem;
 			}
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			void MarkRam(Address address)
+			{
+				ram.dirty.Mark( address & (RAM_SIZE-1) );
+			}
+			//[SLEND]
+
 			Io::Port& Map(Address address)
 			{
 				return map( address );
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NST_DIRTYPAGES_H
+#define NST_DIRTYPAGES_H
+
+#ifdef NST_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include <cstring>
+
+namespace Nes
+{
+	namespace Core
+	{
+		// Tracks which 256-byte pages of a block of memory have been written
+		// since the last Clear(). Blocks larger than MAX_SIZE are never tracked
+		// and are always reported as not covered, so they get saved in full.
+
+		class DirtyPages
+		{
+		public:
+
+			enum
+			{
+				PAGE_SHIFT = 8,
+				PAGE_SIZE = 1U << PAGE_SHIFT,
+				MAX_PAGES = 256,
+				MAX_SIZE = MAX_PAGES * PAGE_SIZE
+			};
+
+			DirtyPages()
+			: mem(NULL), size(0)
+			{
+				Set( true );
+			}
+
+			void Attach(const byte* m,dword s)
+			{
+				if (m && s <= MAX_SIZE)
+				{
+					mem = m;
+					size = s;
+				}
+				else
+				{
+					mem = NULL;
+					size = 0;
+				}
+
+				Set( true );
+			}
+
+			void Detach()
+			{
+				Attach( NULL, 0 );
+			}
+
+			void Set(bool dirty)
+			{
+				std::memset( bits, dirty ? 0xFF : 0x00, sizeof(bits) );
+			}
+
+			void Mark(dword offset)
+			{
+				NST_ASSERT( offset < size );
+				bits[offset >> (PAGE_SHIFT+5)] |= 1UL << (offset >> PAGE_SHIFT & 0x1F);
+			}
+
+			bool Mark(const byte* p)
+			{
+				if (p >= mem && p < mem + size)
+				{
+					Mark( dword(p - mem) );
+					return true;
+				}
+
+				return false;
+			}
+
+			bool Test(uint page) const
+			{
+				NST_ASSERT( page < MAX_PAGES );
+				return bits[page >> 5] & (1UL << (page & 0x1F));
+			}
+
+			bool Covers(const byte* m,dword s) const
+			{
+				return mem && mem == m && size == s;
+			}
+
+			dword NumPages() const
+			{
+				return (size + (PAGE_SIZE-1)) >> PAGE_SHIFT;
+			}
+
+		private:
+
+			const byte* mem;
+			dword size;
+			dword bits[MAX_PAGES / 32];
+		};
+	}
+}
+
+#endif
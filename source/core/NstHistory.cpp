@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "NstCore.hpp"
+#include "NstHistory.hpp"
+
+namespace Nes
+{
+	namespace Core
+	{
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("s", on)
+		#endif
+
+		History::History()
+		:
+		end       (0),
+		spans     (0),
+		budget    (DEFAULT_BUDGET),
+		stateSize (0)
+		{
+		}
+
+		History::~History()
+		{
+			Clear( false );
+		}
+
+		void History::Clear(const bool keep)
+		{
+			for (Keyframe** it = keyframes.Begin(), **const last = keyframes.End(); it != last; ++it)
+			{
+				if (keep && spare.Size() < NUM_LEVELS)
+				{
+					(*it)->state.Clear();
+					spare.Append( *it );
+				}
+				else
+				{
+					delete *it;
+				}
+			}
+
+			keyframes.Clear();
+
+			if (keep)
+			{
+				log.Clear();
+			}
+			else
+			{
+				for (Keyframe** it = spare.Begin(), **const last = spare.End(); it != last; ++it)
+					delete *it;
+
+				spare.Destroy();
+				keyframes.Destroy();
+				log.Destroy();
+			}
+
+			end = 0;
+			spans = 0;
+			stateSize = 0;
+		}
+
+		void History::SetBudget(dword bytes)
+		{
+			budget = NST_MIN(NST_MAX(bytes,dword(MIN_BUDGET)),dword(MAX_BUDGET));
+			Trim();
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("", on)
+		#endif
+
+		History::Keyframe* History::NewKeyframe()
+		{
+			return spare.Size() ? spare.Pop() : new Keyframe;
+		}
+
+		void History::Remove(Keyframe** const it)
+		{
+			Keyframe* const keyframe = *it;
+
+			keyframes.Erase( it );
+			stateSize -= keyframe->state.Size();
+
+			if (spare.Size() < NUM_LEVELS)
+				spare.Append( keyframe );
+			else
+				delete keyframe;
+		}
+
+		void History::Append(const dword frame,const dword frames,const byte* const state,const dword size,const byte* const input,const dword length)
+		{
+			//A span that doesn't follow on from the last one starts a new run.
+			if (keyframes.Size() && frame != end)
+				Clear();
+
+			try
+			{
+				keyframes.Reserve( keyframes.Size() + 1 );
+				spare.Reserve( NUM_LEVELS );
+
+				Keyframe* const keyframe = NewKeyframe();
+
+				keyframe->frame = frame;
+				keyframe->input = log.Size();
+				keyframe->index = spans++;
+				keyframe->level = 0;
+
+				try
+				{
+					keyframe->state.Assign( state, size );
+				}
+				catch (...)
+				{
+					spare.Append( keyframe );
+					throw;
+				}
+
+				keyframes.Append( keyframe );
+				stateSize += size;
+
+				log.Append( input, length );
+				end = frame + frames;
+			}
+			catch (...)
+			{
+				NST_DEBUG_MSG("history append failed!");
+				Clear();
+				return;
+			}
+
+			Thin();
+			Trim();
+		}
+
+		void History::Thin()
+		{
+			for (uint level=0; level < NUM_LEVELS-1; ++level)
+			{
+				//The keyframes of a level lie next to each other, newer levels last.
+				Keyframe** oldest = NULL;
+				uint count = 0;
+
+				for (Keyframe** it = keyframes.End(), **const first = keyframes.Begin(); it != first; )
+				{
+					--it;
+
+					if ((*it)->level == level)
+					{
+						oldest = it;
+						++count;
+					}
+					else if ((*it)->level > level)
+					{
+						break;
+					}
+				}
+
+				if (count <= KEYS_PER_LEVEL)
+					break;
+
+				if ((*oldest)->index & ((2U << level) - 1))
+					Remove( oldest );
+				else
+					(*oldest)->level = level + 1;
+			}
+		}
+
+		void History::Trim()
+		{
+			if (Size() <= budget || keyframes.Size() < 2)
+				return;
+
+			do
+			{
+				Remove( keyframes.Begin() );
+			}
+			while (Size() - keyframes.Front()->input > budget && keyframes.Size() > 1);
+
+			//The input before the new oldest keyframe can't be replayed any more.
+			const dword discard = keyframes.Front()->input;
+
+			log.Erase( log.Begin(), discard );
+
+			for (Keyframe** it = keyframes.Begin(), **const last = keyframes.End(); it != last; ++it)
+				(*it)->input -= discard;
+		}
+
+		void History::Truncate(const dword frame,const dword input)
+		{
+			NST_ASSERT( input <= log.Size() && frame - Begin() <= end - Begin() );
+
+			while (keyframes.Size() && frame < keyframes.Back()->frame)
+				Remove( keyframes.End() - 1 );
+
+			if (keyframes.Size())
+			{
+				log.SetTo( input );
+				end = frame;
+			}
+			else
+			{
+				Clear();
+			}
+		}
+
+		const History::Keyframe* History::Find(const dword frame) const
+		{
+			if (keyframes.Size() && frame - Begin() <= end - Begin())
+			{
+				for (Keyframe** it = keyframes.End(); ; )
+				{
+					if ((*--it)->frame <= frame)
+						return *it;
+				}
+			}
+
+			return NULL;
+		}
+	}
+}
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef NST_HISTORY_H
+#define NST_HISTORY_H
+
+#ifndef NST_VECTOR_H
+#include "NstVector.hpp"
+#endif
+
+#ifdef NST_PRAGMA_ONCE
+#pragma once
+#endif
+
+namespace Nes
+{
+	namespace Core
+	{
+		// A long run of frames kept as sparse keyframes plus every byte of input
+		// read during the run, so any frame in it can be reached by loading one
+		// keyframe and replaying at most MAX_SPACING spans. Each appended span
+		// starts out with a keyframe of its own on level 0. When a level holds more
+		// than KEYS_PER_LEVEL keyframes its oldest one moves up a level if its span
+		// index is a multiple of the next level's spacing and is dropped otherwise,
+		// so the spacing doubles from one level to the next. The top level only
+		// shrinks when the memory budget is exceeded, by dropping the oldest
+		// keyframe together with the input leading up to the next one.
+		//
+		// States and input are kept as opaque bytes, so the class doesn't depend on
+		// the machine and can hold any trajectory that replays deterministically.
+
+		class History
+		{
+		public:
+
+			History();
+			~History();
+
+			enum
+			{
+				MIN_BUDGET = SIZE_1024K,
+				DEFAULT_BUDGET = SIZE_16384K,
+				MAX_BUDGET = SIZE_16384K * 64,
+				KEYS_PER_LEVEL = 8,
+				NUM_LEVELS = 6,
+				MAX_SPACING = 1U << (NUM_LEVELS-1)
+			};
+
+			struct Keyframe
+			{
+				dword frame;
+				dword input;
+				dword index;
+				uint level;
+				Vector<byte> state;
+			};
+
+			void Clear(bool=true);
+			void SetBudget(dword);
+			void Append(dword,dword,const byte*,dword,const byte*,dword);
+			void Truncate(dword,dword);
+			const Keyframe* Find(dword) const;
+
+		private:
+
+			Keyframe* NewKeyframe();
+			void Remove(Keyframe**);
+			void Thin();
+			void Trim();
+
+			// Oldest first.
+			Vector<Keyframe*> keyframes;
+			Vector<Keyframe*> spare;
+			Vector<byte> log;
+			dword end;
+			dword spans;
+			dword budget;
+			dword stateSize;
+
+		public:
+
+			bool Empty() const
+			{
+				return !keyframes.Size();
+			}
+
+			dword Begin() const
+			{
+				return keyframes.Size() ? keyframes.Front()->frame : end;
+			}
+
+			dword End() const
+			{
+				return end;
+			}
+
+			dword GetBudget() const
+			{
+				return budget;
+			}
+
+			dword Size() const
+			{
+				return stateSize + log.Size();
+			}
+
+			const byte* Input() const
+			{
+				return log.Begin();
+			}
+
+			dword InputSize() const
+			{
+				return log.Size();
+			}
+		};
+	}
+}
+
+#endif
@@ -100,6 +100,10 @@ namespace Nes
 			virtual void LoadState(State::Loader&) {}
 			virtual void SaveState(State::Saver&,dword) const {}
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			virtual void SetDirtyPages(bool) {}
+			//[SLEND]
+
 			virtual uint GetDesiredController(uint) const;
 			virtual uint GetDesiredAdapter() const;
 			virtual Region GetDesiredRegion() const = 0;
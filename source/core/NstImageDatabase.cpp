@@ -32,11 +32,120 @@
 #include "NstLog.hpp"
 #include "NstImageDatabase.hpp"
 #include "NstXml.hpp"
+//[SLBEGIN]: Compiled image database.
+#include "NstStream.hpp"
+//[SLEND]
 
 namespace Nes
 {
 	namespace Core
 	{
+		//[SLBEGIN]: Compiled image database.
+
+		// The compiled form is what Load() builds from the XML written out as is:
+		// a header, the string pool as 16-bit characters and the items in hash
+		// order, each one followed by its siblings. Strings are stored as offsets
+		// into the pool, everything else as little-endian dwords.
+
+		class ImageDatabase::Compiled
+		{
+		public:
+
+			enum
+			{
+				MAGIC = AsciiId<'N','D','B'>::V | dword(0x1A) << 24,
+				VERSION = 1
+			};
+
+			class Output
+			{
+				Vector<byte> data;
+
+			public:
+
+				Output& operator << (dword value)
+				{
+					const byte bytes[4] =
+					{
+						byte(value >>  0 & 0xFF),
+						byte(value >>  8 & 0xFF),
+						byte(value >> 16 & 0xFF),
+						byte(value >> 24 & 0xFF)
+					};
+
+					data.Append( bytes, 4 );
+
+					return *this;
+				}
+
+				const Vector<byte>& Data() const
+				{
+					return data;
+				}
+			};
+
+			class Input
+			{
+				const byte* pos;
+				const byte* const end;
+				const dword strings;
+
+			public:
+
+				Input(const byte* b,const byte* e,dword s)
+				: pos(b), end(e), strings(s) {}
+
+				dword Read()
+				{
+					if (end - pos < 4)
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					const dword value = pos[0] | dword(pos[1]) << 8 | dword(pos[2]) << 16 | dword(pos[3]) << 24;
+					pos += 4;
+
+					return value;
+				}
+
+				dword ReadString()
+				{
+					const dword offset = Read();
+
+					if (offset >= strings)
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					return offset;
+				}
+
+				dword ReadCount(dword minSize)
+				{
+					const dword count = Read();
+
+					if (count > dword(end - pos) / (minSize * 4))
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					return count;
+				}
+
+				bool Done() const
+				{
+					return pos == end;
+				}
+			};
+
+			static bool Is(std::istream& stream)
+			{
+				try
+				{
+					return Stream::In( &stream ).Peek32() == MAGIC;
+				}
+				catch (Result)
+				{
+					return false;
+				}
+			}
+		};
+		//[SLEND]
+
 		class ImageDatabase::Item
 		{
 		public:
@@ -110,6 +219,13 @@ namespace Nes
 				{
 					return string;
 				}
+
+				//[SLBEGIN]: Compiled image database.
+				dword Offset(wcstring lut) const
+				{
+					return string - lut;
+				}
+				//[SLEND]
 			};
 
 		public:
@@ -911,6 +1027,296 @@ namespace Nes
 					sibling->Finalize( lut );
 			}
 
+			//[SLBEGIN]: Compiled image database.
+			enum
+			{
+				COMPILED_SIBLING     = 0x1,
+				COMPILED_MULTIREGION = 0x2
+			};
+
+			static void Write(Compiled::Output& output,const Hash& hash)
+			{
+				output << hash.GetCrc32();
+
+				for (uint i=0; i < Hash::SHA1_WORD_LENGTH; ++i)
+					output << hash.GetSha1()[i];
+			}
+
+			static Hash ReadHash(Compiled::Input& input)
+			{
+				dword data[1+Hash::SHA1_WORD_LENGTH];
+
+				for (uint i=0; i < 1+Hash::SHA1_WORD_LENGTH; ++i)
+					data[i] = input.Read();
+
+				return Hash( data+1, data[0] );
+			}
+
+			static void Write(Compiled::Output& output,const Ic::Pins& pins,wcstring const lut)
+			{
+				output << pins.size();
+
+				for (Ic::Pins::const_iterator it(pins.begin()), end(pins.end()); it != end; ++it)
+					output << it->number << it->function.Offset( lut );
+			}
+
+			static void Read(Compiled::Input& input,Ic::Pins& pins)
+			{
+				for (dword n=input.ReadCount(2); n; --n)
+				{
+					const dword number = input.Read();
+					pins.push_back( Ic::Pin(number,input.ReadString()) );
+				}
+			}
+
+			static Item* Read(Compiled::Input& input)
+			{
+				bool sibling;
+				Item* const item = ReadOne( input, sibling );
+
+				try
+				{
+					for (Item* it=item; sibling; it=it->sibling)
+						it->sibling = ReadOne( input, sibling );
+				}
+				catch (...)
+				{
+					delete item;
+					throw;
+				}
+
+				return item;
+			}
+
+			static Item* ReadOne(Compiled::Input& input,bool& sibling)
+			{
+				const Hash hashIn( ReadHash(input) );
+				const dword flags = input.Read();
+				const dword dumpBy = input.ReadString();
+				const dword dumpDate = input.ReadString();
+				const dword dumpState = input.Read();
+				const dword titleIn = input.ReadString();
+				const dword altTitleIn = input.ReadString();
+				const dword clssIn = input.ReadString();
+				const dword subClssIn = input.ReadString();
+				const dword catalogIn = input.ReadString();
+				const dword publisherIn = input.ReadString();
+				const dword developerIn = input.ReadString();
+				const dword portDeveloperIn = input.ReadString();
+				const dword regionIn = input.ReadString();
+
+				Properties propertiesIn;
+
+				for (dword n=input.ReadCount(2); n; --n)
+				{
+					const dword name = input.ReadString();
+					propertiesIn.push_back( Property(name,input.ReadString()) );
+				}
+
+				const dword playersIn = input.Read();
+
+				byte peripheralsIn[MAX_PERIPHERALS];
+
+				for (uint i=0; i < MAX_PERIPHERALS; ++i)
+					peripheralsIn[i] = input.Read();
+
+				const dword systemIn = input.Read();
+				const dword cpuIn = input.Read();
+				const dword ppuIn = input.Read();
+				const dword revisionIn = input.ReadString();
+				const dword boardIn = input.ReadString();
+				const dword pcbIn = input.ReadString();
+				const dword mapperIn = input.Read();
+
+				Roms roms[2];
+
+				for (uint i=0; i < 2; ++i)
+				{
+					for (dword n=input.ReadCount(11); n; --n)
+					{
+						const dword id = input.Read();
+						const dword name = input.ReadString();
+						const dword size = input.Read();
+						const dword package = input.ReadString();
+						const Hash romHash( ReadHash(input) );
+
+						Ic::Pins pins;
+						Read( input, pins );
+
+						roms[i].push_back( Rom(id,name,size,package,pins,romHash) );
+					}
+				}
+
+				Rams rams[2];
+
+				for (uint i=0; i < 2; ++i)
+				{
+					for (dword n=input.ReadCount(5); n; --n)
+					{
+						const dword id = input.Read();
+						const dword size = input.Read();
+						const bool battery = input.Read();
+						const dword package = input.ReadString();
+
+						Ic::Pins pins;
+						Read( input, pins );
+
+						rams[i].push_back( Ram(id,size,battery,package,pins) );
+					}
+				}
+
+				Chips chipsIn;
+
+				for (dword n=input.ReadCount(4); n; --n)
+				{
+					const dword type = input.ReadString();
+					const bool battery = input.Read();
+					const dword package = input.ReadString();
+
+					Ic::Pins pins;
+					Read( input, pins );
+
+					chipsIn.push_back( Chip(type,battery,package,pins) );
+				}
+
+				const dword cicIn = input.ReadString();
+				const dword solderPadsIn = input.Read();
+
+				if (dumpState > Profile::Dump::UNKNOWN || playersIn > MAX_PLAYERS || (mapperIn > MAX_MAPPER && mapperIn != Profile::Board::NO_MAPPER))
+					throw RESULT_ERR_CORRUPT_FILE;
+
+				Item* const item = new Item
+				(
+					hashIn,
+					dumpBy,
+					dumpDate,
+					static_cast<Profile::Dump::State>(dumpState),
+					titleIn,
+					altTitleIn,
+					clssIn,
+					subClssIn,
+					catalogIn,
+					publisherIn,
+					developerIn,
+					portDeveloperIn,
+					regionIn,
+					propertiesIn,
+					playersIn,
+					peripheralsIn,
+					static_cast<Profile::System::Type>(systemIn),
+					static_cast<Profile::System::Cpu>(cpuIn),
+					static_cast<Profile::System::Ppu>(ppuIn),
+					revisionIn,
+					boardIn,
+					pcbIn,
+					mapperIn,
+					roms[0],
+					roms[1],
+					rams[0],
+					rams[1],
+					chipsIn,
+					cicIn,
+					solderPadsIn
+				);
+
+				item->multiRegion = flags & COMPILED_MULTIREGION;
+				sibling = flags & COMPILED_SIBLING;
+
+				return item;
+			}
+		public:
+
+			static Item* Load(Compiled::Input& input,wcstring const lut)
+			{
+				Item* const item = Read( input );
+				item->Finalize( lut );
+
+				return item;
+			}
+
+			void Write(Compiled::Output& output,wcstring const lut) const
+			{
+				for (const Item* it=this; it; it=it->sibling)
+					it->WriteOne( output, lut );
+			}
+
+		private:
+
+			void WriteOne(Compiled::Output& output,wcstring const lut) const
+			{
+				Write( output, hash );
+
+				output << ((sibling ? COMPILED_SIBLING : 0U) | (multiRegion ? COMPILED_MULTIREGION : 0U))
+				       << dump.by.Offset( lut )
+				       << dump.date.Offset( lut )
+				       << dump.state
+				       << title.Offset( lut )
+				       << altTitle.Offset( lut )
+				       << clss.Offset( lut )
+				       << subClss.Offset( lut )
+				       << catalog.Offset( lut )
+				       << publisher.Offset( lut )
+				       << developer.Offset( lut )
+				       << portDeveloper.Offset( lut )
+				       << region.Offset( lut )
+				       << properties.size();
+
+				for (Properties::const_iterator it(properties.begin()), end(properties.end()); it != end; ++it)
+					output << it->name.Offset( lut ) << it->value.Offset( lut );
+
+				output << players;
+
+				for (uint i=0; i < MAX_PERIPHERALS; ++i)
+					output << peripherals[i];
+
+				output << system
+				       << cpu
+				       << ppu
+				       << revision.Offset( lut )
+				       << board.Offset( lut )
+				       << pcb.Offset( lut )
+				       << mapper;
+
+				for (uint i=0; i < 2; ++i)
+				{
+					const Roms& roms = (i ? chr : prg);
+
+					output << roms.size();
+
+					for (Roms::const_iterator it(roms.begin()), end(roms.end()); it != end; ++it)
+					{
+						output << it->id << it->name.Offset( lut ) << it->size << it->package.Offset( lut );
+						Write( output, it->hash );
+						Write( output, it->pins, lut );
+					}
+				}
+
+				for (uint i=0; i < 2; ++i)
+				{
+					const Rams& rams = (i ? vram : wram);
+
+					output << rams.size();
+
+					for (Rams::const_iterator it(rams.begin()), end(rams.end()); it != end; ++it)
+					{
+						output << it->id << it->size << it->battery << it->package.Offset( lut );
+						Write( output, it->pins, lut );
+					}
+				}
+
+				output << chips.size();
+
+				for (Chips::const_iterator it(chips.begin()), end(chips.end()); it != end; ++it)
+				{
+					output << it->type.Offset( lut ) << it->battery << it->package.Offset( lut );
+					Write( output, it->pins, lut );
+				}
+
+				output << cic.Offset( lut ) << solderPads;
+			}
+
+			//[SLEND]
+
 		public:
 
 			struct Less
@@ -1022,9 +1428,13 @@ namespace Nes
 					( items.hashing & HASHING_CRC  ) ? hash.GetCrc32() : 0UL
 				);
 
-				const Item** item = std::lower_bound( items.begin, items.end, searchHash, Item::Less() );
+				//[SLBEGIN]: Compiled image database.
+				const uint bucket = GetBucket( searchHash );
+				const Item** const end = items.index[bucket+1];
+				const Item** item = std::lower_bound( items.index[bucket], end, searchHash, Item::Less() );
 
-				if (item != items.end && (*item)->GetHash() == searchHash)
+				if (item != end && (*item)->GetHash() == searchHash)
+				//[SLEND]
 				{
 					for (const Item* it = *item; it; it = it->GetNextSibling())
 					{
@@ -1177,6 +1587,11 @@ namespace Nes
 
 		Result ImageDatabase::Load(std::istream& baseStream,std::istream* overrideStream)
 		{
+			//[SLBEGIN]: Compiled image database.
+			if (!overrideStream && Compiled::Is( baseStream ))
+				return LoadCompiled( baseStream );
+			//[SLEND]
+
 			Unload();
 
 			try
@@ -1587,6 +2002,11 @@ namespace Nes
 				}
 
 				builder.Construct( strings, items.begin, items.end );
+
+				//[SLBEGIN]: Compiled image database.
+				if (items.begin)
+					Index();
+				//[SLEND]
 			}
 			catch (Result result)
 			{
@@ -1613,6 +2033,165 @@ namespace Nes
 			return RESULT_OK;
 		}
 
+		//[SLBEGIN]: Compiled image database.
+		Result ImageDatabase::LoadCompiled(std::istream& stream)
+		{
+			Unload();
+
+			try
+			{
+				Stream::In in( &stream );
+
+				if (in.Read32() != Compiled::MAGIC)
+					return RESULT_ERR_INVALID_FILE;
+
+				if (in.Read32() != Compiled::VERSION)
+					return RESULT_ERR_UNSUPPORTED_FILE_VERSION;
+
+				const dword hashing = in.Read32();
+				const dword count = in.Read32();
+				const dword length = in.Read32();
+				const dword size = in.Read32();
+
+				if
+				(
+					!(hashing & (HASHING_SHA1|HASHING_CRC)) || hashing > (HASHING_SHA1|HASHING_CRC) ||
+					!count || !length || length > 0x7FFFFFFF / 2 || size > 0x7FFFFFFF - length * 2 ||
+					in.Length() < length * 2 + size
+				)
+					throw RESULT_ERR_CORRUPT_FILE;
+
+				Vector<byte> data( length * 2 + size );
+				in.Read( data.Begin(), data.Size() );
+
+				strings.Resize( length );
+
+				for (dword i=0; i < length; ++i)
+					strings[i] = data[i*2+0] | uint(data[i*2+1]) << 8;
+
+				if (strings[length-1] != L'\0')
+					throw RESULT_ERR_CORRUPT_FILE;
+
+				Compiled::Input input( data.Begin() + length * 2, data.End(), length );
+
+				items.hashing = hashing;
+				items.begin = new const Item* [count];
+				items.end = items.begin;
+
+				for (dword i=0; i < count; ++i)
+				{
+					const Item* const item = Item::Load( input, strings.Begin() );
+					*items.end++ = item;
+
+					if (i && !Item::Less()( items.end[-2], item ))
+						throw RESULT_ERR_CORRUPT_FILE;
+				}
+
+				if (!input.Done())
+					throw RESULT_ERR_CORRUPT_FILE;
+
+				Index();
+			}
+			catch (Result result)
+			{
+				Unload( true );
+				return result;
+			}
+			catch (const std::bad_alloc&)
+			{
+				Unload( true );
+				return RESULT_ERR_OUT_OF_MEMORY;
+			}
+			catch (...)
+			{
+				Unload( true );
+				return RESULT_ERR_GENERIC;
+			}
+
+			Log() << "Database: "
+                  << (items.end - items.begin)
+                  << " items imported from compiled DB" NST_LINEBREAK;
+
+			return RESULT_OK;
+		}
+
+		Result ImageDatabase::Save(std::ostream& stream) const
+		{
+			if (!items.begin)
+				return RESULT_ERR_NOT_READY;
+
+			try
+			{
+				Compiled::Output output;
+
+				for (const Item* const* it=items.begin; it != items.end; ++it)
+					(*it)->Write( output, strings.Begin() );
+
+				Vector<byte> pool( strings.Size() * 2 );
+
+				for (dword i=0, n=strings.Size(); i < n; ++i)
+				{
+					if (dword(strings[i]) > 0xFFFF)
+						throw RESULT_ERR_UNSUPPORTED;
+
+					pool[i*2+0] = strings[i] >> 0 & 0xFF;
+					pool[i*2+1] = strings[i] >> 8 & 0xFF;
+				}
+
+				Stream::Out out( &stream );
+
+				out.Write32( Compiled::MAGIC );
+				out.Write32( Compiled::VERSION );
+				out.Write32( items.hashing );
+				out.Write32( items.end - items.begin );
+				out.Write32( strings.Size() );
+				out.Write32( output.Data().Size() );
+				out.Write( pool.Begin(), pool.Size() );
+				out.Write( output.Data().Begin(), output.Data().Size() );
+			}
+			catch (Result result)
+			{
+				return result;
+			}
+			catch (const std::bad_alloc&)
+			{
+				return RESULT_ERR_OUT_OF_MEMORY;
+			}
+			catch (...)
+			{
+				return RESULT_ERR_GENERIC;
+			}
+
+			return RESULT_OK;
+		}
+
+		uint ImageDatabase::GetBucket(const Hash& hash) const
+		{
+			// items are sorted by CRC first, or by SHA-1 if that's all they have
+
+			return ((items.hashing & HASHING_CRC) ? hash.GetCrc32() : hash.GetSha1()[0]) >> (32 - INDEX_BITS);
+		}
+
+		void ImageDatabase::Index()
+		{
+			NST_ASSERT( items.begin );
+
+			const Item** it = items.begin;
+
+			for (uint i=0; i < INDEX_SIZE; ++i)
+			{
+				items.index[i] = it;
+
+				while (it != items.end && GetBucket( (*it)->GetHash() ) == i)
+					++it;
+			}
+
+			NST_VERIFY( it == items.end );
+
+			items.index[INDEX_SIZE] = items.end;
+		}
+		//[SLEND]
+
 		void ImageDatabase::Unload(const bool error)
 		{
 			if (const Item** it=items.begin)
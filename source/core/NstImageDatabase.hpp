@@ -39,6 +39,9 @@ namespace Nes
 		class ImageDatabase
 		{
 			class Item;
+			//[SLBEGIN]: Compiled image database.
+			class Compiled;
+			//[SLEND]
 
 		public:
 
@@ -100,11 +103,19 @@ namespace Nes
 			};
 
 			Entry Search(const Hash&,FavoredSystem) const;
+			//[SLBEGIN]: Compiled image database.
+			Result Save(std::ostream&) const;
+			//[SLEND]
 
 		private:
 
 			Result Load(std::istream&,std::istream*);
 			void Unload(bool);
+			//[SLBEGIN]: Compiled image database.
+			Result LoadCompiled(std::istream&);
+			void Index();
+			uint GetBucket(const Hash&) const;
+			//[SLEND]
 
 			typedef Vector<wchar_t> Strings;
 
@@ -122,6 +133,14 @@ namespace Nes
 				HASHING_CRC    = 0x2
 			};
 
+			//[SLBEGIN]: Compiled image database.
+			enum
+			{
+				INDEX_BITS = 12,
+				INDEX_SIZE = 1U << INDEX_BITS
+			};
+			//[SLEND]
+
 			ibool enabled;
 
 			struct
@@ -129,6 +148,9 @@ namespace Nes
 				const Item** begin;
 				const Item** end;
 				uint hashing;
+				//[SLBEGIN]: Compiled image database.
+				const Item** index[INDEX_SIZE+1];
+				//[SLEND]
 			}   items;
 
 			Strings strings;
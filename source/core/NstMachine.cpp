@@ -32,6 +32,9 @@
 #include "input/NstInpPad.hpp"
 #include "api/NstApiMachine.hpp"
 #include "api/NstApiUser.hpp"
+//[SLBEGIN]: Scoped trace hooks.
+#include "NstTrace.hpp"
+//[SLEND]
 
 namespace Nes
 {
@@ -304,6 +307,10 @@ namespace Nes
 
 				cpu.Boot( hard );
 
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				SetDirtyPages( true );
+				//[SLEND]
+
 				if (state & Api::Machine::ON)
 				{
 					Api::Machine::eventCallback( hard ? Api::Machine::EVENT_RESET_HARD : Api::Machine::EVENT_RESET_SOFT );
@@ -321,6 +328,17 @@ namespace Nes
 			}
 		}
 
+		//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+		void Machine::SetDirtyPages(bool dirty)
+		{
+			cpu.SetDirtyPages( dirty );
+			ppu.SetDirtyPages( dirty );
+
+			if (image)
+				image->SetDirtyPages( dirty );
+		}
+		//[SLEND]
+
 		void Machine::SwitchMode()
 		{
 			NST_ASSERT( !(state & Api::Machine::ON) );
@@ -348,6 +366,10 @@ namespace Nes
 
 		void Machine::SaveState(State::Saver& saver) const
 		{
+			//[SLBEGIN]: Scoped trace hooks.
+			NST_TRACE_SCOPE( "Machine::SaveState" );
+			//[SLEND]
+
 			NST_ASSERT( (state & (Api::Machine::GAME|Api::Machine::ON)) > Api::Machine::ON );
 
 			saver.Begin( AsciiId<'N','S','T'>::V | 0x1AUL << 24 );
@@ -380,6 +402,10 @@ namespace Nes
 
 		bool Machine::LoadState(State::Loader& loader,const bool resetOnError)
 		{
+			//[SLBEGIN]: Scoped trace hooks.
+			NST_TRACE_SCOPE( "Machine::LoadState" );
+			//[SLEND]
+
 			NST_ASSERT( (state & (Api::Machine::GAME|Api::Machine::ON)) > Api::Machine::ON );
 
 			try
@@ -469,6 +495,12 @@ namespace Nes
 				}
 
 				loader.End();
+
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				//Memory that was not written by the loaded state no longer matches
+				//whatever snapshot the dirty bits were relative to.
+				SetDirtyPages( true );
+				//[SLEND]
 			}
 			catch (...)
 			{
@@ -492,6 +524,10 @@ namespace Nes
 			Input::Controllers* const input
 		)
 		{
+			//[SLBEGIN]: Scoped trace hooks.
+			NST_TRACE_SCOPE( "Machine::Execute" );
+			//[SLEND]
+
 			NST_ASSERT( state & Api::Machine::ON );
 
 			if (!(state & Api::Machine::SOUND))
@@ -510,7 +546,9 @@ namespace Nes
 				cpu.ExecuteFrame( sound );
 				ppu.EndFrame();
 
-				if (video)
+				//[SLBEGIN]: Duplicate frame elision.
+				if (video && !renderer.IsDuplicate( ppu.GetScreen(), ppu.GetBurstPhase() ))
+				//[SLEND]
 					renderer.Blit( *video, ppu.GetScreen(), ppu.GetBurstPhase() );
 
 				cpu.EndFrame();
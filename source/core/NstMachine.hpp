@@ -98,6 +98,9 @@ namespace Nes
 			void   SwitchMode();
 			bool   LoadState(State::Loader&,bool);
 			void   SaveState(State::Saver&) const;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			void   SetDirtyPages(bool);
+			//[SLEND]
 			void   InitializeInputDevices() const;
 			Result UpdateColorMode();
 			Result UpdateColorMode(ColorMode);
@@ -108,6 +108,10 @@ namespace Nes
 		yuvMap (NULL)
 		{
 			cycles.one = PPU_RP2C02_CC;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			oamDirty.Attach( oam.ram, Oam::SIZE );
+			nmtDirty.Attach( nameTable.ram, NameTable::SIZE );
+			//[SLEND]
 			PowerOff();
 		}
 
@@ -186,6 +190,9 @@ namespace Nes
 				std::memcpy( palette.ram, powerUpPalette, Palette::SIZE );
 				std::memset( oam.ram, Oam::GARBAGE, Oam::SIZE );
 				std::memset( nameTable.ram, NameTable::GARBAGE, NameTable::SIZE );
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				SetDirtyPages( true );
+				//[SLEND]
 
 				io.latch = 0;
 				io.buffer = Io::BUFFER_GARBAGE;
@@ -222,6 +229,9 @@ namespace Nes
 				cycles.hClock = HCLOCK_BOOT;
 
 				std::memset( oam.ram, Oam::GARBAGE, Oam::SIZE );
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				oamDirty.Set( true );
+				//[SLEND]
 			}
 			else
 			{
@@ -337,8 +347,10 @@ namespace Nes
 			}
 
 			state.Begin( AsciiId<'P','A','L'>::V ).Compress( palette.ram   ).End();
-			state.Begin( AsciiId<'O','A','M'>::V ).Compress( oam.ram       ).End();
-			state.Begin( AsciiId<'N','M','T'>::V ).Compress( nameTable.ram ).End();
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			state.Begin( AsciiId<'O','A','M'>::V ).Compress( oam.ram,       oamDirty ).End();
+			state.Begin( AsciiId<'N','M','T'>::V ).Compress( nameTable.ram, nmtDirty ).End();
+			//[SLEND]
 
 			if (model == PPU_RP2C02)
 				state.Begin( AsciiId<'F','R','M'>::V ).Write8( (regs.frame & Regs::FRAME_ODD) == 0 ).End();
@@ -349,6 +361,15 @@ namespace Nes
 			state.End();
 		}
 
+		//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+		void Ppu::SetDirtyPages(bool dirty)
+		{
+			oamDirty.Set( dirty );
+			nmtDirty.Set( dirty );
+			vramDirty.Set( dirty );
+		}
+		//[SLEND]
+
 		void Ppu::LoadState(State::Loader& state)
 		{
 			cycles.hClock = HCLOCK_DUMMY;
@@ -861,6 +882,9 @@ namespace Nes
 			regs.oam = (regs.oam + 1) & 0xFF;
 			io.latch = data;
 			*value = data;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			oamDirty.Mark( dword(0) );
+			//[SLEND]
 		}
 
 		NES_PEEK(Ppu,2004)
@@ -957,10 +981,23 @@ namespace Nes
 			{
 				address &= 0x3FFF;
 
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				const byte* target;
+
 				if (address >= 0x2000)
+				{
 					nmt.Poke( address & 0xFFF, data );
+					target = nmt[address >> 10 & 0x3] + (address & 0x3FF);
+				}
 				else
+				{
 					chr.Poke( address, data );
+					target = chr[address >> 10] + (address & 0x3FF);
+				}
+
+				if (!nmtDirty.Mark( target ))
+					vramDirty.Mark( target );
+				//[SLEND]
 			}
 		}
 
@@ -1051,6 +1088,10 @@ namespace Nes
 				*out = io.latch;
 			}
 			while (data & 0xFF);
+
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			oamDirty.Mark( dword(0) );
+			//[SLEND]
 		}
 
 		NES_PEEK(Ppu,4014)
@@ -34,6 +34,9 @@
 #include "NstHook.hpp"
 #include "NstMemory.hpp"
 #include "NstVideoScreen.hpp"
+//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+#include "NstDirtyPages.hpp"
+//[SLEND]
 
 #ifdef NST_PRAGMA_ONCE
 #pragma once
@@ -80,6 +83,10 @@ namespace Nes
 			void LoadState(State::Loader&);
 			void SaveState(State::Saver&,dword) const;
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			void SetDirtyPages(bool);
+			//[SLEND]
+
 			class ChrMem : public Memory<SIZE_8K,SIZE_1K,2>
 			{
 				NES_DECL_ACCESSOR( Pattern );
@@ -421,6 +428,11 @@ namespace Nes
 			Oam oam;
 			Palette palette;
 			NameTable nameTable;
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			DirtyPages oamDirty;
+			DirtyPages nmtDirty;
+			DirtyPages vramDirty;
+			//[SLEND]
 			const TileLut tileLut;
 			Video::Screen screen;
 
@@ -497,6 +509,19 @@ namespace Nes
 				return nmt;
 			}
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			//Boards attach their CHR/NMT RAM here so writes through $2007 get tracked.
+			DirtyPages& GetVramDirtyPages()
+			{
+				return vramDirty;
+			}
+
+			const DirtyPages& GetVramDirtyPages() const
+			{
+				return vramDirty;
+			}
+			//[SLEND]
+
 			Cycle GetClock(dword count=1) const
 			{
 				NST_ASSERT( count );
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "NstCore.hpp"
+#include "NstSimd.hpp"
+
+#ifdef NST_SSE2
+ #if NST_MSVC
+  #include <intrin.h>
+ #elif NST_GCC
+  #include <cpuid.h>
+ #endif
+#endif
+
+namespace Nes
+{
+	namespace Core
+	{
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("s", on)
+		#endif
+
+		const Simd::Level Simd::supported = Simd::Detect();
+		Simd::Level Simd::level = Simd::supported;
+
+		Simd::Level Simd::SetLevel(Level wanted)
+		{
+			level = NST_MIN(wanted,supported);
+			return level;
+		}
+
+		Simd::Level Simd::Detect()
+		{
+		#ifdef NST_SSE2
+
+			uint regs[4];
+
+		#if NST_MSVC
+			__cpuid( reinterpret_cast<int*>(regs), 0 );
+		#else
+			__cpuid( 0, regs[0], regs[1], regs[2], regs[3] );
+		#endif
+
+			const uint maxLeaf = regs[0];
+
+			if (maxLeaf < 1)
+				return LEVEL_NONE;
+
+		#if NST_MSVC
+			__cpuid( reinterpret_cast<int*>(regs), 1 );
+		#else
+			__cpuid( 1, regs[0], regs[1], regs[2], regs[3] );
+		#endif
+
+			if (!(regs[3] & 1UL << 26))
+				return LEVEL_NONE;
+
+		#ifdef NST_AVX2
+
+			// AVX needs OSXSAVE and the OS saving the YMM registers on top of the CPU flag
+
+			if (maxLeaf >= 7 && (regs[2] & (1UL << 27 | 1UL << 28)) == (1UL << 27 | 1UL << 28))
+			{
+			#if NST_MSVC
+				const uint xcr0 = uint(_xgetbv( 0 ));
+			#else
+				uint xcr0, xcr0Hi;
+				__asm__ __volatile__ ( "xgetbv" : "=a" (xcr0), "=d" (xcr0Hi) : "c" (0) );
+			#endif
+
+				if ((xcr0 & 0x6) == 0x6)
+				{
+				#if NST_MSVC
+					__cpuidex( reinterpret_cast<int*>(regs), 7, 0 );
+				#else
+					__cpuid_count( 7, 0, regs[0], regs[1], regs[2], regs[3] );
+				#endif
+
+					if (regs[1] & 1UL << 5)
+						return LEVEL_AVX2;
+				}
+			}
+
+		#endif
+
+			return LEVEL_SSE2;
+
+		#else
+
+			return LEVEL_NONE;
+
+		#endif
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("", on)
+		#endif
+	}
+}
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef NST_SIMD_H
+#define NST_SIMD_H
+
+#ifdef NST_PRAGMA_ONCE
+#pragma once
+#endif
+
+#ifdef NST_MM_INTRINSICS
+
+ #define NST_SSE2
+ #include <emmintrin.h>
+
+ #if NST_MSVC >= 1700
+  #define NST_AVX2
+  #define NST_AVX2_TARGET
+ #elif NST_GCC >= 409
+  #define NST_AVX2
+  #define NST_AVX2_TARGET __attribute__((target("avx2")))
+ #endif
+
+ #ifdef NST_AVX2
+ #include <immintrin.h>
+ #endif
+
+#endif
+
+namespace Nes
+{
+	namespace Core
+	{
+		// Instruction sets usable on the host CPU. A code path needs both the
+		// compiler support (NST_SSE2, NST_AVX2) and the matching runtime level.
+		// AVX2 functions are marked NST_AVX2_TARGET so that the rest of the core
+		// can still be built for plain x86. The level can be lowered to compare
+		// the code paths; filters pick theirs when they're created.
+
+		class Simd
+		{
+		public:
+
+			enum Level
+			{
+				LEVEL_NONE,
+				LEVEL_SSE2,
+				LEVEL_AVX2
+			};
+
+			static Level GetLevel()
+			{
+				return level;
+			}
+
+			static Level GetSupportedLevel()
+			{
+				return supported;
+			}
+
+			static Level SetLevel(Level);
+
+		private:
+
+			static Level Detect();
+
+			static const Level supported;
+			static Level level;
+		};
+	}
+}
+
+#endif
@@ -25,6 +25,9 @@
 #include <algorithm>
 #include "NstCpu.hpp"
 #include "NstSoundRenderer.hpp"
+//[SLBEGIN]: Block sound output.
+#include "NstSimd.hpp"
+//[SLEND]
 
 namespace Nes
 {
@@ -61,6 +64,118 @@ namespace Nes
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("", on)
 			#endif
+
+			//[SLBEGIN]: Block sound output.
+
+			// The left channel of the pseudo stereo output is the right one delayed by
+			// History::SIZE samples. Past the first History::SIZE samples of a block it
+			// comes from the block itself, and the history only needs its last samples.
+
+			iword* NST_FASTCALL Buffer::Convert(iword* NST_RESTRICT dst,const iword* NST_RESTRICT src,const uint length,History& history)
+			{
+				const uint head = NST_MIN(length,uint(History::SIZE));
+				uint i = 0;
+
+				for (; i < head; ++i)
+				{
+					dst[i*2+0] = history.buffer[(history.pos + i) & History::MASK];
+					dst[i*2+1] = src[i];
+				}
+
+			#ifdef NST_SSE2
+				if (Simd::GetLevel() >= Simd::LEVEL_SSE2)
+				{
+					for (; i + 8 <= length; i += 8)
+					{
+						const __m128i left = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src + i - History::SIZE) );
+						const __m128i right = _mm_loadu_si128( reinterpret_cast<const __m128i*>(src + i) );
+
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(dst + i*2 + 0), _mm_unpacklo_epi16( left, right ) );
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(dst + i*2 + 8), _mm_unpackhi_epi16( left, right ) );
+					}
+				}
+			#endif
+
+				for (; i < length; ++i)
+				{
+					dst[i*2+0] = src[i - History::SIZE];
+					dst[i*2+1] = src[i];
+				}
+
+				for (i=length-head; i < length; ++i)
+					history.buffer[(history.pos + i) & History::MASK] = src[i];
+
+				history.pos += length;
+
+				return dst + length * 2;
+			}
+
+			byte* NST_FASTCALL Buffer::Convert(byte* NST_RESTRICT dst,const iword* NST_RESTRICT src,const uint length)
+			{
+				uint i = 0;
+
+			#ifdef NST_SSE2
+				if (Simd::GetLevel() >= Simd::LEVEL_SSE2)
+				{
+					const __m128i bias = _mm_set1_epi16( -0x8000 );
+
+					for (; i + 16 <= length; i += 16)
+					{
+						const __m128i lo = _mm_srli_epi16( _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>(src + i + 0) ), bias ), 8 );
+						const __m128i hi = _mm_srli_epi16( _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>(src + i + 8) ), bias ), 8 );
+
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16( lo, hi ) );
+					}
+				}
+			#endif
+
+				for (; i < length; ++i)
+					dst[i] = dword(src[i] + 32768L) >> 8;
+
+				return dst + length;
+			}
+
+			byte* NST_FASTCALL Buffer::Convert(byte* NST_RESTRICT dst,const iword* NST_RESTRICT src,const uint length,History& history)
+			{
+				const uint head = NST_MIN(length,uint(History::SIZE));
+				uint i = 0;
+
+				for (; i < head; ++i)
+				{
+					dst[i*2+0] = history.buffer[(history.pos + i) & History::MASK];
+					dst[i*2+1] = dword(src[i] + 32768L) >> 8;
+				}
+
+			#ifdef NST_SSE2
+				if (Simd::GetLevel() >= Simd::LEVEL_SSE2)
+				{
+					const __m128i bias = _mm_set1_epi16( -0x8000 );
+
+					for (; i + 8 <= length; i += 8)
+					{
+						const __m128i left = _mm_srli_epi16( _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>(src + i - History::SIZE) ), bias ), 8 );
+						const __m128i right = _mm_srli_epi16( _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>(src + i) ), bias ), 8 );
+
+						_mm_storeu_si128( reinterpret_cast<__m128i*>(dst + i*2), _mm_or_si128( left, _mm_slli_epi16( right, 8 ) ) );
+					}
+				}
+			#endif
+
+				for (; i < length; ++i)
+				{
+					dst[i*2+0] = dword(src[i - History::SIZE] + 32768L) >> 8;
+					dst[i*2+1] = dword(src[i] + 32768L) >> 8;
+				}
+
+				for (i=length-head; i < length; ++i)
+					history.buffer[(history.pos + i) & History::MASK] = dword(src[i] + 32768L) >> 8;
+
+				history.pos += length;
+
+				return dst + length * 2;
+			}
+
+			//[SLEND]
 		}
 	}
 }
@@ -61,6 +61,9 @@ namespace Nes
 
 				void Reset(uint,bool=true);
 				void operator >> (Block&);
+				//[SLBEGIN]: Block sound output.
+				inline void operator << (const Block&);
+				//[SLEND]
 
 				template<typename,uint>
 				class Renderer;
@@ -99,6 +102,12 @@ namespace Nes
 					iword buffer[SIZE];
 				};
 
+				//[SLBEGIN]: Block sound output.
+				static iword* NST_FASTCALL Convert(iword* NST_RESTRICT,const iword* NST_RESTRICT,uint,History&);
+				static byte* NST_FASTCALL Convert(byte* NST_RESTRICT,const iword* NST_RESTRICT,uint);
+				static byte* NST_FASTCALL Convert(byte* NST_RESTRICT,const iword* NST_RESTRICT,uint,History&);
+				//[SLEND]
+
 				uint pos;
 				uint start;
 				iword* const NST_RESTRICT output;
@@ -83,6 +83,20 @@ namespace Nes
 				output[p] = sample;
 			}
 
+			//[SLBEGIN]: Block sound output.
+			inline void Buffer::operator << (const Block& block)
+			{
+				NST_ASSERT( block.length <= SIZE && block.start + block.length <= SIZE );
+
+				const uint chunk = NST_MIN(block.length,SIZE - pos);
+
+				std::memcpy( output + pos, block.data + block.start, sizeof(iword) * chunk );
+				std::memcpy( output, block.data + block.start + chunk, sizeof(iword) * (block.length - chunk) );
+
+				pos = (pos + block.length) & MASK;
+			}
+			//[SLEND]
+
 			inline Buffer::Renderer<iword,0U>::Renderer(void* samples,uint length,const History&)
 			: BaseRenderer<iword>(samples,length) {}
 
@@ -129,10 +143,17 @@ namespace Nes
 			{
 				NST_ASSERT( end - dst >= block.length );
 
-				block.length += block.start;
+				//[SLBEGIN]: Block sound output.
+				if (block.length)
+				{
+					const uint chunk = NST_MIN(block.length,SIZE - block.start);
+
+					dst = Convert( dst, block.data + block.start, chunk, history );
 
-				for (uint i=block.start; i < block.length; ++i)
-					(*this) << Sample( block.data[i & MASK] );
+					if (chunk < block.length)
+						dst = Convert( dst, block.data, block.length - chunk, history );
+				}
+				//[SLEND]
 
 				return dst != end;
 			}
@@ -149,10 +170,17 @@ namespace Nes
 			{
 				NST_ASSERT( end - dst >= block.length );
 
-				block.length += block.start;
+				//[SLBEGIN]: Block sound output.
+				if (block.length)
+				{
+					const uint chunk = NST_MIN(block.length,SIZE - block.start);
 
-				for (uint i=block.start; i < block.length; ++i)
-					(*this) << Sample( block.data[i & MASK] );
+					dst = Convert( dst, block.data + block.start, chunk );
+
+					if (chunk < block.length)
+						dst = Convert( dst, block.data, block.length - chunk );
+				}
+				//[SLEND]
 
 				return dst != end;
 			}
@@ -173,10 +201,17 @@ namespace Nes
 			{
 				NST_ASSERT( end - dst >= block.length );
 
-				block.length += block.start;
+				//[SLBEGIN]: Block sound output.
+				if (block.length)
+				{
+					const uint chunk = NST_MIN(block.length,SIZE - block.start);
 
-				for (uint i=block.start; i < block.length; ++i)
-					(*this) << Sample( block.data[i & MASK] );
+					dst = Convert( dst, block.data + block.start, chunk, history );
+
+					if (chunk < block.length)
+						dst = Convert( dst, block.data, block.length - chunk, history );
+				}
+				//[SLEND]
 
 				return dst != end;
 			}
@@ -34,15 +34,21 @@ namespace Nes
 			enum Compression
 			{
 				NO_COMPRESSION,
-				ZLIB_COMPRESSION
+				ZLIB_COMPRESSION,
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				//Page bitmap followed by the contents of each dirty page.
+				DIRTY_PAGES
+				//[SLEND]
 			};
 
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("s", on)
 			#endif
 
-			Saver::Saver(StdStream p,bool c,bool i,dword append)
-			: stream(p), chunks(CHUNK_RESERVE), useCompression(c), internal(i)
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			Saver::Saver(StdStream p,bool c,bool i,dword append,bool n)
+			: stream(p), chunks(CHUNK_RESERVE), useCompression(c), internal(i), incremental(n)
+			//[SLEND]
 			{
 				NST_COMPILE_ASSERT( CHUNK_RESERVE >= 2 );
 
@@ -148,6 +154,37 @@ namespace Nes
 				return *this;
 			}
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			Saver& Saver::Compress(const byte* const data,const dword length,const DirtyPages& dirty)
+			{
+				if (!incremental || !dirty.Covers( data, length ))
+					return Compress( data, length );
+
+				const dword numPages = dirty.NumPages();
+				byte bitmap[DirtyPages::MAX_PAGES / 8] = {0};
+
+				for (dword i=0; i < numPages; ++i)
+				{
+					if (dirty.Test( i ))
+						bitmap[i >> 3] |= 1U << (i & 0x7);
+				}
+
+				Write8( DIRTY_PAGES );
+				Write( bitmap, (numPages + 7) >> 3 );
+
+				for (dword i=0; i < numPages; ++i)
+				{
+					if (dirty.Test( i ))
+					{
+						const dword offset = i << DirtyPages::PAGE_SHIFT;
+						Write( data + offset, NST_MIN(dword(DirtyPages::PAGE_SIZE),length - offset) );
+					}
+				}
+
+				return *this;
+			}
+			//[SLEND]
+
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("s", on)
 			#endif
@@ -277,6 +314,33 @@ namespace Nes
 								break;
 						}
 
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					//Pages that are not listed keep their current contents, so this only
+					//restores the right state on top of the snapshot it was taken from.
+					case DIRTY_PAGES:
+					{
+						const dword numPages = (length + (DirtyPages::PAGE_SIZE-1)) >> DirtyPages::PAGE_SHIFT;
+
+						if (numPages > DirtyPages::MAX_PAGES)
+							throw RESULT_ERR_CORRUPT_FILE;
+
+						byte bitmap[DirtyPages::MAX_PAGES / 8];
+						Read( bitmap, (numPages + 7) >> 3 );
+
+						for (dword i=0; i < numPages; ++i)
+						{
+							if (bitmap[i >> 3] & (1U << (i & 0x7)))
+							{
+								const dword offset = i << DirtyPages::PAGE_SHIFT;
+								Read( data + offset, NST_MIN(dword(DirtyPages::PAGE_SIZE),length - offset) );
+							}
+						}
+						break;
+					}
+					//[SLEND]
+
 					default:
 
 						throw RESULT_ERR_CORRUPT_FILE;
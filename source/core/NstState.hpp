@@ -30,6 +30,9 @@
 #endif
 
 #include "NstStream.hpp"
+//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+#include "NstDirtyPages.hpp"
+//[SLEND]
 
 #ifdef NST_PRAGMA_ONCE
 #pragma once
@@ -45,7 +48,9 @@ namespace Nes
 			{
 			public:
 
-				Saver(StdStream,bool,bool,dword=0);
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				Saver(StdStream,bool,bool,dword=0,bool=false);
+				//[SLEND]
 				~Saver();
 
 				Saver& Begin(dword);
@@ -55,6 +60,9 @@ namespace Nes
 				Saver& Write64(qword);
 				Saver& Write(const byte*,dword);
 				Saver& Compress(const byte*,dword);
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				Saver& Compress(const byte*,dword,const DirtyPages&);
+				//[SLEND]
 				Saver& End();
 
 			protected:
@@ -71,6 +79,9 @@ namespace Nes
 				Vector<dword> chunks;
 				const bool useCompression;
 				const bool internal;
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				const bool incremental;
+				//[SLEND]
 
 			public:
 
@@ -88,6 +99,20 @@ namespace Nes
 					return Compress( data, N );
 				}
 
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				template<dword N>
+				Saver& Compress(const byte (&data)[N],const DirtyPages& dirty)
+				{
+					NST_COMPILE_ASSERT( N > 0 );
+					return Compress( data, N, dirty );
+				}
+
+				bool Incremental() const
+				{
+					return incremental;
+				}
+				//[SLEND]
+
 				bool Internal() const
 				{
 					return internal;
@@ -0,0 +1,694 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <new>
+#include "NstCore.hpp"
+#include "NstAssert.hpp"
+#include "NstThreadPool.hpp"
+
+#ifndef NST_NO_THREADS
+ #ifdef NST_WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+ #else
+  #include <pthread.h>
+  #include <unistd.h>
+ #endif
+#endif
+
+namespace Nes
+{
+	namespace Core
+	{
+		class ThreadPool::Workers
+		{
+		public:
+
+			Workers();
+			~Workers();
+
+			bool Start(uint);
+			void Run(Job,void*);
+
+		#ifndef NST_NO_THREADS
+
+		private:
+
+			struct Context
+			{
+				Workers* workers;
+				uint index;
+
+			#ifdef NST_WIN32
+				HANDLE thread;
+				HANDLE start;
+			#else
+				pthread_t thread;
+			#endif
+			};
+
+		#ifdef NST_WIN32
+			static DWORD WINAPI Main(LPVOID);
+		#else
+			static void* Main(void*);
+		#endif
+
+			Job job;
+			void* data;
+			uint count;
+			bool quit;
+
+		#ifdef NST_WIN32
+			HANDLE done;
+			volatile LONG pending;
+		#else
+			pthread_mutex_t mutex;
+			pthread_cond_t wake;
+			pthread_cond_t done;
+			uint pending;
+			dword generation;
+		#endif
+
+			Context contexts[MAX_THREADS-1];
+
+		#endif
+		};
+
+	#ifndef NST_NO_THREADS
+	#ifdef NST_WIN32
+
+		void ThreadPool::Workers::Run(const Job j,void* const d)
+		{
+			job = j;
+			data = d;
+			pending = count;
+
+			for (uint i=0; i < count; ++i)
+				::SetEvent( contexts[i].start );
+
+			job( data, 0, count+1 );
+
+			::WaitForSingleObject( done, INFINITE );
+		}
+
+		DWORD WINAPI ThreadPool::Workers::Main(LPVOID param)
+		{
+			const Context& context = *static_cast<const Context*>(param);
+			Workers& workers = *context.workers;
+
+			for (;;)
+			{
+				::WaitForSingleObject( context.start, INFINITE );
+
+				if (workers.quit)
+					break;
+
+				workers.job( workers.data, context.index, workers.count+1 );
+
+				if (!::InterlockedDecrement( &workers.pending ))
+					::SetEvent( workers.done );
+			}
+
+			return 0;
+		}
+
+	#else
+
+		void ThreadPool::Workers::Run(const Job j,void* const d)
+		{
+			::pthread_mutex_lock( &mutex );
+
+			job = j;
+			data = d;
+			pending = count;
+			++generation;
+
+			::pthread_cond_broadcast( &wake );
+			::pthread_mutex_unlock( &mutex );
+
+			job( data, 0, count+1 );
+
+			::pthread_mutex_lock( &mutex );
+
+			while (pending)
+				::pthread_cond_wait( &done, &mutex );
+
+			::pthread_mutex_unlock( &mutex );
+		}
+
+		void* ThreadPool::Workers::Main(void* param)
+		{
+			const Context& context = *static_cast<const Context*>(param);
+			Workers& workers = *context.workers;
+
+			::pthread_mutex_lock( &workers.mutex );
+
+			for (dword generation=0;;)
+			{
+				while (!workers.quit && workers.generation == generation)
+					::pthread_cond_wait( &workers.wake, &workers.mutex );
+
+				if (workers.quit)
+					break;
+
+				generation = workers.generation;
+				::pthread_mutex_unlock( &workers.mutex );
+
+				workers.job( workers.data, context.index, workers.count+1 );
+
+				::pthread_mutex_lock( &workers.mutex );
+
+				if (!--workers.pending)
+					::pthread_cond_signal( &workers.done );
+			}
+
+			::pthread_mutex_unlock( &workers.mutex );
+
+			return NULL;
+		}
+
+	#endif
+	#else
+
+		void ThreadPool::Workers::Run(Job,void*)
+		{
+			NST_UNREACHABLE();
+		}
+
+	#endif
+
+		void ThreadPool::Run(const Job job,void* const data) const
+		{
+			if (workers)
+				workers->Run( job, data );
+			else
+				job( data, 0, 1 );
+		}
+
+		class ThreadQueue::Thread
+		{
+		public:
+
+			Thread();
+			~Thread();
+
+			bool Start();
+			void Post(Job,void*);
+			void Wait(uint);
+
+		#ifndef NST_NO_THREADS
+
+		private:
+
+			void Loop();
+
+		#ifdef NST_WIN32
+
+			static DWORD WINAPI Main(LPVOID);
+
+			void Lock()                        { ::EnterCriticalSection( &mutex );                   }
+			void Unlock()                      { ::LeaveCriticalSection( &mutex );                   }
+			void Block(CONDITION_VARIABLE& c)  { ::SleepConditionVariableCS( &c, &mutex, INFINITE ); }
+			void Signal(CONDITION_VARIABLE& c) { ::WakeAllConditionVariable( &c );                   }
+
+			CRITICAL_SECTION mutex;
+			CONDITION_VARIABLE wake;
+			CONDITION_VARIABLE done;
+			HANDLE handle;
+
+		#else
+
+			static void* Main(void*);
+
+			void Lock()                    { ::pthread_mutex_lock( &mutex );    }
+			void Unlock()                  { ::pthread_mutex_unlock( &mutex );  }
+			void Block(pthread_cond_t& c)  { ::pthread_cond_wait( &c, &mutex ); }
+			void Signal(pthread_cond_t& c) { ::pthread_cond_broadcast( &c );    }
+
+			pthread_mutex_t mutex;
+			pthread_cond_t wake;
+			pthread_cond_t done;
+			pthread_t handle;
+
+		#endif
+
+			struct Entry
+			{
+				Job job;
+				void* data;
+			};
+
+			uint first;
+			uint pending;
+			bool running;
+			bool quit;
+			Entry entries[MAX_JOBS];
+
+		#endif
+		};
+
+	#ifndef NST_NO_THREADS
+
+		void ThreadQueue::Thread::Post(const Job job,void* const data)
+		{
+			Lock();
+
+			while (pending == MAX_JOBS)
+				Block( done );
+
+			Entry& entry = entries[(first + pending) % MAX_JOBS];
+
+			entry.job = job;
+			entry.data = data;
+			++pending;
+
+			Signal( wake );
+			Unlock();
+		}
+
+		void ThreadQueue::Thread::Wait(const uint count)
+		{
+			Lock();
+
+			while (pending > count)
+				Block( done );
+
+			Unlock();
+		}
+
+		void ThreadQueue::Thread::Loop()
+		{
+			Lock();
+
+			for (;;)
+			{
+				while (!pending && !quit)
+					Block( wake );
+
+				if (!pending)
+					break;
+
+				const Entry entry( entries[first] );
+
+				Unlock();
+				entry.job( entry.data );
+				Lock();
+
+				first = (first + 1) % MAX_JOBS;
+				--pending;
+
+				Signal( done );
+			}
+
+			Unlock();
+		}
+
+	#ifdef NST_WIN32
+
+		DWORD WINAPI ThreadQueue::Thread::Main(LPVOID param)
+		{
+			static_cast<Thread*>(param)->Loop();
+			return 0;
+		}
+
+	#else
+
+		void* ThreadQueue::Thread::Main(void* param)
+		{
+			static_cast<Thread*>(param)->Loop();
+			return NULL;
+		}
+
+	#endif
+	#else
+
+		void ThreadQueue::Thread::Post(Job,void*)
+		{
+			NST_UNREACHABLE();
+		}
+
+		void ThreadQueue::Thread::Wait(uint)
+		{
+		}
+
+	#endif
+
+		void ThreadQueue::Post(const Job job,void* const data)
+		{
+			if (thread)
+				thread->Post( job, data );
+			else
+				job( data );
+		}
+
+		void ThreadQueue::Wait(const uint count) const
+		{
+			if (thread)
+				thread->Wait( count );
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("s", on)
+		#endif
+
+	#ifndef NST_NO_THREADS
+	#ifdef NST_WIN32
+
+		ThreadPool::Workers::Workers()
+		:
+		job     (NULL),
+		data    (NULL),
+		count   (0),
+		quit    (false),
+		done    (::CreateEvent( NULL, FALSE, FALSE, NULL )),
+		pending (0)
+		{
+		}
+
+		ThreadPool::Workers::~Workers()
+		{
+			quit = true;
+
+			for (uint i=0; i < count; ++i)
+				::SetEvent( contexts[i].start );
+
+			for (uint i=0; i < count; ++i)
+			{
+				::WaitForSingleObject( contexts[i].thread, INFINITE );
+				::CloseHandle( contexts[i].thread );
+				::CloseHandle( contexts[i].start );
+			}
+
+			if (done)
+				::CloseHandle( done );
+		}
+
+		bool ThreadPool::Workers::Start(const uint n)
+		{
+			NST_ASSERT( !count && n < MAX_THREADS );
+
+			if (!done)
+				return false;
+
+			for (; count < n; ++count)
+			{
+				Context& context = contexts[count];
+
+				context.workers = this;
+				context.index = count + 1;
+				context.start = ::CreateEvent( NULL, FALSE, FALSE, NULL );
+
+				if (!context.start)
+					break;
+
+				context.thread = ::CreateThread( NULL, 0, Main, &context, 0, NULL );
+
+				if (!context.thread)
+				{
+					::CloseHandle( context.start );
+					break;
+				}
+			}
+
+			return count == n;
+		}
+
+	#else
+
+		ThreadPool::Workers::Workers()
+		:
+		job        (NULL),
+		data       (NULL),
+		count      (0),
+		quit       (false),
+		pending    (0),
+		generation (0)
+		{
+			::pthread_mutex_init( &mutex, NULL );
+			::pthread_cond_init( &wake, NULL );
+			::pthread_cond_init( &done, NULL );
+		}
+
+		ThreadPool::Workers::~Workers()
+		{
+			::pthread_mutex_lock( &mutex );
+			quit = true;
+			::pthread_cond_broadcast( &wake );
+			::pthread_mutex_unlock( &mutex );
+
+			for (uint i=0; i < count; ++i)
+				::pthread_join( contexts[i].thread, NULL );
+
+			::pthread_cond_destroy( &done );
+			::pthread_cond_destroy( &wake );
+			::pthread_mutex_destroy( &mutex );
+		}
+
+		bool ThreadPool::Workers::Start(const uint n)
+		{
+			NST_ASSERT( !count && n < MAX_THREADS );
+
+			for (; count < n; ++count)
+			{
+				Context& context = contexts[count];
+
+				context.workers = this;
+				context.index = count + 1;
+
+				if (::pthread_create( &context.thread, NULL, Main, &context ))
+					break;
+			}
+
+			return count == n;
+		}
+
+	#endif
+	#else
+
+		ThreadPool::Workers::Workers()
+		{
+		}
+
+		ThreadPool::Workers::~Workers()
+		{
+		}
+
+		bool ThreadPool::Workers::Start(uint)
+		{
+			return false;
+		}
+
+	#endif
+
+		ThreadPool::ThreadPool()
+		:
+		workers (NULL),
+		threads (1)
+		{
+		}
+
+		ThreadPool::~ThreadPool()
+		{
+			delete workers;
+		}
+
+		Result ThreadPool::SetThreads(const uint n)
+		{
+			if (!n || n > MAX_THREADS)
+				return RESULT_ERR_INVALID_PARAM;
+
+			if (threads == n)
+				return RESULT_NOP;
+
+			delete workers;
+			workers = NULL;
+			threads = 1;
+
+			if (n > 1)
+			{
+				workers = new (std::nothrow) Workers;
+
+				if (!workers)
+					return RESULT_ERR_OUT_OF_MEMORY;
+
+				if (!workers->Start( n-1 ))
+				{
+					delete workers;
+					workers = NULL;
+
+					return RESULT_ERR_UNSUPPORTED;
+				}
+
+				threads = n;
+			}
+
+			return RESULT_OK;
+		}
+
+	#ifndef NST_NO_THREADS
+
+		ThreadQueue::Thread::Thread()
+		:
+		first   (0),
+		pending (0),
+		running (false),
+		quit    (false)
+		{
+		#ifdef NST_WIN32
+			::InitializeCriticalSection( &mutex );
+			::InitializeConditionVariable( &wake );
+			::InitializeConditionVariable( &done );
+		#else
+			::pthread_mutex_init( &mutex, NULL );
+			::pthread_cond_init( &wake, NULL );
+			::pthread_cond_init( &done, NULL );
+		#endif
+		}
+
+		ThreadQueue::Thread::~Thread()
+		{
+			if (running)
+			{
+				Lock();
+				quit = true;
+				Signal( wake );
+				Unlock();
+
+			#ifdef NST_WIN32
+				::WaitForSingleObject( handle, INFINITE );
+				::CloseHandle( handle );
+			#else
+				::pthread_join( handle, NULL );
+			#endif
+			}
+
+		#ifdef NST_WIN32
+			::DeleteCriticalSection( &mutex );
+		#else
+			::pthread_cond_destroy( &done );
+			::pthread_cond_destroy( &wake );
+			::pthread_mutex_destroy( &mutex );
+		#endif
+		}
+
+		bool ThreadQueue::Thread::Start()
+		{
+			NST_ASSERT( !running );
+
+		#ifdef NST_WIN32
+			handle = ::CreateThread( NULL, 0, Main, this, 0, NULL );
+			running = (handle != NULL);
+		#else
+			running = !::pthread_create( &handle, NULL, Main, this );
+		#endif
+
+			return running;
+		}
+
+	#else
+
+		ThreadQueue::Thread::Thread()
+		{
+		}
+
+		ThreadQueue::Thread::~Thread()
+		{
+		}
+
+		bool ThreadQueue::Thread::Start()
+		{
+			return false;
+		}
+
+	#endif
+
+		ThreadQueue::ThreadQueue()
+		: thread(NULL)
+		{
+		}
+
+		ThreadQueue::~ThreadQueue()
+		{
+			Stop();
+		}
+
+		Result ThreadQueue::Start()
+		{
+			if (thread)
+				return RESULT_NOP;
+
+			thread = new (std::nothrow) Thread;
+
+			if (!thread)
+				return RESULT_ERR_OUT_OF_MEMORY;
+
+			if (!thread->Start())
+			{
+				delete thread;
+				thread = NULL;
+
+				return RESULT_ERR_UNSUPPORTED;
+			}
+
+			return RESULT_OK;
+		}
+
+		void ThreadQueue::Stop()
+		{
+			// pending jobs still run before the thread exits
+
+			delete thread;
+			thread = NULL;
+		}
+
+		uint ThreadPool::NumProcessors()
+		{
+		#if defined(NST_NO_THREADS)
+
+			return 1;
+
+		#elif defined(NST_WIN32)
+
+			SYSTEM_INFO info;
+			::GetSystemInfo( &info );
+
+			return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+
+		#else
+
+			const long n = ::sysconf( _SC_NPROCESSORS_ONLN );
+
+			return n > 0 ? n : 1;
+
+		#endif
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("", on)
+		#endif
+	}
+}
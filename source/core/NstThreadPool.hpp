@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef NST_THREADPOOL_H
+#define NST_THREADPOOL_H
+
+#ifdef NST_PRAGMA_ONCE
+#pragma once
+#endif
+
+namespace Nes
+{
+	namespace Core
+	{
+		// Fixed set of worker threads running one job split in equal parts.
+		// The calling thread always takes part 0 and Run() returns once every
+		// part is done. With a single thread, or if the platform has no thread
+		// support (NST_NO_THREADS), the job simply runs on the calling thread.
+
+		class ThreadPool
+		{
+		public:
+
+			ThreadPool();
+			~ThreadPool();
+
+			enum
+			{
+				MAX_THREADS = 16
+			};
+
+			typedef void (*Job)(void*,uint,uint);
+
+			Result SetThreads(uint);
+			void Run(Job,void*) const;
+
+			static uint NumProcessors();
+
+		private:
+
+			class Workers;
+
+			Workers* workers;
+			uint threads;
+
+		public:
+
+			uint NumThreads() const
+			{
+				return threads;
+			}
+		};
+
+		// Single background thread running posted jobs in order. Post() blocks
+		// while MAX_JOBS are still pending and Wait() returns once no more than
+		// the given number are. Without thread support Start() fails.
+
+		class ThreadQueue
+		{
+		public:
+
+			ThreadQueue();
+			~ThreadQueue();
+
+			enum
+			{
+				MAX_JOBS = 4
+			};
+
+			typedef void (*Job)(void*);
+
+			Result Start();
+			void Stop();
+			void Post(Job,void*);
+			void Wait(uint=0) const;
+
+		private:
+
+			class Thread;
+
+			Thread* thread;
+
+		public:
+
+			bool IsRunning() const
+			{
+				return thread;
+			}
+		};
+	}
+}
+
+#endif
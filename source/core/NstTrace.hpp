@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NST_TRACE_H
+#define NST_TRACE_H
+
+#ifdef NST_PRAGMA_ONCE
+#pragma once
+#endif
+
+#include "api/NstApi.hpp"
+#include "NstCore.hpp"
+
+#ifdef NST_TRACE
+#define NST_TRACE_SCOPE_CONCAT_(a_,b_) a_##b_
+#define NST_TRACE_SCOPE_NAME_(line_) NST_TRACE_SCOPE_CONCAT_(traceScope,line_)
+#define NST_TRACE_SCOPE(name_) const Nes::Core::Trace::Scope NST_TRACE_SCOPE_NAME_(__LINE__)( name_ )
+#else
+#define NST_TRACE_SCOPE(name_)
+#endif
+
+namespace Nes
+{
+	namespace Core
+	{
+		// Hooks for timing hot paths of the core. The front-end supplies the
+		// clock and the recorder, so the core itself keeps no trace buffers.
+		// Without NST_TRACE the scopes compile to nothing.
+
+		class Trace
+		{
+		public:
+
+			typedef qword (NST_CALLBACK *BeginCallback)();
+			typedef void (NST_CALLBACK *EndCallback)(cstring,qword);
+
+			static void SetCallbacks(BeginCallback,EndCallback);
+
+			class Scope
+			{
+				const cstring name;
+				const qword start;
+
+				Scope(const Scope&);
+				void operator = (const Scope&);
+
+			public:
+
+				explicit Scope(cstring n)
+				: name(n), start(begin ? begin() : 0) {}
+
+				~Scope()
+				{
+					if (end)
+						end( name, start );
+				}
+			};
+
+		private:
+
+			static BeginCallback begin;
+			static EndCallback end;
+		};
+	}
+}
+
+#endif
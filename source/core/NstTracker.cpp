@@ -43,7 +43,13 @@ namespace Nes
 		rewinderSound   (false),
 		rewinderEnabled (NULL),
 		rewinder        (NULL),
-		movie           (NULL)
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+		movie           (NULL),
+		rewinderKeys    (Rewinder::DEFAULT_KEYS),
+		//[SLEND]
+		//[SLBEGIN]: Multi-resolution rewind history.
+		rewinderHistory (History::DEFAULT_BUDGET)
+		//[SLEND]
 		{}
 
 		Tracker::~Tracker()
@@ -128,6 +134,31 @@ namespace Nes
 				rewinder->Reset();
 		}
 
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+		void Tracker::SetRewinderKeys(uint keys)
+		{
+			keys = NST_MIN(NST_MAX(keys,uint(Rewinder::MIN_KEYS)),uint(Rewinder::MAX_KEYS));
+
+			if (rewinderKeys != keys)
+			{
+				rewinderKeys = keys;
+
+				if (rewinder)
+					rewinder->SetNumKeys( keys );
+			}
+		}
+		//[SLEND]
+
+		//[SLBEGIN]: Multi-resolution rewind history.
+		void Tracker::SetRewinderHistory(dword bytes)
+		{
+			rewinderHistory = NST_MIN(NST_MAX(bytes,dword(History::MIN_BUDGET)),dword(History::MAX_BUDGET));
+
+			if (rewinder)
+				rewinder->SetHistoryBudget( rewinderHistory );
+		}
+		//[SLEND]
+
 		void Tracker::UpdateRewinderState(bool enable)
 		{
 			if (enable && rewinderEnabled && !movie)
@@ -143,8 +174,14 @@ namespace Nes
 						rewinderEnabled->cpu,
 						rewinderEnabled->cpu.GetApu(),
 						rewinderEnabled->ppu,
-						rewinderSound
+						//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+						rewinderSound,
+						rewinderKeys
+						//[SLEND]
 					);
+					//[SLBEGIN]: Multi-resolution rewind history.
+					rewinder->SetHistoryBudget( rewinderHistory );
+					//[SLEND]
 				}
 			}
 			else
@@ -277,6 +314,18 @@ namespace Nes
 			return rewinder && rewinder->IsRewinding();
 		}
 
+		//[SLBEGIN]: Multi-resolution rewind history.
+		Result Tracker::SeekRewinder(dword frames) const
+		{
+			return rewinder ? rewinder->Seek( frames ) : RESULT_ERR_NOT_READY;
+		}
+
+		dword Tracker::GetRewinderHistoryLength() const
+		{
+			return rewinder ? rewinder->GetHistoryLength() : 0;
+		}
+		//[SLEND]
+
 		bool Tracker::IsMoviePlaying() const
 		{
 			return movie && movie->IsPlaying();
@@ -69,6 +69,14 @@ namespace Nes
 			Result EnableRewinder(Machine*);
 			void   EnableRewinderSound(bool);
 			void   ResetRewinder() const;
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			void   SetRewinderKeys(uint);
+			//[SLEND]
+			//[SLBEGIN]: Multi-resolution rewind history.
+			void   SetRewinderHistory(dword);
+			Result SeekRewinder(dword) const;
+			dword  GetRewinderHistoryLength() const;
+			//[SLEND]
 			Result StartRewinding() const;
 			Result StopRewinding() const;
 			bool   IsRewinding() const;
@@ -91,6 +99,12 @@ namespace Nes
 			Machine* rewinderEnabled;
 			Rewinder* rewinder;
 			Movie* movie;
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			uint rewinderKeys;
+			//[SLEND]
+			//[SLBEGIN]: Multi-resolution rewind history.
+			dword rewinderHistory;
+			//[SLEND]
 
 		public:
 
@@ -104,6 +118,20 @@ namespace Nes
 				return rewinderSound;
 			}
 
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			uint GetRewinderKeys() const
+			{
+				return rewinderKeys;
+			}
+			//[SLEND]
+
+			//[SLBEGIN]: Multi-resolution rewind history.
+			dword GetRewinderHistory() const
+			{
+				return rewinderHistory;
+			}
+			//[SLEND]
+
 			bool IsFrameLocked() const
 			{
 				return movie;
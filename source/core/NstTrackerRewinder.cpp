@@ -30,7 +30,6 @@
 #include "NstState.hpp"
 #include "NstTrackerRewinder.hpp"
 #include "api/NstApiRewinder.hpp"
-#include "NstZlib.hpp"
 
 namespace Nes
 {
@@ -145,9 +144,14 @@ namespace Nes
 		apu     (a)
 		{}
 
-		Tracker::Rewinder::Rewinder(Machine& e,EmuExecute x,EmuLoadState l,EmuSaveState s,Cpu& c,const Apu& a,Ppu& p,bool b)
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+		Tracker::Rewinder::Rewinder(Machine& e,EmuExecute x,EmuLoadState l,EmuSaveState s,Cpu& c,const Apu& a,Ppu& p,bool b,uint n)
 		:
 		rewinding    (false),
+		keys         (NULL),
+		numKeys      (0),
+		imageKey     (NULL),
+		replay       (0),
 		sound        (a,b),
 		video        (p),
 		emulator     (e),
@@ -157,8 +161,9 @@ namespace Nes
 		cpu          (c),
 		ppu          (p)
 		{
-			Reset( true );
+			SetNumKeys( n );
 		}
+		//[SLEND]
 
 		Tracker::Rewinder::ReverseVideo::~ReverseVideo()
 		{
@@ -173,7 +178,35 @@ namespace Nes
 		Tracker::Rewinder::~Rewinder()
 		{
 			LinkPorts( false );
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			delete [] keys;
+			//[SLEND]
+		}
+
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+		void Tracker::Rewinder::SetNumKeys(uint n)
+		{
+			n = NST_MIN(NST_MAX(n,uint(MIN_KEYS)),uint(MAX_KEYS));
+
+			if (numKeys != n)
+			{
+				Key* const next = new Key [n];
+
+				delete [] keys;
+				keys = next;
+				numKeys = n;
+			}
+
+			Reset( true );
+		}
+		//[SLEND]
+
+		//[SLBEGIN]: Multi-resolution rewind history.
+		void Tracker::Rewinder::SetHistoryBudget(dword bytes)
+		{
+			history.SetBudget( bytes );
 		}
+		//[SLEND]
 
 		void Tracker::Rewinder::LinkPorts(bool on)
 		{
@@ -181,6 +214,9 @@ namespace Nes
 			{
 				cpu.Unlink( 0x4016+i, this, &Rewinder::Peek_Port_Get, &Rewinder::Poke_Port );
 				cpu.Unlink( 0x4016+i, this, &Rewinder::Peek_Port_Put, &Rewinder::Poke_Port );
+				//[SLBEGIN]: Multi-resolution rewind history.
+				cpu.Unlink( 0x4016+i, this, &Rewinder::Peek_Port_Replay, &Rewinder::Poke_Port );
+				//[SLEND]
 			}
 
 			if (on)
@@ -190,26 +226,62 @@ namespace Nes
 			}
 		}
 
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
 		Tracker::Rewinder::Key::Key()
+		: type(EMPTY), depth(0), start(0)
 		{
+			input.Reset( false );
 		}
 
 		Tracker::Rewinder::Key::~Key()
 		{
 		}
 
-		void Tracker::Rewinder::Key::Input::Reset()
+		void Tracker::Rewinder::Key::Input::Reset(bool keep)
 		{
 			pos = BAD_POS;
-			buffer.Destroy();
+
+			if (keep)
+				buffer.Clear();
+			else
+				buffer.Destroy();
 		}
 
-		void Tracker::Rewinder::Key::Reset()
+		void Tracker::Rewinder::Key::Reset(bool keep)
+		{
+			type = EMPTY;
+			depth = 0;
+
+			if (keep)
+				state.Clear();
+			else
+				state.Destroy();
+
+			input.Reset( keep );
+		}
+
+		Tracker::Rewinder::Snapshot::Snapshot()
+		:
+		imageBuffer (image),
+		nextBuffer  (next),
+		in          (&imageBuffer),
+		out         (&nextBuffer)
 		{
-			stream.str( std::string() );
-			input.Reset();
 		}
 
+		void Tracker::Rewinder::Snapshot::Reset()
+		{
+			image.Clear();
+		}
+
+		Tracker::Rewinder::Snapshot::Buffer::Buffer(Vector<byte>& d)
+		: data(d), written(0)
+		{
+			setp( NULL, NULL );
+			setg( NULL, NULL, NULL );
+		}
+		//[SLEND]
+
 		void Tracker::Rewinder::Reset(bool on)
 		{
 			video.End();
@@ -223,10 +295,19 @@ namespace Nes
 
 			uturn = false;
 			frame = LAST_FRAME;
-			key = keys + LAST_KEY;
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			key = keys + (numKeys-1);
+			imageKey = NULL;
 
-			for (uint i=0; i < NUM_FRAMES; ++i)
-				keys[i].Reset();
+			for (uint i=0; i < numKeys; ++i)
+				keys[i].Reset( on );
+
+			snapshot.Reset();
+			//[SLEND]
+			//[SLBEGIN]: Multi-resolution rewind history.
+			key->start = dword(0) - dword(NUM_FRAMES);
+			history.Clear( on );
+			//[SLEND]
 
 			LinkPorts( on );
 		}
@@ -323,30 +404,13 @@ namespace Nes
 				buffer.Reserve( hint );
 		}
 
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+		//The input is kept uncompressed, so the buffer is reused as is.
 		bool Tracker::Rewinder::Key::Input::EndForward()
 		{
 			if (pos == 0)
 			{
 				pos = buffer.Size();
-
-				if (Zlib::AVAILABLE && pos >= MIN_COMPRESSION_SIZE)
-				{
-					Buffer tmp( pos - 1 );
-
-					if (const dword size = Zlib::Compress( buffer.Begin(), buffer.Size(), tmp.Begin(), tmp.Size(), Zlib::NORMAL_COMPRESSION ))
-					{
-						NST_ASSERT( size < pos );
-						tmp.SetTo( size );
-						Buffer::Swap( tmp, buffer );
-					}
-					else
-					{
-						NST_DEBUG_MSG("compress() in Tracker::Rewinder::Key::Input failed!");
-					}
-
-					buffer.Defrag();
-				}
-
 				return true;
 			}
 
@@ -355,21 +419,9 @@ namespace Nes
 
 		void Tracker::Rewinder::Key::Input::BeginBackward()
 		{
-			dword size = pos;
 			pos = 0;
-
-			if (Zlib::AVAILABLE && size > buffer.Size())
-			{
-				Buffer tmp( size );
-				size = Zlib::Uncompress( buffer.Begin(), buffer.Size(), tmp.Begin(), tmp.Size() );
-
-				if (!size)
-					throw RESULT_ERR_CORRUPT_FILE;
-
-				NST_VERIFY( size == tmp.Size() );
-				Buffer::Swap( tmp, buffer );
-			}
 		}
+		//[SLEND]
 
 		inline void Tracker::Rewinder::Key::Input::EndBackward()
 		{
@@ -428,7 +480,9 @@ namespace Nes
 
 		inline bool Tracker::Rewinder::Key::CanRewind() const
 		{
-			return input.CanRewind();
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			return input.CanRewind() && type != EMPTY;
+			//[SLEND]
 		}
 
 		inline void Tracker::Rewinder::Key::ResumeForward()
@@ -436,51 +490,421 @@ namespace Nes
 			input.ResumeForward();
 		}
 
-		void Tracker::Rewinder::Key::BeginForward(Machine& emulator,EmuSaveState saveState,EmuLoadState loadState)
+		//[SLBEGIN]: Multi-resolution rewind history.
+		inline const Vector<byte>& Tracker::Rewinder::Key::GetInput() const
 		{
-			NST_ASSERT( !saveState || !loadState );
+			return input.Data();
+		}
+		//[SLEND]
 
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+		void Tracker::Rewinder::Key::BeginForward()
+		{
 			input.BeginForward();
+		}
+
+		void Tracker::Rewinder::Key::EndForward()
+		{
+			if (!input.EndForward())
+				Reset();
+		}
+
+		void Tracker::Rewinder::Key::BeginBackward()
+		{
+			NST_VERIFY( CanRewind() );
+
+			input.BeginBackward();
+		}
 
-			if (saveState)
+		void Tracker::Rewinder::Snapshot::Buffer::BeginWrite()
+		{
+			written = 0;
+			data.Clear();
+
+			char* const begin = reinterpret_cast<char*>(data.Begin());
+			setp( begin, begin + data.Capacity() );
+		}
+
+		dword Tracker::Rewinder::Snapshot::Buffer::EndWrite()
+		{
+			written = NST_MAX(written,dword(pptr() - pbase()));
+			data.SetTo( written );
+
+			return written;
+		}
+
+		void Tracker::Rewinder::Snapshot::Buffer::BeginRead()
+		{
+			char* const begin = reinterpret_cast<char*>(data.Begin());
+			setg( begin, begin, begin + data.Size() );
+		}
+
+		Tracker::Rewinder::Snapshot::Buffer::int_type Tracker::Rewinder::Snapshot::Buffer::overflow(int_type c)
+		{
+			const dword pos = pptr() - pbase();
+			written = NST_MAX(written,pos);
+
+			//Grows only until the largest state has been written once.
+			data.Reserve( NST_MAX(data.Capacity() * 2,dword(SIZE_4K)) );
+
+			char* const begin = reinterpret_cast<char*>(data.Begin());
+			setp( begin, begin + data.Capacity() );
+			pbump( int(pos) );
+
+			if (!traits_type::eq_int_type( c, traits_type::eof() ))
 			{
-				stream.clear();
-				stream.seekp( 0, std::stringstream::beg );
-				stream.clear();
+				*pptr() = traits_type::to_char_type( c );
+				pbump( 1 );
+			}
 
-				State::Saver saver( &static_cast<std::ostream&>(stream), false, true );
+			return traits_type::not_eof( c );
+		}
+
+		std::streampos Tracker::Rewinder::Snapshot::Buffer::seekoff(std::streamoff offset,std::ios::seekdir dir,std::ios::openmode which)
+		{
+			//The saver seeks back to fill in chunk lengths, then forward again.
+			const bool output = (which & std::ios::out);
+
+			const std::streamoff pos = output ? (pptr() - pbase()) : (gptr() - eback());
+			const std::streamoff end = output ? NST_MAX(std::streamoff(written),pos) : (egptr() - eback());
+
+			if (output)
+				written = dword(end);
+
+			const std::streamoff next = offset + (dir == std::ios::beg ? 0 : dir == std::ios::cur ? pos : end);
+
+			if (next < 0 || next > end)
+				return std::streampos(std::streamoff(-1));
+
+			if (output)
+			{
+				setp( pbase(), epptr() );
+				pbump( int(next) );
+			}
+			else
+			{
+				setg( eback(), eback() + next, egptr() );
+			}
+
+			return std::streampos(next);
+		}
+
+		std::streampos Tracker::Rewinder::Snapshot::Buffer::seekpos(std::streampos pos,std::ios::openmode which)
+		{
+			return seekoff( std::streamoff(pos), std::ios::beg, which );
+		}
+
+		void Tracker::Rewinder::Snapshot::Save(Key& key,const bool delta,Machine& emulator,EmuSaveState saveState)
+		{
+			out.clear();
+			nextBuffer.BeginWrite();
+
+			{
+				State::Saver saver( &static_cast<std::ostream&>(out), false, true );
 				(emulator.*saveState)( saver );
 			}
-			else if (loadState)
+
+			const dword size = nextBuffer.EndWrite();
+
+			if (delta && size == image.Size())
+			{
+				//A bitmap of the pages that changed, followed by the pages themselves.
+				const dword numPages = (size + (DirtyPages::PAGE_SIZE-1)) >> DirtyPages::PAGE_SHIFT;
+
+				key.state.Resize( (numPages + 7) >> 3 );
+				std::memset( key.state.Begin(), 0, key.state.Size() );
+
+				for (dword i=0, offset=0; i < numPages; ++i, offset += DirtyPages::PAGE_SIZE)
+				{
+					const dword length = NST_MIN(dword(DirtyPages::PAGE_SIZE),size - offset);
+
+					if (std::memcmp( next.Begin() + offset, image.Begin() + offset, length ))
+					{
+						key.state[i >> 3] |= 1U << (i & 0x7);
+						key.state.Append( next.Begin() + offset, length );
+					}
+				}
+
+				key.type = Key::DELTA;
+			}
+			else
 			{
-				TurnForward( emulator, loadState );
+				key.state.Assign( next.Begin(), size );
+				key.type = Key::FULL;
 			}
+
+			Vector<byte>::Swap( image, next );
 		}
 
-		void Tracker::Rewinder::Key::EndForward()
+		void Tracker::Rewinder::Snapshot::ApplyDelta(const Key& key,Vector<byte>& target)
 		{
-			if (!input.EndForward())
-				Reset();
+			NST_ASSERT( key.type == Key::DELTA );
+
+			const dword size = target.Size();
+			const dword numPages = (size + (DirtyPages::PAGE_SIZE-1)) >> DirtyPages::PAGE_SHIFT;
+
+			const byte* bitmap = key.state.Begin();
+			const byte* src = bitmap + ((numPages + 7) >> 3);
+			const byte* const end = key.state.End();
+
+			if (src > end)
+				throw RESULT_ERR_CORRUPT_FILE;
+
+			for (dword i=0, offset=0; i < numPages; ++i, offset += DirtyPages::PAGE_SIZE)
+			{
+				if (bitmap[i >> 3] & (1U << (i & 0x7)))
+				{
+					const dword length = NST_MIN(dword(DirtyPages::PAGE_SIZE),size - offset);
+
+					if (dword(end - src) < length)
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					std::memcpy( target.Begin() + offset, src, length );
+					src += length;
+				}
+			}
+		}
+
+		void Tracker::Rewinder::Snapshot::Rebuild(const Key* const* chain,uint length,Vector<byte>& target) const
+		{
+			//The chain runs from the key to rebuild back to a full key, or to the key in the image.
+			if ((!length || chain[length-1]->type == Key::DELTA) && &target != &image)
+				target.Assign( image.Begin(), image.Size() );
+
+			while (length)
+			{
+				const Key& key = *chain[--length];
+
+				if (key.type == Key::FULL)
+					target.Assign( key.state.Begin(), key.state.Size() );
+				else
+					ApplyDelta( key, target );
+			}
 		}
 
-		void Tracker::Rewinder::Key::TurnForward(Machine& emulator,EmuLoadState loadState)
+		void Tracker::Rewinder::Snapshot::Promote(const Key* const* chain,uint length,Key& key)
 		{
-			stream.clear();
-			stream.seekg( 0, std::stringstream::beg );
-			stream.clear();
+			Rebuild( chain, length, next );
+
+			key.state.Assign( next.Begin(), next.Size() );
+			key.type = Key::FULL;
+		}
 
-			State::Loader loader( &static_cast<std::istream&>(stream), false );
+		void Tracker::Rewinder::Snapshot::Restore(const Key* const* chain,uint length,Machine& emulator,EmuLoadState loadState)
+		{
+			Rebuild( chain, length, image );
+			Load( emulator, loadState );
+		}
+
+		void Tracker::Rewinder::Snapshot::Restore(const Vector<byte>& state,Machine& emulator,EmuLoadState loadState)
+		{
+			image.Assign( state.Begin(), state.Size() );
+			Load( emulator, loadState );
+		}
+
+		void Tracker::Rewinder::Snapshot::Load(Machine& emulator,EmuLoadState loadState)
+		{
+			in.clear();
+			imageBuffer.BeginRead();
+
+			State::Loader loader( &static_cast<std::istream&>(in), false );
 			(emulator.*loadState)( loader, true );
 		}
 
-		void Tracker::Rewinder::Key::BeginBackward(Machine& emulator,EmuLoadState loadState)
+		uint Tracker::Rewinder::GetChain(const Key* it,const Key** chain)
 		{
-			NST_VERIFY( CanRewind() );
+			uint length = 0;
 
-			TurnForward( emulator, loadState );
-			input.BeginBackward();
+			for (; it != imageKey; it = PrevKey( const_cast<Key*>(it) ))
+			{
+				if (it->type == Key::EMPTY || length == FULL_KEY_INTERVAL)
+					throw RESULT_ERR_CORRUPT_FILE;
+
+				chain[length++] = it;
+
+				if (it->type == Key::FULL)
+					break;
+			}
+
+			return length;
+		}
+
+		void Tracker::Rewinder::SaveKey(const dword start)
+		{
+			const Key* chain[FULL_KEY_INTERVAL];
+
+			ArchiveKey( start );
+
+			//The next key was stored against what this one holds now.
+			Key* const next = NextKey();
+
+			if (next != key && next->type == Key::DELTA)
+			{
+				snapshot.Promote( chain, GetChain( next, chain ), *next );
+				next->depth = 0;
+			}
+
+			Key* const prev = PrevKey();
+			const bool delta = (prev == imageKey && prev->type != Key::EMPTY && prev->depth+1 < FULL_KEY_INTERVAL);
+
+			snapshot.Save( *key, delta, emulator, emuSaveState );
+
+			key->depth = (key->type == Key::DELTA ? prev->depth+1 : 0);
+			key->start = start;
+			imageKey = key;
+		}
+
+		void Tracker::Rewinder::LoadKey(Key* const target)
+		{
+			const Key* chain[FULL_KEY_INTERVAL];
+
+			snapshot.Restore( chain, GetChain( target, chain ), emulator, emuLoadState );
+			imageKey = target;
+		}
+		//[SLEND]
+
+		//[SLBEGIN]: Multi-resolution rewind history.
+		void Tracker::Rewinder::ArchiveKey(const dword start)
+		{
+			//Only the oldest key leaves the ring in order. Keys left over from before
+			//a rewind or seek lie ahead of the new one and are simply dropped.
+			if (key->type != Key::EMPTY && key->start + dword(numKeys) * NUM_FRAMES == start)
+			{
+				//The oldest key is always stored in full.
+				NST_VERIFY( key->type == Key::FULL );
+
+				if (key->type == Key::FULL && key->CanRewind())
+				{
+					const Vector<byte>& input = key->GetInput();
+					history.Append( key->start, NUM_FRAMES, key->state.Begin(), key->state.Size(), input.Begin(), input.Size() );
+				}
+				else
+				{
+					history.Clear();
+				}
+			}
+		}
+
+		Tracker::Rewinder::Key* Tracker::Rewinder::OldestKey()
+		{
+			Key* it = key;
+
+			for (Key* prev = PrevKey( it ); prev != key && prev->CanRewind() && prev->start + NUM_FRAMES == it->start; prev = PrevKey( prev ))
+				it = prev;
+
+			return it;
+		}
+
+		dword Tracker::Rewinder::GetHistoryLength()
+		{
+			if (rewinding || uturn)
+				return 0;
+
+			const dword position = key->start + frame + 1;
+
+			//Right after a reset or a seek into the history the ring is empty.
+			if (key->type == Key::EMPTY)
+				return (!history.Empty() && history.End() == position) ? position - history.Begin() : 0;
+
+			//The first frame of the oldest key can only be reached through the history.
+			const dword start = OldestKey()->start;
+
+			return position - ((!history.Empty() && history.End() == start) ? history.Begin() : start + 1);
 		}
 
+		void Tracker::Rewinder::Replay(dword count,const bool archived)
+		{
+			LinkPorts( false );
+
+			for (uint i=0; i < 2; ++i)
+				ports[i] = cpu.Link( 0x4016+i, Cpu::LEVEL_HIGHEST, this, archived ? &Rewinder::Peek_Port_Replay : &Rewinder::Peek_Port_Get, &Rewinder::Poke_Port );
+
+			while (count--)
+				(emulator.*emuExecute)( NULL, NULL, NULL );
+
+			LinkPorts();
+		}
+
+		Result Tracker::Rewinder::Seek(const dword frames)
+		{
+			if (rewinding || uturn)
+				return RESULT_ERR_NOT_READY;
+
+			if (!frames)
+				return RESULT_NOP;
+
+			if (frames > GetHistoryLength())
+				return RESULT_ERR_INVALID_PARAM;
+
+			const dword target = key->start + frame + 1 - frames;
+
+			try
+			{
+				Key* const oldest = OldestKey();
+				Key* it = key;
+
+				while (it != oldest && target <= it->start)
+					it = PrevKey( it );
+
+				if (it->type != Key::EMPTY && target > it->start)
+				{
+					//Replay the key up to the target and record from there on.
+					key = it;
+					LoadKey( it );
+					it->BeginBackward();
+					Replay( target - it->start, false );
+					it->ResumeForward();
+					frame = target - it->start - 1;
+					NextKey()->Invalidate();
+				}
+				else
+				{
+					//Everything in the ring lies past the target, so it starts over
+					//from there once the history is replayed up to it.
+					const History::Keyframe* const keyframe = history.Find( target );
+
+					if (!keyframe)
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					snapshot.Restore( keyframe->state, emulator, emuLoadState );
+
+					replay = keyframe->input;
+					Replay( target - keyframe->frame, true );
+
+					if (replay > history.InputSize())
+						throw RESULT_ERR_CORRUPT_FILE;
+
+					history.Truncate( target, replay );
+
+					for (uint i=0; i < numKeys; ++i)
+						keys[i].Reset();
+
+					key = keys + (numKeys-1);
+					key->start = target - NUM_FRAMES;
+					frame = LAST_FRAME;
+					imageKey = NULL;
+				}
+			}
+			catch (Result result)
+			{
+				Reset();
+				return result;
+			}
+			catch (const std::bad_alloc&)
+			{
+				Reset();
+				return RESULT_ERR_OUT_OF_MEMORY;
+			}
+			catch (...)
+			{
+				Reset();
+				return RESULT_ERR_GENERIC;
+			}
+
+			return RESULT_OK;
+		}
+		//[SLEND]
+
 		inline void Tracker::Rewinder::Key::EndBackward()
 		{
 			input.EndBackward();
@@ -498,7 +922,9 @@ namespace Nes
 
 		inline Tracker::Rewinder::Key* Tracker::Rewinder::PrevKey(Key* k)
 		{
-			return (k != keys ? k-1 : keys+LAST_KEY);
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			return (k != keys ? k-1 : keys+(numKeys-1));
+			//[SLEND]
 		}
 
 		inline Tracker::Rewinder::Key* Tracker::Rewinder::PrevKey()
@@ -508,7 +934,9 @@ namespace Nes
 
 		inline Tracker::Rewinder::Key* Tracker::Rewinder::NextKey(Key* k)
 		{
-			return (k != keys+LAST_KEY ? k+1 : keys);
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			return (k != keys+(numKeys-1) ? k+1 : keys);
+			//[SLEND]
 		}
 
 		inline Tracker::Rewinder::Key* Tracker::Rewinder::NextKey()
@@ -661,8 +1089,12 @@ namespace Nes
 					{
 						frame = 0;
 						key->EndForward();
+						//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+						const dword start = key->start + NUM_FRAMES;
 						key = NextKey();
-						key->BeginForward( emulator, emuSaveState, NULL );
+						SaveKey( start );
+						key->BeginForward();
+						//[SLEND]
 					}
 				}
 				else
@@ -676,7 +1108,10 @@ namespace Nes
 
 						if (prev->CanRewind())
 						{
-							prev->BeginBackward( emulator, emuLoadState );
+							//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+							LoadKey( prev );
+							prev->BeginBackward();
+							//[SLEND]
 							key = prev;
 						}
 						else
@@ -685,7 +1120,10 @@ namespace Nes
 
 							key->Invalidate();
 							key = NextKey();
-							key->BeginForward( emulator, NULL, emuLoadState );
+							//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+							LoadKey( key );
+							key->BeginForward();
+							//[SLEND]
 
 							Api::Rewinder::stateCallback( Api::Rewinder::STOPPED );
 
@@ -733,7 +1171,10 @@ namespace Nes
 				video.Begin();
 				sound.Begin();
 
-				key->BeginBackward( emulator, emuLoadState );
+				//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+				LoadKey( key );
+				key->BeginBackward();
+				//[SLEND]
 				LinkPorts();
 
 				{
@@ -768,7 +1209,9 @@ namespace Nes
 					{
 						frame = 0;
 						key = NextKey();
-						key->TurnForward( emulator, emuLoadState );
+						//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+						LoadKey( key );
+						//[SLEND]
 					}
 
 					(emulator.*emuExecute)( NULL, NULL, NULL );
@@ -823,6 +1266,18 @@ namespace Nes
 			return key->Get();
 		}
 
+		//[SLBEGIN]: Multi-resolution rewind history.
+		NES_PEEK(Tracker::Rewinder,Port_Replay)
+		{
+			if (replay < history.InputSize())
+				return history.Input()[replay++];
+
+			//Open bus, and the replay is marked as having run out of input.
+			replay = history.InputSize() + 1;
+			return 0x40;
+		}
+		//[SLEND]
+
 		NES_POKE_AD(Tracker::Rewinder,Port)
 		{
 			ports[address-0x4016]->Poke( address, data );
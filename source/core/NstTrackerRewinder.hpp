@@ -25,8 +25,13 @@
 #ifndef NST_TRACKER_REWINDER_H
 #define NST_TRACKER_REWINDER_H
 
-#include <sstream>
+//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+#include <iostream>
+//[SLEND]
 #include "api/NstApiSound.hpp"
+//[SLBEGIN]: Multi-resolution rewind history.
+#include "NstHistory.hpp"
+//[SLEND]
 
 #ifndef NST_VECTOR_H
 #include "NstVector.hpp"
@@ -48,12 +53,31 @@ namespace Nes
 
 		public:
 
-			Rewinder(Machine&,EmuExecute,EmuLoadState,EmuSaveState,Cpu&,const Apu&,Ppu&,bool);
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			Rewinder(Machine&,EmuExecute,EmuLoadState,EmuSaveState,Cpu&,const Apu&,Ppu&,bool,uint);
+			//[SLEND]
 			~Rewinder();
 
 			Result Start();
 			Result Stop();
 			void   Execute(Video::Output*,Sound::Output*,Input::Controllers*);
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			void   SetNumKeys(uint);
+
+			// Starting a rewind turns the previous key into the one being replayed,
+			// so with two keys there'd be nothing left to rewind into after it.
+			enum
+			{
+				MIN_KEYS = 3,
+				DEFAULT_KEYS = 60,
+				MAX_KEYS = 60 * 60
+			};
+			//[SLEND]
+			//[SLBEGIN]: Multi-resolution rewind history.
+			void   SetHistoryBudget(dword);
+			dword  GetHistoryLength();
+			Result Seek(dword);
+			//[SLEND]
 
 		private:
 
@@ -61,14 +85,22 @@ namespace Nes
 			void LinkPorts(bool=true);
 			void ChangeDirection();
 
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
 			enum
 			{
-				NUM_KEYS = 60,
-				LAST_KEY = NUM_KEYS-1,
 				NUM_FRAMES = 60,
-				LAST_FRAME = NUM_FRAMES-1
+				LAST_FRAME = NUM_FRAMES-1,
+				FULL_KEY_INTERVAL = 8
 			};
 
+			// Each key holds the machine state at its first frame and the controller
+			// reads made during its frames. Every FULL_KEY_INTERVAL keys the state is
+			// stored in full; the keys in between only store the 256-byte pages that
+			// differ from the key before them. Before a key is overwritten, the key
+			// after it is stored in full if it depends on it, so the oldest key is
+			// always complete. The buffers are kept between uses, so once every key
+			// has been written the rewinder stops allocating.
+
 			class Key
 			{
 				class Input
@@ -78,7 +110,6 @@ namespace Nes
 					enum
 					{
 						BAD_POS = INT_MAX,
-						MIN_COMPRESSION_SIZE = 1024,
 						OPEN_BUS = 0x40
 					};
 
@@ -87,7 +118,7 @@ namespace Nes
 
 				public:
 
-					void Reset();
+					void Reset(bool);
 					inline void BeginForward();
 					bool EndForward();
 					void BeginBackward();
@@ -99,20 +130,31 @@ namespace Nes
 					inline void ResumeForward();
 					inline bool CanRewind() const;
 					inline void Invalidate();
+
+					const Buffer& Data() const
+					{
+						return buffer;
+					}
 				};
 
 				Input input;
-				std::stringstream stream;
 
 			public:
 
+				enum Type
+				{
+					EMPTY,
+					FULL,
+					DELTA
+				};
+
 				Key();
 				~Key();
 
-				void Reset();
-				void BeginForward(Machine&,EmuSaveState,EmuLoadState);
+				void Reset(bool=true);
+				void BeginForward();
 				void EndForward();
-				void BeginBackward(Machine&,EmuLoadState);
+				void BeginBackward();
 				inline void EndBackward();
 
 				inline uint Put(uint);
@@ -120,9 +162,63 @@ namespace Nes
 
 				inline bool CanRewind() const;
 				inline void ResumeForward();
-				inline void TurnForward(Machine&,EmuLoadState);
 				inline void Invalidate();
+				inline const Vector<byte>& GetInput() const;
+
+				Type type;
+				uint depth;
+				Vector<byte> state;
+				dword start;
+			};
+
+			class Snapshot
+			{
+			public:
+
+				Snapshot();
+
+				void Reset();
+				void Save(Key&,bool,Machine&,EmuSaveState);
+				void Restore(const Key* const*,uint,Machine&,EmuLoadState);
+				void Promote(const Key* const*,uint,Key&);
+				void Restore(const Vector<byte>&,Machine&,EmuLoadState);
+
+			private:
+
+				class Buffer : public std::streambuf
+				{
+				public:
+
+					explicit Buffer(Vector<byte>&);
+
+					void  BeginWrite();
+					dword EndWrite();
+					void  BeginRead();
+
+				private:
+
+					int_type overflow(int_type);
+					std::streampos seekoff(std::streamoff,std::ios::seekdir,std::ios::openmode);
+					std::streampos seekpos(std::streampos,std::ios::openmode);
+
+					Vector<byte>& data;
+					dword written;
+				};
+
+				void Rebuild(const Key* const*,uint,Vector<byte>&) const;
+				void Load(Machine&,EmuLoadState);
+				static void ApplyDelta(const Key&,Vector<byte>&);
+
+				// The raw state of the newest key saved or restored, which the next
+				// key's pages are compared against, and the state being saved.
+				Vector<byte> image;
+				Vector<byte> next;
+				Buffer imageBuffer;
+				Buffer nextBuffer;
+				std::istream in;
+				std::ostream out;
 			};
+			//[SLEND]
 
 			class ReverseVideo
 			{
@@ -202,10 +298,23 @@ namespace Nes
 			inline Key* PrevKey();
 			inline Key* NextKey(Key*);
 			inline Key* NextKey();
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			uint GetChain(const Key*,const Key**);
+			void SaveKey(dword);
+			void LoadKey(Key*);
+			//[SLEND]
+			//[SLBEGIN]: Multi-resolution rewind history.
+			void ArchiveKey(dword);
+			Key* OldestKey();
+			void Replay(dword,bool);
+			//[SLEND]
 
 			NES_DECL_PEEK( Port_Get );
 			NES_DECL_PEEK( Port_Put );
 			NES_DECL_POKE( Port     );
+			//[SLBEGIN]: Multi-resolution rewind history.
+			NES_DECL_PEEK( Port_Replay );
+			//[SLEND]
 
 			ibool rewinding;
 			ibool uturn;
@@ -214,7 +323,18 @@ namespace Nes
 			const Io::Port* ports[2];
 
 			Key* key;
-			Key keys[NUM_KEYS];
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			Key* keys;
+			uint numKeys;
+			Key* imageKey;
+			Snapshot snapshot;
+			//[SLEND]
+			//[SLBEGIN]: Multi-resolution rewind history.
+			// Where the keys go once they drop out of the ring, and the position in
+			// its input while replaying from one of its keyframes.
+			History history;
+			dword replay;
+			//[SLEND]
 
 			ReverseSound sound;
 			ReverseVideo video;
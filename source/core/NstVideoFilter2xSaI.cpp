@@ -75,21 +75,23 @@ namespace Nes
 				);
 			}
 
+			//[SLBEGIN]: Strip-parallel video filtering.
 			template<typename T>
-			void Renderer::Filter2xSaI::BlitType(const Input& input,const Output& output) const
+			void Renderer::Filter2xSaI::BlitType(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const word* NST_RESTRICT src = input.pixels;
+				const word* NST_RESTRICT src = input.pixels + first * WIDTH;
 				const long pitch = output.pitch;
 
 				T* NST_RESTRICT dst[2] =
 				{
-					static_cast<T*>(output.pixels),
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch)
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch * long(first * 2)),
+					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + pitch * long(first * 2 + 1))
 				};
 
 				dword a,b,c,d,e=0,f=0,g,h,i=0,j=0,k,l,m,n,o;
 
-				for (uint y=0; y < HEIGHT; ++y)
+				for (uint y=first; y < last; ++y)
+				//[SLEND]
 				{
 					for (uint x=0; x < WIDTH; ++x, ++src, dst[0] += 2, dst[1] += 2)
 					{
@@ -252,15 +254,17 @@ namespace Nes
 				}
 			}
 
-			void Renderer::Filter2xSaI::Blit(const Input& input,const Output& output,uint)
+			//[SLBEGIN]: Strip-parallel video filtering.
+			void Renderer::Filter2xSaI::Blit(const Input& input,const Output& output,uint,const uint first,const uint last)
 			{
 				switch (format.bpp)
 				{
-					case 32: BlitType< dword >( input, output ); break;
-					case 16: BlitType< word  >( input, output ); break;
+					case 32: BlitType< dword >( input, output, first, last ); break;
+					case 16: BlitType< word  >( input, output, first, last ); break;
 					default: NST_UNREACHABLE();
 				}
 			}
+			//[SLEND]
 		}
 	}
 }
@@ -45,10 +45,12 @@ namespace Nes
 
 			private:
 
-				void Blit(const Input&,const Output&,uint);
+				//[SLBEGIN]: Strip-parallel video filtering.
+				void Blit(const Input&,const Output&,uint,uint,uint);
 
 				template<typename T>
-				void BlitType(const Input&,const Output&) const;
+				void BlitType(const Input&,const Output&,uint,uint) const;
+				//[SLEND]
 
 				inline dword Blend(dword,dword) const;
 				inline dword Blend(dword,dword,dword,dword) const;
@@ -23,6 +23,9 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 
+//[SLBEGIN]: SIMD video filter kernels.
+#include <cstring>
+//[SLEND]
 #include "NstCore.hpp"
 
 #ifndef NST_NO_HQ2X
@@ -37,10 +40,12 @@ namespace Nes
 	{
 		namespace Video
 		{
-			void Renderer::FilterHqX::Blit(const Input& input,const Output& output,uint)
+			//[SLBEGIN]: Strip-parallel video filtering.
+			void Renderer::FilterHqX::Blit(const Input& input,const Output& output,uint,uint first,uint last)
 			{
-				(*this.*path)( input, output );
+				(*this.*path)( input, output, first, last );
 			}
+			//[SLEND]
 
 			template<dword R,dword G,dword B>
 			dword Renderer::FilterHqX::Interpolate1(dword c1,dword c2)
@@ -136,6 +141,13 @@ namespace Nes
 					for (uint k=0; k < 9; ++k)
 						c[k] = lut.rgb[w[k]];
 				}
+
+				//[SLBEGIN]: SIMD video filter kernels.
+				static NST_FORCE_INLINE dword Convert(const Lut& lut,dword pixel)
+				{
+					return lut.rgb[pixel];
+				}
+				//[SLEND]
 			};
 
 			template<>
@@ -150,57 +162,324 @@ namespace Nes
 				void Convert(const Lut&)
 				{
 				}
+
+				//[SLBEGIN]: SIMD video filter kernels.
+				static dword Convert(const Lut&,dword pixel)
+				{
+					return pixel;
+				}
+				//[SLEND]
 			};
 
+			//[SLBEGIN]: SIMD video filter kernels.
+			class Renderer::FilterHqX::Lines
+			{
+			public:
+
+				Lines(const Input&,const Lut&,Classify,uint);
+
+				void Next();
+
+				NST_FORCE_INLINE void Load(uint (&)[10],uint) const;
+
+				const dword* w[3];
+				const dword* yuv[3];
+				dword pattern[WIDTH];
+
+			private:
+
+				void Fill(uint,uint);
+
+				struct Line
+				{
+					dword w[1+WIDTH+1];
+					dword yuv[1+WIDTH+1];
+				};
+
+				const Input& input;
+				const Lut& lut;
+				const Classify classify;
+				uint row;
+				Line lines[3];
+			};
+
+			Renderer::FilterHqX::Lines::Lines(const Input& i,const Lut& l,Classify c,const uint first)
+			:
+			input    (i),
+			lut      (l),
+			classify (c),
+			row      (first)
+			{
+				// a strip starting further down needs the input row just above it too
+
+				if (first)
+					Fill( (first-1) % 3, first-1 );
+
+				Fill( first % 3, first );
+			}
+
+			void Renderer::FilterHqX::Lines::Fill(const uint slot,const uint y)
+			{
+				const Input::Pixel* NST_RESTRICT src = input.pixels + y * WIDTH;
+				Line& line = lines[slot];
+
+				for (uint x=1; x <= WIDTH; ++x)
+				{
+					line.w[x] = input.palette[*src++];
+					line.yuv[x] = lut.yuv[line.w[x]];
+				}
+
+				line.w[0] = line.w[1];
+				line.yuv[0] = line.yuv[1];
+				line.w[WIDTH+1] = line.w[WIDTH];
+				line.yuv[WIDTH+1] = line.yuv[WIDTH];
+			}
+
+			void Renderer::FilterHqX::Lines::Next()
+			{
+				const uint y = row++;
+
+				if (y+1 < HEIGHT)
+					Fill( (y+1) % 3, y+1 );
+
+				const uint slots[3] =
+				{
+					(y ? y-1 : y) % 3,
+					y % 3,
+					(y+1 < HEIGHT ? y+1 : y) % 3
+				};
+
+				for (uint i=0; i < 3; ++i)
+				{
+					w[i] = lines[slots[i]].w;
+					yuv[i] = lines[slots[i]].yuv;
+				}
+
+				classify( w, yuv, pattern );
+			}
+
+			NST_FORCE_INLINE void Renderer::FilterHqX::Lines::Load(uint (&b)[10],const uint x) const
+			{
+				for (uint i=0; i < 3; ++i)
+				{
+					b[i*3+0] = w[i][x+0];
+					b[i*3+1] = w[i][x+1];
+					b[i*3+2] = w[i][x+2];
+				}
+			}
+
+			void Renderer::FilterHqX::ClassifyLine(const dword* const (&w)[3],const dword* const (&yuv)[3],dword* NST_RESTRICT pattern)
+			{
+				for (uint x=0; x < WIDTH; ++x)
+				{
+					const dword w5 = w[1][x+1];
+					const dword yuv5 = yuv[1][x+1];
+
+					pattern[x] =
+					(
+						(w5 != w[0][x+0] && ((yuv5 - yuv[0][x+0]) & Lut::YUV_MASK) ? 0x01U : 0x0U) |
+						(w5 != w[0][x+1] && ((yuv5 - yuv[0][x+1]) & Lut::YUV_MASK) ? 0x02U : 0x0U) |
+						(w5 != w[0][x+2] && ((yuv5 - yuv[0][x+2]) & Lut::YUV_MASK) ? 0x04U : 0x0U) |
+						(w5 != w[1][x+0] && ((yuv5 - yuv[1][x+0]) & Lut::YUV_MASK) ? 0x08U : 0x0U) |
+						(w5 != w[1][x+2] && ((yuv5 - yuv[1][x+2]) & Lut::YUV_MASK) ? 0x10U : 0x0U) |
+						(w5 != w[2][x+0] && ((yuv5 - yuv[2][x+0]) & Lut::YUV_MASK) ? 0x20U : 0x0U) |
+						(w5 != w[2][x+1] && ((yuv5 - yuv[2][x+1]) & Lut::YUV_MASK) ? 0x40U : 0x0U) |
+						(w5 != w[2][x+2] && ((yuv5 - yuv[2][x+2]) & Lut::YUV_MASK) ? 0x80U : 0x0U)
+					);
+
+					// nine equal pixels interpolate to the same color in every case
+
+					if
+					(
+						!pattern[x] &&
+						w5 == w[0][x+0] && w5 == w[0][x+1] && w5 == w[0][x+2] && w5 == w[1][x+0] &&
+						w5 == w[1][x+2] && w5 == w[2][x+0] && w5 == w[2][x+1] && w5 == w[2][x+2]
+					)
+						pattern[x] = PATTERN_FLAT;
+				}
+			}
+
+			#ifdef NST_SSE2
+
+			void Renderer::FilterHqX::ClassifyLineSse2(const dword* const (&w)[3],const dword* const (&yuv)[3],dword* NST_RESTRICT pattern)
+			{
+				NST_COMPILE_ASSERT( sizeof(dword) == 4 && WIDTH % 4 == 0 );
+
+				// equal pixels always have equal YUV values, so unlike the scalar
+				// path the pattern bits only need the masked YUV difference
+
+				const __m128i mask = _mm_set1_epi32( Lut::YUV_MASK );
+				const __m128i zero = _mm_setzero_si128();
+
+				for (uint x=0; x < WIDTH; x += 4)
+				{
+					const __m128i yuv5 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(yuv[1] + x+1) );
+
+					#define NST_SIMILAR(row_,col_,bit_) _mm_and_si128( _mm_cmpeq_epi32( _mm_and_si128( _mm_sub_epi32( yuv5, _mm_loadu_si128( reinterpret_cast<const __m128i*>(yuv[row_] + x+col_) ) ), mask ), zero ), _mm_set1_epi32( bit_ ) )
+
+					const __m128i similar = _mm_or_si128
+					(
+						_mm_or_si128
+						(
+							_mm_or_si128( NST_SIMILAR(0,0,0x01), NST_SIMILAR(0,1,0x02) ),
+							_mm_or_si128( NST_SIMILAR(0,2,0x04), NST_SIMILAR(1,0,0x08) )
+						),
+						_mm_or_si128
+						(
+							_mm_or_si128( NST_SIMILAR(1,2,0x10), NST_SIMILAR(2,0,0x20) ),
+							_mm_or_si128( NST_SIMILAR(2,1,0x40), NST_SIMILAR(2,2,0x80) )
+						)
+					);
+
+					#undef NST_SIMILAR
+
+					const __m128i w5 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(w[1] + x+1) );
+
+					#define NST_EQUAL(row_,col_) _mm_cmpeq_epi32( w5, _mm_loadu_si128( reinterpret_cast<const __m128i*>(w[row_] + x+col_) ) )
+
+					const __m128i flat = _mm_and_si128
+					(
+						_mm_and_si128
+						(
+							_mm_and_si128( NST_EQUAL(0,0), NST_EQUAL(0,1) ),
+							_mm_and_si128( NST_EQUAL(0,2), NST_EQUAL(1,0) )
+						),
+						_mm_and_si128
+						(
+							_mm_and_si128( NST_EQUAL(1,2), NST_EQUAL(2,0) ),
+							_mm_and_si128( NST_EQUAL(2,1), NST_EQUAL(2,2) )
+						)
+					);
+
+					#undef NST_EQUAL
+
+					_mm_storeu_si128
+					(
+						reinterpret_cast<__m128i*>(pattern + x),
+						_mm_or_si128
+						(
+							_mm_xor_si128( similar, _mm_set1_epi32( 0xFF ) ),
+							_mm_and_si128( flat, _mm_set1_epi32( PATTERN_FLAT ) )
+						)
+					);
+				}
+			}
+
+			#endif
+
+			#ifdef NST_AVX2
+
+			NST_AVX2_TARGET void Renderer::FilterHqX::ClassifyLineAvx2(const dword* const (&w)[3],const dword* const (&yuv)[3],dword* NST_RESTRICT pattern)
+			{
+				NST_COMPILE_ASSERT( sizeof(dword) == 4 && WIDTH % 8 == 0 );
+
+				const __m256i mask = _mm256_set1_epi32( Lut::YUV_MASK );
+				const __m256i zero = _mm256_setzero_si256();
+
+				for (uint x=0; x < WIDTH; x += 8)
+				{
+					const __m256i yuv5 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(yuv[1] + x+1) );
+
+					#define NST_SIMILAR(row_,col_,bit_) _mm256_and_si256( _mm256_cmpeq_epi32( _mm256_and_si256( _mm256_sub_epi32( yuv5, _mm256_loadu_si256( reinterpret_cast<const __m256i*>(yuv[row_] + x+col_) ) ), mask ), zero ), _mm256_set1_epi32( bit_ ) )
+
+					const __m256i similar = _mm256_or_si256
+					(
+						_mm256_or_si256
+						(
+							_mm256_or_si256( NST_SIMILAR(0,0,0x01), NST_SIMILAR(0,1,0x02) ),
+							_mm256_or_si256( NST_SIMILAR(0,2,0x04), NST_SIMILAR(1,0,0x08) )
+						),
+						_mm256_or_si256
+						(
+							_mm256_or_si256( NST_SIMILAR(1,2,0x10), NST_SIMILAR(2,0,0x20) ),
+							_mm256_or_si256( NST_SIMILAR(2,1,0x40), NST_SIMILAR(2,2,0x80) )
+						)
+					);
+
+					#undef NST_SIMILAR
+
+					const __m256i w5 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(w[1] + x+1) );
+
+					#define NST_EQUAL(row_,col_) _mm256_cmpeq_epi32( w5, _mm256_loadu_si256( reinterpret_cast<const __m256i*>(w[row_] + x+col_) ) )
+
+					const __m256i flat = _mm256_and_si256
+					(
+						_mm256_and_si256
+						(
+							_mm256_and_si256( NST_EQUAL(0,0), NST_EQUAL(0,1) ),
+							_mm256_and_si256( NST_EQUAL(0,2), NST_EQUAL(1,0) )
+						),
+						_mm256_and_si256
+						(
+							_mm256_and_si256( NST_EQUAL(1,2), NST_EQUAL(2,0) ),
+							_mm256_and_si256( NST_EQUAL(2,1), NST_EQUAL(2,2) )
+						)
+					);
+
+					#undef NST_EQUAL
+
+					_mm256_storeu_si256
+					(
+						reinterpret_cast<__m256i*>(pattern + x),
+						_mm256_or_si256
+						(
+							_mm256_xor_si256( similar, _mm256_set1_epi32( 0xFF ) ),
+							_mm256_and_si256( flat, _mm256_set1_epi32( PATTERN_FLAT ) )
+						)
+					);
+				}
+
+				_mm256_zeroupper();
+			}
+
+			#endif
+			//[SLEND]
+
+			//[SLBEGIN]: Strip-parallel video filtering.
 			template<typename T,dword R,dword G,dword B>
-			void Renderer::FilterHqX::Blit2x(const Input& input,const Output& output) const
+			void Renderer::FilterHqX::Blit2x(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels);
 				const long pitch = output.pitch + output.pitch - (WIDTH*2 * sizeof(T));
 
+				byte* const pixels = static_cast<byte*>(output.pixels) + output.pitch * long(first * 2);
+
 				T* NST_RESTRICT dst[2] =
 				{
-					static_cast<T*>(output.pixels) - 2,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch) - 2
+					reinterpret_cast<T*>(pixels) - 2,
+					reinterpret_cast<T*>(pixels + output.pitch) - 2
 				};
+				//[SLEND]
 
-				for (uint y=HEIGHT; y; --y)
-				{
-					const uint lines[2] =
-					{
-						y < HEIGHT ? WIDTH * sizeof(Input::Pixel) : 0,
-						y > 1      ? WIDTH * sizeof(Input::Pixel) : 0
-					};
-
-					Buffer<T> b;
+				//[SLBEGIN]: SIMD video filter kernels.
+				Lines lines( input, lut, classify, first );
 
-					b.w[2] = (b.w[1] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])]);
-					b.w[5] = (b.w[4] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)]);
-					b.w[8] = (b.w[7] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])]);
+				for (uint y=last-first; y; --y)
+				{
+					lines.Next();
 
-					for (uint x=WIDTH; x; )
+					for (uint x=0; x < WIDTH; ++x)
 					{
-						src += sizeof(Input::Pixel);
 						dst[0] += 2;
 						dst[1] += 2;
 
-						b.w[0] = b.w[1];
-						b.w[1] = b.w[2];
-						b.w[3] = b.w[4];
-						b.w[4] = b.w[5];
-						b.w[6] = b.w[7];
-						b.w[7] = b.w[8];
-
-						if (--x)
+						if (lines.pattern[x] == PATTERN_FLAT)
 						{
-							b.w[2] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])];
-							b.w[5] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)];
-							b.w[8] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])];
+							const dword c = Buffer<T>::Convert( lut, lines.w[1][x+1] );
+
+							for (uint i=0; i < 2; ++i)
+								dst[0][i] = c;
+
+							for (uint i=0; i < 2; ++i)
+								dst[1][i] = c;
+
+							continue;
 						}
 
-						b.Convert( lut );
+						Buffer<T> b;
 
-						const uint yuv5 = lut.yuv[b.w[4]];
+						lines.Load( b.w, x );
+						b.Convert( lut );
+						//[SLEND]
 
 						#include "NstVideoFilterHq2x.inl"
 					}
@@ -210,57 +489,56 @@ namespace Nes
 				}
 			}
 
+			//[SLBEGIN]: Strip-parallel video filtering.
 			template<typename T,dword R,dword G,dword B>
-			void Renderer::FilterHqX::Blit3x(const Input& input,const Output& output) const
+			void Renderer::FilterHqX::Blit3x(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels);
 				const long pitch = (output.pitch * 2) + output.pitch - (WIDTH*3 * sizeof(T));
 
+				byte* const pixels = static_cast<byte*>(output.pixels) + output.pitch * long(first * 3);
+
 				T* NST_RESTRICT dst[3] =
 				{
-					static_cast<T*>(output.pixels) - 3,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch) - 3,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 2) - 3
+					reinterpret_cast<T*>(pixels) - 3,
+					reinterpret_cast<T*>(pixels + output.pitch) - 3,
+					reinterpret_cast<T*>(pixels + output.pitch * 2) - 3
 				};
+				//[SLEND]
 
-				for (uint y=HEIGHT; y; --y)
-				{
-					const uint lines[2] =
-					{
-						y < HEIGHT ? WIDTH * sizeof(Input::Pixel) : 0,
-						y > 1      ? WIDTH * sizeof(Input::Pixel) : 0
-					};
-
-					Buffer<T> b;
+				//[SLBEGIN]: SIMD video filter kernels.
+				Lines lines( input, lut, classify, first );
 
-					b.w[2] = (b.w[1] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])]);
-					b.w[5] = (b.w[4] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)]);
-					b.w[8] = (b.w[7] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])]);
+				for (uint y=last-first; y; --y)
+				{
+					lines.Next();
 
-					for (uint x=WIDTH; x; )
+					for (uint x=0; x < WIDTH; ++x)
 					{
-						src += sizeof(Input::Pixel);
 						dst[0] += 3;
 						dst[1] += 3;
 						dst[2] += 3;
 
-						b.w[0] = b.w[1];
-						b.w[1] = b.w[2];
-						b.w[3] = b.w[4];
-						b.w[4] = b.w[5];
-						b.w[6] = b.w[7];
-						b.w[7] = b.w[8];
-
-						if (--x)
+						if (lines.pattern[x] == PATTERN_FLAT)
 						{
-							b.w[2] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])];
-							b.w[5] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)];
-							b.w[8] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])];
+							const dword c = Buffer<T>::Convert( lut, lines.w[1][x+1] );
+
+							for (uint i=0; i < 3; ++i)
+								dst[0][i] = c;
+
+							for (uint i=0; i < 3; ++i)
+								dst[1][i] = c;
+
+							for (uint i=0; i < 3; ++i)
+								dst[2][i] = c;
+
+							continue;
 						}
 
-						b.Convert( lut );
+						Buffer<T> b;
 
-						const uint yuv5 = lut.yuv[b.w[4]];
+						lines.Load( b.w, x );
+						b.Convert( lut );
+						//[SLEND]
 
 						#include "NstVideoFilterHq3x.inl"
 					}
@@ -271,59 +549,61 @@ namespace Nes
 				}
 			}
 
+			//[SLBEGIN]: Strip-parallel video filtering.
 			template<typename T,dword R,dword G,dword B>
-			void Renderer::FilterHqX::Blit4x(const Input& input,const Output& output) const
+			void Renderer::FilterHqX::Blit4x(const Input& input,const Output& output,const uint first,const uint last) const
 			{
-				const byte* NST_RESTRICT src = reinterpret_cast<const byte*>(input.pixels);
 				const long pitch = (output.pitch * 3) + output.pitch - (WIDTH*4 * sizeof(T));
 
+				byte* const pixels = static_cast<byte*>(output.pixels) + output.pitch * long(first * 4);
+
 				T* NST_RESTRICT dst[4] =
 				{
-					static_cast<T*>(output.pixels) - 4,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch) - 4,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 2) - 4,
-					reinterpret_cast<T*>(static_cast<byte*>(output.pixels) + output.pitch * 3) - 4
+					reinterpret_cast<T*>(pixels) - 4,
+					reinterpret_cast<T*>(pixels + output.pitch) - 4,
+					reinterpret_cast<T*>(pixels + output.pitch * 2) - 4,
+					reinterpret_cast<T*>(pixels + output.pitch * 3) - 4
 				};
+				//[SLEND]
 
-				for (uint y=HEIGHT; y; --y)
-				{
-					const uint lines[2] =
-					{
-						y < HEIGHT ? WIDTH * sizeof(Input::Pixel) : 0,
-						y > 1      ? WIDTH * sizeof(Input::Pixel) : 0
-					};
-
-					Buffer<T> b;
+				//[SLBEGIN]: SIMD video filter kernels.
+				Lines lines( input, lut, classify, first );
 
-					b.w[2] = (b.w[1] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])]);
-					b.w[5] = (b.w[4] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)]);
-					b.w[8] = (b.w[7] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])]);
+				for (uint y=last-first; y; --y)
+				{
+					lines.Next();
 
-					for (uint x=WIDTH; x; )
+					for (uint x=0; x < WIDTH; ++x)
 					{
-						src += sizeof(Input::Pixel);
 						dst[0] += 4;
 						dst[1] += 4;
 						dst[2] += 4;
 						dst[3] += 4;
 
-						b.w[0] = b.w[1];
-						b.w[1] = b.w[2];
-						b.w[3] = b.w[4];
-						b.w[4] = b.w[5];
-						b.w[6] = b.w[7];
-						b.w[7] = b.w[8];
-
-						if (--x)
+						if (lines.pattern[x] == PATTERN_FLAT)
 						{
-							b.w[2] = input.palette[*reinterpret_cast<const Input::Pixel*>(src - lines[0])];
-							b.w[5] = input.palette[*reinterpret_cast<const Input::Pixel*>(src)];
-							b.w[8] = input.palette[*reinterpret_cast<const Input::Pixel*>(src + lines[1])];
+							const dword c = Buffer<T>::Convert( lut, lines.w[1][x+1] );
+
+							for (uint i=0; i < 4; ++i)
+								dst[0][i] = c;
+
+							for (uint i=0; i < 4; ++i)
+								dst[1][i] = c;
+
+							for (uint i=0; i < 4; ++i)
+								dst[2][i] = c;
+
+							for (uint i=0; i < 4; ++i)
+								dst[3][i] = c;
+
+							continue;
 						}
 
-						b.Convert( lut );
+						Buffer<T> b;
 
-						const uint yuv5 = lut.yuv[b.w[4]];
+						lines.Load( b.w, x );
+						b.Convert( lut );
+						//[SLEND]
 
 						#include "NstVideoFilterHq4x.inl"
 					}
@@ -429,12 +709,83 @@ namespace Nes
 				}
 			}
 
+			//[SLBEGIN]: SIMD video filter kernels.
+			Renderer::FilterHqX::Classify Renderer::FilterHqX::GetClassify()
+			{
+				#ifdef NST_AVX2
+				if (Simd::GetLevel() >= Simd::LEVEL_AVX2)
+					return &FilterHqX::ClassifyLineAvx2;
+				#endif
+
+				#ifdef NST_SSE2
+				if (Simd::GetLevel() >= Simd::LEVEL_SSE2)
+					return &FilterHqX::ClassifyLineSse2;
+				#endif
+
+				return &FilterHqX::ClassifyLine;
+			}
+
+			#ifdef NST_DEBUG
+
+			bool Renderer::FilterHqX::Verify() const
+			{
+				// runs the kernel and the scalar one on lines with runs of equal
+				// pixels and a few colors spread over the table to get near matches
+				// on one line only, 'nsttools filters' compares whole frames
+
+				dword data[2][3][1+WIDTH+1];
+				dword patterns[2][WIDTH];
+				dword colors[8];
+
+				dword seed = 1;
+
+				for (uint i=0; i < 8; ++i)
+				{
+					seed = (seed * 1664525UL + 1013904223UL) & 0xFFFFFFFF;
+					colors[i] = (seed >> 16) & (i < 4 ? 0xFFFF : 0x18E3);
+				}
+
+				for (uint i=0; i < 3; ++i)
+				{
+					for (uint x=0; x < 1+WIDTH+1; ++x)
+					{
+						seed = (seed * 1664525UL + 1013904223UL) & 0xFFFFFFFF;
+
+						if (i && (seed & 0x3000))
+							data[0][i][x] = data[0][0][x];
+						else if (x && (seed & 0xC000))
+							data[0][i][x] = data[0][i][x-1];
+						else
+							data[0][i][x] = colors[seed >> 29];
+
+						data[1][i][x] = lut.yuv[data[0][i][x]];
+					}
+				}
+
+				const dword* const w[3] = { data[0][0], data[0][1], data[0][2] };
+				const dword* const yuv[3] = { data[1][0], data[1][1], data[1][2] };
+
+				ClassifyLine( w, yuv, patterns[0] );
+				classify( w, yuv, patterns[1] );
+
+				return std::memcmp( patterns[0], patterns[1], sizeof(patterns[0]) ) == 0;
+			}
+
+			#endif
+			//[SLEND]
+
 			Renderer::FilterHqX::FilterHqX(const RenderState& state)
 			:
-			Filter (state),
-			path   (GetPath(state)),
-			lut    (state.bits.count == 32,format.shifts)
+			Filter   (state),
+			path     (GetPath(state)),
+			//[SLBEGIN]: SIMD video filter kernels.
+			classify (GetClassify()),
+			//[SLEND]
+			lut      (state.bits.count == 32,format.shifts)
 			{
+				//[SLBEGIN]: SIMD video filter kernels.
+				NST_VERIFY( Verify() );
+				//[SLEND]
 			}
 
 			bool Renderer::FilterHqX::Check(const RenderState& state)
@@ -30,6 +30,10 @@
 #pragma once
 #endif
 
+//[SLBEGIN]: SIMD video filter kernels.
+#include "NstSimd.hpp"
+//[SLEND]
+
 namespace Nes
 {
 	namespace Core
@@ -48,11 +52,42 @@ namespace Nes
 
 				~FilterHqX() {}
 
-				typedef void (FilterHqX::*Path)(const Input&,const Output&) const;
+				//[SLBEGIN]: Strip-parallel video filtering.
+				typedef void (FilterHqX::*Path)(const Input&,const Output&,uint,uint) const;
+				//[SLEND]
 
 				static Path GetPath(const RenderState&);
 
-				void Blit(const Input&,const Output&,uint);
+				//[SLBEGIN]: SIMD video filter kernels.
+				enum
+				{
+					PATTERN_FLAT = 0x100
+				};
+
+				typedef void (*Classify)(const dword* const (&)[3],const dword* const (&)[3],dword*);
+
+				static Classify GetClassify();
+
+				static void ClassifyLine(const dword* const (&)[3],const dword* const (&)[3],dword*);
+
+				#ifdef NST_SSE2
+				static void ClassifyLineSse2(const dword* const (&)[3],const dword* const (&)[3],dword*);
+				#endif
+
+				#ifdef NST_AVX2
+				static NST_AVX2_TARGET void ClassifyLineAvx2(const dword* const (&)[3],const dword* const (&)[3],dword*);
+				#endif
+
+				#ifdef NST_DEBUG
+				bool Verify() const;
+				#endif
+
+				class Lines;
+				//[SLEND]
+
+				//[SLBEGIN]: Strip-parallel video filtering.
+				void Blit(const Input&,const Output&,uint,uint,uint);
+				//[SLEND]
 				void Transform(const byte (&)[PALETTE][3],Input::Palette&) const;
 
 				template<dword R,dword G,dword B> static dword Interpolate1(dword,dword);
@@ -69,13 +104,19 @@ namespace Nes
 				inline dword Diff(uint,uint) const;
 
 				template<typename T,dword R,dword G,dword B>
-				void Blit2x(const Input&,const Output&) const;
+				//[SLBEGIN]: Strip-parallel video filtering.
+				void Blit2x(const Input&,const Output&,uint,uint) const;
+				//[SLEND]
 
 				template<typename T,dword R,dword G,dword B>
-				void Blit3x(const Input&,const Output&) const;
+				//[SLBEGIN]: Strip-parallel video filtering.
+				void Blit3x(const Input&,const Output&,uint,uint) const;
+				//[SLEND]
 
 				template<typename T,dword R,dword G,dword B>
-				void Blit4x(const Input&,const Output&) const;
+				//[SLBEGIN]: Strip-parallel video filtering.
+				void Blit4x(const Input&,const Output&,uint,uint) const;
+				//[SLEND]
 
 				template<typename T>
 				struct Buffer;
@@ -96,6 +137,9 @@ namespace Nes
 				};
 
 				const Path path;
+				//[SLBEGIN]: SIMD video filter kernels.
+				const Classify classify;
+				//[SLEND]
 				const Lut lut;
 			};
 		}
@@ -47,13 +47,15 @@ namespace Nes
 
 				~FilterNone() {}
 
-				void Blit(const Input&,const Output&,uint);
+				//[SLBEGIN]: Strip-parallel video filtering.
+				void Blit(const Input&,const Output&,uint,uint,uint);
 
 				template<typename T>
-				static void BlitAligned(const Input&,const Output&);
+				static void BlitAligned(const Input&,const Output&,uint,uint);
 
 				template<typename T>
-				static void BlitUnaligned(const Input&,const Output&);
+				static void BlitUnaligned(const Input&,const Output&,uint,uint);
+				//[SLEND]
 			};
 		}
 	}
@@ -22,9 +22,18 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 
+//[SLBEGIN]: SIMD video filter kernels.
+#include <new>
+#include <cstring>
+//[SLEND]
 #include "NstAssert.hpp"
 #include "NstVideoRenderer.hpp"
 #include "NstVideoFilterNtsc.hpp"
+//[SLBEGIN]: SIMD video filter kernels.
+#ifdef NST_AVX2
+#include "../nes_ntsc/nes_ntsc_avx2.h"
+#endif
+//[SLEND]
 #include "NstFpuPrecision.hpp"
 
 namespace Nes
@@ -33,23 +42,27 @@ namespace Nes
 	{
 		namespace Video
 		{
-			void Renderer::FilterNtsc::Blit(const Input& input,const Output& output,uint phase)
+			//[SLBEGIN]: Strip-parallel video filtering.
+			void Renderer::FilterNtsc::Blit(const Input& input,const Output& output,uint phase,uint first,uint last)
 			{
-				(*this.*path)( input, output, phase );
+				(*this.*path)( input, output, phase, first, last );
 			}
 
 			template<typename Pixel,uint BITS>
-			void Renderer::FilterNtsc::BlitType(const Input& input,const Output& output,uint phase) const
+			void Renderer::FilterNtsc::BlitType(const Input& input,const Output& output,uint phase,const uint first,const uint last) const
 			{
-				NST_ASSERT( phase < 3 );
+				NST_ASSERT( phase < 3 && first <= last && last <= HEIGHT );
 
-				const Input::Pixel* NST_RESTRICT src = input.pixels;
-				Pixel* NST_RESTRICT dst = static_cast<Pixel*>(output.pixels);
+				// rows are independent, only the phase of the first one depends on its position
+
+				const Input::Pixel* NST_RESTRICT src = input.pixels + first * WIDTH;
+				Pixel* NST_RESTRICT dst = reinterpret_cast<Pixel*>(static_cast<byte*>(output.pixels) + long(first) * output.pitch);
 				const long pad = output.pitch - (NTSC_WIDTH-7) * sizeof(Pixel);
 
-				phase &= lut.noFieldMerging;
+				phase = ((phase & lut.noFieldMerging) + first) % 3;
 
-				for (uint y=HEIGHT; y; --y)
+				for (uint y=last-first; y; --y)
+				//[SLEND]
 				{
 					NES_NTSC_BEGIN_ROW( &lut, phase, lut.black, lut.black, *src++ );
 
@@ -88,6 +101,47 @@ namespace Nes
 				}
 			}
 
+			//[SLBEGIN]: SIMD video filter kernels.
+			#ifdef NST_AVX2
+
+			template<typename Pixel,uint BITS>
+			NST_AVX2_TARGET void Renderer::FilterNtsc::BlitTypeAvx2(const Input& input,const Output& output,uint phase,const uint first,const uint last) const
+			{
+				NST_ASSERT( phase < 3 && first <= last && last <= HEIGHT );
+
+				// same walk as BlitType but each chunk of three pixels produces its
+				// seven outputs at once, the eighth lane is overwritten by the next chunk
+
+				const Input::Pixel* NST_RESTRICT src = input.pixels + first * WIDTH;
+				Pixel* NST_RESTRICT dst = reinterpret_cast<Pixel*>(static_cast<byte*>(output.pixels) + long(first) * output.pitch);
+				const long pad = output.pitch - (NTSC_WIDTH-7) * sizeof(Pixel);
+
+				phase = ((phase & lut.noFieldMerging) + first) % 3;
+
+				for (uint y=last-first; y; --y)
+				{
+					NES_NTSC_AVX2_BEGIN_ROW( &lut, phase, lut.black, lut.black, *src++ );
+
+					__m256i raw;
+
+					for (const Input::Pixel* const end=src+(NTSC_WIDTH/7*3-3); src != end; src += 3, dst += 7)
+					{
+						NES_NTSC_AVX2_COLOR_IN( src[0], src[1], src[2], raw );
+						NES_NTSC_AVX2_STORE_8( dst, NES_NTSC_AVX2_RGB_OUT( raw, BITS ), BITS );
+					}
+
+					NES_NTSC_AVX2_COLOR_IN( lut.black, lut.black, lut.black, raw );
+					NES_NTSC_AVX2_STORE_7( dst, NES_NTSC_AVX2_RGB_OUT( raw, BITS ), BITS );
+
+					dst = reinterpret_cast<Pixel*>(reinterpret_cast<byte*>(dst) + pad);
+
+					phase = (phase + 1) % 3;
+				}
+			}
+
+			#endif
+			//[SLEND]
+
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("s", on)
 			#endif
@@ -101,8 +155,28 @@ namespace Nes
 				);
 			}
 
-			Renderer::FilterNtsc::Path Renderer::FilterNtsc::GetPath(const RenderState& state,const Lut& lut)
+			//[SLBEGIN]: SIMD video filter kernels.
+			Renderer::FilterNtsc::Path Renderer::FilterNtsc::GetPath(const RenderState& state,const Simd::Level level)
 			{
+				#ifdef NST_AVX2
+				if (level >= Simd::LEVEL_AVX2)
+				{
+					if (state.bits.count == 32)
+					{
+						return &FilterNtsc::BlitTypeAvx2<dword,32>;
+					}
+					else if (state.bits.mask.g == 0x07E0)
+					{
+						return &FilterNtsc::BlitTypeAvx2<word,16>;
+					}
+					else
+					{
+						return &FilterNtsc::BlitTypeAvx2<word,15>;
+					}
+				}
+				#endif
+				//[SLEND]
+
 				if (state.bits.count == 32)
 				{
 					return &FilterNtsc::BlitType<dword,32>;
@@ -185,11 +259,62 @@ namespace Nes
 			)
 			:
 			Filter (state),
-			path   (GetPath(state,lut)),
+			//[SLBEGIN]: SIMD video filter kernels.
+			path   (GetPath(state,Simd::GetLevel())),
+			//[SLEND]
 			lut    (palette,sharpness,resolution,bleed,artifacts,fringing,fieldMerging)
 			{
+				//[SLBEGIN]: SIMD video filter kernels.
+				NST_VERIFY( Verify(GetPath(state,Simd::LEVEL_NONE)) );
+				//[SLEND]
 			}
 
+			//[SLBEGIN]: SIMD video filter kernels.
+			#ifdef NST_DEBUG
+
+			bool Renderer::FilterNtsc::Verify(const Path reference) const
+			{
+				// runs the chosen path and the scalar one over a few rows of random
+				// colors with runs of equal pixels, one row for each phase
+
+				enum
+				{
+					ROWS = 3,
+					PITCH = NTSC_WIDTH * sizeof(dword)
+				};
+
+				Input* const input = new (std::nothrow) Input;
+				byte* const pixels = new (std::nothrow) byte [ROWS * PITCH * 2];
+
+				bool result = true;
+
+				if (input && pixels)
+				{
+					dword seed = 1;
+
+					for (uint i=0; i < ROWS * WIDTH; ++i)
+					{
+						seed = (seed * 1664525UL + 1013904223UL) & 0xFFFFFFFF;
+						input->pixels[i] = (i && (seed & 0xC000)) ? input->pixels[i-1] : (seed >> 16) % PALETTE;
+					}
+
+					std::memset( pixels, 0, ROWS * PITCH * 2 );
+
+					(*this.*reference)( *input, Output(pixels,PITCH), 0, 0, ROWS );
+					(*this.*path)( *input, Output(pixels + ROWS * PITCH,PITCH), 0, 0, ROWS );
+
+					result = std::memcmp( pixels, pixels + ROWS * PITCH, ROWS * PITCH ) == 0;
+				}
+
+				delete [] pixels;
+				delete input;
+
+				return result;
+			}
+
+			#endif
+			//[SLEND]
+
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("", on)
 			#endif
@@ -26,6 +26,9 @@
 #define NST_VIDEO_FILTER_NTSC_H
 
 #include "../nes_ntsc/nes_ntsc.h"
+//[SLBEGIN]: SIMD video filter kernels.
+#include "NstSimd.hpp"
+//[SLEND]
 
 #ifdef NST_PRAGMA_ONCE
 #pragma once
@@ -54,12 +57,25 @@ namespace Nes
 					NTSC_WIDTH = 602
 				};
 
-				typedef void (FilterNtsc::*Path)(const Input&,const Output&,uint) const;
+				//[SLBEGIN]: Strip-parallel video filtering.
+				typedef void (FilterNtsc::*Path)(const Input&,const Output&,uint,uint,uint) const;
 
-				void Blit(const Input&,const Output&,uint);
+				void Blit(const Input&,const Output&,uint,uint,uint);
 
 				template<typename T,uint BITS>
-				void BlitType(const Input&,const Output&,uint) const;
+				void BlitType(const Input&,const Output&,uint,uint,uint) const;
+				//[SLEND]
+
+				//[SLBEGIN]: SIMD video filter kernels.
+				#ifdef NST_AVX2
+				template<typename T,uint BITS>
+				NST_AVX2_TARGET void BlitTypeAvx2(const Input&,const Output&,uint,uint,uint) const;
+				#endif
+
+				#ifdef NST_DEBUG
+				bool Verify(Path) const;
+				#endif
+				//[SLEND]
 
 				class Lut : public nes_ntsc_t
 				{
@@ -78,7 +94,9 @@ namespace Nes
 					const uint black;
 				};
 
-				static Path GetPath(const RenderState&,const Lut&);
+				//[SLBEGIN]: SIMD video filter kernels.
+				static Path GetPath(const RenderState&,Simd::Level);
+				//[SLEND]
 
 				const Path path;
 				const Lut lut;
@@ -23,10 +23,16 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 
+//[SLBEGIN]: SIMD video filter kernels.
+#include <cstring>
+//[SLEND]
 #include "NstCore.hpp"
 
 #ifndef NST_NO_SCALEX
 
+//[SLBEGIN]: SIMD video filter kernels.
+#include "NstAssert.hpp"
+//[SLEND]
 #include "NstVideoRenderer.hpp"
 #include "NstVideoFilterScaleX.hpp"
 
@@ -36,194 +42,308 @@ namespace Nes
 	{
 		namespace Video
 		{
-			void Renderer::FilterScaleX::Blit(const Input& input,const Output& output,uint)
+			//[SLBEGIN]: Strip-parallel video filtering.
+			void Renderer::FilterScaleX::Blit(const Input& input,const Output& output,uint,uint first,uint last)
 			{
-				path( input, output );
+				path( input, output, kernel, first, last );
 			}
+			//[SLEND]
 
-			template<typename T,int PREV,int NEXT>
-			NST_FORCE_INLINE T* Renderer::FilterScaleX::Blit2xBorder(T* NST_RESTRICT dst,const Input::Pixel* NST_RESTRICT src,const Input::Palette& palette)
+			//[SLBEGIN]: SIMD video filter kernels.
+			class Renderer::FilterScaleX::Lines
 			{
-				{
-					dword p[4] =
-					{
-						palette[src[ PREV ]],
-						palette[src[ 0    ]],
-						palette[src[ 1    ]],
-						palette[src[ NEXT ]]
-					};
+			public:
 
-					if (p[0] != p[3] && p[2] != p[1] && p[2] == p[0])
-						p[1] = p[0];
+				Lines(const Input&,uint);
 
-					dst[0] = p[1];
-					dst[1] = p[1];
-				}
+				void Next();
 
-				src += 1;
-				dst += 2;
+				const dword* rows[3];
 
-				for (uint x=WIDTH-2; x; --x)
-				{
-					const dword p[4] =
-					{
-						palette[src[  PREV ]],
-						palette[src[ -1    ]],
-						palette[src[  0    ]],
-						palette[src[  1    ]]
-					};
+			private:
 
-					if (p[0] != p[1] && p[1] != p[3])
-					{
-						dst[0] = p[1] == p[0] ? p[0] : p[2];
-						dst[1] = p[3] == p[0] ? p[0] : p[2];
-					}
-					else
-					{
-						dst[0] = p[2];
-						dst[1] = p[2];
-					}
+				void Fill(uint,uint);
 
-					src += 1;
-					dst += 2;
-				}
+				const Input& input;
+				uint row;
+				dword lines[3][1+WIDTH+1];
+			};
 
-				const dword p[4] =
-				{
-					palette[src[  PREV ]],
-					palette[src[ -1    ]],
-					palette[src[  0    ]],
-					palette[src[  NEXT ]]
-				};
+			Renderer::FilterScaleX::Lines::Lines(const Input& i,const uint first)
+			:
+			input (i),
+			row   (first)
+			{
+				if (first)
+					Fill( (first-1) % 3, first-1 );
+
+				Fill( first % 3, first );
+			}
+
+			void Renderer::FilterScaleX::Lines::Fill(const uint slot,const uint y)
+			{
+				const Input::Pixel* NST_RESTRICT src = input.pixels + y * WIDTH;
+				dword* NST_RESTRICT line = lines[slot];
+
+				for (uint x=1; x <= WIDTH; ++x)
+					line[x] = input.palette[*src++];
+
+				line[0] = line[1];
+				line[WIDTH+1] = line[WIDTH];
+			}
+
+			void Renderer::FilterScaleX::Lines::Next()
+			{
+				const uint y = row++;
 
-				if (p[0] != p[3] && p[1] != p[2])
+				if (y+1 < HEIGHT)
+					Fill( (y+1) % 3, y+1 );
+
+				rows[0] = lines[(y ? y-1 : y) % 3];
+				rows[1] = lines[y % 3];
+				rows[2] = lines[(y+1 < HEIGHT ? y+1 : y) % 3];
+			}
+
+			void Renderer::FilterScaleX::Scale2xLine(const dword* const (&rows)[3],dword (&out)[2][WIDTH])
+			{
+				for (uint x=0; x < WIDTH; ++x)
 				{
-					dst[0] = p[1] == p[0] ? p[0] : p[2];
-					dst[1] = p[2] == p[0] ? p[0] : p[2];
+					const dword v = rows[0][x+1];
+					const dword l = rows[1][x+0];
+					const dword c = rows[1][x+1];
+					const dword r = rows[1][x+2];
+
+					out[0][x] = (v != l && l != r && r == v) ? v : c;
 				}
-				else
+			}
+
+			void Renderer::FilterScaleX::Scale3xLine(const dword* const (&rows)[3],dword (&out)[2][WIDTH])
+			{
+				for (uint x=0; x < WIDTH; ++x)
 				{
-					dst[0] = p[2];
-					dst[1] = p[2];
+					const dword v = rows[0][x+1];
+					const dword w = rows[2][x+1];
+					const dword l = rows[1][x+0];
+					const dword c = rows[1][x+1];
+					const dword r = rows[1][x+2];
+
+					out[0][x] = (l == v && w != v && r != v) ? v : c;
+					out[1][x] = (r == v && w != v && l != v) ? v : c;
 				}
-
-				return dst + 2;
 			}
 
-			template<typename T,int PREV,int NEXT>
-			NST_FORCE_INLINE T* Renderer::FilterScaleX::Blit3xBorder(T* NST_RESTRICT dst,const Input::Pixel* NST_RESTRICT src,const Input::Palette& palette)
+			#ifdef NST_SSE2
+
+			void Renderer::FilterScaleX::Scale2xLineSse2(const dword* const (&rows)[3],dword (&out)[2][WIDTH])
 			{
-				{
-					const dword p = palette[src[0]];
+				NST_COMPILE_ASSERT( sizeof(dword) == 4 && WIDTH % 4 == 0 );
 
-					dst[0] = p;
-					dst[1] = p;
+				for (uint x=0; x < WIDTH; x += 4)
+				{
+					const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[0] + x+1) );
+					const __m128i l = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[1] + x+0) );
+					const __m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[1] + x+1) );
+					const __m128i r = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[1] + x+2) );
 
-					const dword q = palette[src[PREV]];
+					// r == v and v != l already imply l != r
+					const __m128i mask = _mm_andnot_si128( _mm_cmpeq_epi32( v, l ), _mm_cmpeq_epi32( r, v ) );
 
-					dst[2] = (q != palette[src[1]] && q != palette[src[NEXT]]) ? q : p;
+					_mm_storeu_si128( reinterpret_cast<__m128i*>(out[0] + x), _mm_or_si128( _mm_and_si128( mask, v ), _mm_andnot_si128( mask, c ) ) );
 				}
+			}
 
-				src += 1;
-				dst += 3;
+			void Renderer::FilterScaleX::Scale3xLineSse2(const dword* const (&rows)[3],dword (&out)[2][WIDTH])
+			{
+				NST_COMPILE_ASSERT( sizeof(dword) == 4 && WIDTH % 4 == 0 );
 
-				for (uint x=WIDTH-2; x; --x)
+				for (uint x=0; x < WIDTH; x += 4)
 				{
-					const dword p[5] =
+					const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[0] + x+1) );
+					const __m128i w = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[2] + x+1) );
+					const __m128i l = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[1] + x+0) );
+					const __m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[1] + x+1) );
+					const __m128i r = _mm_loadu_si128( reinterpret_cast<const __m128i*>(rows[1] + x+2) );
+
+					const __m128i vw = _mm_cmpeq_epi32( v, w );
+					const __m128i vl = _mm_cmpeq_epi32( v, l );
+					const __m128i vr = _mm_cmpeq_epi32( v, r );
+
+					const __m128i masks[2] =
 					{
-						palette[src[  PREV ]],
-						palette[src[ -1    ]],
-						palette[src[  0    ]],
-						palette[src[  1    ]],
-						palette[src[  NEXT ]]
+						_mm_andnot_si128( _mm_or_si128( vw, vr ), vl ),
+						_mm_andnot_si128( _mm_or_si128( vw, vl ), vr )
 					};
 
-					dst[0] = (p[1] == p[0] && p[4] != p[0] && p[3] != p[0]) ? p[0] : p[2];
-					dst[1] = p[2];
-					dst[2] = (p[3] == p[0] && p[4] != p[0] && p[1] != p[0]) ? p[0] : p[2];
-
-					src += 1;
-					dst += 3;
+					_mm_storeu_si128( reinterpret_cast<__m128i*>(out[0] + x), _mm_or_si128( _mm_and_si128( masks[0], v ), _mm_andnot_si128( masks[0], c ) ) );
+					_mm_storeu_si128( reinterpret_cast<__m128i*>(out[1] + x), _mm_or_si128( _mm_and_si128( masks[1], v ), _mm_andnot_si128( masks[1], c ) ) );
 				}
+			}
 
-				const dword p[2] =
-				{
-					palette[src[ PREV ]],
-					palette[src[ 0    ]]
-				};
-
-				dst[0] = p[p[0] != palette[src[-1]] || p[0] == palette[src[NEXT]]];
-				dst[1] = p[1];
-				dst[2] = p[1];
+			#endif
 
-				return dst + 3;
-			}
+			#ifdef NST_AVX2
 
-			template<typename T>
-			NST_FORCE_INLINE T* Renderer::FilterScaleX::Blit3xCenter(T* NST_RESTRICT dst,const Input::Pixel* NST_RESTRICT src,const Input::Palette& palette)
+			NST_AVX2_TARGET void Renderer::FilterScaleX::Scale2xLineAvx2(const dword* const (&rows)[3],dword (&out)[2][WIDTH])
 			{
-				for (uint x=WIDTH; x; --x)
+				NST_COMPILE_ASSERT( sizeof(dword) == 4 && WIDTH % 8 == 0 );
+
+				for (uint x=0; x < WIDTH; x += 8)
 				{
-					const dword p = palette[*src++];
+					const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[0] + x+1) );
+					const __m256i l = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[1] + x+0) );
+					const __m256i c = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[1] + x+1) );
+					const __m256i r = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[1] + x+2) );
 
-					dst[0] = p;
-					dst[1] = p;
-					dst[2] = p;
+					const __m256i mask = _mm256_andnot_si256( _mm256_cmpeq_epi32( v, l ), _mm256_cmpeq_epi32( r, v ) );
 
-					dst += 3;
+					_mm256_storeu_si256( reinterpret_cast<__m256i*>(out[0] + x), _mm256_blendv_epi8( c, v, mask ) );
 				}
 
-				return dst;
+				_mm256_zeroupper();
 			}
 
-			template<typename T,int PREV,int NEXT>
-			NST_FORCE_INLINE T* Renderer::FilterScaleX::Blit2xLine(T* dst,const Input::Pixel* const src,const Input::Palette& palette,const long pad)
+			NST_AVX2_TARGET void Renderer::FilterScaleX::Scale3xLineAvx2(const dword* const (&rows)[3],dword (&out)[2][WIDTH])
 			{
-				dst = reinterpret_cast<T*>(reinterpret_cast<byte*>(Blit2xBorder<T,PREV,NEXT>( dst, src, palette )) + pad);
-				dst = reinterpret_cast<T*>(reinterpret_cast<byte*>(Blit2xBorder<T,NEXT,PREV>( dst, src, palette )) + pad);
+				NST_COMPILE_ASSERT( sizeof(dword) == 4 && WIDTH % 8 == 0 );
 
-				return dst;
+				for (uint x=0; x < WIDTH; x += 8)
+				{
+					const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[0] + x+1) );
+					const __m256i w = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[2] + x+1) );
+					const __m256i l = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[1] + x+0) );
+					const __m256i c = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[1] + x+1) );
+					const __m256i r = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(rows[1] + x+2) );
+
+					const __m256i vw = _mm256_cmpeq_epi32( v, w );
+					const __m256i vl = _mm256_cmpeq_epi32( v, l );
+					const __m256i vr = _mm256_cmpeq_epi32( v, r );
+
+					_mm256_storeu_si256( reinterpret_cast<__m256i*>(out[0] + x), _mm256_blendv_epi8( c, v, _mm256_andnot_si256( _mm256_or_si256( vw, vr ), vl ) ) );
+					_mm256_storeu_si256( reinterpret_cast<__m256i*>(out[1] + x), _mm256_blendv_epi8( c, v, _mm256_andnot_si256( _mm256_or_si256( vw, vl ), vr ) ) );
+				}
+
+				_mm256_zeroupper();
 			}
 
-			template<typename T,int PREV,int NEXT>
-			NST_FORCE_INLINE T* Renderer::FilterScaleX::Blit3xLine(T* dst,const Input::Pixel* const src,const Input::Palette& palette,const long pad)
+			#endif
+
+			template<typename T>
+			NST_FORCE_INLINE void Renderer::FilterScaleX::Store2x(T* NST_RESTRICT dst,const dword* const (&rows)[3],const dword (&out)[2][WIDTH])
 			{
-				dst = reinterpret_cast<T*>(reinterpret_cast<byte*>(Blit3xBorder<T,PREV,NEXT>( dst, src, palette )) + pad);
-				dst = reinterpret_cast<T*>(reinterpret_cast<byte*>(Blit3xCenter<T>( dst, src, palette )) + pad);
-				dst = reinterpret_cast<T*>(reinterpret_cast<byte*>(Blit3xBorder<T,NEXT,PREV>( dst, src, palette )) + pad);
+				const dword* const NST_RESTRICT v = rows[0] + 1;
+				const dword* const NST_RESTRICT c = rows[1] + 1;
+				const dword* const NST_RESTRICT w = rows[2] + 1;
 
-				return dst;
+				for (uint x=0; x < WIDTH; ++x)
+				{
+					dst[x*2+0] = c[x];
+					dst[x*2+1] = out[0][x];
+				}
+
+				// the border pixels follow their own rules
+
+				dst[0] = dst[1] = (v[0] != w[0] && c[1] != c[0] && c[1] == v[0]) ? v[0] : c[0];
+
+				const uint e = WIDTH-1;
+
+				if (v[e] != w[e] && c[e-1] != c[e] && c[e-1] == v[e])
+					dst[e*2+0] = v[e];
 			}
 
 			template<typename T>
-			void Renderer::FilterScaleX::Blit2x(const Input& input,const Output& output)
+			NST_FORCE_INLINE void Renderer::FilterScaleX::Store3x(T* NST_RESTRICT dst,const dword* const (&rows)[3],const dword (&out)[2][WIDTH])
 			{
-				const Input::Pixel* src = input.pixels;
-				T* dst = static_cast<T*>(output.pixels);
-				const long pad = output.pitch - long(sizeof(T) * WIDTH*2);
+				const dword* const NST_RESTRICT v = rows[0] + 1;
+				const dword* const NST_RESTRICT c = rows[1] + 1;
+				const dword* const NST_RESTRICT w = rows[2] + 1;
 
-				dst = Blit2xLine<T,0,WIDTH>( dst, src, input.palette, pad );
+				for (uint x=0; x < WIDTH; ++x)
+				{
+					dst[x*3+0] = out[0][x];
+					dst[x*3+1] = c[x];
+					dst[x*3+2] = out[1][x];
+				}
+
+				dst[0] = c[0];
+				dst[2] = (v[0] != c[1] && v[0] != w[0]) ? v[0] : c[0];
 
-				for (uint y=HEIGHT-2; y; --y)
-					dst = Blit2xLine<T,-WIDTH,WIDTH>( dst, src += WIDTH, input.palette, pad );
+				const uint e = WIDTH-1;
 
-				Blit2xLine<T,-WIDTH,0>( dst, src + WIDTH, input.palette, pad );
+				dst[e*3+0] = (v[e] != c[e-1] || v[e] == w[e]) ? c[e] : v[e];
+				dst[e*3+2] = c[e];
 			}
 
 			template<typename T>
-			void Renderer::FilterScaleX::Blit3x(const Input& input,const Output& output)
+			void Renderer::FilterScaleX::Blit2x(const Input& input,const Output& output,const Kernel kernel,const uint first,const uint last)
 			{
-				const Input::Pixel* src = input.pixels;
-				T* dst = static_cast<T*>(output.pixels);
-				const long pad = output.pitch - long(sizeof(T) * WIDTH*3);
+				byte* dst = static_cast<byte*>(output.pixels) + output.pitch * long(first * 2);
+				Lines lines( input, first );
+				dword out[2][WIDTH];
+
+				for (uint y=last-first; y; --y)
+				{
+					lines.Next();
+
+					for (uint i=0; i < 2; ++i)
+					{
+						const dword* const rows[3] =
+						{
+							lines.rows[i ? 2 : 0],
+							lines.rows[1],
+							lines.rows[i ? 0 : 2]
+						};
+
+						kernel( rows, out );
+						Store2x( reinterpret_cast<T*>(dst), rows, out );
+						dst += output.pitch;
+					}
+				}
+			}
 
-				dst = Blit3xLine<T,0,WIDTH>( dst, src, input.palette, pad );
+			template<typename T>
+			void Renderer::FilterScaleX::Blit3x(const Input& input,const Output& output,const Kernel kernel,const uint first,const uint last)
+			{
+				byte* dst = static_cast<byte*>(output.pixels) + output.pitch * long(first * 3);
+				Lines lines( input, first );
+				dword out[2][WIDTH];
 
-				for (uint y=HEIGHT-2; y; --y)
-					dst = Blit3xLine<T,-WIDTH,WIDTH>( dst, src += WIDTH, input.palette, pad );
+				for (uint y=last-first; y; --y)
+				{
+					lines.Next();
 
-				Blit3xLine<T,-WIDTH,0>( dst, src + WIDTH, input.palette, pad );
+					for (uint i=0; i < 3; ++i)
+					{
+						T* NST_RESTRICT line = reinterpret_cast<T*>(dst);
+
+						if (i == 1)
+						{
+							const dword* const NST_RESTRICT c = lines.rows[1] + 1;
+
+							for (uint x=0; x < WIDTH; ++x)
+							{
+								line[x*3+0] = c[x];
+								line[x*3+1] = c[x];
+								line[x*3+2] = c[x];
+							}
+						}
+						else
+						{
+							const dword* const rows[3] =
+							{
+								lines.rows[i ? 2 : 0],
+								lines.rows[1],
+								lines.rows[i ? 0 : 2]
+							};
+
+							kernel( rows, out );
+							Store3x( line, rows, out );
+						}
+
+						dst += output.pitch;
+					}
+				}
 			}
+			//[SLEND]
 
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("s", on)
@@ -247,11 +367,70 @@ namespace Nes
 				}
 			}
 
+			//[SLBEGIN]: SIMD video filter kernels.
+			Renderer::FilterScaleX::Kernel Renderer::FilterScaleX::GetKernel(const RenderState& state,const Simd::Level level)
+			{
+				const bool scale2x = (state.filter == RenderState::FILTER_SCALE2X);
+
+				#ifdef NST_AVX2
+				if (level >= Simd::LEVEL_AVX2)
+					return scale2x ? &FilterScaleX::Scale2xLineAvx2 : &FilterScaleX::Scale3xLineAvx2;
+				#endif
+
+				#ifdef NST_SSE2
+				if (level >= Simd::LEVEL_SSE2)
+					return scale2x ? &FilterScaleX::Scale2xLineSse2 : &FilterScaleX::Scale3xLineSse2;
+				#endif
+
+				return scale2x ? &FilterScaleX::Scale2xLine : &FilterScaleX::Scale3xLine;
+			}
+
+			#ifdef NST_DEBUG
+
+			bool Renderer::FilterScaleX::Verify(const Kernel kernel,const Kernel reference)
+			{
+				// runs both kernels on lines with runs of equal pixels, on one
+				// line only, 'nsttools filters' compares whole frames
+
+				dword data[3][1+WIDTH+1];
+				dword out[2][2][WIDTH] = {};
+				dword seed = 1;
+
+				for (uint i=0; i < 3; ++i)
+				{
+					for (uint x=0; x < 1+WIDTH+1; ++x)
+					{
+						seed = (seed * 1664525UL + 1013904223UL) & 0xFFFFFFFF;
+
+						if (i && (seed & 0x3000))
+							data[i][x] = data[0][x];
+						else if (x && (seed & 0xC000))
+							data[i][x] = data[i][x-1];
+						else
+							data[i][x] = seed >> 29;
+					}
+				}
+
+				const dword* const rows[3] = { data[0], data[1], data[2] };
+
+				reference( rows, out[0] );
+				kernel( rows, out[1] );
+
+				return std::memcmp( out[0], out[1], sizeof(out[0]) ) == 0;
+			}
+
+			#endif
+			//[SLEND]
+
 			Renderer::FilterScaleX::FilterScaleX(const RenderState& state)
 			:
 			Filter (state),
-			path   (GetPath(state))
+			path   (GetPath(state)),
+			//[SLBEGIN]: SIMD video filter kernels.
+			kernel (GetKernel(state,Simd::GetLevel()))
 			{
+				NST_VERIFY( Verify(kernel,GetKernel(state,Simd::LEVEL_NONE)) );
+				//[SLEND]
 			}
 
 			bool Renderer::FilterScaleX::Check(const RenderState& state)
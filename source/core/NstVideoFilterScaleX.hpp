@@ -30,6 +30,10 @@
 #pragma once
 #endif
 
+//[SLBEGIN]: SIMD video filter kernels.
+#include "NstSimd.hpp"
+//[SLEND]
+
 namespace Nes
 {
 	namespace Core
@@ -48,34 +52,49 @@ namespace Nes
 
 				~FilterScaleX() {}
 
-				typedef void (*Path)(const Input&,const Output&);
+				//[SLBEGIN]: SIMD video filter kernels.
+				typedef void (*Kernel)(const dword* const (&)[3],dword (&)[2][WIDTH]);
+				typedef void (*Path)(const Input&,const Output&,Kernel,uint,uint);
 
 				static Path GetPath(const RenderState&);
+				static Kernel GetKernel(const RenderState&,Simd::Level);
 
-				void Blit(const Input&,const Output&,uint);
+				void Blit(const Input&,const Output&,uint,uint,uint);
 
-				template<typename T,int PREV,int NEXT>
-				static NST_FORCE_INLINE T* Blit2xBorder(T* NST_RESTRICT,const Input::Pixel* NST_RESTRICT,const Input::Palette&);
+				static void Scale2xLine(const dword* const (&)[3],dword (&)[2][WIDTH]);
+				static void Scale3xLine(const dword* const (&)[3],dword (&)[2][WIDTH]);
 
-				template<typename T,int PREV,int NEXT>
-				static NST_FORCE_INLINE T* Blit3xBorder(T* NST_RESTRICT,const Input::Pixel* NST_RESTRICT,const Input::Palette&);
+				#ifdef NST_SSE2
+				static void Scale2xLineSse2(const dword* const (&)[3],dword (&)[2][WIDTH]);
+				static void Scale3xLineSse2(const dword* const (&)[3],dword (&)[2][WIDTH]);
+				#endif
 
-				template<typename T>
-				static NST_FORCE_INLINE T* Blit3xCenter(T* NST_RESTRICT,const Input::Pixel* NST_RESTRICT,const Input::Palette&);
+				#ifdef NST_AVX2
+				static NST_AVX2_TARGET void Scale2xLineAvx2(const dword* const (&)[3],dword (&)[2][WIDTH]);
+				static NST_AVX2_TARGET void Scale3xLineAvx2(const dword* const (&)[3],dword (&)[2][WIDTH]);
+				#endif
+
+				#ifdef NST_DEBUG
+				static bool Verify(Kernel,Kernel);
+				#endif
 
-				template<typename T,int PREV,int NEXT>
-				static NST_FORCE_INLINE T* Blit2xLine(T*,const Input::Pixel*,const Input::Palette&,long);
+				template<typename T>
+				static NST_FORCE_INLINE void Store2x(T* NST_RESTRICT,const dword* const (&)[3],const dword (&)[2][WIDTH]);
 
-				template<typename T,int PREV,int NEXT>
-				static NST_FORCE_INLINE T* Blit3xLine(T*,const Input::Pixel*,const Input::Palette&,long);
+				template<typename T>
+				static NST_FORCE_INLINE void Store3x(T* NST_RESTRICT,const dword* const (&)[3],const dword (&)[2][WIDTH]);
 
 				template<typename T>
-				static void Blit2x(const Input&,const Output&);
+				static void Blit2x(const Input&,const Output&,Kernel,uint,uint);
 
 				template<typename T>
-				static void Blit3x(const Input&,const Output&);
+				static void Blit3x(const Input&,const Output&,Kernel,uint,uint);
+
+				class Lines;
 
 				const Path path;
+				const Kernel kernel;
+				//[SLEND]
 			};
 		}
 	}
@@ -534,13 +534,47 @@ namespace Nes
 				mask.b = 0;
 			}
 
+			//[SLBEGIN]: Duplicate frame elision.
+			Renderer::Elision::Elision()
+			:
+			enabled    (false),
+			valid      (false),
+			duplicate  (false),
+			burstPhase (0),
+			previous   (NULL)
+			{
+			}
+
+			Renderer::Elision::~Elision()
+			{
+				delete previous;
+			}
+			//[SLEND]
+
+			//[SLBEGIN]: Deferred frame pipeline.
+			struct Renderer::Frame
+			{
+				Renderer* renderer;
+				Output output;
+				uint burstPhase;
+				Input screen;
+			};
+
 			Renderer::Renderer()
-			: filter(NULL) {}
+			:
+			filter    (NULL),
+			frames    (NULL),
+			numFrames (0),
+			nextFrame (0)
+			{}
 
 			Renderer::~Renderer()
 			{
+				queue.Stop();
+				delete [] frames;
 				delete filter;
 			}
+			//[SLEND]
 
 			Result Renderer::SetState(const RenderState& renderState)
 			{
@@ -558,6 +592,13 @@ namespace Nes
 					)
 						return RESULT_NOP;
 
+					//[SLBEGIN]: Deferred frame pipeline.
+					Flush();
+					//[SLEND]
+					//[SLBEGIN]: Duplicate frame elision.
+					elision.valid = false;
+					//[SLEND]
+
 					delete filter;
 					filter = NULL;
 				}
@@ -790,26 +831,220 @@ namespace Nes
 				state.update = 0;
 			}
 
+			//[SLBEGIN]: Strip-parallel video filtering.
+			Result Renderer::SetBlitThreads(uint count)
+			{
+				Flush();
+
+				return threads.SetThreads( count );
+			}
+			//[SLEND]
+
+			//[SLBEGIN]: Deferred frame pipeline.
+			Result Renderer::SetFrameQueue(uint count)
+			{
+				if (count > MAX_QUEUED_FRAMES)
+					return RESULT_ERR_INVALID_PARAM;
+
+				if (count == numFrames)
+					return RESULT_NOP;
+
+				queue.Stop();
+
+				delete [] frames;
+				frames = NULL;
+				numFrames = 0;
+				nextFrame = 0;
+
+				if (count)
+				{
+					frames = new (std::nothrow) Frame [count];
+
+					if (!frames)
+						return RESULT_ERR_OUT_OF_MEMORY;
+
+					const Result result = queue.Start();
+
+					if (NES_FAILED(result))
+					{
+						delete [] frames;
+						frames = NULL;
+
+						return result;
+					}
+
+					for (uint i=0; i < count; ++i)
+						frames[i].renderer = this;
+
+					numFrames = count;
+				}
+
+				return RESULT_OK;
+			}
+			//[SLEND]
+
+			//[SLBEGIN]: Duplicate frame elision.
+			void Renderer::EnableDuplicateFrameSkip(bool enable)
+			{
+				if (enable && !elision.previous)
+					elision.previous = new (std::nothrow) Input;
+
+				if (!enable)
+				{
+					delete elision.previous;
+					elision.previous = NULL;
+				}
+
+				elision.enabled = (enable && elision.previous);
+				elision.valid = false;
+				elision.duplicate = false;
+			}
+			//[SLEND]
+
 			#ifdef NST_MSVC_OPTIMIZE
 			#pragma optimize("", on)
 			#endif
 
+			//[SLBEGIN]: Strip-parallel video filtering.
+			struct Renderer::Strips
+			{
+				Filter* filter;
+				const Input* input;
+				const Output* output;
+				uint burstPhase;
+			};
+
+			void Renderer::BlitStrip(void* data,uint index,uint count)
+			{
+				const Strips& strips = *static_cast<const Strips*>(data);
+
+				strips.filter->Blit
+				(
+					*strips.input,
+					*strips.output,
+					strips.burstPhase,
+					HEIGHT * index / count,
+					HEIGHT * (index+1) / count
+				);
+			}
+			//[SLEND]
+
+			//[SLBEGIN]: Deferred frame pipeline.
 			void Renderer::Blit(Output& output,Input& input,uint burstPhase)
 			{
 				if (filter)
 				{
-					if (state.update)
-						UpdateFilter( input );
+					if (numFrames)
+					{
+						// The filter is only changed while the queue is idle. Every queued
+						// frame has its own copy of the screen so the PPU can go on with
+						// the next one.
+
+						if (state.update)
+						{
+							queue.Wait();
+							UpdateFilter( input );
+						}
+
+						queue.Wait( numFrames-1 );
+
+						Frame& frame = frames[nextFrame];
+						nextFrame = (nextFrame + 1) % numFrames;
+
+						frame.output = output;
+						frame.burstPhase = burstPhase;
+						frame.screen = input;
 
-					if (Output::lockCallback( output ))
+						queue.Post( &Renderer::RenderFrame, &frame );
+					}
+					else
 					{
-						NST_VERIFY( std::labs(output.pitch) >= dword(state.width) << (filter->format.bpp / 16) );
+						if (state.update)
+							UpdateFilter( input );
+
+						Render( output, input, burstPhase );
+					}
+				}
+			}
+			//[SLEND]
 
-						if (std::labs(output.pitch) >= dword(state.width) << (filter->format.bpp / 16))
-							filter->Blit( input, output, burstPhase );
+			//[SLBEGIN]: Duplicate frame elision.
+			bool Renderer::IsDuplicate(const Input& input,const uint burstPhase)
+			{
+				// A frame matching the last one is left out, the caller keeps showing
+				// the previous picture. Any pending update means the picture changes
+				// even if the screen doesn't, and without field merging the NTSC
+				// picture depends on the burst phase.
+
+				elision.duplicate = false;
+
+				if (!elision.enabled || !filter)
+					return false;
 
-						Output::unlockCallback( output );
+				// the screen is compared in full, usually it differs early on and
+				// only a real duplicate pays for the whole comparison
+
+				const bool same =
+				(
+					elision.valid &&
+					std::memcmp( elision.previous->pixels, input.pixels, sizeof(Input::Pixel) * Input::PIXELS ) == 0
+				);
+
+				elision.duplicate =
+				(
+					same && !state.update &&
+					(burstPhase == elision.burstPhase || state.filter != RenderState::FILTER_NTSC || state.fieldMerging)
+				);
+
+				if (!same)
+					std::memcpy( elision.previous->pixels, input.pixels, sizeof(Input::Pixel) * Input::PIXELS );
+
+				elision.valid = true;
+				elision.burstPhase = burstPhase;
+
+				return elision.duplicate;
+			}
+			//[SLEND]
+
+			//[SLBEGIN]: Deferred frame pipeline.
+			void Renderer::RenderFrame(void* data)
+			{
+				Frame& frame = *static_cast<Frame*>(data);
+				frame.renderer->Render( frame.output, frame.screen, frame.burstPhase );
+			}
+
+			void Renderer::Flush(uint frames)
+			{
+				queue.Wait( frames );
+			}
+
+			void Renderer::Render(Output& output,const Input& input,uint burstPhase)
+			{
+				//[SLEND]
+				if (Output::lockCallback( output ))
+				{
+					NST_VERIFY( std::labs(output.pitch) >= dword(state.width) << (filter->format.bpp / 16) );
+
+					if (std::labs(output.pitch) >= dword(state.width) << (filter->format.bpp / 16))
+					{
+						//[SLBEGIN]: Strip-parallel video filtering.
+						// Every filter reads at most one input row outside its own strip
+						// and writes only the output rows of it, so the strips can run
+						// concurrently. The plain copy is bound by memory and isn't split.
+
+						if (threads.NumThreads() > 1 && state.filter != RenderState::FILTER_NONE)
+						{
+							Strips strips = { filter, &input, &output, burstPhase };
+							threads.Run( &Renderer::BlitStrip, &strips );
+						}
+						else
+						{
+							filter->Blit( input, output, burstPhase, 0, HEIGHT );
+						}
+						//[SLEND]
 					}
+
+					Output::unlockCallback( output );
 				}
 			}
 		}
@@ -28,6 +28,9 @@
 #include <cstdlib>
 #include "api/NstApiVideo.hpp"
 #include "NstVideoScreen.hpp"
+//[SLBEGIN]: Strip-parallel video filtering.
+#include "NstThreadPool.hpp"
+//[SLEND]
 
 #ifdef NST_PRAGMA_ONCE
 #pragma once
@@ -70,10 +73,28 @@ namespace Nes
 					DEFAULT_PALETTE = PALETTE_YUV
 				};
 
+				//[SLBEGIN]: Deferred frame pipeline.
+				enum
+				{
+					MAX_QUEUED_FRAMES = Api::Video::MAX_QUEUED_FRAMES
+				};
+				//[SLEND]
+
 				Result SetState(const RenderState&);
 				Result GetState(RenderState&) const;
 				Result SetHue(int);
 				void Blit(Output&,Input&,uint);
+				//[SLBEGIN]: Strip-parallel video filtering.
+				Result SetBlitThreads(uint);
+				//[SLEND]
+				//[SLBEGIN]: Deferred frame pipeline.
+				Result SetFrameQueue(uint);
+				void Flush(uint=0);
+				//[SLEND]
+				//[SLBEGIN]: Duplicate frame elision.
+				bool IsDuplicate(const Input&,uint);
+				void EnableDuplicateFrameSkip(bool);
+				//[SLEND]
 
 				Result SetDecoder(const Decoder&);
 
@@ -92,6 +113,34 @@ namespace Nes
 
 				void UpdateFilter(Input&);
 
+				//[SLBEGIN]: Strip-parallel video filtering.
+				struct Strips;
+
+				static void BlitStrip(void*,uint,uint);
+				//[SLEND]
+
+				//[SLBEGIN]: Deferred frame pipeline.
+				struct Frame;
+
+				void Render(Output&,const Input&,uint);
+
+				static void RenderFrame(void*);
+				//[SLEND]
+
+				//[SLBEGIN]: Duplicate frame elision.
+				struct Elision
+				{
+					Elision();
+					~Elision();
+
+					bool enabled;
+					bool valid;
+					bool duplicate;
+					uint burstPhase;
+					Input* previous;
+				};
+				//[SLEND]
+
 				class Palette
 				{
 				public:
@@ -194,7 +243,9 @@ namespace Nes
 
 					virtual ~Filter() {}
 
-					virtual void Blit(const Input&,const Output&,uint) = 0;
+					//[SLBEGIN]: Strip-parallel video filtering.
+					virtual void Blit(const Input&,const Output&,uint,uint,uint) = 0;
+					//[SLEND]
 					virtual void Transform(const byte (&)[PALETTE][3],Input::Palette&) const;
 
 					const Format format;
@@ -235,6 +286,18 @@ namespace Nes
 				Filter* filter;
 				State state;
 				Palette palette;
+				//[SLBEGIN]: Strip-parallel video filtering.
+				ThreadPool threads;
+				//[SLEND]
+				//[SLBEGIN]: Deferred frame pipeline.
+				Frame* frames;
+				uint numFrames;
+				uint nextFrame;
+				ThreadQueue queue;
+				//[SLEND]
+				//[SLBEGIN]: Duplicate frame elision.
+				Elision elision;
+				//[SLEND]
 
 			public:
 
@@ -352,6 +415,32 @@ namespace Nes
 				{
 					return filter;
 				}
+
+				//[SLBEGIN]: Strip-parallel video filtering.
+				uint GetBlitThreads() const
+				{
+					return threads.NumThreads();
+				}
+				//[SLEND]
+
+				//[SLBEGIN]: Deferred frame pipeline.
+				uint GetFrameQueue() const
+				{
+					return numFrames;
+				}
+				//[SLEND]
+
+				//[SLBEGIN]: Duplicate frame elision.
+				bool IsDuplicateFrameSkipEnabled() const
+				{
+					return elision.enabled;
+				}
+
+				bool IsFrameDuplicate() const
+				{
+					return elision.duplicate;
+				}
+				//[SLEND]
 			};
 		}
 	}
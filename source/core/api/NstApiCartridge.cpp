@@ -393,6 +393,13 @@ namespace Nes
 				emulator.imageDatabase->Unload();
 		}
 
+		//[SLBEGIN]: Compiled image database.
+		Result Cartridge::Database::Save(std::ostream& stream) const throw()
+		{
+			return emulator.imageDatabase ? emulator.imageDatabase->Save( stream ) : RESULT_ERR_NOT_READY;
+		}
+		//[SLEND]
+
 		Result Cartridge::Database::Enable(bool state) throw()
 		{
 			if (Create())
@@ -993,13 +993,15 @@ namespace Nes
 					}
 				};
 
+				//[SLBEGIN]: Compiled image database.
 				/**
-				* Resets and loads internal XML database.
+				* Resets and loads internal XML or compiled database.
 				*
 				* @param stream input stream
 				* @return result code
 				*/
 				Result Load(std::istream& stream) throw();
+				//[SLEND]
 
 				/**
 				* Resets and loads internal <b>and</b> external XML databases.
@@ -1015,6 +1017,19 @@ namespace Nes
 				*/
 				void Unload() throw();
 
+				//[SLBEGIN]: Compiled image database.
+				/**
+				* Saves the loaded databases in compiled form.
+				*
+				* Passing the compiled form to Load() restores the same databases
+				* without parsing any XML. It can't be combined with another database.
+				*
+				* @param stream output stream
+				* @return result code
+				*/
+				Result Save(std::ostream& stream) const throw();
+				//[SLEND]
+
 				/**
 				* Enables image corrections.
 				*
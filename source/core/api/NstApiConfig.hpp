@@ -51,6 +51,10 @@
 // NST_MM_INTRINSICS         - For MMX/SSE compiler intrinsics support through
 //                             xmmintrin.h/emmintrin.h/mmintrin.h. Auto-defined if
 //                             compiler is Win32 MSVC and _M_IX86 is defined.
+//[SLBEGIN]: SIMD video filter kernels.
+//                             Also auto-defined for GCC on x86 when SSE2 is enabled.
+//                             SSE2/AVX2 code paths are picked at runtime, see NstSimd.hpp.
+//[SLEND]
 //
 // NST_CALL <attribute>      - Compiler/platform specific calling convention for non-member
 //                             functions. Placed between return type and function name, e.g
@@ -102,6 +106,17 @@
 //                             this option is not worth using and Nestopia will force a
 //                             compile time error. Auto-defined if compiler is MSVC.
 //
+//[SLBEGIN]: Scoped trace hooks.
+// NST_TRACE                 - Compile in the scoped trace hooks around Machine::Execute,
+//                             SaveState and LoadState. See Core::Trace in NstTrace.hpp.
+//[SLEND]
+//
+//[SLBEGIN]: Strip-parallel video filtering.
+// NST_NO_THREADS            - Build without thread support. Video filtering then always
+//                             runs on the emulation thread. Threads use the Win32 API on
+//                             Win32 and POSIX threads elsewhere, see NstThreadPool.hpp.
+//[SLEND]
+//
 // Abbrevations:
 //
 // BC - Borland C++
@@ -225,9 +225,16 @@ namespace Nes
 				Core::State::Loader loader( &stream, true );
 
 				if (emulator.LoadState( loader, true ))
+				{
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					emulator.SetDirtyPages( false );
+					//[SLEND]
 					return RESULT_OK;
+				}
 				else
+				{
 					return RESULT_ERR_INVALID_CRC;
+				}
 			}
 			catch (Result result)
 			{
@@ -243,15 +250,20 @@ namespace Nes
 			}
 		}
 
-		Result Machine::SaveState(std::ostream& stream,Compression compression) const throw()
+		//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+		Result Machine::SaveState(std::ostream& stream,Compression compression,Snapshot snapshot) const throw()
+		//[SLEND]
 		{
 			if (!Is(GAME,ON))
 				return RESULT_ERR_NOT_READY;
 
 			try
 			{
-				Core::State::Saver saver( &stream, compression != NO_COMPRESSION, false );
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				Core::State::Saver saver( &stream, compression != NO_COMPRESSION, false, 0, snapshot == INCREMENTAL_SNAPSHOT );
 				emulator.SaveState( saver );
+				emulator.SetDirtyPages( false );
+				//[SLEND]
 			}
 			catch (Result result)
 			{
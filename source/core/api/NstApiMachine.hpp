@@ -293,6 +293,24 @@ namespace Nes
 				USE_COMPRESSION
 			};
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			/**
+			* Amount of memory written to a state.
+			*/
+			enum Snapshot
+			{
+				/**
+				* Complete state (default).
+				*/
+				FULL_SNAPSHOT,
+				/**
+				* Only the RAM pages written since the last state was loaded or saved.
+				* It must be loaded on top of that state to be restored correctly.
+				*/
+				INCREMENTAL_SNAPSHOT
+			};
+			//[SLEND]
+
 			/**
 			* Loads a state.
 			*
@@ -301,14 +319,17 @@ namespace Nes
 			*/
 			Result LoadState(std::istream& stream) throw();
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
 			/**
 			* Saves a state.
 			*
 			* @param stream output stream which the state will be written to
 			* @param compression to allow internal compression in the state, default is USE_COMPRESSION
+			* @param snapshot to only write RAM pages changed since the last state, default is FULL_SNAPSHOT
 			* @return result code
 			*/
-			Result SaveState(std::ostream& stream,Compression compression=USE_COMPRESSION) const throw();
+			Result SaveState(std::ostream& stream,Compression compression=USE_COMPRESSION,Snapshot snapshot=FULL_SNAPSHOT) const throw();
+			//[SLEND]
 
 			/**
 			* Returns a machine state.
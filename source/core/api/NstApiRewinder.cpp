@@ -72,6 +72,49 @@ namespace Nes
 			emulator.tracker.EnableRewinderSound( enable );
 		}
 
+		//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+		void Rewinder::SetNumKeys(uint keys) throw()
+		{
+			try
+			{
+				emulator.tracker.SetRewinderKeys( keys );
+			}
+			catch (...)
+			{
+			}
+		}
+
+		uint Rewinder::GetNumKeys() const throw()
+		{
+			return emulator.tracker.GetRewinderKeys();
+		}
+		//[SLEND]
+
+		//[SLBEGIN]: Multi-resolution rewind history.
+		void Rewinder::SetHistorySize(ulong bytes) throw()
+		{
+			emulator.tracker.SetRewinderHistory( bytes );
+		}
+
+		ulong Rewinder::GetHistorySize() const throw()
+		{
+			return emulator.tracker.GetRewinderHistory();
+		}
+
+		ulong Rewinder::GetHistoryLength() const throw()
+		{
+			return emulator.tracker.GetRewinderHistoryLength();
+		}
+
+		Result Rewinder::Seek(ulong frames) throw()
+		{
+			if (emulator.Is(Machine::GAME,Machine::ON))
+				return emulator.tracker.SeekRewinder( frames );
+
+			return RESULT_ERR_NOT_READY;
+		}
+		//[SLEND]
+
 		Rewinder::Direction Rewinder::GetDirection() const throw()
 		{
 			return emulator.tracker.IsRewinding() ? BACKWARD : FORWARD;
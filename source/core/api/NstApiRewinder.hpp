@@ -110,6 +110,67 @@ namespace Nes
 			*/
 			bool IsSoundEnabled() const throw();
 
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			/**
+			* Sets how far back the rewinder can go.
+			*
+			* Each key covers 60 frames, so the default of 60 keys is about a minute
+			* of NTSC play. Changing it clears the rewind history.
+			*
+			* @param keys number of keys, clamped to 3 and 3600
+			*/
+			void SetNumKeys(uint keys) throw();
+
+			/**
+			* Returns how many keys the rewinder keeps.
+			*
+			* @return number of keys
+			*/
+			uint GetNumKeys() const throw();
+			//[SLEND]
+
+			//[SLBEGIN]: Multi-resolution rewind history.
+			/**
+			* Sets the memory budget of the history kept beyond the keys.
+			*
+			* Keys that drop out of the rewinder are kept as keyframes that get
+			* sparser the older they are, together with the input in between, so
+			* any frame in the history can be reached with Seek(). When the budget
+			* is exceeded the oldest part of the history is dropped. The default is
+			* 16 MB.
+			*
+			* @param bytes size in bytes, clamped to 1 MB and 1 GB
+			*/
+			void SetHistorySize(ulong bytes) throw();
+
+			/**
+			* Returns the memory budget of the history.
+			*
+			* @return size in bytes
+			*/
+			ulong GetHistorySize() const throw();
+
+			/**
+			* Returns how many frames back Seek() can go.
+			*
+			* @return number of frames, 0 while rewinding
+			*/
+			ulong GetHistoryLength() const throw();
+
+			/**
+			* Goes back a number of frames and carries on recording from there.
+			*
+			* Loads the nearest key or keyframe before the target and replays the
+			* recorded input up to it, which is at most a few thousand frames of
+			* emulation without video or sound. Everything after the target is
+			* dropped.
+			*
+			* @param frames number of frames to go back, at most GetHistoryLength()
+			* @return result code
+			*/
+			Result Seek(ulong frames) throw();
+			//[SLEND]
+
 			/**
 			* Sets direction.
 			*
@@ -0,0 +1,399 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <new>
+#include <sstream>
+#include "../NstMachine.hpp"
+#include "../NstState.hpp"
+#include "../NstImage.hpp"
+#include "../NstVector.hpp"
+#include "NstApiEmulator.hpp"
+#include "NstApiSound.hpp"
+#include "NstApiVideo.hpp"
+#include "NstApiVerifier.hpp"
+
+namespace Nes
+{
+	namespace Api
+	{
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("s", on)
+		#endif
+
+		class Verifier::Instance
+		{
+		public:
+
+			Instance(Core::Machine&,std::istream&,const Configuration&);
+			~Instance();
+
+			Result Begin();
+			Result Execute();
+
+			static void Hash(const Core::Machine&,FrameHash&);
+
+		private:
+
+			void RoundTrip();
+			void Save(std::stringstream&,bool);
+			void Load(std::stringstream&);
+
+			static FrameHash::Value Fnv(const std::string&);
+
+			Core::Machine& machine;
+			std::istream& movie;
+			const Configuration& configuration;
+			Core::Video::Output video;
+			Core::Sound::Output sound;
+			Core::Vector<byte> pixels;
+			Core::Vector<byte> samples;
+			std::stringstream parent;
+			bool hasParent;
+			ulong frame;
+
+		public:
+
+			bool IsPlaying() const
+			{
+				return machine.tracker.IsMoviePlaying();
+			}
+		};
+
+		Verifier::Instance::Instance(Core::Machine& m,std::istream& s,const Configuration& c)
+		:
+		machine       (m),
+		movie         (s),
+		configuration (c),
+		hasParent     (false),
+		frame         (0)
+		{
+			sound.samples[0] = NULL;
+			sound.samples[1] = NULL;
+			sound.length[0] = 0;
+			sound.length[1] = 0;
+		}
+
+		Verifier::Instance::~Instance()
+		{
+			machine.tracker.StopMovie();
+		}
+
+		Result Verifier::Instance::Begin()
+		{
+			if (configuration.video)
+			{
+				Video::RenderState renderState;
+
+				renderState.bits.count  = 32;
+				renderState.bits.mask.r = 0x00FF0000;
+				renderState.bits.mask.g = 0x0000FF00;
+				renderState.bits.mask.b = 0x000000FF;
+				renderState.width       = Core::Video::Output::WIDTH;
+				renderState.height      = Core::Video::Output::HEIGHT;
+				renderState.filter      = Video::RenderState::FILTER_NONE;
+
+				const Result result = Video(machine).SetRenderState( renderState );
+
+				if (NES_FAILED(result))
+					return result;
+
+				pixels.Resize( Core::Video::Output::WIDTH * Core::Video::Output::HEIGHT * 4 );
+				video.pixels = pixels.Begin();
+				video.pitch = Core::Video::Output::WIDTH * 4;
+			}
+
+			if (configuration.sound)
+			{
+				const Sound api( machine );
+				const uint length = api.GetSampleRate() / 50 + 1;
+
+				samples.Resize( length * (api.GetSampleBits() / 8) * (api.GetSpeaker() == Sound::SPEAKER_STEREO ? 2 : 1) );
+				sound.samples[0] = samples.Begin();
+				sound.length[0] = length;
+			}
+
+			return machine.tracker.PlayMovie( machine, movie );
+		}
+
+		Result Verifier::Instance::Execute()
+		{
+			const Result result = machine.tracker.Execute
+			(
+				machine,
+				configuration.video ? &video : NULL,
+				configuration.sound ? &sound : NULL,
+				NULL
+			);
+
+			if (NES_SUCCEEDED(result) && configuration.snapshotInterval && ++frame % configuration.snapshotInterval == 0)
+				RoundTrip();
+
+			return result;
+		}
+
+		void Verifier::Instance::RoundTrip()
+		{
+			if (configuration.snapshot == Machine::INCREMENTAL_SNAPSHOT)
+			{
+				if (hasParent)
+				{
+					std::stringstream delta;
+
+					Save( delta, true );
+					Load( parent );
+					Load( delta );
+				}
+
+				parent.str( std::string() );
+				Save( parent, false );
+				hasParent = true;
+			}
+			else
+			{
+				std::stringstream full;
+
+				Save( full, false );
+				Load( full );
+			}
+		}
+
+		void Verifier::Instance::Save(std::stringstream& stream,const bool incremental)
+		{
+			std::ostream& out = stream;
+
+			{
+				Core::State::Saver saver( &out, false, false, 0, incremental );
+				machine.SaveState( saver );
+			}
+
+			machine.SetDirtyPages( false );
+		}
+
+		void Verifier::Instance::Load(std::stringstream& stream)
+		{
+			stream.clear();
+			stream.seekg( 0 );
+
+			std::istream& in = stream;
+
+			{
+				Core::State::Loader loader( &in, false );
+
+				if (!machine.LoadState( loader, false ))
+					throw RESULT_ERR_CORRUPT_FILE;
+			}
+
+			machine.SetDirtyPages( false );
+		}
+
+		Verifier::FrameHash::Value Verifier::Instance::Fnv(const std::string& data)
+		{
+			FrameHash::Value hash = 0xCBF29CE484222325ULL;
+
+			for (std::string::const_iterator it(data.begin()), end(data.end()); it != end; ++it)
+				hash = (hash ^ byte(*it)) * 0x100000001B3ULL;
+
+			return hash;
+		}
+
+		void Verifier::Instance::Hash(const Core::Machine& machine,FrameHash& hash)
+		{
+			for (uint i=0; i < NUM_SUBSYSTEMS; ++i)
+			{
+				std::ostringstream stream;
+				std::ostream& out = stream;
+
+				{
+					Core::State::Saver saver( &out, false, false );
+
+					switch (i)
+					{
+						case SUBSYSTEM_CPU:   machine.cpu.SaveState( saver, Core::AsciiId<'C','P','U'>::V, Core::AsciiId<'A','P','U'>::V ); break;
+						case SUBSYSTEM_PPU:   machine.ppu.SaveState( saver, Core::AsciiId<'P','P','U'>::V ); break;
+						case SUBSYSTEM_IMAGE: machine.image->SaveState( saver, Core::AsciiId<'I','M','G'>::V ); break;
+					}
+				}
+
+				hash.subsystems[i] = Fnv( stream.str() );
+			}
+		}
+
+		Verifier::FrameHash::FrameHash() throw()
+		{
+			for (uint i=0; i < NUM_SUBSYSTEMS; ++i)
+				subsystems[i] = 0;
+		}
+
+		Verifier::FrameHash::Value Verifier::FrameHash::Combined() const throw()
+		{
+			FrameHash::Value hash = 0xCBF29CE484222325ULL;
+
+			for (uint i=0; i < NUM_SUBSYSTEMS; ++i)
+				hash = (hash ^ subsystems[i]) * 0x100000001B3ULL;
+
+			return hash;
+		}
+
+		Verifier::Configuration::Configuration() throw()
+		:
+		video            (false),
+		sound            (false),
+		snapshotInterval (0),
+		snapshot         (Machine::FULL_SNAPSHOT)
+		{
+		}
+
+		Verifier::Divergence::Divergence() throw()
+		:
+		frame     (NONE),
+		frames    (0),
+		subsystem (SUBSYSTEM_CPU)
+		{
+		}
+
+		Result Verifier::GetFrameHash(FrameHash& hash) const throw()
+		{
+			if (!emulator.Is(Machine::GAME,Machine::ON))
+				return RESULT_ERR_NOT_READY;
+
+			try
+			{
+				Instance::Hash( emulator, hash );
+			}
+			catch (Result result)
+			{
+				return result;
+			}
+			catch (const std::bad_alloc&)
+			{
+				return RESULT_ERR_OUT_OF_MEMORY;
+			}
+			catch (...)
+			{
+				return RESULT_ERR_GENERIC;
+			}
+
+			return RESULT_OK;
+		}
+
+		Result Verifier::Run
+		(
+			std::istream& movie,
+			const Configuration& configuration,
+			Emulator& other,
+			std::istream& otherMovie,
+			const Configuration& otherConfiguration,
+			const ulong maxFrames,
+			Divergence& divergence,
+			std::ostream* const trace
+		)   throw()
+		{
+			Core::Machine& otherMachine = other;
+
+			if (&otherMachine == &emulator || !emulator.Is(Machine::GAME) || !otherMachine.Is(Machine::GAME))
+				return RESULT_ERR_NOT_READY;
+
+			divergence = Divergence();
+
+			try
+			{
+				Instance first( emulator, movie, configuration );
+				Instance second( otherMachine, otherMovie, otherConfiguration );
+				Instance* const instances[2] = { &first, &second };
+
+				for (uint i=0; i < 2; ++i)
+				{
+					const Result result = instances[i]->Begin();
+
+					if (NES_FAILED(result))
+						return result;
+				}
+
+				while (divergence.frames < maxFrames && first.IsPlaying() && second.IsPlaying())
+				{
+					for (uint i=0; i < 2; ++i)
+					{
+						const Result result = instances[i]->Execute();
+
+						if (NES_FAILED(result))
+							return result;
+
+						Instance::Hash( i ? otherMachine : emulator, divergence.hashes[i] );
+					}
+
+					if (trace)
+					{
+						*trace << divergence.frames;
+
+						for (uint i=0; i < NUM_SUBSYSTEMS; ++i)
+						{
+							char hex[16+1];
+
+							for (uint j=0; j < 16; ++j)
+								hex[j] = "0123456789abcdef"[divergence.hashes[0].subsystems[i] >> (60 - j * 4) & 0xF];
+
+							hex[16] = '\0';
+							*trace << '\t' << hex;
+						}
+
+						*trace << '\n';
+					}
+
+					for (uint i=0; i < NUM_SUBSYSTEMS; ++i)
+					{
+						if (divergence.hashes[0].subsystems[i] != divergence.hashes[1].subsystems[i])
+						{
+							divergence.frame = divergence.frames;
+							divergence.subsystem = static_cast<Subsystem>(i);
+							break;
+						}
+					}
+
+					++divergence.frames;
+
+					if (divergence.frame != Divergence::NONE)
+						break;
+				}
+			}
+			catch (Result result)
+			{
+				return result;
+			}
+			catch (const std::bad_alloc&)
+			{
+				return RESULT_ERR_OUT_OF_MEMORY;
+			}
+			catch (...)
+			{
+				return RESULT_ERR_GENERIC;
+			}
+
+			return RESULT_OK;
+		}
+
+		#ifdef NST_MSVC_OPTIMIZE
+		#pragma optimize("", on)
+		#endif
+	}
+}
@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NST_API_VERIFIER_H
+#define NST_API_VERIFIER_H
+
+#include <iosfwd>
+#include "NstApiMachine.hpp"
+
+#ifdef NST_PRAGMA_ONCE
+#pragma once
+#endif
+
+#if NST_ICC >= 810
+#pragma warning( push )
+#pragma warning( disable : 304 444 )
+#elif NST_MSVC >= 1200
+#pragma warning( push )
+#pragma warning( disable : 4512 )
+#endif
+
+namespace Nes
+{
+	namespace Api
+	{
+		class Emulator;
+
+		/**
+		* Deterministic replay verifier interface.
+		*
+		* Plays the same movie on two emulator instances in lockstep and
+		* compares a hash of their state after every frame.
+		*/
+		class Verifier : public Base
+		{
+		public:
+
+			/**
+			* Interface constructor.
+			*
+			* @param instance emulator instance
+			*/
+			template<typename T>
+			Verifier(T& instance)
+			: Base(instance) {}
+
+			/**
+			* Hashed part of the machine.
+			*/
+			enum Subsystem
+			{
+				/**
+				* CPU registers, RAM and APU.
+				*/
+				SUBSYSTEM_CPU,
+				/**
+				* PPU registers, OAM, palette and name tables.
+				*/
+				SUBSYSTEM_PPU,
+				/**
+				* Cartridge, disk or sound image including mapper state.
+				*/
+				SUBSYSTEM_IMAGE,
+				/**
+				* Number of subsystems.
+				*/
+				NUM_SUBSYSTEMS
+			};
+
+			/**
+			* Per-frame state hash.
+			*/
+			struct FrameHash
+			{
+				FrameHash() throw();
+
+				/**
+				* 64-bit hash value.
+				*/
+				typedef unsigned long long Value;
+
+				/**
+				* FNV-1a hash of each subsystem's state.
+				*/
+				Value subsystems[NUM_SUBSYSTEMS];
+
+				/**
+				* Returns a single hash of all subsystems.
+				*
+				* @return hash
+				*/
+				Value Combined() const throw();
+			};
+
+			/**
+			* Emulation settings for one side of a verification run.
+			*/
+			struct Configuration
+			{
+				Configuration() throw();
+
+				/**
+				* Render video every frame, default is false.
+				*/
+				bool video;
+
+				/**
+				* Render sound every frame, default is false.
+				*/
+				bool sound;
+
+				/**
+				* Save and reload the state every N frames, 0 (default) to disable.
+				*/
+				uint snapshotInterval;
+
+				/**
+				* Type of state used for the reload, default is FULL_SNAPSHOT.
+				*
+				* With INCREMENTAL_SNAPSHOT the previous full state is restored first
+				* and the incremental state is loaded on top of it.
+				*/
+				Machine::Snapshot snapshot;
+			};
+
+			/**
+			* Verification result.
+			*/
+			struct Divergence
+			{
+				Divergence() throw();
+
+				enum
+				{
+					NONE = 0xFFFFFFFF
+				};
+
+				/**
+				* First frame that differs, NONE if both runs matched.
+				*/
+				ulong frame;
+
+				/**
+				* Number of frames compared.
+				*/
+				ulong frames;
+
+				/**
+				* First subsystem that differs.
+				*/
+				Subsystem subsystem;
+
+				/**
+				* Hashes of the differing frame for this and the other instance.
+				*/
+				FrameHash hashes[2];
+			};
+
+			/**
+			* Hashes the current machine state.
+			*
+			* @param hash object to be filled
+			* @return result code
+			*/
+			Result GetFrameHash(FrameHash& hash) const throw();
+
+			/**
+			* Plays a movie on this and another instance and compares every frame.
+			*
+			* Both instances must have the same image loaded.
+			*
+			* @param movie movie stream for this instance
+			* @param configuration settings for this instance
+			* @param other the other emulator instance
+			* @param otherMovie movie stream for the other instance
+			* @param otherConfiguration settings for the other instance
+			* @param maxFrames frames to run at most, or until either movie ends
+			* @param divergence object to be filled with the result
+			* @param trace optional stream receiving one line of hashes per frame of this instance
+			* @return result code
+			*/
+			Result Run
+			(
+				std::istream& movie,
+				const Configuration& configuration,
+				Emulator& other,
+				std::istream& otherMovie,
+				const Configuration& otherConfiguration,
+				ulong maxFrames,
+				Divergence& divergence,
+				std::ostream* trace=NULL
+			)   throw();
+
+		private:
+
+			class Instance;
+		};
+	}
+}
+
+#if NST_MSVC >= 1200 || NST_ICC >= 810
+#pragma warning( pop )
+#endif
+
+#endif
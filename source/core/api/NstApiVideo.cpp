@@ -163,6 +163,60 @@ namespace Nes
 			return emulator.renderer.IsFieldMergingEnabled();
 		}
 
+		//[SLBEGIN]: Strip-parallel video filtering.
+		Result Video::SetBlitThreads(uint threads) throw()
+		{
+			if (!threads)
+			{
+				threads = Core::ThreadPool::NumProcessors();
+
+				if (threads > Core::ThreadPool::MAX_THREADS)
+					threads = Core::ThreadPool::MAX_THREADS;
+			}
+
+			return emulator.renderer.SetBlitThreads( threads );
+		}
+
+		uint Video::GetBlitThreads() const throw()
+		{
+			return emulator.renderer.GetBlitThreads();
+		}
+		//[SLEND]
+
+		//[SLBEGIN]: Deferred frame pipeline.
+		Result Video::SetFrameQueue(uint frames) throw()
+		{
+			return emulator.renderer.SetFrameQueue( frames );
+		}
+
+		uint Video::GetFrameQueue() const throw()
+		{
+			return emulator.renderer.GetFrameQueue();
+		}
+
+		void Video::Flush(uint frames) throw()
+		{
+			emulator.renderer.Flush( frames );
+		}
+		//[SLEND]
+
+		//[SLBEGIN]: Duplicate frame elision.
+		void Video::EnableDuplicateFrameSkip(bool state) throw()
+		{
+			emulator.renderer.EnableDuplicateFrameSkip( state );
+		}
+
+		bool Video::IsDuplicateFrameSkipEnabled() const throw()
+		{
+			return emulator.renderer.IsDuplicateFrameSkipEnabled();
+		}
+
+		bool Video::IsFrameDuplicate() const throw()
+		{
+			return emulator.renderer.IsFrameDuplicate();
+		}
+		//[SLEND]
+
 		Result Video::SetRenderState(const RenderState& state) throw()
 		{
 			const Result result = emulator.renderer.SetState( state );
@@ -183,6 +237,9 @@ namespace Nes
 			if (emulator.renderer.IsReady())
 			{
 				emulator.renderer.Blit( output, emulator.ppu.GetScreen(), emulator.ppu.GetBurstPhase() );
+				//[SLBEGIN]: Deferred frame pipeline.
+				emulator.renderer.Flush();
+				//[SLEND]
 				return RESULT_OK;
 			}
 
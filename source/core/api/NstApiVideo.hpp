@@ -207,6 +207,13 @@ namespace Nes
 				MAX_HUE                         =  +45
 			};
 
+			//[SLBEGIN]: Deferred frame pipeline.
+			enum
+			{
+				MAX_QUEUED_FRAMES = 3
+			};
+			//[SLEND]
+
 			/**
 			* Allows the PPU to render more than eight sprites per line.
 			*
@@ -371,6 +378,87 @@ namespace Nes
 			*/
 			bool IsFieldMergingEnabled() const throw();
 
+			//[SLBEGIN]: Strip-parallel video filtering.
+			/**
+			* Sets the number of threads used for filtering each frame.
+			*
+			* The frame is split into horizontal strips, one per thread, with the
+			* emulation thread doing one of them. Filters other than FILTER_NONE
+			* benefit from it.
+			*
+			* @param threads thread count, 1 (default) to filter on the emulation thread only or 0 for one per processor
+			* @return result code
+			*/
+			Result SetBlitThreads(uint threads) throw();
+
+			/**
+			* Returns the number of threads used for filtering each frame.
+			*
+			* @return thread count
+			*/
+			uint GetBlitThreads() const throw();
+			//[SLEND]
+
+			//[SLBEGIN]: Deferred frame pipeline.
+			/**
+			* Sets the number of frames that can be queued for rendering.
+			*
+			* With a queue, executing a frame only copies the finished NES screen.
+			* Palette conversion, filtering and the lock and unlock callbacks then
+			* run on a separate thread while emulation continues with the next
+			* frame. The callbacks must be safe to call from that thread. The surface
+			* given to Emulator::Execute must stay valid until the frame is rendered,
+			* see Flush().
+			*
+			* @param frames 0 (default) to render inside Emulator::Execute, up to MAX_QUEUED_FRAMES otherwise
+			* @return result code
+			*/
+			Result SetFrameQueue(uint frames) throw();
+
+			/**
+			* Returns the number of frames that can be queued for rendering.
+			*
+			* @return frame count, 0 if rendering is done inside Emulator::Execute
+			*/
+			uint GetFrameQueue() const throw();
+
+			/**
+			* Waits until queued frames have been rendered.
+			*
+			* @param frames number of frames that may still be pending, 0 (default) to wait for all
+			*/
+			void Flush(uint frames=0) throw();
+			//[SLEND]
+
+			//[SLBEGIN]: Duplicate frame elision.
+			/**
+			* Enables skipping of duplicate frames.
+			*
+			* Emulator::Execute hashes each finished NES screen. If it matches the last
+			* one and no render setting changed in between, the frame isn't filtered
+			* and the video output, including the lock and unlock callbacks, is left
+			* alone. The caller must then show the previous picture again, see
+			* IsFrameDuplicate(). Disabled by default.
+			*
+			* @param state true to enable
+			*/
+			void EnableDuplicateFrameSkip(bool state) throw();
+
+			/**
+			* Checks if duplicate frames are skipped.
+			*
+			* @return true if enabled
+			*/
+			bool IsDuplicateFrameSkipEnabled() const throw();
+
+			/**
+			* Checks if the last frame was a duplicate and wasn't rendered.
+			*
+			* @return true if the video output of the last Emulator::Execute was left untouched
+			*/
+			bool IsFrameDuplicate() const throw();
+			//[SLEND]
+
 			/**
 			* Performs a manual blit to the video output object.
 			*
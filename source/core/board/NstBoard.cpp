@@ -357,6 +357,13 @@ namespace Nes
 
 				vram.Fill( 0x00 );
 
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				if (const uint size = board.GetWram())
+					wrkDirty.Attach( wrk.Source(0).Mem(), size );
+
+				ppu.GetVramDirtyPages().Attach( vram.Mem(), vram.Size() );
+				//[SLEND]
+
 				if (Log::Available())
 				{
 					Log log;
@@ -453,11 +460,13 @@ namespace Nes
 			{
 				state.Begin( baseChunk );
 
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
 				if (const uint size = board.GetWram())
-					state.Begin( AsciiId<'W','R','M'>::V ).Compress( wrk.Source().Mem(), size ).End();
+					state.Begin( AsciiId<'W','R','M'>::V ).Compress( wrk.Source().Mem(), size, wrkDirty ).End();
 
 				if (const uint size = board.GetVram())
-					state.Begin( AsciiId<'V','R','M'>::V ).Compress( vram.Mem(), size ).End();
+					state.Begin( AsciiId<'V','R','M'>::V ).Compress( vram.Mem(), size, ppu.GetVramDirtyPages() ).End();
+				//[SLEND]
 
 				prg.SaveState( state, AsciiId<'P','R','G'>::V );
 				chr.SaveState( state, AsciiId<'C','H','R'>::V );
@@ -469,6 +478,13 @@ namespace Nes
 				state.End();
 			}
 
+			//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+			void Board::SetDirtyPages(bool dirty)
+			{
+				wrkDirty.Set( dirty );
+			}
+			//[SLEND]
+
 			void Board::LoadState(State::Loader& state)
 			{
 				while (const dword chunk = state.Begin())
@@ -634,7 +650,12 @@ namespace Nes
 				NST_VERIFY( wrk.Writable(0) );
 
 				if (wrk.Writable(0))
+				{
 					wrk[0][address - 0x6000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk[0] + (address - 0x6000) );
+					//[SLEND]
+				}
 			}
 
 			NES_PEEK_A(Board,Wram_6)
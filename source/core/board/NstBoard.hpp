@@ -664,6 +664,10 @@ namespace Nes
 				void SaveState(State::Saver&,dword) const;
 				void LoadState(State::Loader&);
 
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				void SetDirtyPages(bool);
+				//[SLEND]
+
 				enum Event
 				{
 					EVENT_END_FRAME,
@@ -689,7 +693,12 @@ namespace Nes
 			protected:
 
 				explicit Board(const Context&);
-				virtual ~Board() {}
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				virtual ~Board()
+				{
+					ppu.GetVramDirtyPages().Detach();
+				}
+				//[SLEND]
 
 				typedef Memory<SIZE_32K,SIZE_8K,2> Prg;
 				typedef Memory<SIZE_8K,SIZE_8K,2> Wrk;
@@ -705,6 +714,9 @@ namespace Nes
 				Wrk wrk;
 				const Vram vram;
 				const Type board;
+				//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+				DirtyPages wrkDirty;
+				//[SLEND]
 
 			private:
 
@@ -101,7 +101,12 @@ namespace Nes
 						NST_VERIFY( wrk.Writable(0) );
 
 						if (wrk.Writable(0))
+						{
 							wrk[0][address - 0x6000] = data;
+							//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+							wrkDirty.Mark( wrk[0] + (address - 0x6000) );
+							//[SLEND]
+						}
 					}
 					else
 					{
@@ -87,6 +87,9 @@ namespace Nes
 				NES_POKE_AD(B2708,6000)
 				{
 					wrk.Source()[address - 0x6000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk.Source().Mem(address - 0x6000) );
+					//[SLEND]
 				}
 
 				NES_POKE_D(B2708,8000)
@@ -102,6 +105,9 @@ namespace Nes
 				NES_POKE_AD(B2708,B800)
 				{
 					wrk.Source()[address - 0x9800] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk.Source().Mem(address - 0x9800) );
+					//[SLEND]
 				}
 
 				NES_PEEK_A(B2708,C000)
@@ -63,6 +63,9 @@ namespace Nes
 				NES_POKE_AD(GeniusMerioBros,7000)
 				{
 					wrk[0][address & 0x7FF] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk[0] + (address & 0x7FF) );
+					//[SLEND]
 				}
 			}
 		}
@@ -95,6 +95,9 @@ namespace Nes
 				NES_POKE_AD(Sbx,4400)
 				{
 					*wrk.Source(0).Mem(address - 0x4400) = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk.Source(0).Mem(address - 0x4400) );
+					//[SLEND]
 				}
 
 				NES_PEEK_A(Sbx,6000)
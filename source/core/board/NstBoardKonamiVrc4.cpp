@@ -187,6 +187,9 @@ namespace Nes
 				NES_POKE_AD(Vrc4,6000)
 				{
 					wrk[0][address - 0x6000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk[0] + (address - 0x6000) );
+					//[SLEND]
 				}
 
 				NES_POKE_D(Vrc4,8000)
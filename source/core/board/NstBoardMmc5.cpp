@@ -1464,7 +1464,12 @@ namespace Nes
 				NST_VERIFY( (banks.security & Banks::CAN_WRITE_6) == Banks::CAN_WRITE_6 );
 
 				if ((banks.security & Banks::CAN_WRITE_6) == Banks::CAN_WRITE_6)
+				{
 					wrk[0][address - 0x6000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk[0] + (address - 0x6000) );
+					//[SLEND]
+				}
 			}
 
 			NES_POKE_AD(Mmc5,8000)
@@ -1472,7 +1477,12 @@ namespace Nes
 				NST_VERIFY( (banks.security & Banks::CAN_WRITE_8) == Banks::CAN_WRITE_8 );
 
 				if ((banks.security & Banks::CAN_WRITE_8) == Banks::CAN_WRITE_8)
+				{
 					prg[0][address - 0x8000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( prg[0] + (address - 0x8000) );
+					//[SLEND]
+				}
 			}
 
 			NES_POKE_AD(Mmc5,A000)
@@ -1480,7 +1490,12 @@ namespace Nes
 				NST_VERIFY( (banks.security & Banks::CAN_WRITE_A) == Banks::CAN_WRITE_A );
 
 				if ((banks.security & Banks::CAN_WRITE_A) == Banks::CAN_WRITE_A)
+				{
 					prg[1][address - 0xA000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( prg[1] + (address - 0xA000) );
+					//[SLEND]
+				}
 			}
 
 			NES_POKE_AD(Mmc5,C000)
@@ -1488,7 +1503,12 @@ namespace Nes
 				NST_VERIFY( (banks.security & Banks::CAN_WRITE_C) == Banks::CAN_WRITE_C );
 
 				if ((banks.security & Banks::CAN_WRITE_C) == Banks::CAN_WRITE_C)
+				{
 					prg[2][address - 0xC000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( prg[2] + (address - 0xC000) );
+					//[SLEND]
+				}
 			}
 
 			NES_PEEK_A(Mmc5,6000)
@@ -58,6 +58,9 @@ namespace Nes
 				NES_POKE_AD(Edu2000,6000)
 				{
 					wrk[0][address - 0x6000] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk[0] + (address - 0x6000) );
+					//[SLEND]
 				}
 
 				NES_POKE_D(Edu2000,8000)
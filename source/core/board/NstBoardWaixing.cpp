@@ -164,6 +164,9 @@ namespace Nes
 				NES_POKE_AD(TypeI,5000)
 				{
 					wrk.Source()[address-(0x5000-0x2000)] = data;
+					//[SLBEGIN]: Dirty-page tracking for incremental savestates.
+					wrkDirty.Mark( wrk.Source().Mem(address-(0x5000-0x2000)) );
+					//[SLEND]
 				}
 
 				NES_POKE_AD(TypeF,8001)
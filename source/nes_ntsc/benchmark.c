@@ -1,4 +1,7 @@
 /* Measures performance of blitter, useful for improving a custom blitter.
+Also times the AVX2 blitter built from nes_ntsc_avx2.h against the scalar one
+and reports the largest difference between their outputs. Build with the
+library source, e.g. gcc -O2 benchmark.c -x c nes_ntsc.inl
 NOTE: This assumes that the process is getting 100% CPU time; you might need to
 arrange for this or else the performance will be reported lower than it really is. */
 
@@ -8,6 +11,30 @@ arrange for this or else the performance will be reported lower than it really i
 #include <stdio.h>
 #include <time.h>
 
+#if defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) && \
+		(defined (__i386__) || defined (__x86_64__))
+	#define HAVE_AVX2 1
+	#define AVX2_TARGET __attribute__((target("avx2")))
+	#define avx2_supported() __builtin_cpu_supports( "avx2" )
+#elif defined (_MSC_VER) && _MSC_VER >= 1700 && (defined (_M_IX86) || defined (_M_X64))
+	#include <intrin.h>
+	#define HAVE_AVX2 1
+	#define AVX2_TARGET
+	static int avx2_supported( void )
+	{
+		int info [4];
+		__cpuid( info, 1 );
+		if ( (info [2] & 0x18000000) != 0x18000000 || (_xgetbv( 0 ) & 6) != 6 )
+			return 0;
+		__cpuidex( info, 7, 0 );
+		return info [1] >> 5 & 1;
+	}
+#endif
+
+#ifdef HAVE_AVX2
+	#include "nes_ntsc_avx2.h"
+#endif
+
 enum { in_width   = 256 };
 enum { in_height  = 240 };
 
@@ -19,15 +46,88 @@ struct data_t
 	nes_ntsc_t ntsc;
 	unsigned char  in  [ in_height] [ in_width];
 	unsigned short out [out_height] [out_width];
+	unsigned short out_simd [out_height] [out_width];
 };
 
-static int time_blitter( void );
+typedef void (*blitter_t)( struct data_t* );
+
+static double time_blitter( blitter_t, struct data_t* );
+
+static void blit_scalar( struct data_t* data )
+{
+	nes_ntsc_blit( &data->ntsc, data->in [0], in_width, 0,
+		in_width, in_height, data->out [0], sizeof data->out [0] );
+}
+
+#ifdef HAVE_AVX2
+
+/* same as nes_ntsc_blit() using the AVX2 interface */
+static AVX2_TARGET void blit_avx2( struct data_t* data )
+{
+	int burst_phase = 0;
+	int y;
+	for ( y = 0; y < in_height; y++ )
+	{
+		unsigned char const* line_in = data->in [y];
+		unsigned short* line_out = data->out_simd [y];
+		int n;
+		__m256i raw;
+		NES_NTSC_AVX2_BEGIN_ROW( &data->ntsc, burst_phase,
+				nes_ntsc_black, nes_ntsc_black, *line_in );
+		++line_in;
+
+		for ( n = (in_width - 1) / nes_ntsc_in_chunk; n; --n )
+		{
+			NES_NTSC_AVX2_COLOR_IN( line_in [0], line_in [1], line_in [2], raw );
+			NES_NTSC_AVX2_STORE_8( line_out, NES_NTSC_AVX2_RGB_OUT( raw, 16 ), 16 );
+			line_in  += 3;
+			line_out += 7;
+		}
+
+		NES_NTSC_AVX2_COLOR_IN( nes_ntsc_black, nes_ntsc_black, nes_ntsc_black, raw );
+		NES_NTSC_AVX2_STORE_7( line_out, NES_NTSC_AVX2_RGB_OUT( raw, 16 ), 16 );
+
+		burst_phase = (burst_phase + 1) % nes_ntsc_burst_count;
+	}
+}
+
+/* largest difference of any RGB component, in steps of that component */
+static int max_error( struct data_t const* data )
+{
+	int max = 0;
+	int y;
+	for ( y = 0; y < out_height; y++ )
+	{
+		int x;
+		for ( x = 0; x < out_width; x++ )
+		{
+			int const a = data->out      [y] [x];
+			int const b = data->out_simd [y] [x];
+			int const diff [3] = {
+				(a >> 11       ) - (b >> 11       ),
+				(a >>  5 & 0x3F) - (b >>  5 & 0x3F),
+				(a       & 0x1F) - (b       & 0x1F)
+			};
+			int i;
+			for ( i = 0; i < 3; i++ )
+			{
+				if ( max < abs( diff [i] ) )
+					max = abs( diff [i] );
+			}
+		}
+	}
+	return max;
+}
+
+#endif
 
 int main()
 {
 	struct data_t* data = (struct data_t*) malloc( sizeof *data );
 	if ( data )
 	{
+		double scalar_rate;
+
 		/* fill with random pixel data */
 		int y;
 		for ( y = 0; y < in_height; y++ )
@@ -36,51 +136,63 @@ int main()
 			for ( x = 0; x < in_width; x++ )
 				data->in [y] [x] = rand() >> 4 & 0x1F;
 		}
-		
+
 		printf( "Timing nes_ntsc...\n" );
 		fflush( stdout );
-		
+
 		nes_ntsc_init( &data->ntsc, 0 );
-		
+
 		/* measure frame rate */
-		while ( time_blitter() )
+		scalar_rate = time_blitter( blit_scalar, data );
+
+	#ifdef HAVE_AVX2
+		if ( scalar_rate && avx2_supported() )
 		{
-			nes_ntsc_blit( &data->ntsc, data->in [0], in_width, 0,
-				in_width, in_height, data->out [0], sizeof data->out [0] );
+			double simd_rate;
+
+			printf( "Timing AVX2 blitter...\n" );
+			fflush( stdout );
+
+			simd_rate = time_blitter( blit_avx2, data );
+			if ( simd_rate )
+				printf( "Speedup: %.2fx, max error: %d\n",
+						simd_rate / scalar_rate, max_error( data ) );
 		}
-		
+	#endif
+
 		free( data );
 	}
-	
+
 	getchar();
 	return 0;
 }
 
-static int time_blitter( void )
+static double time_blitter( blitter_t blit, struct data_t* data )
 {
 	int const duration = 4; /* seconds */
-	static clock_t end_time;
-	static int count;
-	if ( !count )
+	clock_t end_time;
+	clock_t time = clock();
+	long count = 0;
+	double rate;
+
+	while ( clock() == time ) { }
+	if ( clock() - time > CLOCKS_PER_SEC )
 	{
-		clock_t time = clock();
-		while ( clock() == time ) { }
-		if ( clock() - time > CLOCKS_PER_SEC )
-		{
-			/* clock increments less-often than once every second */
-			printf( "Insufficient time resolution\n" );
-			return 0;
-		}
-		end_time = clock() + CLOCKS_PER_SEC * duration;
+		/* clock increments less-often than once every second */
+		printf( "Insufficient time resolution\n" );
+		return 0;
 	}
-	else if ( clock() >= end_time )
+
+	end_time = clock() + CLOCKS_PER_SEC * duration;
+	do
 	{
-		int rate = count / duration;
-		printf( "Performance: %d frames per second, which would use %d%% CPU at 60 FPS\n",
-				rate, 60 * 100 / rate );
-		return 0;
+		blit( data );
+		count++;
 	}
-	count++;
-	
-	return 1;
+	while ( clock() < end_time );
+
+	rate = (double) count / duration;
+	printf( "Performance: %d frames per second, which would use %d%% CPU at 60 FPS\n",
+			(int) rate, (int) (60 * 100 / rate) );
+	return rate;
 }
@@ -0,0 +1,161 @@
+/* NES NTSC video filter, AVX2 blitter interface */
+
+/* nes_ntsc 0.2.2 */
+#ifndef NES_NTSC_AVX2_H
+#define NES_NTSC_AVX2_H
+
+#include "nes_ntsc.h"
+#include <immintrin.h>
+
+/* Vector version of the custom blitter interface in nes_ntsc.h. Instead of
+one output pixel at a time, each chunk of three input pixels generates all
+seven output pixels at once in lanes 0-6 of an __m256i. Output is identical
+to the scalar macros. The blitter using these must be compiled for AVX2, and
+the caller must check that the CPU supports it.
+
+	NES_NTSC_AVX2_BEGIN_ROW( ntsc, burst, nes_ntsc_black, nes_ntsc_black, in [0] );
+	for ( n = chunk_count; n; --n, in += 3, out += 7 )
+	{
+		__m256i raw;
+		NES_NTSC_AVX2_COLOR_IN( in [1], in [2], in [3], raw );
+		NES_NTSC_AVX2_STORE_8( out, NES_NTSC_AVX2_RGB_OUT( raw, 16 ), 16 );
+	}
+	... last chunk with nes_ntsc_black and NES_NTSC_AVX2_STORE_7 ...
+
+STORE_8 writes one pixel past the chunk, which the next chunk overwrites, so
+the last chunk of a row must use STORE_7. */
+
+/* Begins outputting row and starts three pixels. Declares variables. */
+#define NES_NTSC_AVX2_BEGIN_ROW( ntsc, burst, pixel0, pixel1, pixel2 ) \
+	char const* const ktable = \
+		(char const*) (ntsc)->table [0] + burst * (nes_ntsc_burst_size * sizeof (nes_ntsc_rgb_t));\
+	nes_ntsc_rgb_t const* kernel0  = NES_NTSC_ENTRY_( ktable, (pixel0) );\
+	nes_ntsc_rgb_t const* kernel1  = NES_NTSC_ENTRY_( ktable, (pixel1) );\
+	nes_ntsc_rgb_t const* kernel2  = NES_NTSC_ENTRY_( ktable, (pixel2) );\
+	nes_ntsc_rgb_t const* kernelx0;\
+	nes_ntsc_rgb_t const* kernelx1 = kernel0;\
+	nes_ntsc_rgb_t const* kernelx2 = kernel0;\
+	nes_ntsc_rgb_t const* kernelxx1;\
+	nes_ntsc_rgb_t const* kernelxx2
+
+/* Reads three input pixels and generates seven clamped raw output pixels.
+Each input pixel adds a run of 14 kernel entries to 14 consecutive output
+pixels, so a chunk sums contiguous slices of the last three chunks' kernels;
+pixels 1 and 2 start inside the chunk and their slices are split by mask. */
+#define NES_NTSC_AVX2_COLOR_IN( pixel0, pixel1, pixel2, raw_out ) {\
+	kernelxx1 = kernelx1;\
+	kernelxx2 = kernelx2;\
+	kernelx0  = kernel0;\
+	kernelx1  = kernel1;\
+	kernelx2  = kernel2;\
+	kernel0   = NES_NTSC_ENTRY_( ktable, (pixel0) );\
+	kernel1   = NES_NTSC_ENTRY_( ktable, (pixel1) );\
+	kernel2   = NES_NTSC_ENTRY_( ktable, (pixel2) );\
+	raw_out = _mm256_add_epi32(\
+		_mm256_add_epi32(\
+			_mm256_add_epi32( NES_NTSC_AVX2_LOAD_( kernel0 + 0 ), NES_NTSC_AVX2_LOAD_( kernelx0 + 7 ) ),\
+			_mm256_add_epi32( NES_NTSC_AVX2_LOAD_( kernelx1 + 19 ), NES_NTSC_AVX2_LOAD_( kernelx2 + 31 ) )\
+		),\
+		_mm256_add_epi32(\
+			_mm256_add_epi32(\
+				NES_NTSC_AVX2_MASKLOAD_( kernel1 + 12, 0, 0,-1,-1,-1,-1,-1, 0 ),\
+				NES_NTSC_AVX2_MASKLOAD_( kernelxx1 + 26, -1,-1, 0, 0, 0, 0, 0, 0 )\
+			),\
+			_mm256_add_epi32(\
+				NES_NTSC_AVX2_MASKLOAD_( kernel2 + 24, 0, 0, 0, 0,-1,-1,-1, 0 ),\
+				NES_NTSC_AVX2_MASKLOAD_( kernelxx2 + 38, -1,-1,-1,-1, 0, 0, 0, 0 )\
+			)\
+		)\
+	);\
+	NES_NTSC_AVX2_CLAMP_( raw_out );\
+}
+
+/* Converts raw pixels to the output format. Bits are the same as for
+NES_NTSC_RGB_OUT(), the result holds one pixel per 32-bit lane. */
+#define NES_NTSC_AVX2_RGB_OUT( raw, bits ) (\
+	(bits) == 16 ? NES_NTSC_AVX2_PACK_( raw, 13, 0xF800, 8, 0x07E0, 4, 0x001F ) :\
+	(bits) == 15 ? NES_NTSC_AVX2_PACK_( raw, 14, 0x7C00, 9, 0x03E0, 4, 0x001F ) :\
+	(bits) ==  0 ? (raw) :\
+	               NES_NTSC_AVX2_PACK_( raw,  5, 0xFF0000, 3, 0xFF00, 1, 0xFF )\
+)
+
+/* Stores eight converted pixels, the last one being garbage */
+#define NES_NTSC_AVX2_STORE_8( rgb_out, pixels, bits ) {\
+	if ( (bits) == 16 || (bits) == 15 )\
+		_mm_storeu_si128( (__m128i*) (rgb_out), NES_NTSC_AVX2_NARROW_( pixels ) );\
+	else\
+		_mm256_storeu_si256( (__m256i*) (rgb_out), (pixels) );\
+}
+
+/* Stores seven converted pixels */
+#define NES_NTSC_AVX2_STORE_7( rgb_out, pixels, bits ) {\
+	if ( (bits) == 16 || (bits) == 15 )\
+	{\
+		__m128i const narrow_ = NES_NTSC_AVX2_NARROW_( pixels );\
+		_mm_storel_epi64( (__m128i*) (rgb_out), narrow_ );\
+		(rgb_out) [4] = _mm_extract_epi16( narrow_, 4 );\
+		(rgb_out) [5] = _mm_extract_epi16( narrow_, 5 );\
+		(rgb_out) [6] = _mm_extract_epi16( narrow_, 6 );\
+	}\
+	else\
+	{\
+		_mm256_maskstore_epi32( (int*) (rgb_out), _mm256_setr_epi32( -1,-1,-1,-1,-1,-1,-1, 0 ), (pixels) );\
+	}\
+}
+
+
+/* private */
+
+/* Kernel entries are read as 32-bit values. Where nes_ntsc_rgb_t is wider,
+the low halves are packed together; only those matter for the output. */
+#define NES_NTSC_AVX2_LOAD_( kernel ) (\
+	sizeof (nes_ntsc_rgb_t) == 4 ?\
+		_mm256_loadu_si256( (__m256i const*) (kernel) ) :\
+		NES_NTSC_AVX2_LOW_(\
+			_mm256_loadu_si256( (__m256i const*) (kernel) ),\
+			_mm256_loadu_si256( (__m256i const*) ((kernel) + 4) ) )\
+)
+
+/* Lanes outside the mask are zero, reads past the end of the slice are
+suppressed since they could run past the end of the table */
+#define NES_NTSC_AVX2_MASKLOAD_( kernel, m0, m1, m2, m3, m4, m5, m6, m7 ) (\
+	sizeof (nes_ntsc_rgb_t) == 4 ?\
+		_mm256_maskload_epi32( (int const*) (kernel), _mm256_setr_epi32( m0, m1, m2, m3, m4, m5, m6, m7 ) ) :\
+		NES_NTSC_AVX2_LOW_(\
+			_mm256_maskload_epi64( (nes_ntsc_avx2_int64_ const*) (kernel), _mm256_setr_epi64x( m0, m1, m2, m3 ) ),\
+			_mm256_maskload_epi64( (nes_ntsc_avx2_int64_ const*) ((kernel) + 4), _mm256_setr_epi64x( m4, m5, m6, m7 ) ) )\
+)
+
+#define NES_NTSC_AVX2_LOW_( lo, hi ) \
+	_mm256_permute2x128_si256(\
+		_mm256_permutevar8x32_epi32( lo, _mm256_setr_epi32( 0, 2, 4, 6, 0, 2, 4, 6 ) ),\
+		_mm256_permutevar8x32_epi32( hi, _mm256_setr_epi32( 0, 2, 4, 6, 0, 2, 4, 6 ) ), 0x20 )
+
+#ifdef _MSC_VER
+	typedef __int64 nes_ntsc_avx2_int64_;
+#else
+	typedef long long nes_ntsc_avx2_int64_;
+#endif
+
+#define NES_NTSC_AVX2_CLAMP_( io ) {\
+	__m256i const sub_ = _mm256_and_si256( _mm256_srli_epi32( io, 9 ),\
+			_mm256_set1_epi32( nes_ntsc_clamp_mask ) );\
+	__m256i clamp_ = _mm256_sub_epi32( _mm256_set1_epi32( nes_ntsc_clamp_add ), sub_ );\
+	io = _mm256_or_si256( io, clamp_ );\
+	clamp_ = _mm256_sub_epi32( clamp_, sub_ );\
+	io = _mm256_and_si256( io, clamp_ );\
+}
+
+#define NES_NTSC_AVX2_PACK_( raw, s0, m0, s1, m1, s2, m2 ) \
+	_mm256_or_si256(\
+		_mm256_or_si256(\
+			_mm256_and_si256( _mm256_srli_epi32( raw, s0 ), _mm256_set1_epi32( m0 ) ),\
+			_mm256_and_si256( _mm256_srli_epi32( raw, s1 ), _mm256_set1_epi32( m1 ) )\
+		),\
+		_mm256_and_si256( _mm256_srli_epi32( raw, s2 ), _mm256_set1_epi32( m2 ) )\
+	)
+
+#define NES_NTSC_AVX2_NARROW_( pixels ) \
+	_mm_packus_epi32( _mm256_castsi256_si128( pixels ), _mm256_extracti128_si256( pixels, 1 ) )
+
+#endif
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NST_TOOLS_H
+#define NST_TOOLS_H
+
+#pragma once
+
+#include "../core/api/NstApiEmulator.hpp"
+#include "../core/api/NstApiMachine.hpp"
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		//Exit codes shared by all commands.
+		enum
+		{
+			EXIT_OK = 0,
+			EXIT_MISMATCH = 1,
+			EXIT_ERROR = 2,
+			EXIT_USAGE = 3
+		};
+
+		//Loads an image into the emulator and powers it on.
+		Nes::Result LoadImage(Nes::Api::Emulator&,const char*);
+
+		//Commands, called with the arguments following the command name.
+		int Verify(int,char**);
+		int Benchmark(int,char**);
+		int Mcts(int,char**);
+		int Replay(int,char**);
+		int Database(int,char**);
+		int Filters(int,char**);
+	}
+}
+
+#endif
@@ -0,0 +1,609 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../core/NstCore.hpp"
+#include "../core/NstSimd.hpp"
+#include "../core/api/NstApiInput.hpp"
+#include "../core/api/NstApiSound.hpp"
+#include "../core/api/NstApiVideo.hpp"
+#include "NstTools.hpp"
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		typedef Nes::Core::Simd Simd;
+
+		struct BenchmarkSettings
+		{
+			BenchmarkSettings()
+			: frames(3600), snapshots(100), seed(1), video(false), sound(false) {}
+
+			unsigned long frames;
+			unsigned long snapshots;
+			unsigned long seed;
+			bool video;
+			bool sound;
+		};
+
+		struct SnapshotResult
+		{
+			SnapshotResult()
+			: saveNs(0), loadNs(0), bytes(0) {}
+
+			double saveNs;
+			double loadNs;
+			size_t bytes;
+		};
+
+		//The APU mixer and the sample conversion have a scalar and an SSE2 path, and a
+		//format for each conversion, so every format is played with both and compared.
+		struct SoundFormat
+		{
+			const char* name;
+			unsigned int bits;
+			Nes::Api::Sound::Speaker speaker;
+		};
+
+		static const SoundFormat soundFormats[] =
+		{
+			{ "16bit_stereo", 16, Nes::Api::Sound::SPEAKER_STEREO },
+			{ "8bit_mono",     8, Nes::Api::Sound::SPEAKER_MONO   },
+			{ "8bit_stereo",   8, Nes::Api::Sound::SPEAKER_STEREO }
+		};
+
+		enum
+		{
+			NUM_SOUND_FORMATS = sizeof(soundFormats) / sizeof(soundFormats[0]),
+			NUM_SOUND_LEVELS = Simd::LEVEL_SSE2 + 1
+		};
+
+		struct SoundResult
+		{
+			SoundResult()
+			: levels(0), mismatchFrame(-1)
+			{
+				for (int i=0; i < NUM_SOUND_LEVELS; ++i)
+					nsPerFrame[i] = 0;
+			}
+
+			double nsPerFrame[NUM_SOUND_LEVELS];
+			int levels;
+			long mismatchFrame;
+		};
+
+		struct BenchmarkResult
+		{
+			enum
+			{
+				SNAPSHOT_RAW,
+				SNAPSHOT_COMPRESSED,
+				SNAPSHOT_INCREMENTAL,
+				NUM_SNAPSHOTS
+			};
+
+			BenchmarkResult()
+			: fps(0), nsPerFrame(0), nsPerCpuCycle(0), nsPerScanline(0), pal(false) {}
+
+			std::string name;
+			double fps;
+			double nsPerFrame;
+			double nsPerCpuCycle;
+			double nsPerScanline;
+			bool pal;
+			SnapshotResult snapshots[NUM_SNAPSHOTS];
+			SoundResult sound[NUM_SOUND_FORMATS];
+		};
+
+		static double ElapsedNs(const Clock::time_point& start)
+		{
+			return double(std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - start ).count());
+		}
+
+		//Scripted input: a deterministic random pad state that is held for a few frames at a time,
+		//so games get past title screens without the results depending on the host.
+		class RandomInput
+		{
+		public:
+
+			explicit RandomInput(unsigned long seed)
+			: state(seed ? seed : 1), held(0) {}
+
+			void Update(Nes::Core::Input::Controllers& controllers)
+			{
+				if (held == 0)
+				{
+					controllers.pad[0].buttons = Next() & 0xFF;
+					held = 1 + Next() % 16;
+				}
+
+				--held;
+			}
+
+		private:
+
+			unsigned long Next()
+			{
+				state = state * 1103515245UL + 12345UL;
+				return (state >> 16) & 0x7FFF;
+			}
+
+			unsigned long state;
+			unsigned long held;
+		};
+
+		class BenchmarkOutput
+		{
+		public:
+
+			BenchmarkOutput(Nes::Api::Emulator& emulator,const BenchmarkSettings& settings)
+			{
+				sound.samples[0] = NULL;
+				sound.samples[1] = NULL;
+				sound.length[0] = 0;
+				sound.length[1] = 0;
+
+				if (settings.video)
+				{
+					Nes::Api::Video::RenderState renderState;
+
+					renderState.bits.count  = 32;
+					renderState.bits.mask.r = 0x00FF0000;
+					renderState.bits.mask.g = 0x0000FF00;
+					renderState.bits.mask.b = 0x000000FF;
+					renderState.width       = Nes::Core::Video::Output::WIDTH;
+					renderState.height      = Nes::Core::Video::Output::HEIGHT;
+					renderState.filter      = Nes::Api::Video::RenderState::FILTER_NONE;
+
+					Nes::Api::Video( emulator ).SetRenderState( renderState );
+
+					pixels.resize( Nes::Core::Video::Output::WIDTH * Nes::Core::Video::Output::HEIGHT * 4 );
+					video.pixels = &pixels.front();
+					video.pitch = Nes::Core::Video::Output::WIDTH * 4;
+				}
+
+				if (settings.sound)
+				{
+					const Nes::Api::Sound api( emulator );
+					const unsigned long length = api.GetSampleRate() / 50 + 1;
+
+					samples.resize( length * (api.GetSampleBits() / 8) * (api.GetSpeaker() == Nes::Api::Sound::SPEAKER_STEREO ? 2 : 1) );
+					sound.samples[0] = &samples.front();
+					sound.length[0] = length;
+				}
+			}
+
+			Nes::Core::Video::Output* GetVideo()
+			{
+				return video.pixels ? &video : NULL;
+			}
+
+			Nes::Core::Sound::Output* GetSound()
+			{
+				return sound.samples[0] ? &sound : NULL;
+			}
+
+			const std::vector<unsigned char>& GetSamples() const
+			{
+				return samples;
+			}
+
+		private:
+
+			Nes::Core::Video::Output video;
+			Nes::Core::Sound::Output sound;
+			std::vector<unsigned char> pixels;
+			std::vector<unsigned char> samples;
+		};
+
+		static bool BenchmarkSnapshots(Nes::Api::Emulator& emulator,const BenchmarkSettings& settings,BenchmarkResult& result)
+		{
+			Nes::Api::Machine machine( emulator );
+			Nes::Core::Input::Controllers controllers;
+			RandomInput input( settings.seed + 1 );
+
+			for (int type=0; type < BenchmarkResult::NUM_SNAPSHOTS; ++type)
+			{
+				SnapshotResult& snapshot = result.snapshots[type];
+				double saveNs = 0, loadNs = 0;
+
+				for (unsigned long i=0; i < settings.snapshots; ++i)
+				{
+					//The parent state is saved first so an incremental state only holds one frame of writes.
+					std::stringstream parent;
+
+					if (type == BenchmarkResult::SNAPSHOT_INCREMENTAL && NES_FAILED(machine.SaveState( parent, Nes::Api::Machine::NO_COMPRESSION )))
+						return false;
+
+					input.Update( controllers );
+					emulator.Execute( NULL, NULL, &controllers );
+
+					std::stringstream stream;
+					Clock::time_point start = Clock::now();
+
+					const Nes::Result saved = machine.SaveState
+					(
+						stream,
+						type == BenchmarkResult::SNAPSHOT_COMPRESSED ? Nes::Api::Machine::USE_COMPRESSION : Nes::Api::Machine::NO_COMPRESSION,
+						type == BenchmarkResult::SNAPSHOT_INCREMENTAL ? Nes::Api::Machine::INCREMENTAL_SNAPSHOT : Nes::Api::Machine::FULL_SNAPSHOT
+					);
+
+					saveNs += ElapsedNs( start );
+
+					if (NES_FAILED(saved))
+						return false;
+
+					snapshot.bytes = size_t(stream.tellp());
+					start = Clock::now();
+
+					if (type == BenchmarkResult::SNAPSHOT_INCREMENTAL && NES_FAILED(machine.LoadState( parent )))
+						return false;
+
+					if (NES_FAILED(machine.LoadState( stream )))
+						return false;
+
+					loadNs += ElapsedNs( start );
+				}
+
+				if (settings.snapshots)
+				{
+					snapshot.saveNs = saveNs / settings.snapshots;
+					snapshot.loadNs = loadNs / settings.snapshots;
+				}
+			}
+
+			return true;
+		}
+
+		//Plays the image once for each sound format and level with the same input, keeping every sample,
+		//and checks that the samples of each level are the same as the scalar ones.
+		static bool BenchmarkSound(const std::string& path,const BenchmarkSettings& settings,BenchmarkResult& result)
+		{
+			const Simd::Level supported = Simd::GetSupportedLevel();
+			bool succeeded = true;
+
+			BenchmarkSettings soundSettings( settings );
+			soundSettings.video = false;
+
+			for (int format=0; format < NUM_SOUND_FORMATS && succeeded; ++format)
+			{
+				SoundResult& sound = result.sound[format];
+				std::vector<unsigned char> reference;
+
+				for (int level=Simd::LEVEL_NONE; level < NUM_SOUND_LEVELS && level <= supported; ++level)
+				{
+					Simd::SetLevel( Simd::Level(level) );
+
+					Nes::Api::Emulator emulator;
+
+					if (NES_FAILED(LoadImage( emulator, path.c_str() )))
+					{
+						succeeded = false;
+						break;
+					}
+
+					Nes::Api::Sound api( emulator );
+					api.SetSampleBits( soundFormats[format].bits );
+					api.SetSpeaker( soundFormats[format].speaker );
+
+					BenchmarkOutput output( emulator, soundSettings );
+					Nes::Core::Input::Controllers controllers;
+					RandomInput input( settings.seed );
+
+					const std::vector<unsigned char>& frame = output.GetSamples();
+					std::vector<unsigned char> samples;
+					samples.reserve( frame.size() * settings.frames );
+
+					double elapsedNs = 0;
+
+					for (unsigned long i=0; i < settings.frames && succeeded; ++i)
+					{
+						input.Update( controllers );
+
+						const Clock::time_point start = Clock::now();
+						succeeded = NES_SUCCEEDED(emulator.Execute( NULL, output.GetSound(), &controllers ));
+						elapsedNs += ElapsedNs( start );
+
+						samples.insert( samples.end(), frame.begin(), frame.end() );
+					}
+
+					if (!succeeded)
+						break;
+
+					if (settings.frames)
+						sound.nsPerFrame[level] = elapsedNs / settings.frames;
+
+					sound.levels = level + 1;
+
+					if (level == Simd::LEVEL_NONE)
+					{
+						reference.swap( samples );
+					}
+					else if (sound.mismatchFrame < 0 && samples != reference)
+					{
+						size_t offset = 0;
+
+						while (samples[offset] == reference[offset])
+							++offset;
+
+						sound.mismatchFrame = long(offset / frame.size());
+					}
+				}
+			}
+
+			Simd::SetLevel( supported );
+
+			return succeeded;
+		}
+
+		static bool Benchmark(const std::string& path,const std::string& name,const BenchmarkSettings& settings,BenchmarkResult& result)
+		{
+			Nes::Api::Emulator emulator;
+
+			if (NES_FAILED(LoadImage( emulator, path.c_str() )))
+				return false;
+
+			result.name = name;
+			result.pal = Nes::Api::Machine( emulator ).GetMode() == Nes::Api::Machine::PAL;
+
+			BenchmarkOutput output( emulator, settings );
+			Nes::Core::Input::Controllers controllers;
+			RandomInput input( settings.seed );
+
+			const Clock::time_point start = Clock::now();
+
+			for (unsigned long frame=0; frame < settings.frames; ++frame)
+			{
+				input.Update( controllers );
+
+				if (NES_FAILED(emulator.Execute( output.GetVideo(), output.GetSound(), &controllers )))
+					return false;
+			}
+
+			const double elapsedNs = ElapsedNs( start );
+
+			//There's no instruction counter in the CPU core, so timings are per master clock derived cycle instead.
+			const double cpuCyclesPerFrame = result.pal ? 33247.5 : 29780.5;
+			const double scanlinesPerFrame = result.pal ? 312 : 262;
+
+			if (settings.frames && elapsedNs > 0)
+			{
+				result.nsPerFrame = elapsedNs / settings.frames;
+				result.fps = 1e9 / result.nsPerFrame;
+				result.nsPerCpuCycle = result.nsPerFrame / cpuCyclesPerFrame;
+				result.nsPerScanline = result.nsPerFrame / scanlinesPerFrame;
+			}
+
+			if (!BenchmarkSnapshots( emulator, settings, result ))
+				return false;
+
+			return !settings.sound || BenchmarkSound( path, settings, result );
+		}
+
+		static void WriteJson(std::FILE* file,const BenchmarkSettings& settings,const std::vector<BenchmarkResult>& results)
+		{
+			static const char* const snapshotNames[BenchmarkResult::NUM_SNAPSHOTS] =
+			{
+				"raw", "compressed", "incremental"
+			};
+
+			static const char* const levelNames[NUM_SOUND_LEVELS] =
+			{
+				"scalar", "sse2"
+			};
+
+			std::fprintf( file, "{\n" );
+			std::fprintf( file, "  \"frames\": %lu,\n", settings.frames );
+			std::fprintf( file, "  \"seed\": %lu,\n", settings.seed );
+			std::fprintf( file, "  \"video\": %s,\n", settings.video ? "true" : "false" );
+			std::fprintf( file, "  \"sound\": %s,\n", settings.sound ? "true" : "false" );
+			std::fprintf( file, "  \"roms\": [" );
+
+			for (size_t i=0; i < results.size(); ++i)
+			{
+				const BenchmarkResult& result = results[i];
+
+				std::string name;
+
+				for (std::string::const_iterator it(result.name.begin()); it != result.name.end(); ++it)
+				{
+					if (*it == '"' || *it == '\\')
+						name += '\\';
+
+					name += *it;
+				}
+
+				std::fprintf( file, "%s\n    {\n", i ? "," : "" );
+				std::fprintf( file, "      \"name\": \"%s\",\n", name.c_str() );
+				std::fprintf( file, "      \"region\": \"%s\",\n", result.pal ? "pal" : "ntsc" );
+				std::fprintf( file, "      \"fps\": %.2f,\n", result.fps );
+				std::fprintf( file, "      \"ns_per_frame\": %.1f,\n", result.nsPerFrame );
+				std::fprintf( file, "      \"ns_per_cpu_cycle\": %.3f,\n", result.nsPerCpuCycle );
+				std::fprintf( file, "      \"ns_per_scanline\": %.1f,\n", result.nsPerScanline );
+				std::fprintf( file, "      \"savestates\": {" );
+
+				for (int j=0; j < BenchmarkResult::NUM_SNAPSHOTS; ++j)
+				{
+					const SnapshotResult& snapshot = result.snapshots[j];
+
+					std::fprintf
+					(
+						file,
+						"%s\n        \"%s\": { \"save_ns\": %.0f, \"load_ns\": %.0f, \"bytes\": %lu }",
+						j ? "," : "",
+						snapshotNames[j],
+						snapshot.saveNs,
+						snapshot.loadNs,
+						(unsigned long)snapshot.bytes
+					);
+				}
+
+				std::fprintf( file, "\n      }" );
+
+				if (settings.sound)
+				{
+					std::fprintf( file, ",\n      \"sound\": {" );
+
+					for (int j=0; j < NUM_SOUND_FORMATS; ++j)
+					{
+						const SoundResult& sound = result.sound[j];
+
+						std::fprintf( file, "%s\n        \"%s\": { ", j ? "," : "", soundFormats[j].name );
+
+						for (int level=0; level < sound.levels; ++level)
+							std::fprintf( file, "\"%s_ns_per_frame\": %.1f, ", levelNames[level], sound.nsPerFrame[level] );
+
+						std::fprintf( file, "\"matches\": %s }", sound.mismatchFrame < 0 ? "true" : "false" );
+					}
+
+					std::fprintf( file, "\n      }" );
+				}
+
+				std::fprintf( file, "\n    }" );
+			}
+
+			std::fprintf( file, "\n  ]\n}\n" );
+		}
+
+		int Benchmark(int argc,char** argv)
+		{
+			if (argc < 1)
+				return EXIT_USAGE;
+
+			const std::string directory = argv[0];
+			const char* outputPath = NULL;
+			BenchmarkSettings settings;
+
+			for (int i=1; i < argc; ++i)
+			{
+				if (std::strcmp( argv[i], "-video" ) == 0)
+				{
+					settings.video = true;
+				}
+				else if (std::strcmp( argv[i], "-sound" ) == 0)
+				{
+					settings.sound = true;
+				}
+				else if (i + 1 == argc)
+				{
+					return EXIT_USAGE;
+				}
+				else if (std::strcmp( argv[i], "-frames" ) == 0)
+				{
+					settings.frames = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-snapshots" ) == 0)
+				{
+					settings.snapshots = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-seed" ) == 0)
+				{
+					settings.seed = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-o" ) == 0)
+				{
+					outputPath = argv[++i];
+				}
+				else
+				{
+					return EXIT_USAGE;
+				}
+			}
+
+			std::vector<std::string> names;
+			WIN32_FIND_DATAA findData;
+
+			const HANDLE find = ::FindFirstFileA( (directory + "\\*").c_str(), &findData );
+
+			if (find == INVALID_HANDLE_VALUE)
+			{
+				std::fprintf( stderr, "can't open %s\n", directory.c_str() );
+				return EXIT_ERROR;
+			}
+
+			do
+			{
+				if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+					names.push_back( findData.cFileName );
+			}
+			while (::FindNextFileA( find, &findData ));
+
+			::FindClose( find );
+
+			std::vector<BenchmarkResult> results;
+			int exitCode = EXIT_OK;
+
+			for (size_t i=0; i < names.size(); ++i)
+			{
+				BenchmarkResult result;
+
+				if (Benchmark( directory + "\\" + names[i], names[i], settings, result ))
+				{
+					std::fprintf( stderr, "%-40s %8.1f fps\n", names[i].c_str(), result.fps );
+
+					for (int j=0; j < NUM_SOUND_FORMATS; ++j)
+					{
+						if (result.sound[j].mismatchFrame >= 0)
+						{
+							std::fprintf( stderr, "%-40s %s sound from SSE2 differs from scalar in frame %ld\n", names[i].c_str(), soundFormats[j].name, result.sound[j].mismatchFrame );
+							exitCode = EXIT_MISMATCH;
+						}
+					}
+					results.push_back( result );
+				}
+				else
+				{
+					std::fprintf( stderr, "%-40s skipped\n", names[i].c_str() );
+				}
+			}
+
+			std::FILE* const file = outputPath ? std::fopen( outputPath, "w" ) : stdout;
+
+			if (!file)
+			{
+				std::fprintf( stderr, "can't open %s\n", outputPath );
+				return EXIT_ERROR;
+			}
+
+			WriteJson( file, settings, results );
+
+			if (file != stdout)
+				std::fclose( file );
+
+			return results.empty() ? EXIT_ERROR : exitCode;
+		}
+	}
+}
@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../core/api/NstApiCartridge.hpp"
+#include "NstTools.hpp"
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		typedef Nes::Api::Cartridge::Profile::Hash Hash;
+
+		static double ElapsedNs(const Clock::time_point& start)
+		{
+			return double(std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - start ).count());
+		}
+
+		static bool ReadFile(const char* path,std::string& data)
+		{
+			std::ifstream stream( path, std::ifstream::in|std::ifstream::binary );
+
+			if (!stream.is_open())
+				return false;
+
+			std::ostringstream buffer;
+			buffer << stream.rdbuf();
+			data = buffer.str();
+
+			return true;
+		}
+
+		//Collects the hashes of all cartridge and arcade images in the XML, used for timing hits.
+		static void ReadHashes(const std::string& xml,std::vector<Hash>& hashes)
+		{
+			static const char* const tags[] = { "<cartridge ", "<arcade " };
+
+			for (size_t i=0; i < 2; ++i)
+			{
+				for (size_t pos=xml.find( tags[i] ); pos != std::string::npos; pos=xml.find( tags[i], pos + 1 ))
+				{
+					const std::string tag( xml, pos, xml.find( '>', pos ) - pos );
+					const size_t sha1 = tag.find( " sha1=\"" );
+					const size_t crc = tag.find( " crc=\"" );
+
+					if (sha1 != std::string::npos && crc != std::string::npos)
+						hashes.push_back( Hash(tag.substr( sha1 + 7, 40 ).c_str(),tag.substr( crc + 6, 8 ).c_str()) );
+				}
+			}
+		}
+
+		//Loads the database from memory the given number of times, returns the average time.
+		static double TimeLoad(Nes::Api::Cartridge::Database database,const std::string& data,unsigned long runs,Nes::Result& result)
+		{
+			double ns = 0;
+
+			for (unsigned long i=0; i < runs; ++i)
+			{
+				std::istringstream stream( data, std::istringstream::in|std::istringstream::binary );
+
+				const Clock::time_point start( Clock::now() );
+				result = database.Load( stream );
+				ns += ElapsedNs( start );
+
+				if (NES_FAILED(result))
+					return 0;
+			}
+
+			return ns / runs;
+		}
+
+		int Database(int argc,char** argv)
+		{
+			if (argc < 2)
+				return EXIT_USAGE;
+
+			const char* const xmlPath = argv[0];
+			const char* const outputPath = argv[1];
+			unsigned long runs = 10;
+
+			for (int i=2; i < argc; ++i)
+			{
+				if (i + 1 == argc)
+				{
+					return EXIT_USAGE;
+				}
+				else if (std::strcmp( argv[i], "-runs" ) == 0)
+				{
+					runs = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else
+				{
+					return EXIT_USAGE;
+				}
+			}
+
+			if (!runs)
+				return EXIT_USAGE;
+
+			std::string xml;
+
+			if (!ReadFile( xmlPath, xml ))
+			{
+				std::fprintf( stderr, "can't open %s\n", xmlPath );
+				return EXIT_ERROR;
+			}
+
+			Nes::Api::Emulator xmlEmulator, compiledEmulator;
+			Nes::Api::Cartridge::Database xmlDatabase( Nes::Api::Cartridge(xmlEmulator).GetDatabase() );
+			Nes::Api::Cartridge::Database compiledDatabase( Nes::Api::Cartridge(compiledEmulator).GetDatabase() );
+
+			Nes::Result result;
+			const double xmlNs = TimeLoad( xmlDatabase, xml, runs, result );
+
+			if (NES_FAILED(result))
+			{
+				std::fprintf( stderr, "can't load %s (error %d)\n", xmlPath, int(result) );
+				return EXIT_ERROR;
+			}
+
+			std::ostringstream compiled( std::ostringstream::out|std::ostringstream::binary );
+
+			if (NES_FAILED(result=xmlDatabase.Save( compiled )))
+			{
+				std::fprintf( stderr, "can't compile %s (error %d)\n", xmlPath, int(result) );
+				return EXIT_ERROR;
+			}
+
+			{
+				std::ofstream stream( outputPath, std::ofstream::out|std::ofstream::binary );
+
+				if (!stream.write( compiled.str().data(), compiled.str().size() ))
+				{
+					std::fprintf( stderr, "can't write %s\n", outputPath );
+					return EXIT_ERROR;
+				}
+			}
+
+			const double compiledNs = TimeLoad( compiledDatabase, compiled.str(), runs, result );
+
+			if (NES_FAILED(result))
+			{
+				std::fprintf( stderr, "can't load the compiled database (error %d)\n", int(result) );
+				return EXIT_ERROR;
+			}
+
+			//Both forms must give the same answers, and compiling the compiled form must give it back.
+			std::ostringstream recompiled( std::ostringstream::out|std::ostringstream::binary );
+			bool match = NES_SUCCEEDED(compiledDatabase.Save( recompiled )) && recompiled.str() == compiled.str();
+
+			std::vector<Hash> hashes;
+			ReadHashes( xml, hashes );
+
+			unsigned long found = 0;
+
+			for (size_t i=0; i < hashes.size(); ++i)
+			{
+				const Nes::Api::Cartridge::Database::Entry a( xmlDatabase.FindEntry( hashes[i], Nes::Api::Machine::FAVORED_NES_NTSC ) );
+				const Nes::Api::Cartridge::Database::Entry b( compiledDatabase.FindEntry( hashes[i], Nes::Api::Machine::FAVORED_NES_NTSC ) );
+
+				if (!a != !b || (a && (std::wcscmp( a.GetTitle(), b.GetTitle() ) || a.GetMapper() != b.GetMapper() || a.GetSystem() != b.GetSystem())))
+					match = false;
+
+				if (a)
+					++found;
+			}
+
+			double lookupNs = 0;
+
+			if (found)
+			{
+				const unsigned long lookups = 1000000UL / hashes.size() + 1;
+				const Clock::time_point start( Clock::now() );
+
+				for (unsigned long i=0; i < lookups; ++i)
+				{
+					for (size_t j=0; j < hashes.size(); ++j)
+						found += !compiledDatabase.FindEntry( hashes[j], Nes::Api::Machine::FAVORED_NES_NTSC ) ? 0 : 1;
+				}
+
+				lookupNs = ElapsedNs( start ) / (double(lookups) * hashes.size());
+			}
+
+			std::printf( "{\n" );
+			std::printf( "  \"xml_bytes\": %lu,\n", (unsigned long)xml.size() );
+			std::printf( "  \"compiled_bytes\": %lu,\n", (unsigned long)compiled.str().size() );
+			std::printf( "  \"xml_load_ns\": %.0f,\n", xmlNs );
+			std::printf( "  \"compiled_load_ns\": %.0f,\n", compiledNs );
+			std::printf( "  \"images\": %lu,\n", (unsigned long)hashes.size() );
+			std::printf( "  \"lookup_ns\": %.1f,\n", lookupNs );
+			std::printf( "  \"match\": %s\n", match ? "true" : "false" );
+			std::printf( "}\n" );
+
+			return match ? EXIT_OK : EXIT_MISMATCH;
+		}
+	}
+}
@@ -0,0 +1,318 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../core/NstCore.hpp"
+#include "../core/NstSimd.hpp"
+#include "../core/NstVideoRenderer.hpp"
+#include "NstTools.hpp"
+
+//The filters are driven through the core's renderer directly, so the frames fed to them
+//can be made up to hit the cases that matter instead of depending on what a game shows.
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+		typedef Nes::Core::Simd Simd;
+		typedef Nes::Core::Video::Renderer Renderer;
+		typedef Nes::Core::Video::Screen Screen;
+		typedef Nes::Api::Video::RenderState RenderState;
+
+		struct FilterType
+		{
+			const char* name;
+			RenderState::Filter filter;
+			unsigned int width;
+			unsigned int height;
+		};
+
+		struct FilterFormat
+		{
+			const char* name;
+			unsigned int bits;
+			unsigned long r, g, b;
+		};
+
+		static const FilterType filterTypes[] =
+		{
+			{ "scale2x", RenderState::FILTER_SCALE2X, Screen::WIDTH * 2,                      Screen::HEIGHT * 2 },
+			{ "scale3x", RenderState::FILTER_SCALE3X, Screen::WIDTH * 3,                      Screen::HEIGHT * 3 },
+			{ "hq2x",    RenderState::FILTER_HQ2X,    Screen::WIDTH * 2,                      Screen::HEIGHT * 2 },
+			{ "hq3x",    RenderState::FILTER_HQ3X,    Screen::WIDTH * 3,                      Screen::HEIGHT * 3 },
+			{ "hq4x",    RenderState::FILTER_HQ4X,    Screen::WIDTH * 4,                      Screen::HEIGHT * 4 },
+			{ "ntsc",    RenderState::FILTER_NTSC,    Nes::Core::Video::Output::NTSC_WIDTH,   Screen::HEIGHT }
+		};
+
+		static const FilterFormat filterFormats[] =
+		{
+			{ "rgb565", 16, 0xF800, 0x07E0, 0x001F },
+			{ "rgb555", 16, 0x7C00, 0x03E0, 0x001F },
+			{ "rgb888", 32, 0xFF0000, 0x00FF00, 0x0000FF }
+		};
+
+		static const char* const levelNames[] =
+		{
+			"scalar", "sse2", "avx2"
+		};
+
+		class FrameRandom
+		{
+		public:
+
+			explicit FrameRandom(unsigned long seed)
+			: state(seed ? seed : 1) {}
+
+			unsigned long Next()
+			{
+				state = state * 1103515245UL + 12345UL;
+				return (state >> 16) & 0x7FFF;
+			}
+
+			unsigned long Next(unsigned long range)
+			{
+				return Next() % range;
+			}
+
+		private:
+
+			unsigned long state;
+		};
+
+		//Every kind of frame is there for a reason:
+		//noise gives every pair of colours, flat ones have no edges at all, runs of a
+		//few colours give the equal and nearly equal neighbours the filters branch on,
+		//stripes and checks give edges in every direction and the border frames only
+		//change the outer columns, which ScaleX patches up after its kernel.
+		enum FrameKind
+		{
+			FRAME_NOISE,
+			FRAME_FLAT,
+			FRAME_RUNS,
+			FRAME_EDGES,
+			FRAME_BORDERS,
+			NUM_FRAMES
+		};
+
+		static void GenerateFrame(Screen& screen,const FrameKind kind,FrameRandom& random)
+		{
+			Screen::Pixel colors[4];
+
+			for (unsigned int i=0; i < 4; ++i)
+				colors[i] = Screen::Pixel(random.Next( Screen::PALETTE ));
+
+			//Nearby entries in the palette are close in colour too.
+			colors[3] = Screen::Pixel((colors[2] & ~0xFU) | ((colors[2] + 1) & 0xFU));
+
+			for (unsigned int y=0; y < Screen::HEIGHT; ++y)
+			{
+				Screen::Pixel* const row = screen.pixels + y * Screen::WIDTH;
+
+				for (unsigned int x=0; x < Screen::WIDTH; ++x)
+				{
+					switch (kind)
+					{
+						case FRAME_NOISE:
+
+							row[x] = Screen::Pixel(random.Next( Screen::PALETTE ));
+							break;
+
+						case FRAME_FLAT:
+
+							row[x] = colors[0];
+							break;
+
+						case FRAME_RUNS:
+
+							if (y && random.Next( 4 ))
+								row[x] = (row - Screen::WIDTH)[x];
+							else if (x && random.Next( 4 ))
+								row[x] = row[x-1];
+							else
+								row[x] = colors[random.Next( 4 )];
+
+							break;
+
+						case FRAME_EDGES:
+						{
+							const unsigned int width = 1 + (colors[0] & 0x3);
+							const unsigned int slope = colors[1] % 3;
+							const unsigned int position = (slope == 0 ? x : slope == 1 ? x + y : x + Screen::HEIGHT - y) / width;
+
+							row[x] = colors[((position ^ (y / width)) & 0x1) + ((colors[1] & 0x4) ? 2 : 0)];
+							break;
+						}
+
+						case FRAME_BORDERS:
+
+							row[x] = (x < 3 || x >= Screen::WIDTH - 3 || y == 0 || y == Screen::HEIGHT - 1) ? colors[random.Next( 3 )] : colors[3];
+							break;
+
+						default:
+
+							break;
+					}
+				}
+			}
+		}
+
+		//Renders every frame at the given level and leaves the output of each one after another in the pixels.
+		static bool Render(const FilterType& filter,const FilterFormat& format,Simd::Level level,std::vector<Screen>& frames,std::vector<unsigned char>& pixels,double& nsPerFrame)
+		{
+			Simd::SetLevel( level );
+
+			Renderer renderer;
+			RenderState renderState;
+
+			renderState.filter      = filter.filter;
+			renderState.width       = filter.width;
+			renderState.height      = filter.height;
+			renderState.bits.count  = format.bits;
+			renderState.bits.mask.r = format.r;
+			renderState.bits.mask.g = format.g;
+			renderState.bits.mask.b = format.b;
+
+			if (NES_FAILED(renderer.SetState( renderState )))
+				return false;
+
+			const size_t pitch = filter.width * (format.bits / 8);
+			const size_t size = pitch * filter.height;
+
+			//Anything a path doesn't write keeps the fill, so that's compared too.
+			pixels.assign( size * frames.size(), 0xA5 );
+
+			double elapsedNs = 0;
+
+			for (size_t i=0; i < frames.size(); ++i)
+			{
+				Nes::Core::Video::Output output( &pixels[size * i], long(pitch) );
+
+				const Clock::time_point start = Clock::now();
+				renderer.Blit( output, frames[i], unsigned(i % 3) );
+				elapsedNs += double(std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - start ).count());
+			}
+
+			nsPerFrame = frames.empty() ? 0 : elapsedNs / frames.size();
+
+			return true;
+		}
+
+		int Filters(int argc,char** argv)
+		{
+			unsigned long numFrames = NUM_FRAMES * 4;
+			unsigned long seed = 1;
+
+			for (int i=0; i < argc; ++i)
+			{
+				if (i + 1 == argc)
+				{
+					return EXIT_USAGE;
+				}
+				else if (std::strcmp( argv[i], "-frames" ) == 0)
+				{
+					numFrames = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-seed" ) == 0)
+				{
+					seed = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else
+				{
+					return EXIT_USAGE;
+				}
+			}
+
+			std::vector<Screen> frames( numFrames );
+			FrameRandom random( seed );
+
+			for (size_t i=0; i < frames.size(); ++i)
+				GenerateFrame( frames[i], FrameKind(i % NUM_FRAMES), random );
+
+			const Simd::Level supported = Simd::GetSupportedLevel();
+			int exitCode = EXIT_OK;
+
+			for (size_t i=0; i < sizeof(filterTypes) / sizeof(filterTypes[0]); ++i)
+			{
+				for (size_t j=0; j < sizeof(filterFormats) / sizeof(filterFormats[0]); ++j)
+				{
+					const FilterType& filter = filterTypes[i];
+					const FilterFormat& format = filterFormats[j];
+
+					std::vector<unsigned char> reference, pixels;
+					double nsPerFrame;
+
+					if (!Render( filter, format, Simd::LEVEL_NONE, frames, reference, nsPerFrame ))
+					{
+						std::printf( "%-8s %s  not built in\n", filter.name, format.name );
+						continue;
+					}
+
+					std::printf( "%-8s %s  %-6s  %8.3f ms/frame\n", filter.name, format.name, levelNames[Simd::LEVEL_NONE], nsPerFrame / 1e6 );
+
+					for (int level=Simd::LEVEL_NONE+1; level <= supported; ++level)
+					{
+						Render( filter, format, Simd::Level(level), frames, pixels, nsPerFrame );
+
+						const size_t size = reference.size() / frames.size();
+						size_t offset = 0;
+
+						while (offset < reference.size() && reference[offset] == pixels[offset])
+							++offset;
+
+						if (offset == reference.size())
+						{
+							std::printf( "%-8s %s  %-6s  %8.3f ms/frame\n", filter.name, format.name, levelNames[level], nsPerFrame / 1e6 );
+						}
+						else
+						{
+							const size_t pitch = size / filter.height;
+
+							std::printf
+							(
+								"%-8s %s  %-6s  differs from scalar in frame %lu at %lu,%lu\n",
+								filter.name,
+								format.name,
+								levelNames[level],
+								(unsigned long)(offset / size),
+								(unsigned long)(offset % size % pitch / (format.bits / 8)),
+								(unsigned long)(offset % size / pitch)
+							);
+
+							exitCode = EXIT_MISMATCH;
+						}
+					}
+				}
+			}
+
+			Simd::SetLevel( supported );
+
+			return exitCode;
+		}
+	}
+}
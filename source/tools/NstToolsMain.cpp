@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "NstTools.hpp"
+
+#if NST_MSVC
+
+ #ifdef _DEBUG
+ #pragma comment(lib,"emucoredebug")
+ #else
+ #pragma comment(lib,"emucore")
+ #endif
+
+#endif
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		struct Command
+		{
+			const char* name;
+			int (*function)(int,char**);
+			const char* usage;
+		};
+
+		static const Command commands[] =
+		{
+			{
+				"verify", Verify,
+				"verify <image> <movie> [-a <config>] [-b <config>] [-frames <n>] [-trace <file>]\n"
+				"  Plays the movie on two emulators in lockstep and reports the first frame\n"
+				"  whose state differs. A config is a comma separated list of: video, sound,\n"
+				"  full=<n>, incremental=<n> (reload the state every n frames).\n"
+				"  Defaults: -a none -b incremental=1"
+			},
+			{
+				"benchmark", Benchmark,
+				"benchmark <directory> [-frames <n>] [-snapshots <n>] [-seed <n>] [-video] [-sound] [-o <file>]\n"
+				"  Runs every image in the directory with scripted random input and writes\n"
+				"  emulation speed and savestate save/load timings as JSON. With -sound, each\n"
+				"  image is also played in every sample format with the scalar and the SSE2\n"
+				"  sound mixing and conversion, which are timed and must give the same samples.\n"
+				"  Defaults: -frames 3600 -snapshots 100 -seed 1"
+			},
+			{
+				"mcts", Mcts,
+				"mcts [-min <n>] [-max <n>] [-rollout <frames>] [-seed <n>]\n"
+				"  Grows a RamAi search tree over a synthetic in-memory game up to 10^max\n"
+				"  nodes and writes iteration rate, phase latency percentiles, memory and\n"
+				"  allocation figures for every size from 10^min as JSON.\n"
+				"  Defaults: -min 3 -max 6 -rollout 60 -seed 1"
+			},
+			{
+				"replay", Replay,
+				"replay <image> <sequence> [-movie <file>]\n"
+				"  Plays the last best path saved in a RamAi action sequence file from\n"
+				"  power-on, optionally recording it as a movie, and checks that the state\n"
+				"  at the root of the search matches the one the path was saved from."
+			},
+			{
+				"database", Database,
+				"database <database.xml> <output> [-runs <n>]\n"
+				"  Compiles an XML image database into the form Cartridge::Database::Load()\n"
+				"  reads without parsing, checks that both forms give the same entries and\n"
+				"  writes the load time of each and the lookup time as JSON.\n"
+				"  Defaults: -runs 10"
+			},
+			{
+				"filters", Filters,
+				"filters [-frames <n>] [-seed <n>]\n"
+				"  Renders made up frames through the ScaleX, HqX and NTSC filters in every\n"
+				"  format at each SIMD level the CPU supports, checks that each level's\n"
+				"  output matches the scalar one byte for byte and reports the time per frame.\n"
+				"  Defaults: -frames 20 -seed 1"
+			}
+		};
+
+		Nes::Result LoadImage(Nes::Api::Emulator& emulator,const char* path)
+		{
+			std::ifstream stream( path, std::ifstream::in|std::ifstream::binary );
+
+			if (!stream.is_open())
+			{
+				std::fprintf( stderr, "can't open %s\n", path );
+				return Nes::RESULT_ERR_INVALID_FILE;
+			}
+
+			Nes::Api::Machine machine( emulator );
+			Nes::Result result = machine.Load( stream, Nes::Api::Machine::FAVORED_NES_NTSC );
+
+			if (NES_SUCCEEDED(result))
+				result = machine.Power( true );
+
+			if (NES_FAILED(result))
+				std::fprintf( stderr, "can't load %s (error %d)\n", path, int(result) );
+
+			return result;
+		}
+
+		static int Usage()
+		{
+			std::fprintf( stderr, "usage: nsttools <command> [arguments]\n\n" );
+
+			for (size_t i=0; i < sizeof(commands) / sizeof(commands[0]); ++i)
+				std::fprintf( stderr, "%s\n\n", commands[i].usage );
+
+			return EXIT_ERROR;
+		}
+	}
+}
+
+int main(int argc,char** argv)
+{
+	using namespace Nestopia::Tools;
+
+	if (argc >= 2)
+	{
+		for (size_t i=0; i < sizeof(commands) / sizeof(commands[0]); ++i)
+		{
+			if (std::strcmp( argv[1], commands[i].name ) == 0)
+			{
+				const int exitCode = commands[i].function( argc - 2, argv + 2 );
+				return exitCode == EXIT_USAGE ? Usage() : exitCode;
+			}
+		}
+	}
+
+	return Usage();
+}
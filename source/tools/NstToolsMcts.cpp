@@ -0,0 +1,472 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "../core/api/NstApiInput.hpp"
+#include "../../RamAi/Source/Data/BinaryCodedDecimal.h"
+#include "../../RamAi/Source/MonteCarlo/GameMonteCarloTree.h"
+#include "../../RamAi/Source/Settings/AiSettings.h"
+#include "../../RamAi/Source/Settings/ConsoleSettings.h"
+#include "../../RamAi/Source/Settings/GameSettings.h"
+#include "NstTools.hpp"
+
+#if NST_MSVC
+#pragma comment(lib,"RamAi")
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Allocation counting. Every block carries its size in front of it so the number of
+// live bytes is known at any time, which is what the nodes per GB figure is based on.
+////////////////////////////////////////////////////////////////////////////////////////
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		namespace Allocations
+		{
+			enum
+			{
+				HEADER = 16
+			};
+
+			static unsigned long long count = 0;
+			static unsigned long long liveBytes = 0;
+
+			static void* Allocate(size_t size)
+			{
+				unsigned char* const block = static_cast<unsigned char*>(std::malloc( size + HEADER ));
+
+				if (!block)
+					return NULL;
+
+				*reinterpret_cast<size_t*>(block) = size;
+				++count;
+				liveBytes += size;
+
+				return block + HEADER;
+			}
+
+			static void Free(void* p)
+			{
+				if (p)
+				{
+					unsigned char* const block = static_cast<unsigned char*>(p) - HEADER;
+					liveBytes -= *reinterpret_cast<size_t*>(block);
+					std::free( block );
+				}
+			}
+		}
+	}
+}
+
+void* operator new (size_t size)
+{
+	if (void* const p = Nestopia::Tools::Allocations::Allocate( size ? size : 1 ))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+void* operator new [] (size_t size)
+{
+	return operator new (size);
+}
+
+void* operator new (size_t size,const std::nothrow_t&) throw()
+{
+	return Nestopia::Tools::Allocations::Allocate( size ? size : 1 );
+}
+
+void* operator new [] (size_t size,const std::nothrow_t&) throw()
+{
+	return Nestopia::Tools::Allocations::Allocate( size ? size : 1 );
+}
+
+void operator delete (void* p) throw()
+{
+	Nestopia::Tools::Allocations::Free( p );
+}
+
+void operator delete [] (void* p) throw()
+{
+	Nestopia::Tools::Allocations::Free( p );
+}
+
+void operator delete (void* p,const std::nothrow_t&) throw()
+{
+	Nestopia::Tools::Allocations::Free( p );
+}
+
+void operator delete [] (void* p,const std::nothrow_t&) throw()
+{
+	Nestopia::Tools::Allocations::Free( p );
+}
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		typedef std::chrono::high_resolution_clock Clock;
+
+		//A deterministic stand-in for the emulator. Its whole state is a small block of
+		//memory, so saving, loading and stepping cost next to nothing and the timings
+		//are dominated by the search tree itself.
+		class SyntheticGame
+		{
+		public:
+
+			enum
+			{
+				SIZE = 64,
+				RNG = 0,
+				POSITION = 4,
+				SCORE = 8,
+				SCORE_DIGITS = 6
+			};
+
+			explicit SyntheticGame(unsigned long seed)
+			{
+				std::memset( ram, 0, sizeof(ram) );
+				Store32( RNG, seed ? seed : 1 );
+			}
+
+			RamAi::Savestate Save() const
+			{
+				return RamAi::Savestate( ram, SIZE );
+			}
+
+			void Load(const RamAi::Savestate& savestate)
+			{
+				savestate.CopyTo( ram );
+			}
+
+			void Step(const RamAi::ButtonSet& buttons)
+			{
+				const unsigned long input = buttons.GetBitfield().GetValue();
+				const unsigned long rng = Load32( RNG ) * 1664525UL + 1013904223UL;
+
+				Store32( RNG, rng ^ input );
+
+				//Moving right scores, standing on a "hazard" square costs points.
+				unsigned long position = Load32( POSITION );
+
+				if (input & Nes::Core::Input::Controllers::Pad::RIGHT)
+					++position;
+				else if ((input & Nes::Core::Input::Controllers::Pad::LEFT) && position)
+					--position;
+
+				Store32( POSITION, position );
+
+				unsigned long score = GetScore();
+
+				if ((rng >> 24 ^ position) % 7 == 0)
+					score = score > 10 ? score - 10 : 0;
+				else if (input & (Nes::Core::Input::Controllers::Pad::A|Nes::Core::Input::Controllers::Pad::RIGHT))
+					score += (rng >> 28) + 1;
+
+				SetScore( score );
+			}
+
+			unsigned long GetScore() const
+			{
+				return RamAi::BinaryCodedDecimal::ToInt( ram + SCORE, SCORE_DIGITS, RamAi::BinaryCodedDecimal::Big, false );
+			}
+
+		private:
+
+			void SetScore(unsigned long score)
+			{
+				score %= 1000000UL;
+
+				for (int i=SCORE_DIGITS-1; i >= 0; --i, score /= 10)
+					ram[SCORE+i] = score % 10;
+			}
+
+			unsigned long Load32(unsigned int offset) const
+			{
+				return ram[offset] | ram[offset+1] << 8 | ram[offset+2] << 16 | static_cast<unsigned long>(ram[offset+3]) << 24;
+			}
+
+			void Store32(unsigned int offset,unsigned long value)
+			{
+				for (unsigned int i=0; i < 4; ++i)
+					ram[offset+i] = (value >> (i * 8)) & 0xFF;
+			}
+
+			unsigned char ram[SIZE];
+		};
+
+		struct MctsSettings
+		{
+			MctsSettings()
+			: minExponent(3), maxExponent(6), rolloutFrames(60), seed(1) {}
+
+			unsigned int minExponent;
+			unsigned int maxExponent;
+			unsigned long rolloutFrames;
+			unsigned long seed;
+		};
+
+		//Latencies of one phase over a window of iterations, in nanoseconds.
+		class Latencies
+		{
+		public:
+
+			void Add(const Clock::duration& duration)
+			{
+				samples.push_back( static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::nanoseconds>( duration ).count()) );
+			}
+
+			void Reset(size_t expected)
+			{
+				samples.clear();
+				samples.reserve( expected );
+			}
+
+			size_t GetBytes() const
+			{
+				return samples.capacity() * sizeof(unsigned long);
+			}
+
+			unsigned long Percentile(unsigned int percent)
+			{
+				if (samples.empty())
+					return 0;
+
+				std::vector<unsigned long>::iterator nth = samples.begin() + (samples.size() - 1) * percent / 100;
+				std::nth_element( samples.begin(), nth, samples.end() );
+
+				return *nth;
+			}
+
+			void Write(std::FILE* file,const char* name)
+			{
+				std::fprintf
+				(
+					file,
+					"\"%s\": { \"p50\": %lu, \"p90\": %lu, \"p99\": %lu, \"max\": %lu }",
+					name,
+					Percentile( 50 ),
+					Percentile( 90 ),
+					Percentile( 99 ),
+					Percentile( 100 )
+				);
+			}
+
+		private:
+
+			std::vector<unsigned long> samples;
+		};
+
+		static void SetUpSettings(const MctsSettings& settings)
+		{
+			typedef Nes::Core::Input::Controllers::Pad Pad;
+
+			RamAi::ConsoleSettings::Specs specs;
+
+			specs.frameRate = 60;
+			specs.initialisationButtonSet = RamAi::ButtonSet(Pad::START);
+			specs.directionalPadFields[RamAi::DirectionalPad::Up] = RamAi::ButtonSet(Pad::UP);
+			specs.directionalPadFields[RamAi::DirectionalPad::Down] = RamAi::ButtonSet(Pad::DOWN);
+			specs.directionalPadFields[RamAi::DirectionalPad::Left] = RamAi::ButtonSet(Pad::LEFT);
+			specs.directionalPadFields[RamAi::DirectionalPad::Right] = RamAi::ButtonSet(Pad::RIGHT);
+			specs.buttonsField = RamAi::ButtonSet(Pad::A | Pad::B);
+
+			RamAi::ConsoleSettings::SetSpecs( specs );
+
+			RamAi::GameSettings gameSettings;
+
+			gameSettings.gameName = "Synthetic";
+			gameSettings.scoreOffset = SyntheticGame::SCORE;
+			gameSettings.scoreSize = SyntheticGame::SCORE_DIGITS;
+			gameSettings.scoreEndianness = RamAi::BinaryCodedDecimal::Big;
+			gameSettings.scoreTwoDigitsPerByte = false;
+
+			RamAi::GameSettings::SetInstance( gameSettings );
+
+			std::srand( settings.seed );
+		}
+
+		int Mcts(int argc,char** argv)
+		{
+			MctsSettings settings;
+
+			for (int i=0; i < argc; ++i)
+			{
+				if (i + 1 == argc)
+				{
+					return EXIT_USAGE;
+				}
+				else if (std::strcmp( argv[i], "-min" ) == 0)
+				{
+					settings.minExponent = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-max" ) == 0)
+				{
+					settings.maxExponent = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-rollout" ) == 0)
+				{
+					settings.rolloutFrames = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-seed" ) == 0)
+				{
+					settings.seed = std::strtoul( argv[++i], NULL, 10 );
+				}
+				else
+				{
+					return EXIT_USAGE;
+				}
+			}
+
+			if (settings.minExponent < 1 || settings.maxExponent < settings.minExponent || settings.maxExponent > 9)
+				return EXIT_USAGE;
+
+			SetUpSettings( settings );
+
+			SyntheticGame game( settings.seed );
+			RamAi::GameMonteCarloTree tree;
+
+			const unsigned long long baseBytes = Allocations::liveBytes;
+
+			tree.GetRoot().SetSavestate( game.Save() );
+
+			const unsigned int macroActionLength = std::max<unsigned int>( RamAi::AiSettings::GetData().macroActionLength, 1 );
+
+			Latencies select, expand, simulate, backpropagate;
+			unsigned long long nodes = 1, iterations = 0;
+
+			std::printf( "{\n  \"rollout_frames\": %lu,\n  \"seed\": %lu,\n  \"sizes\": [", settings.rolloutFrames, settings.seed );
+
+			unsigned long long target = 1;
+
+			for (unsigned int i=0; i < settings.minExponent; ++i)
+				target *= 10;
+
+			for (unsigned int exponent=settings.minExponent; exponent <= settings.maxExponent; ++exponent, target *= 10)
+			{
+				//Reserved up front so the samples don't show up in the allocation figures.
+				select.Reset( size_t(target - nodes) );
+				expand.Reset( size_t(target - nodes) );
+				simulate.Reset( size_t(target - nodes) );
+				backpropagate.Reset( size_t(target - nodes) );
+
+				const unsigned long long windowIterations = iterations;
+				const unsigned long long windowAllocations = Allocations::count;
+
+				const Clock::time_point windowStart = Clock::now();
+
+				//A 32-bit build runs out of address space somewhere past 10^6 nodes.
+				try
+				{
+					while (nodes < target)
+					{
+						//The same steps the expansion and simulation states take, minus the per-frame state machine.
+						const Clock::time_point start = Clock::now();
+
+						RamAi::TreeNode& selected = tree.Select();
+
+						const Clock::time_point selectEnd = Clock::now();
+
+						game.Load( *selected.GetSavestate() );
+
+						RamAi::TreeNode& expanded = tree.Expand( selected );
+
+						if (&expanded != &selected)
+						{
+							RamAi::ButtonSet action;
+							expanded.GetParent()->GetActionLeadingToChild( expanded, action );
+
+							for (unsigned int j=0; j < macroActionLength; ++j)
+								game.Step( action );
+
+							RamAi::Savestate savestate = game.Save();
+							savestate.SharePagesWith( *selected.GetSavestate() );
+							expanded.SetSavestate( std::move(savestate) );
+
+							++nodes;
+						}
+
+						const Clock::time_point expandEnd = Clock::now();
+
+						for (unsigned long j=0; j < settings.rolloutFrames; ++j)
+							game.Step( RamAi::ConsoleSettings::GetSpecs().GenerateRandomInput() );
+
+						const Clock::time_point simulateEnd = Clock::now();
+
+						tree.Backpropagate( expanded, game.GetScore() );
+
+						const Clock::time_point end = Clock::now();
+
+						select.Add( selectEnd - start );
+						expand.Add( expandEnd - selectEnd );
+						simulate.Add( simulateEnd - expandEnd );
+						backpropagate.Add( end - simulateEnd );
+
+						++iterations;
+					}
+				}
+				catch (const std::bad_alloc&)
+				{
+					std::fprintf( stderr, "out of memory at %llu nodes\n", nodes );
+					settings.maxExponent = exponent;
+				}
+
+				const double seconds = std::chrono::duration<double>( Clock::now() - windowStart ).count();
+				const unsigned long long count = iterations - windowIterations;
+				const unsigned long long treeBytes = Allocations::liveBytes - baseBytes - select.GetBytes() - expand.GetBytes() - simulate.GetBytes() - backpropagate.GetBytes();
+
+				std::fprintf( stderr, "%12llu nodes %12llu iterations %10.0f it/s\n", nodes, iterations, seconds > 0 ? count / seconds : 0.0 );
+
+				std::printf( "%s\n    {\n", exponent > settings.minExponent ? "," : "" );
+				std::printf( "      \"nodes\": %llu,\n", nodes );
+				std::printf( "      \"iterations\": %llu,\n", count );
+				std::printf( "      \"iterations_per_second\": %.1f,\n", seconds > 0 ? count / seconds : 0.0 );
+				std::printf( "      \"tree_bytes\": %llu,\n", treeBytes );
+				std::printf( "      \"nodes_per_gb\": %.0f,\n", treeBytes ? nodes * 1073741824.0 / treeBytes : 0.0 );
+				std::printf( "      \"allocations_per_iteration\": %.2f,\n", count ? double(Allocations::count - windowAllocations) / count : 0.0 );
+				std::printf( "      \"latency_ns\": {\n        " );
+				select.Write( stdout, "select" );
+				std::printf( ",\n        " );
+				expand.Write( stdout, "expand" );
+				std::printf( ",\n        " );
+				simulate.Write( stdout, "simulate" );
+				std::printf( ",\n        " );
+				backpropagate.Write( stdout, "backpropagate" );
+				std::printf( "\n      }\n    }" );
+			}
+
+			std::printf( "\n  ]\n}\n" );
+
+			return EXIT_OK;
+		}
+	}
+}
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+#include "../core/api/NstApiInput.hpp"
+#include "../core/api/NstApiMovie.hpp"
+#include "../../RamAi/Source/Action/ActionSequenceFile.h"
+#include "NstTools.hpp"
+
+#if NST_MSVC
+#pragma comment(lib,"RamAi")
+#endif
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		static unsigned long long HashState(Nes::Api::Emulator& emulator)
+		{
+			//Hashed the same way as RamAi::Savestate::CalculateHash(), over an uncompressed state.
+			std::ostringstream stream( std::ostringstream::out|std::ostringstream::binary );
+			Nes::Api::Machine( emulator ).SaveState( stream, Nes::Api::Machine::NO_COMPRESSION );
+
+			const std::string state( stream.str() );
+			unsigned long long hash = 0xCBF29CE484222325ULL;
+
+			for (std::string::const_iterator it(state.begin()), end(state.end()); it != end; ++it)
+				hash = (hash ^ static_cast<unsigned char>(*it)) * 0x100000001B3ULL;
+
+			return hash;
+		}
+
+		int Replay(int argc,char** argv)
+		{
+			if (argc < 2)
+				return EXIT_USAGE;
+
+			const char* const imagePath = argv[0];
+			const char* const sequencePath = argv[1];
+			const char* moviePath = NULL;
+
+			for (int i=2; i < argc; ++i)
+			{
+				if (i + 1 == argc)
+					return EXIT_USAGE;
+
+				if (std::strcmp( argv[i], "-movie" ) == 0)
+				{
+					moviePath = argv[i+1];
+				}
+				else
+				{
+					return EXIT_USAGE;
+				}
+
+				++i;
+			}
+
+			std::ifstream sequenceFile( sequencePath, std::ifstream::in|std::ifstream::binary );
+
+			if (!sequenceFile.is_open())
+			{
+				std::fprintf( stderr, "can't open %s\n", sequencePath );
+				return EXIT_ERROR;
+			}
+
+			const std::vector<char> data( (std::istreambuf_iterator<char>(sequenceFile)), std::istreambuf_iterator<char>() );
+			RamAi::ActionSequenceFile::Record record;
+
+			if (!RamAi::ActionSequenceFile::ReadLastRecord( reinterpret_cast<const uint8_t*>(data.data()), data.size(), record ))
+			{
+				std::fprintf( stderr, "no action sequence in %s\n", sequencePath );
+				return EXIT_ERROR;
+			}
+
+			Nes::Api::Emulator emulator;
+
+			if (NES_FAILED(LoadImage( emulator, imagePath )))
+				return EXIT_ERROR;
+
+			std::fstream movie;
+
+			if (moviePath)
+			{
+				movie.open( moviePath, std::fstream::in|std::fstream::out|std::fstream::binary|std::fstream::trunc );
+
+				if (!movie.is_open())
+				{
+					std::fprintf( stderr, "can't open %s\n", moviePath );
+					return EXIT_ERROR;
+				}
+
+				if (NES_FAILED(Nes::Api::Movie( emulator ).Record( movie, Nes::Api::Movie::CLEAN )))
+				{
+					std::fprintf( stderr, "can't record %s\n", moviePath );
+					return EXIT_ERROR;
+				}
+			}
+
+			const RamAi::ActionSequenceFile::RecordHeader& header = *record.GetHeader();
+
+			std::vector<RamAi::ButtonSet> inputs;
+			record.GetFrameInputs( inputs, true );
+
+			Nes::Core::Input::Controllers controllers;
+			bool rootStateMatches = (header.rootStateHash == 0);
+
+			for (size_t frame=0; frame <= inputs.size(); ++frame)
+			{
+				//The search started from the state right after initialisation.
+				//With an empty best path that's after the last input, so one more pass is made to check it.
+				if (frame == header.initialisationFrames && header.rootStateHash)
+					rootStateMatches = (HashState( emulator ) == header.rootStateHash);
+
+				if (frame == inputs.size())
+					break;
+
+				controllers.pad[0].buttons = inputs[frame].GetBitfield().GetValue();
+
+				if (NES_FAILED(emulator.Execute( NULL, NULL, &controllers )))
+				{
+					std::fprintf( stderr, "emulation failed at frame %lu\n", static_cast<unsigned long>(frame) );
+					return EXIT_ERROR;
+				}
+			}
+
+			if (moviePath)
+				Nes::Api::Movie( emulator ).Stop();
+
+			std::printf
+			(
+				"iteration %lu: %lu frames in %lu runs, best average score %.2f, root state %s\n",
+				static_cast<unsigned long>(header.iteration),
+				static_cast<unsigned long>(header.numberOfFrames),
+				static_cast<unsigned long>(header.numberOfRuns),
+				header.bestAverageScore,
+				header.rootStateHash ? (rootStateMatches ? "matches" : "differs") : "unknown"
+			);
+
+			return rootStateMatches ? EXIT_OK : EXIT_MISMATCH;
+		}
+	}
+}
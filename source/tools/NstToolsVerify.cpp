@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "../core/api/NstApiVerifier.hpp"
+#include "NstTools.hpp"
+
+namespace Nestopia
+{
+	namespace Tools
+	{
+		static bool ParseConfiguration(const char* string,Nes::Api::Verifier::Configuration& configuration)
+		{
+			configuration = Nes::Api::Verifier::Configuration();
+
+			char buffer[256];
+			std::strncpy( buffer, string, sizeof(buffer) - 1 );
+			buffer[sizeof(buffer) - 1] = '\0';
+
+			for (char* token = std::strtok( buffer, "," ); token; token = std::strtok( NULL, "," ))
+			{
+				if (std::strcmp( token, "none" ) == 0)
+				{
+				}
+				else if (std::strcmp( token, "video" ) == 0)
+				{
+					configuration.video = true;
+				}
+				else if (std::strcmp( token, "sound" ) == 0)
+				{
+					configuration.sound = true;
+				}
+				else if (std::strncmp( token, "full=", 5 ) == 0)
+				{
+					configuration.snapshot = Nes::Api::Machine::FULL_SNAPSHOT;
+					configuration.snapshotInterval = std::atoi( token + 5 );
+				}
+				else if (std::strncmp( token, "incremental=", 12 ) == 0)
+				{
+					configuration.snapshot = Nes::Api::Machine::INCREMENTAL_SNAPSHOT;
+					configuration.snapshotInterval = std::atoi( token + 12 );
+				}
+				else
+				{
+					std::fprintf( stderr, "unknown config option: %s\n", token );
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		int Verify(int argc,char** argv)
+		{
+			if (argc < 2)
+				return EXIT_USAGE;
+
+			const char* const imagePath = argv[0];
+			const char* const moviePath = argv[1];
+			const char* tracePath = NULL;
+			unsigned long maxFrames = ~0UL;
+
+			Nes::Api::Verifier::Configuration configurations[2];
+			ParseConfiguration( "incremental=1", configurations[1] );
+
+			for (int i=2; i < argc; ++i)
+			{
+				if (i + 1 == argc)
+					return EXIT_USAGE;
+
+				if (std::strcmp( argv[i], "-a" ) == 0 || std::strcmp( argv[i], "-b" ) == 0)
+				{
+					if (!ParseConfiguration( argv[i+1], configurations[argv[i][1] == 'b'] ))
+						return EXIT_USAGE;
+				}
+				else if (std::strcmp( argv[i], "-frames" ) == 0)
+				{
+					maxFrames = std::strtoul( argv[i+1], NULL, 10 );
+				}
+				else if (std::strcmp( argv[i], "-trace" ) == 0)
+				{
+					tracePath = argv[i+1];
+				}
+				else
+				{
+					return EXIT_USAGE;
+				}
+
+				++i;
+			}
+
+			Nes::Api::Emulator emulators[2];
+
+			for (int i=0; i < 2; ++i)
+			{
+				if (NES_FAILED(LoadImage( emulators[i], imagePath )))
+					return EXIT_ERROR;
+			}
+
+			std::ifstream movies[2];
+
+			for (int i=0; i < 2; ++i)
+			{
+				movies[i].open( moviePath, std::ifstream::in|std::ifstream::binary );
+
+				if (!movies[i].is_open())
+				{
+					std::fprintf( stderr, "can't open %s\n", moviePath );
+					return EXIT_ERROR;
+				}
+			}
+
+			std::ofstream trace;
+
+			if (tracePath)
+			{
+				trace.open( tracePath );
+
+				if (!trace.is_open())
+				{
+					std::fprintf( stderr, "can't open %s\n", tracePath );
+					return EXIT_ERROR;
+				}
+			}
+
+			Nes::Api::Verifier::Divergence divergence;
+
+			const Nes::Result result = Nes::Api::Verifier( emulators[0] ).Run
+			(
+				movies[0],
+				configurations[0],
+				emulators[1],
+				movies[1],
+				configurations[1],
+				maxFrames,
+				divergence,
+				tracePath ? &trace : NULL
+			);
+
+			if (NES_FAILED(result))
+			{
+				std::fprintf( stderr, "verification failed (error %d)\n", int(result) );
+				return EXIT_ERROR;
+			}
+
+			if (divergence.frame == Nes::Api::Verifier::Divergence::NONE)
+			{
+				std::printf( "%lu frames match\n", divergence.frames );
+				return EXIT_OK;
+			}
+
+			static const char* const names[Nes::Api::Verifier::NUM_SUBSYSTEMS] =
+			{
+				"cpu", "ppu", "image"
+			};
+
+			std::printf( "diverged at frame %lu in %s\n", divergence.frame, names[divergence.subsystem] );
+
+			for (int i=0; i < Nes::Api::Verifier::NUM_SUBSYSTEMS; ++i)
+			{
+				std::printf
+				(
+					"  %-5s a=%08lx%08lx b=%08lx%08lx\n",
+					names[i],
+					(unsigned long)(divergence.hashes[0].subsystems[i] >> 32), (unsigned long)(divergence.hashes[0].subsystems[i] & 0xFFFFFFFF),
+					(unsigned long)(divergence.hashes[1].subsystems[i] >> 32), (unsigned long)(divergence.hashes[1].subsystems[i] & 0xFFFFFFFF)
+				);
+			}
+
+			return EXIT_MISMATCH;
+		}
+	}
+}
@@ -115,6 +115,28 @@ namespace Nestopia
 					settings.rewindSpeed ? NST_CLAMP(settings.rewindSpeed,MIN_SPEED,MAX_SPEED) :
                                            DEFAULT_REWIND_SPEED
 				);
+
+				//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+				//Each key is 60 frames. There is no control for it in the dialog.
+				settings.rewindKeys = rewinder["keys"].Int();
+
+				settings.rewindKeys =
+				(
+					settings.rewindKeys ? NST_CLAMP(settings.rewindKeys,MIN_REWIND_KEYS,MAX_REWIND_KEYS) :
+                                          DEFAULT_REWIND_KEYS
+				);
+				//[SLEND]
+
+				//[SLBEGIN]: Multi-resolution rewind history.
+				//Memory for the history beyond the keys, in megabytes.
+				settings.rewindHistory = rewinder["history"].Int();
+
+				settings.rewindHistory =
+				(
+					settings.rewindHistory ? NST_CLAMP(settings.rewindHistory,MIN_REWIND_HISTORY,MAX_REWIND_HISTORY) :
+                                             DEFAULT_REWIND_HISTORY
+				);
+				//[SLEND]
 			}
 
 			{
@@ -153,6 +175,12 @@ namespace Nestopia
 				rewinder[ "use-native-speed" ].YesNo() = settings.useDefaultRewindSpeed;
 				rewinder[ "speed"            ].Int() = settings.rewindSpeed;
 				rewinder[ "sound"            ].YesNo() = !settings.noRewindSound;
+				//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+				rewinder[ "keys"             ].Int() = settings.rewindKeys;
+				//[SLEND]
+				//[SLBEGIN]: Multi-resolution rewind history.
+				rewinder[ "history"          ].Int() = settings.rewindHistory;
+				//[SLEND]
 			}
 
 			{
@@ -57,6 +57,16 @@ namespace Nestopia
 				DEFAULT_ALT_SPEED = DEFAULT_SPEED * 2,
 				DEFAULT_REWIND_SPEED = DEFAULT_SPEED,
 				DEFAULT_FRAME_SKIPS = 8,
+				//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+				MIN_REWIND_KEYS = 3,
+				MAX_REWIND_KEYS = 3600,
+				DEFAULT_REWIND_KEYS = 60,
+				//[SLEND]
+				//[SLBEGIN]: Multi-resolution rewind history.
+				MIN_REWIND_HISTORY = 1,
+				MAX_REWIND_HISTORY = 1024,
+				DEFAULT_REWIND_HISTORY = 16,
+				//[SLEND]
 				MAX_MHZ_TRIPLE_BUFFERING_ENABLE = 1350,
 				MAX_MHZ_AUTO_FRAME_SKIP_ENABLE = 950
 			};
@@ -86,6 +96,12 @@ namespace Nestopia
 				uchar altSpeed;
 				uchar rewindSpeed;
 				uchar maxFrameSkips;
+				//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+				uint rewindKeys;
+				//[SLEND]
+				//[SLBEGIN]: Multi-resolution rewind history.
+				uint rewindHistory;
+				//[SLEND]
 			}   settings;
 
 			Dialog dialog;
@@ -158,6 +174,20 @@ namespace Nestopia
 				return settings.rewindSpeed;
 			}
 
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			uint GetRewindKeys() const
+			{
+				return settings.rewindKeys;
+			}
+			//[SLEND]
+
+			//[SLBEGIN]: Multi-resolution rewind history.
+			uint GetRewindHistory() const
+			{
+				return settings.rewindHistory;
+			}
+			//[SLEND]
+
 			uint GetMaxFrameSkips() const
 			{
 				return settings.maxFrameSkips;
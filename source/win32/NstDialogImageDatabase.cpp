@@ -26,11 +26,17 @@
 #include "NstWindowParam.hpp"
 #include "NstWindowUser.hpp"
 #include "NstIoStream.hpp"
+//[SLBEGIN]: Compiled image database.
+#include "NstIoFile.hpp"
+//[SLEND]
 #include "NstResourceFile.hpp"
 #include "NstManagerPaths.hpp"
 #include "NstApplicationInstance.hpp"
 #include "NstDialogImageDatabase.hpp"
 #include "../core/api/NstApiCartridge.hpp"
+//[SLBEGIN]: Compiled image database.
+#include "../core/NstCrc32.hpp"
+//[SLEND]
 
 namespace Nestopia
 {
@@ -104,6 +110,14 @@ namespace Nestopia
 					if (settings.external && settings.file.Empty())
 						settings.external = false;
 
+					//[SLBEGIN]: Compiled image database.
+					uint key[CACHE_KEY_LENGTH];
+					const bool cacheable = GetCacheKey( internal, key );
+
+					if (cacheable && LoadCache( key ))
+						return;
+					//[SLEND]
+
 					if (settings.external && internal.Size())
 					{
 						Io::Stream::In stream0( Application::Instance::GetFullPath(settings.file) );
@@ -126,6 +140,11 @@ namespace Nestopia
 						if (NES_FAILED(Nes::Cartridge(emulator).GetDatabase().Load( stream )))
 							throw 1;
 					}
+
+					//[SLBEGIN]: Compiled image database.
+					if (cacheable)
+						SaveCache( key );
+					//[SLEND]
 				}
 			}
 			catch (...)
@@ -139,6 +158,99 @@ namespace Nestopia
 			}
 		}
 
+		//[SLBEGIN]: Compiled image database.
+
+		// The loaded databases are kept compiled in imagedatabase.ndb, prefixed
+		// by the CRC of the internal database and the size and time of the
+		// external one, so later starts skip the XML parsing until either changes.
+
+		bool ImageDatabase::GetCacheKey(const Collection::Buffer& internal,uint (&key)[CACHE_KEY_LENGTH]) const
+		{
+			key[0] = internal.Size() ? Nes::Core::Crc32::Compute( reinterpret_cast<const uchar*>(internal.Ptr()), internal.Size() ) : 0;
+			key[1] = 0;
+			key[2] = 0;
+			key[3] = 0;
+
+			if (settings.external)
+			{
+				WIN32_FILE_ATTRIBUTE_DATA data;
+
+				if (!::GetFileAttributesEx( Application::Instance::GetFullPath(settings.file).Ptr(), GetFileExInfoStandard, &data ) || data.nFileSizeHigh)
+					return false;
+
+				key[1] = data.nFileSizeLow;
+				key[2] = data.ftLastWriteTime.dwLowDateTime;
+				key[3] = data.ftLastWriteTime.dwHighDateTime;
+			}
+
+			return true;
+		}
+
+		bool ImageDatabase::LoadCache(const uint (&key)[CACHE_KEY_LENGTH])
+		{
+			const Path fileName( Application::Instance::GetExePath(L"imagedatabase.ndb") );
+
+			if (!fileName.FileExists())
+				return false;
+
+			try
+			{
+				Collection::Buffer data;
+
+				{
+					Io::File file( fileName, Io::File::COLLECT );
+
+					if (file.Size() <= CACHE_KEY_LENGTH * 4)
+						return false;
+
+					for (uint i=0; i < CACHE_KEY_LENGTH; ++i)
+					{
+						if (file.Read32() != key[i])
+							return false;
+					}
+
+					file.Stream() >> data;
+				}
+
+				// a damaged file is rejected by the core and rebuilt from the XML
+
+				Io::Stream::In stream( data );
+
+				return NES_SUCCEEDED(Nes::Cartridge(emulator).GetDatabase().Load( stream ));
+			}
+			catch (...)
+			{
+				return false;
+			}
+		}
+
+		void ImageDatabase::SaveCache(const uint (&key)[CACHE_KEY_LENGTH]) const
+		{
+			try
+			{
+				Collection::Buffer data;
+
+				{
+					Io::Stream::Out stream( data );
+
+					if (NES_FAILED(Nes::Cartridge(emulator).GetDatabase().Save( stream )))
+						return;
+				}
+
+				Io::File file( Application::Instance::GetExePath(L"imagedatabase.ndb"), Io::File::DUMP );
+
+				for (uint i=0; i < CACHE_KEY_LENGTH; ++i)
+					file.Write32( key[i] );
+
+				file.Write( data.Ptr(), data.Size() );
+			}
+			catch (...)
+			{
+				// without it the next start just parses the XML again
+			}
+		}
+		//[SLEND]
+
 		ibool ImageDatabase::OnInitDialog(Param&)
 		{
 			dialog.CheckBox( IDC_IMAGEDATABASE_INTERNAL ).Check( settings.internal );
@@ -48,6 +48,16 @@ namespace Nestopia
 
 			void Update(bool);
 			void UpdateAvailibility() const;
+			//[SLBEGIN]: Compiled image database.
+			enum
+			{
+				CACHE_KEY_LENGTH = 4
+			};
+
+			bool GetCacheKey(const Collection::Buffer&,uint (&)[CACHE_KEY_LENGTH]) const;
+			bool LoadCache(const uint (&)[CACHE_KEY_LENGTH]);
+			void SaveCache(const uint (&)[CACHE_KEY_LENGTH]) const;
+			//[SLEND]
 
 			ibool OnInitDialog  (Param&);
 			ibool OnCmdExternal (Param&);
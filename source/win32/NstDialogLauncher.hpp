@@ -337,6 +337,29 @@ namespace Nestopia
 
 						Hash hash;
 
+						//[SLBEGIN]: Parallel launcher search.
+						struct Stamp
+						{
+							uint size;
+							uint time[2];
+
+							void Clear()
+							{
+								size = 0;
+								time[0] = 0;
+								time[1] = 0;
+							}
+
+							bool operator == (const Stamp& stamp) const
+							{
+								return (time[0] | time[1]) && size == stamp.size && time[0] == stamp.time[0] && time[1] == stamp.time[1];
+							}
+						};
+
+						Stamp stamp;
+						uint fileCrc;
+						//[SLEND]
+
 						ushort pRom;
 						ushort cRom;
 						ushort wRam;
@@ -451,6 +474,9 @@ namespace Nestopia
 					ushort loaded;
 					Strings strings;
 					Entries entries;
+					//[SLBEGIN]: Parallel launcher search.
+					uint scanned;
+					//[SLEND]
 
 				public:
 
@@ -24,6 +24,9 @@
 
 #include <map>
 #include <set>
+//[SLBEGIN]: Parallel launcher search.
+#include <exception>
+//[SLEND]
 #include "NstWindowUser.hpp"
 #include "NstIoFile.hpp"
 #include "NstIoArchive.hpp"
@@ -57,7 +60,12 @@ namespace Nestopia
 		mapper     (0),
 		type       (t),
 		attributes (0)
-		{}
+		{
+			//[SLBEGIN]: Parallel launcher search.
+			stamp.Clear();
+			fileCrc = 0;
+			//[SLEND]
+		}
 
 		class Launcher::List::Files::Inserter
 		{
@@ -78,7 +86,9 @@ namespace Nestopia
 
 		protected:
 
-			void ReadFile(wcstring const,const Dialog&);
+			//[SLBEGIN]: Parallel launcher search.
+			void ReadFile(wcstring const);
+			//[SLEND]
 
 			enum Stop
 			{
@@ -104,6 +114,14 @@ namespace Nestopia
 			Entries entries;
 			Strings& saveStrings;
 			Entries& saveEntries;
+			//[SLBEGIN]: Parallel launcher search.
+			Entry::Stamp stamp;
+			uint fileCrc;
+			const Nes::Cartridge::Database& imageDatabase;
+			CRITICAL_SECTION* archiveLock;
+
+			bool CanParse() const;
+			//[SLEND]
 
 		private:
 
@@ -136,7 +154,6 @@ namespace Nestopia
 
 			Buffer buffer;
 			FileChecksums parsedFiles;
-			const Nes::Cartridge::Database& imageDatabase;
 		};
 
 		Launcher::List::Files::Inserter::Inserter
@@ -150,8 +167,18 @@ namespace Nestopia
 		include       ( i ),
 		saveStrings   ( v ),
 		saveEntries   ( e ),
-		imageDatabase ( r )
-		{}
+		//[SLBEGIN]: Parallel launcher search.
+		fileCrc       ( 0 ),
+		//[SLEND]
+		imageDatabase ( r ),
+		//[SLBEGIN]: Parallel launcher search.
+		archiveLock   ( NULL )
+		//[SLEND]
+		{
+			//[SLBEGIN]: Parallel launcher search.
+			stamp.Clear();
+			//[SLEND]
+		}
 
 		Launcher::List::Files::Inserter::Parser Launcher::List::Files::Inserter::GetParser() const
 		{
@@ -194,6 +221,13 @@ namespace Nestopia
 			return NULL;
 		}
 
+		//[SLBEGIN]: Parallel launcher search.
+		bool Launcher::List::Files::Inserter::CanParse() const
+		{
+			return GetParser() != NULL;
+		}
+		//[SLEND]
+
 		void Launcher::List::Files::Inserter::AddEntry(const Entry& entry)
 		{
 			entries.PushBack( entry );
@@ -201,6 +235,10 @@ namespace Nestopia
 			Entry& back = entries.Back();
 
 			back.file = (strings << path.string.File());
+			//[SLBEGIN]: Parallel launcher search.
+			back.stamp = stamp;
+			back.fileCrc = fileCrc;
+			//[SLEND]
 
 			if (path.reference == PATH_NOT_ADDED)
 				path.reference = (strings << path.string.Directory());
@@ -224,6 +262,25 @@ namespace Nestopia
 			path.string = fileName;
 			strings = saveStrings;
 
+			//[SLBEGIN]: Parallel launcher search.
+			{
+				WIN32_FILE_ATTRIBUTE_DATA data;
+
+				if (::GetFileAttributesEx( path.string.Ptr(), GetFileExInfoStandard, &data ) && !data.nFileSizeHigh)
+				{
+					stamp.size = data.nFileSizeLow;
+					stamp.time[0] = data.ftLastWriteTime.dwLowDateTime;
+					stamp.time[1] = data.ftLastWriteTime.dwHighDateTime;
+				}
+				else
+				{
+					stamp.Clear();
+				}
+
+				fileCrc = 0;
+			}
+			//[SLEND]
+
 			{
 				const int index = strings.Find( path.string.Directory() );
 
@@ -259,17 +316,17 @@ namespace Nestopia
 			return false;
 		}
 
-		void Launcher::List::Files::Inserter::ReadFile(wcstring const fileName,const Dialog& dialog)
+		//[SLBEGIN]: Parallel launcher search.
+		void Launcher::List::Files::Inserter::ReadFile(wcstring const fileName)
 		{
 			path.string.File() = fileName;
 
 			if (Parser const parser = GetParser())
 			{
-				if (dialog)
-					dialog.Control( IDC_LAUNCHER_FILESEARCH_FILE ).Text() << path.string.Ptr();
-
 				compressed = 0;
+				fileCrc = 0;
 				buffer.Clear();
+		//[SLEND]
 
 				try
 				{
@@ -293,7 +350,15 @@ namespace Nestopia
 		bool Launcher::List::Files::Inserter::UniqueFile()
 		{
 			NST_ASSERT( buffer.Size() );
-			return !include[Include::UNIQUE] || parsedFiles.insert(Crc(0,buffer.Size())).second;
+
+			//[SLBEGIN]: Parallel launcher search.
+			if (!include[Include::UNIQUE])
+				return true;
+
+			fileCrc = Crc(0,buffer.Size());
+
+			return parsedFiles.insert( fileCrc ).second;
+			//[SLEND]
 		}
 
 		bool Launcher::List::Files::Inserter::PrepareFile(const uint minSize,const uint fileId)
@@ -554,6 +619,32 @@ namespace Nestopia
 		{
 			compressed = Entry::ARCHIVE;
 
+			//[SLBEGIN]: Parallel launcher search.
+
+			// the archive readers share their state and temporary file, so
+			// workers open one archive at a time
+
+			struct Lock
+			{
+				CRITICAL_SECTION* const section;
+
+				explicit Lock(CRITICAL_SECTION* s)
+				: section(s)
+				{
+					if (section)
+						::EnterCriticalSection( section );
+				}
+
+				~Lock()
+				{
+					if (section)
+						::LeaveCriticalSection( section );
+				}
+			};
+
+			const Lock lock( archiveLock );
+			//[SLEND]
+
 			Io::File file;
 
 			try
@@ -581,6 +672,9 @@ namespace Nestopia
 				{
 					path.string << '>';
 					buffer.Resize( archive[i].Size() );
+					//[SLBEGIN]: Parallel launcher search.
+					fileCrc = 0;
+					//[SLEND]
 
 					if (archive[i].Uncompress( buffer.Ptr() ))
 						(*this.*parser)();
@@ -618,10 +712,17 @@ namespace Nestopia
 			(
 				Strings&,
 				Entries&,
+				//[SLBEGIN]: Parallel launcher search.
+				uint&,
+				//[SLEND]
 				const Settings&,
 				const Nes::Cartridge::Database&
 			);
 
+			//[SLBEGIN]: Parallel launcher search.
+			~Searcher();
+			//[SLEND]
+
 			void Search();
 
 		private:
@@ -633,6 +734,50 @@ namespace Nestopia
 
 			typedef std::set<HeapString> SearchedPaths;
 
+			//[SLBEGIN]: Parallel launcher search.
+
+			// Files are collected while walking the folders and parsed afterwards by
+			// a worker per CPU. Files whose size and time match the entries already in
+			// the list are taken from those instead. The results are merged in walk
+			// order so the list comes out the same as with a single thread.
+			// The cache is only used if the entries were found with the same
+			// settings, as they decide what a file turns into.
+
+			class Worker;
+
+			enum
+			{
+				MAX_WORKERS = 16,
+				CACHED = MAX_WORKERS
+			};
+
+			struct Job
+			{
+				uint directory;
+				HeapString file;
+				Entry::Stamp stamp;
+				uint worker;
+				uint first;
+				uint count;
+			};
+
+			struct Cached
+			{
+				uint first;
+				uint count;
+			};
+
+			typedef std::vector<Path> Directories;
+			typedef std::vector<Job> Jobs;
+			typedef std::map<HeapString,Cached> Cache;
+
+			void IndexCache();
+			bool FindCache(Job&);
+			void AddJob(const WIN32_FIND_DATA&,uint);
+			bool NextJob(uint&);
+			void Parse(System::Thread::Terminator);
+			void Merge(const Worker* const*);
+
 			ibool OnInitDialog (Param&);
 
 			bool UniquePath();
@@ -642,27 +787,141 @@ namespace Nestopia
 
 			const Settings::Folders& folders;
 			SearchedPaths searchedPaths;
+			Directories directories;
+			Jobs jobs;
+			Cache cache;
+			uint& scanned;
+			LONG volatile nextJob;
+			CRITICAL_SECTION archiveSection;
 			Dialog dialog;
 			System::Thread thread;
+			//[SLEND]
+		};
+
+		//[SLBEGIN]: Parallel launcher search.
+		class Launcher::List::Files::Searcher::Worker : public Inserter
+		{
+		public:
+
+			Worker(Searcher&,uint);
+
+			void Parse(Job&);
+			void Run(System::Thread::Terminator);
+
+			System::Thread thread;
+			std::exception_ptr failure;
+
+		private:
+
+			Searcher& searcher;
+			const uint id;
+			uint directory;
+
+		public:
+
+			const Strings& GetStrings() const
+			{
+				return strings;
+			}
+
+			const Entries& GetEntries() const
+			{
+				return entries;
+			}
 		};
 
+		Launcher::List::Files::Searcher::Worker::Worker(Searcher& s,const uint i)
+		:
+		Inserter  (s.saveStrings,s.saveEntries,s.include,s.imageDatabase),
+		searcher  (s),
+		id        (i),
+		directory (~0U)
+		{
+			archiveLock = &s.archiveSection;
+		}
+
+		void Launcher::List::Files::Searcher::Worker::Parse(Job& job)
+		{
+			if (directory != job.directory)
+			{
+				directory = job.directory;
+				path.string = searcher.directories[directory];
+				path.reference = PATH_NOT_ADDED;
+			}
+
+			stamp = job.stamp;
+
+			const uint first = entries.Size();
+
+			try
+			{
+				ReadFile( job.file.Ptr() );
+			}
+			catch (Stop)
+			{
+				// reached file count limit
+			}
+
+			job.worker = id;
+			job.first = first;
+			job.count = entries.Size() - first;
+		}
+
+		void Launcher::List::Files::Searcher::Worker::Run(System::Thread::Terminator terminate)
+		{
+			// the thread would swallow anything thrown, it's passed on once stopped
+
+			try
+			{
+				for (uint index; !terminate && searcher.NextJob( index ); )
+					Parse( searcher.jobs[index] );
+			}
+			catch (...)
+			{
+				failure = std::current_exception();
+			}
+		}
+		//[SLEND]
+
 		Launcher::List::Files::Searcher::Searcher
 		(
 			Strings& v,
 			Entries& e,
+			//[SLBEGIN]: Parallel launcher search.
+			uint& c,
+			//[SLEND]
 			const Settings& s,
 			const Nes::Cartridge::Database& r
 		)
 		:
 		Inserter (v,e,s.include,r),
 		folders  (s.folders),
+		//[SLBEGIN]: Parallel launcher search.
+		scanned  (c),
+		nextJob  (0),
+		//[SLEND]
 		dialog   (IDD_LAUNCHER_SEARCH,WM_INITDIALOG,this,&Searcher::OnInitDialog)
-		{}
+		{
+			//[SLBEGIN]: Parallel launcher search.
+			::InitializeCriticalSection( &archiveSection );
+			//[SLEND]
+		}
+
+		//[SLBEGIN]: Parallel launcher search.
+		Launcher::List::Files::Searcher::~Searcher()
+		{
+			::DeleteCriticalSection( &archiveSection );
+		}
+		//[SLEND]
 
 		void Launcher::List::Files::Searcher::Start(System::Thread::Terminator terminator)
 		{
 			try
 			{
+				//[SLBEGIN]: Parallel launcher search.
+				IndexCache();
+				//[SLEND]
+
 				for (Settings::Folders::const_iterator it(folders.begin()), end(folders.end()); it != end; ++it)
 				{
 					if (it->path.Length())
@@ -672,11 +931,16 @@ namespace Nestopia
 						if (UniquePath())
 						{
 							path.incSubDir = it->incSubDir;
-							path.reference = PATH_NOT_ADDED;
+							//[SLBEGIN]: Parallel launcher search.
 							Search( terminator );
+							//[SLEND]
 						}
 					}
 				}
+
+				//[SLBEGIN]: Parallel launcher search.
+				Parse( terminator );
+				//[SLEND]
 			}
 			catch (Stop)
 			{
@@ -691,6 +955,9 @@ namespace Nestopia
 
 			saveStrings = strings;
 			saveEntries = entries;
+			//[SLBEGIN]: Parallel launcher search.
+			scanned = include.Word();
+			//[SLEND]
 		}
 
 		ibool Launcher::List::Files::Searcher::OnInitDialog(Param&)
@@ -728,6 +995,11 @@ namespace Nestopia
 				}
 			};
 
+			//[SLBEGIN]: Parallel launcher search.
+			const uint directory = directories.size();
+			directories.push_back( path.string );
+			//[SLEND]
+
 			path.string.File() = "*.*";
 
 			FileFinder findFile( path.string.Ptr() );
@@ -745,8 +1017,10 @@ namespace Nestopia
 					{
 						if (findFile.data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
 							ReadPath( findFile.data.cFileName, terminate );
+						//[SLBEGIN]: Parallel launcher search.
 						else
-							ReadFile( findFile.data.cFileName, dialog );
+							AddJob( findFile.data, directory );
+						//[SLEND]
 					}
 				}
 				while (::FindNextFile( findFile.handle, &findFile.data ));
@@ -776,22 +1050,235 @@ namespace Nestopia
 			{
 				path.string.Directory() += subDir;
 
+				//[SLBEGIN]: Parallel launcher search.
 				if (UniquePath())
-				{
-					const uint reference = path.reference;
-					path.reference = PATH_NOT_ADDED;
 					Search( terminator );
-					path.reference = reference;
-				}
+				//[SLEND]
 
 				path.string.Directory() -= 1;
 			}
 		}
 
+		//[SLBEGIN]: Parallel launcher search.
+		void Launcher::List::Files::Searcher::IndexCache()
+		{
+			// entries of one file are stored in a row, archives by the archive's path
+
+			if (scanned != include.Word())
+				return;
+
+			Cache::iterator previous( cache.end() );
+
+			for (uint i=0, n=saveEntries.Size(); i < n; ++i)
+			{
+				const Entry& entry = saveEntries[i];
+
+				if (!entry.type)
+				{
+					previous = cache.end();
+					continue;
+				}
+
+				const Path fileName( saveStrings[entry.path], saveStrings[entry.file] );
+				HeapString key( fileName );
+
+				if (entry.type & Entry::ARCHIVE)
+				{
+					if (const uint length = fileName.Archive().Length())
+						key.ShrinkTo( length );
+				}
+
+				if (previous != cache.end() && previous->first == key && previous->second.first + previous->second.count == i)
+				{
+					++previous->second.count;
+				}
+				else
+				{
+					const Cached cached = {i,1};
+					previous = cache.insert( Cache::value_type(key,cached) ).first;
+				}
+			}
+		}
+
+		bool Launcher::List::Files::Searcher::FindCache(Job& job)
+		{
+			path.string.File() = job.file;
+
+			const Cache::const_iterator it( cache.find( path.string ) );
+
+			path.string.File().Clear();
+
+			if (it == cache.end())
+				return false;
+
+			for (uint i=it->second.first, n=it->second.first+it->second.count; i < n; ++i)
+			{
+				const Entry& entry = saveEntries[i];
+
+				if
+				(
+					!(entry.stamp == job.stamp) ||
+					(include[Include::UNIQUE] && !entry.fileCrc) ||
+					(entry.type & Entry::ALL & ~include.Word()) ||
+					((entry.type & Entry::ARCHIVE) && !include[Include::ARCHIVE])
+				)
+					return false;
+			}
+
+			job.worker = CACHED;
+			job.first = it->second.first;
+			job.count = it->second.count;
+
+			return true;
+		}
+
+		void Launcher::List::Files::Searcher::AddJob(const WIN32_FIND_DATA& data,const uint directory)
+		{
+			path.string.File() = data.cFileName;
+
+			const bool parsable = CanParse();
+
+			path.string.File().Clear();
+
+			if (parsable)
+			{
+				jobs.push_back( Job() );
+
+				Job& job = jobs.back();
+
+				job.directory = directory;
+				job.file = data.cFileName;
+				job.stamp.size = data.nFileSizeLow;
+				job.stamp.time[0] = data.ftLastWriteTime.dwLowDateTime;
+				job.stamp.time[1] = data.ftLastWriteTime.dwHighDateTime;
+				job.worker = 0;
+				job.first = 0;
+				job.count = 0;
+
+				if (data.nFileSizeHigh)
+					job.stamp.Clear();
+
+				FindCache( job );
+			}
+		}
+
+		bool Launcher::List::Files::Searcher::NextJob(uint& index)
+		{
+			do
+			{
+				index = ::InterlockedIncrement( &nextJob ) - 1;
+			}
+			while (index < jobs.size() && jobs[index].worker == CACHED);
+
+			return index < jobs.size();
+		}
+
+		void Launcher::List::Files::Searcher::Parse(System::Thread::Terminator terminate)
+		{
+			struct Workers
+			{
+				Worker* list[MAX_WORKERS];
+				uint count;
+
+				Workers()
+				: count(0) {}
+
+				~Workers()
+				{
+					// stops the threads before anything they use goes away
+
+					while (count)
+						delete list[--count];
+				}
+			};
+
+			Workers workers;
+
+			SYSTEM_INFO info;
+			::GetSystemInfo( &info );
+
+			const uint count = NST_MAX( NST_MIN( uint(info.dwNumberOfProcessors), uint(MAX_WORKERS) ), 1U );
+
+			for (uint i=0; i < count; ++i)
+			{
+				workers.list[i] = new Worker( *this, i );
+				workers.count = i + 1;
+			}
+
+			nextJob = 0;
+
+			for (uint i=1; i < count; ++i)
+				workers.list[i]->thread.Start( System::Thread::Callback(workers.list[i],&Worker::Run) );
+
+			for (uint index; NextJob( index ); )
+			{
+				if (terminate)
+					throw ABORT_SEARCH;
+
+				dialog.Control( IDC_LAUNCHER_FILESEARCH_FILE ).Text() << Path( directories[jobs[index].directory], jobs[index].file ).Ptr();
+
+				workers.list[0]->Parse( jobs[index] );
+			}
+
+			// every job is taken, stopping waits for the ones still being parsed
+
+			for (uint i=1; i < count; ++i)
+				workers.list[i]->thread.Stop();
+
+			for (uint i=1; i < count; ++i)
+			{
+				if (workers.list[i]->failure)
+					std::rethrow_exception( workers.list[i]->failure );
+			}
+
+			Merge( workers.list );
+		}
+
+		void Launcher::List::Files::Searcher::Merge(const Worker* const* const workers)
+		{
+			typedef std::set<uint> FileChecksums;
+
+			FileChecksums files;
+			std::vector<uint> references( directories.size(), uint(PATH_NOT_ADDED) );
+
+			for (Jobs::const_iterator job(jobs.begin()), end(jobs.end()); job != end; ++job)
+			{
+				const Strings& source = (job->worker == CACHED ? saveStrings : workers[job->worker]->GetStrings());
+				const Entries& found = (job->worker == CACHED ? saveEntries : workers[job->worker]->GetEntries());
+
+				for (uint i=job->first, n=job->first+job->count; i < n; ++i)
+				{
+					if (include[Include::UNIQUE] && !files.insert( found[i].fileCrc ).second)
+						continue;
+
+					entries.PushBack( found[i] );
+
+					Entry& entry = entries.Back();
+
+					entry.file = (strings << source[found[i].file]);
+
+					if (references[job->directory] == PATH_NOT_ADDED)
+						references[job->directory] = (strings << directories[job->directory].Directory());
+
+					entry.path = references[job->directory];
+
+					if (found[i].name)
+						entry.name = (strings << source[found[i].name]);
+
+					if (entries.Size() == MAX_ENTRIES)
+						throw STOP_SEARCH;
+				}
+			}
+		}
+		//[SLEND]
+
 		Launcher::List::Files::Files()
 		:
-		dirty  (false),
-		loaded (!Application::Instance::GetExePath(L"launcher.xml").FileExists())
+		dirty   (false),
+		loaded  (!Application::Instance::GetExePath(L"launcher.xml").FileExists()),
+		//[SLBEGIN]: Parallel launcher search.
+		scanned (0)
+		//[SLEND]
 		{
 			if (loaded)
 				Io::Log() << "Launcher: database file \"launcher.xml\" not present\r\n";
@@ -817,6 +1304,10 @@ namespace Nestopia
 				if (!xml.GetRoot().IsType( L"launcher" ) || !xml.GetRoot().GetAttribute( L"version" ).IsValue(L"1.1"))
 					throw 1;
 
+				//[SLBEGIN]: Parallel launcher search.
+				scanned = xml.GetRoot().GetAttribute( L"include" ).GetUnsignedValue( 16 );
+				//[SLEND]
+
 				for (Xml::Node node(xml.GetRoot().GetFirstChild()); node; node=node.GetNextSibling())
 				{
 					Entry entry;
@@ -865,6 +1356,26 @@ namespace Nestopia
 					if (node.GetChild( L"archive" ).IsValue( L"yes" ))
 						entry.type |= Entry::ARCHIVE;
 
+					//[SLBEGIN]: Parallel launcher search.
+					{
+						const Xml::Node time( node.GetChild( L"time" ) );
+
+						if (std::wcslen( time.GetValue() ) == 16)
+						{
+							wchar_t high[8+1];
+
+							std::wcsncpy( high, time.GetValue(), 8 );
+							high[8] = '\0';
+
+							entry.stamp.size = node.GetChild( L"size" ).GetUnsignedValue();
+							entry.stamp.time[0] = std::wcstoul( time.GetValue() + 8, NULL, 16 );
+							entry.stamp.time[1] = std::wcstoul( high, NULL, 16 );
+						}
+
+						entry.fileCrc = node.GetChild( L"filecrc" ).GetUnsignedValue( 16 );
+					}
+					//[SLEND]
+
 					switch (entry.type & Entry::ALL)
 					{
 						case Entry::XML:
@@ -973,6 +1484,15 @@ namespace Nestopia
 						Xml::Node root( xml.Create(L"launcher") );
 						root.AddAttribute( L"version", L"1.1" );
 
+						//[SLBEGIN]: Parallel launcher search.
+						if (scanned)
+						{
+							wchar_t include[16];
+							std::swprintf( include, L"%X", scanned );
+							root.AddAttribute( L"include", include );
+						}
+						//[SLEND]
+
 						for (Entries::ConstIterator it(entries.Begin()), end(entries.End()); it != end; ++it)
 						{
 							wcstring type;
@@ -998,6 +1518,23 @@ namespace Nestopia
 
 							wchar_t buffer[32];
 
+							//[SLBEGIN]: Parallel launcher search.
+							if (it->stamp.time[0] | it->stamp.time[1])
+							{
+								std::swprintf( buffer, L"%u", it->stamp.size );
+								node.AddChild( L"size", buffer );
+
+								std::swprintf( buffer, L"%08X%08X", it->stamp.time[1], it->stamp.time[0] );
+								node.AddChild( L"time", buffer );
+							}
+
+							if (it->fileCrc)
+							{
+								std::swprintf( buffer, L"%08X", it->fileCrc );
+								node.AddChild( L"filecrc", buffer );
+							}
+							//[SLEND]
+
 							switch (it->type & Entry::ALL)
 							{
 								case Entry::NSF:
@@ -1230,6 +1767,9 @@ namespace Nestopia
 
 			entries.Destroy();
 			strings.Clear();
+			//[SLBEGIN]: Parallel launcher search.
+			scanned = 0;
+			//[SLEND]
 		}
 
 		void Launcher::List::Files::Refresh
@@ -1239,7 +1779,9 @@ namespace Nestopia
 		)
 		{
 			dirty = true;
-			Searcher( strings, entries, settings, imageDatabase ).Search();
+			//[SLBEGIN]: Parallel launcher search.
+			Searcher( strings, entries, scanned, settings, imageDatabase ).Search();
+			//[SLEND]
 		}
 
 		Nes::Cartridge::Database::Entry Launcher::List::Files::Entry::SearchDb(const Nes::Cartridge::Database* db) const
@@ -204,8 +204,10 @@ namespace Nestopia
 			}
 		};
 
+		//[SLBEGIN]: Strip-parallel video filtering.
 		Video::Settings::Settings()
-		: fullscreenScale(SCREEN_MATCHED), backup(NULL) {}
+		: fullscreenScale(SCREEN_MATCHED), filterThreads(1), backup(NULL) {}
+		//[SLEND]
 
 		Video::Settings::~Settings()
 		{
@@ -353,6 +355,15 @@ namespace Nestopia
 			settings.autoHz = !video[ "auto-display-frequency" ].No();
 			settings.tvAspect = video[ "tv-aspect-ratio" ].Yes();
 
+			//[SLBEGIN]: Strip-parallel video filtering.
+			// 0 means one thread per processor
+
+			settings.filterThreads = video[ "filter-threads" ].Int( 1 );
+
+			if (NES_FAILED(Nes::Video(nes).SetBlitThreads( settings.filterThreads )))
+				settings.filterThreads = 1;
+			//[SLEND]
+
 			settings.filter = settings.filters + Filter::Load
 			(
 				cfg,
@@ -406,6 +417,9 @@ namespace Nestopia
 			video[ "screen-curvature"       ].Int() = MAX_SCREEN_CURVATURE + settings.screenCurvature;
 			video[ "auto-display-frequency" ].YesNo() = settings.autoHz;
 			video[ "tv-aspect-ratio"        ].YesNo() = settings.tvAspect;
+			//[SLBEGIN]: Strip-parallel video filtering.
+			video[ "filter-threads"         ].Int() = settings.filterThreads;
+			//[SLEND]
 
 			{
 				Configuration::Section palette( video["palette"] );
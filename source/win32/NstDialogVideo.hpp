@@ -122,6 +122,9 @@ namespace Nestopia
 				bool autoPalette;
 				bool autoHz;
 				bool tvAspect;
+				//[SLBEGIN]: Strip-parallel video filtering.
+				uint filterThreads;
+				//[SLEND]
 				const Backup* backup;
 			};
 
@@ -360,11 +360,18 @@ namespace Nestopia
 						return IDS_AVI_WRITE_ERR;
 				}
 
-				Buffer pixels( bitmapInfo.biSizeImage );
+				//[SLBEGIN]: Deferred frame pipeline.
+				Buffer pixels( bitmapInfo.biSizeImage * 2 );
 				Buffer samples( waveFormat.nAvgBytesPerSec / videoInfo.dwRate );
 
-				// picture will be stored upside down, adjust the pitch
-				Nes::Video::Output videoOutput( pixels.ptr + (VIDEO_BPP/8 * bitmapInfo.biWidth * (renderState.height-1)), -int(VIDEO_BPP/8 * bitmapInfo.biWidth) );
+				// two pictures, one is being rendered while the other is written,
+				// both stored upside down so adjust the pitch
+				Nes::Video::Output videoOutput[2] =
+				{
+					Nes::Video::Output( pixels.ptr + (VIDEO_BPP/8 * bitmapInfo.biWidth * (renderState.height-1)), -int(VIDEO_BPP/8 * bitmapInfo.biWidth) ),
+					Nes::Video::Output( pixels.ptr + bitmapInfo.biSizeImage + (VIDEO_BPP/8 * bitmapInfo.biWidth * (renderState.height-1)), -int(VIDEO_BPP/8 * bitmapInfo.biWidth) )
+				};
+
 				Nes::Sound::Output soundOutput( samples.ptr, samples.size / waveFormat.nBlockAlign );
 
 				{
@@ -379,44 +386,109 @@ namespace Nestopia
 					Nes::Video(emulator).SetRenderState( tmp );
 				}
 
-				for (uint frame=0, sample=0, size=0; Nes::Movie(emulator).IsPlaying() && size < MAX_FILE_SIZE; ++frame, sample += soundOutput.length[0])
+				// frame N is filtered on the pipeline thread while frame N+1 is emulated,
+				// the queue is drained before the pictures go out of scope
+
+				struct FrameQueue
 				{
-					::Sleep( 0 );
+					Nes::Video video;
+					const uint frames;
+					//[SLEND]
+					//[SLBEGIN]: Duplicate frame elision.
+					const bool skip;
+
+					FrameQueue(Nes::Emulator& emulator)
+					: video(emulator), frames(video.GetFrameQueue()), skip(video.IsDuplicateFrameSkipEnabled())
+					{
+						video.SetFrameQueue( 1 );
+						video.EnableDuplicateFrameSkip( true );
+					}
+
+					~FrameQueue()
+					{
+						video.Flush();
+						video.SetFrameQueue( frames );
+						video.EnableDuplicateFrameSkip( skip );
+					}
+				};
 
-					if (locker.CheckInput( VK_ESCAPE ))
-						return IDS_AVI_WRITE_ABORT;
+				const FrameQueue frameQueue( emulator );
 
-					if (NES_FAILED(emulator.Nes::Emulator::Execute( &videoOutput, sound ? &soundOutput : NULL, NULL )))
-						return IDS_AVI_WRITE_ERR;
+				// A duplicate frame isn't rendered at all and reuses the picture of
+				// the one before, so the pictures only swap on new frames. The line
+				// doubling is done in place and only once for each picture.
+
+				uint target = 0, previous = 0;
+				bool fresh = false;
+
+				for (uint frame=0, sample=0, size=0; ; ++frame, sample += soundOutput.length[0])
+				{
+					const bool playing = Nes::Movie(emulator).IsPlaying() && size < MAX_FILE_SIZE;
+					long written[2] = {0,0};
+
+					uint current = previous;
+					bool rendered = false;
 
-					if (bitmapInfo.biHeight == renderState.height * 2)
+					if (playing)
 					{
-						const uint pitch = -videoOutput.pitch;
+						::Sleep( 0 );
 
-						for (uchar *src=pixels.ptr + (pitch * (renderState.height-1)), *dst = pixels.ptr + (bitmapInfo.biSizeImage - pitch); ; src -= pitch)
-						{
-							std::memcpy( dst, src, pitch );
-							dst -= pitch;
+						if (locker.CheckInput( VK_ESCAPE ))
+							return IDS_AVI_WRITE_ABORT;
 
-							if (dst == pixels.ptr)
-								break;
+						if (NES_FAILED(emulator.Nes::Emulator::Execute( &videoOutput[target], sound ? &soundOutput : NULL, NULL )))
+							return IDS_AVI_WRITE_ERR;
 
-							std::memcpy( dst, src, pitch );
-							dst -= pitch;
+						if (!Nes::Video(emulator).IsFrameDuplicate())
+						{
+							current = target;
+							target ^= 1;
+							rendered = true;
 						}
+
+						if (sound && ::AVIStreamWrite( sound, sample, soundOutput.length[0], samples.ptr, samples.size, 0, NULL, written+1 ) != AVIERR_OK)
+							return IDS_AVI_WRITE_ERR;
 					}
 
-					long written[2] = {0,0};
+					if (frame)
+					{
+						// wait for the previous picture only, the current one may still be pending
+						Nes::Video(emulator).Flush( playing ? 1 : 0 );
 
-					if
-					(
-						(::AVIStreamWrite( compressor, frame, 1, pixels.ptr, pixels.size, AVIIF_KEYFRAME, NULL, written+0 ) != AVIERR_OK) ||
-						(sound && ::AVIStreamWrite( sound, sample, soundOutput.length[0], samples.ptr, samples.size, 0, NULL, written+1 ) != AVIERR_OK)
-					)
-						return IDS_AVI_WRITE_ERR;
+						uchar* const picture = pixels.ptr + previous * bitmapInfo.biSizeImage;
+
+						if (fresh && bitmapInfo.biHeight == renderState.height * 2)
+						{
+							const uint pitch = VIDEO_BPP/8 * bitmapInfo.biWidth;
 
+							for (uchar *src=picture + (pitch * (renderState.height-1)), *dst = picture + (bitmapInfo.biSizeImage - pitch); ; src -= pitch)
+							{
+								std::memcpy( dst, src, pitch );
+								dst -= pitch;
+
+								if (dst == picture)
+									break;
+
+								std::memcpy( dst, src, pitch );
+								dst -= pitch;
+							}
+						}
+
+						if (::AVIStreamWrite( compressor, frame - 1, 1, picture, bitmapInfo.biSizeImage, AVIIF_KEYFRAME, NULL, written+0 ) != AVIERR_OK)
+							return IDS_AVI_WRITE_ERR;
+					}
+
+					previous = current;
+					fresh = rendered;
+					//[SLEND]
+
+					//[SLBEGIN]: Deferred frame pipeline.
 					size += (written[0] > 0 ? written[0] : 0) + (written[1] > 0 ? written[1] : 0);
+
+					if (!playing)
+						break;
 				}
+				//[SLEND]
 
 				avi.SetSuccess();
 
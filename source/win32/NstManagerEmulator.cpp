@@ -54,6 +54,11 @@ namespace Nestopia
 		{
 			static Nes::User::Answer NST_CALLBACK Confirm(Nes::User::UserData,Nes::User::Question question)
 			{
+				//[SLBEGIN]: Recording RamAi movies in the background.
+				if (RamAiMovieRecorder::IsRecorderThread())
+					return Nes::User::ANSWER_DEFAULT;
+				//[SLEND]
+
 				NST_COMPILE_ASSERT( Nes::User::NUM_QUESTION_CALLBACKS == 2 );
 
 				switch (question)
@@ -83,6 +88,11 @@ namespace Nestopia
 
 			static void NST_CALLBACK DoFileIO(Nes::User::UserData user,Nes::User::File& context)
 			{
+				//[SLBEGIN]: Recording RamAi movies in the background.
+				if (RamAiMovieRecorder::IsRecorderThread())
+					return;
+				//[SLEND]
+
 				NST_COMPILE_ASSERT( Nes::User::NUM_FILE_CALLBACKS == 17 );
 				NST_ASSERT( user );
 
@@ -157,6 +167,11 @@ namespace Nestopia
 
 			static void NST_CALLBACK OnMachine(Nes::User::UserData user,Nes::Machine::Event event,Nes::Result result)
 			{
+				//[SLBEGIN]: Recording RamAi movies in the background.
+				if (RamAiMovieRecorder::IsRecorderThread())
+					return;
+				//[SLEND]
+
 				NST_COMPILE_ASSERT( Nes::Machine::NUM_EVENT_CALLBACKS == 8 );
 				NST_ASSERT( user );
 
@@ -224,6 +239,11 @@ namespace Nestopia
 
 			static void NST_CALLBACK OnEvent(Nes::User::UserData,Nes::User::Event event,const void* data)
 			{
+				//[SLBEGIN]: Recording RamAi movies in the background.
+				if (RamAiMovieRecorder::IsRecorderThread())
+					return;
+				//[SLEND]
+
 				NST_COMPILE_ASSERT( Nes::User::NUM_EVENT_CALLBACKS == 3 );
 
 				switch (event)
@@ -250,6 +270,11 @@ namespace Nestopia
 
 			static void NST_CALLBACK OnControllerPort(Nes::Input::UserData user,uint port,Nes::Input::Type type)
 			{
+				//[SLBEGIN]: Recording RamAi movies in the background.
+				if (RamAiMovieRecorder::IsRecorderThread())
+					return;
+				//[SLEND]
+
 				NST_ASSERT( user && port < Nes::Input::NUM_PORTS );
 
 				static_cast<Emulator*>(user)->events( static_cast<Event>(EVENT_PORT1_CONTROLLER + port), type );
@@ -257,6 +282,11 @@ namespace Nestopia
 
 			static void NST_CALLBACK OnAdapterPort(Nes::Input::UserData user,Nes::Input::Adapter adapter)
 			{
+				//[SLBEGIN]: Recording RamAi movies in the background.
+				if (RamAiMovieRecorder::IsRecorderThread())
+					return;
+				//[SLEND]
+
 				NST_ASSERT( user );
 
 				static_cast<Emulator*>(user)->events( EVENT_PORT_ADAPTER, adapter );
@@ -307,6 +337,11 @@ namespace Nestopia
 
 			static void NST_CALLBACK OnMovie(Nes::Nsf::UserData user,Nes::Movie::Event event,Nes::Result result)
 			{
+				//[SLBEGIN]: Recording RamAi movies in the background.
+				if (RamAiMovieRecorder::IsRecorderThread())
+					return;
+				//[SLEND]
+
 				NST_COMPILE_ASSERT( Nes::Movie::NUM_EVENT_CALLBACKS == 4 );
 				NST_ASSERT( user );
 
@@ -1257,7 +1292,7 @@ namespace Nestopia
 
 						ramAiApi->ImportGameSettings(gameSettings, settings.paths.start.Directory(), gameNameWide);
 
-						ramAiApi->InitialiseGame(gameSettings);
+						ramAiApi->InitialiseGame(gameSettings, imageBuffer, patchBuffer, bypassPatchValidation, favoredSystem);
 					}
 					//[SLEND]
 				}
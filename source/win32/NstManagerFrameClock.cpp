@@ -86,6 +86,13 @@ namespace Nestopia
 
 		void FrameClock::UpdateRewinderState(bool force) const
 		{
+			//[SLBEGIN]: Keyframes in a preallocated ring of raw snapshots.
+			Nes::Rewinder(emulator).SetNumKeys( dialog->GetRewindKeys() );
+			//[SLEND]
+			//[SLBEGIN]: Multi-resolution rewind history.
+			Nes::Rewinder(emulator).SetHistorySize( ulong(dialog->GetRewindHistory()) << 20 );
+			//[SLEND]
+
 			if (NES_SUCCEEDED(Nes::Rewinder(emulator).Enable( force && dialog->UseRewinder() )))
 				Nes::Rewinder(emulator).EnableSound( !dialog->NoRewindSound() );
 		}
@@ -917,6 +917,11 @@ namespace Nestopia
 
 			Input& input = *static_cast<Input*>(data);
 
+			//[SLBEGIN]: The RamAi movie recorder runs its own emulator on another thread, with its buttons already set.
+			if (&pad != &input.nesControllers.pad[index])
+				return true;
+			//[SLEND]
+
 			input.CheckPoll();
 
 			//[SLBEGIN]: Disabled what seems to be default controls?
@@ -22,11 +22,18 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cstring>
 #include "NstRamAiApi.h"
 
+#include "../../core/api/NstApiCartridge.hpp"
 #include "../../core/api/NstApiInput.hpp"
 #include "../../core/api/NstApiMovie.hpp"
 #include "../NstApplicationInstance.hpp"
+#include "../../../RamAi/Source/Score/ScoreLogColumns.h"
+#include "../../../RamAi/Source/Settings/AiSettings.h"
+#include "../../../RamAi/Source/Trace.h"
+#include "../../core/NstTrace.hpp"
 #include "NstRamAiDebug.h"
 
 
@@ -35,27 +42,58 @@ Nestopia::RamAiApi::RamAiApi(Managers::Emulator &emulator)
 	, m_emulator(emulator)
 	, m_allowHumanOverride(true)
 {
+#ifdef NST_TRACE
+	//The core's trace scopes go into the same buffers as RamAi's own.
+	Nes::Core::Trace::SetCallbacks(&RamAiApi::BeginCoreTrace, &RamAiApi::EndCoreTrace);
+#endif
 }
 
 Nestopia::RamAiApi::~RamAiApi()
 {
+	//The base class's state machine outlives our files, so stop its checkpoint writer first.
+	RamAi::Api::DisableTreeCheckpoints();
+
+	WriteTraceFile();
+
+#ifdef NST_TRACE
+	Nes::Core::Trace::SetCallbacks(NULL, NULL);
+#endif
 }
 
-void Nestopia::RamAiApi::InitialiseGame(const RamAi::GameSettings &gameDetails)
+void Nestopia::RamAiApi::InitialiseGame(const RamAi::GameSettings &gameDetails, const Collection::Buffer &image, const Collection::Buffer &patch,
+	const bool bypassPatchValidation, const Nes::Machine::FavoredSystem favoredSystem)
 {
-	//Bind functions to this specific instance and pass them to the base class.
-	RamAi::StateMachine::SaveStateHandleSignature saveStateHandle = std::bind(&RamAiApi::SaveState, this);
+	//The trace of the previous game is kept until the next one is written over it.
+	WriteTraceFile();
 
-	//std::placeholders are used for extra parameters that are filled in later.
-	RamAi::StateMachine::LoadStateHandleSignature loadStateHandle = std::bind(&RamAiApi::LoadState, this, std::placeholders::_1); 
+	//Movies of the previous game are finished on its own recorder.
+	m_movieRecorder.reset();
+	m_movieRecorder = std::make_unique<RamAiMovieRecorder>(image, patch, bypassPatchValidation, favoredSystem, Nes::Machine(m_emulator).GetMode());
+
+	//Finish writing the previous game's checkpoint and log; the new game gets its own files.
+	RamAi::Api::DisableTreeCheckpoints();
+	m_checkpointBlobFile.reset();
+
+	m_scoreLogWriter.reset();
+	m_scoreLogFile.reset();
+	m_scoreLogSpillWriter.reset();
+	m_scoreLogSpillFile.reset();
+	m_bestPathWriter.reset();
+	m_bestPathFile.reset();
 
+	//Bind file handles to this specific instance and pass them to the base class.
+	//std::placeholders are used for extra parameters that are filled in later.
 	RamAi::ScoreLog::SaveLogToFileSignature saveLogToFileHandle = std::bind(&RamAiApi::SaveLogToFile, this, std::placeholders::_1, std::placeholders::_2); 
+	RamAi::ScoreLog::SpillLogToFileSignature spillLogToFileHandle = std::bind(&RamAiApi::SpillLogToFile, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
 
-	RamAi::StateMachine::StartRecordingHandleSignature startRecordingHandle = std::bind(&RamAiApi::StartRecording, this, std::placeholders::_1);
-	RamAi::StateMachine::FinishRecordingHandleSignature finishRecordingHandle = std::bind(&RamAiApi::FinishRecording, this);
+	RamAi::StateMachine::SaveBestPathHandleSignature saveBestPathHandle = std::bind(&RamAiApi::SaveBestPath, this, std::placeholders::_1, std::placeholders::_2);
 
 	//Call the base.
-	RamAi::Api::InitialiseGame(gameDetails, saveStateHandle, loadStateHandle, saveLogToFileHandle, startRecordingHandle, finishRecordingHandle);
+	//The emulator itself is driven through this class's EmulatorBackend implementation.
+	RamAi::Api::InitialiseGame(gameDetails, *this, saveLogToFileHandle, spillLogToFileHandle, saveBestPathHandle);
+
+	InitialiseTreeCheckpoints(gameDetails);
+	InitialiseMetrics();
 
 	EnableTurbo(true);
 }
@@ -135,53 +173,95 @@ void Nestopia::RamAiApi::ImportGameSettings(RamAi::GameSettings &gameSettings, c
 	}
 }
 
-RamAi::Savestate Nestopia::RamAiApi::SaveState()
+bool Nestopia::RamAiApi::SaveInto(RamAi::Savestate &savestate)
 {
-	//Most of this is derived from Nestopia::Managers::Emulator::SaveState().
-	Collection::Buffer buffer;
-	Io::Stream::Out stream(buffer);
+	RAMAI_TRACE_SCOPE("RamAiApi::SaveInto");
 
-	Nes::Result result = Nes::Machine(m_emulator).SaveState(stream, s_compressSavestates ? Nes::Machine::USE_COMPRESSION : Nes::Machine::NO_COMPRESSION);
+	//Most of this is derived from Nestopia::Managers::Emulator::SaveState().
+	//Clearing the buffer keeps its capacity, so it only grows on the first few saves.
+	m_saveStateBuffer.Clear();
 
-	if (NES_SUCCEEDED(result))
 	{
-		return std::move(BufferToSavestate(buffer));
-	}
-	else
-	{
-		return RamAi::Savestate();
-	}
-}
+		Io::Stream::Out stream(m_saveStateBuffer);
 
-RamAi::Savestate Nestopia::RamAiApi::BufferToSavestate(const Collection::Buffer &buffer)
-{
-	//Get byte array from buffer.
-	const uint8_t *bytePtr = reinterpret_cast<const uint8_t*>(buffer.Ptr());
-	const size_t numberOfBytes = buffer.Size();
+		Nes::Result result = Nes::Machine(m_emulator).SaveState(stream, s_compressSavestates ? Nes::Machine::USE_COMPRESSION : Nes::Machine::NO_COMPRESSION);
 
-	return RamAi::Savestate(bytePtr, numberOfBytes);
+		if (NES_FAILED(result))
+		{
+			return false;
+		}
+	}
+
+	savestate = RamAi::Savestate(reinterpret_cast<const uint8_t*>(m_saveStateBuffer.Ptr()), m_saveStateBuffer.Size());
+	return true;
 }
 
-void Nestopia::RamAiApi::LoadState(const RamAi::Savestate &savestate)
+void Nestopia::RamAiApi::LoadFrom(const uint8_t *data, const size_t size)
 {
+	RAMAI_TRACE_SCOPE("RamAiApi::LoadFrom");
+
 	//Most of this is derived from Nestopia::Managers::Emulator::LoadState().
-	Collection::Buffer buffer = std::move(SavestateToBuffer(savestate));
-	Io::Stream::In stream(buffer);
+	//The stream reads straight from the state machine's buffer, so nothing is copied.
+	//States are always saved and loaded in full. By the time a node is restored the emulator has
+	//simulated well past it, so an incremental snapshot (only the pages written since its base
+	//state) would be applied on top of the wrong state.
+	Io::Stream::In stream(data, static_cast<uint>(size));
 
 	Nes::Result result = Nes::Machine(m_emulator).LoadState(stream);
 
 	assert(NES_SUCCEEDED(result));
 }
 
-Nestopia::Collection::Buffer Nestopia::RamAiApi::SavestateToBuffer(const RamAi::Savestate &savestate)
+void Nestopia::RamAiApi::SaveLogToFile(const RamAi::ScoreLog &scoreLog, const RamAi::MonteCarloTreeBase &tree)
 {
-	const char *charPtr = reinterpret_cast<const char*>(savestate.GetData().get());
-	Collection::Buffer buffer(charPtr, savestate.GetSize());
+	//The file is opened once per game and only new items are appended to it after that.
+	if (!m_scoreLogWriter && !OpenLogFile(scoreLog, s_scoreLogExtension, m_scoreLogFile, m_scoreLogWriter))
+	{
+		return;
+	}
+
+	if (m_scoreLogWriter->PopWriteFailed())
+	{
+		RamAi::Debug::OutLine("Error saving log file for iteration " + std::to_string(scoreLog.GetCurrentIteration()), RamAi::Colour::Red);
+	}
 
-	return buffer;
+	m_scoreLogWriter->Append(scoreLog, tree);
 }
 
-void Nestopia::RamAiApi::SaveLogToFile(const RamAi::ScoreLog &scoreLog, const RamAi::MonteCarloTreeBase &tree)
+void Nestopia::RamAiApi::SpillLogToFile(const RamAi::ScoreLog &scoreLog, const size_t firstItemIndex, const size_t numberOfItems)
+{
+	if (!m_scoreLogSpillWriter && !OpenLogFile(scoreLog, s_scoreLogSpillExtension, m_scoreLogSpillFile, m_scoreLogSpillWriter))
+	{
+		return;
+	}
+
+	if (m_scoreLogSpillWriter->PopWriteFailed())
+	{
+		RamAi::Debug::OutLine("Error spilling log file for iteration " + std::to_string(scoreLog.GetCurrentIteration()), RamAi::Colour::Red);
+	}
+
+	m_scoreLogSpillBuffer.clear();
+	RamAi::ScoreLogColumns::AppendBlock(scoreLog, firstItemIndex, numberOfItems, m_scoreLogSpillBuffer);
+
+	m_scoreLogSpillWriter->AppendData(m_scoreLogSpillBuffer.data(), m_scoreLogSpillBuffer.size());
+}
+
+void Nestopia::RamAiApi::SaveBestPath(const RamAi::ScoreLog &scoreLog, const std::string &record)
+{
+	if (!m_bestPathWriter && !OpenLogFile(scoreLog, s_bestPathExtension, m_bestPathFile, m_bestPathWriter))
+	{
+		return;
+	}
+
+	if (m_bestPathWriter->PopWriteFailed())
+	{
+		RamAi::Debug::OutLine("Error saving best path for iteration " + std::to_string(scoreLog.GetCurrentIteration()), RamAi::Colour::Red);
+	}
+
+	m_bestPathWriter->AppendData(record.data(), record.size());
+}
+
+bool Nestopia::RamAiApi::OpenLogFile(const RamAi::ScoreLog &scoreLog, const std::wstring &extension, std::unique_ptr<Io::File> &outFile, std::unique_ptr<RamAi::ScoreLogWriter> &outWriter)
 {
 	//Create the directory to store logs first.
 	{
@@ -197,7 +277,7 @@ void Nestopia::RamAiApi::SaveLogToFile(const RamAi::ScoreLog &scoreLog, const Ra
 	//More string junk!
 	std::wstring scoreLogFileNameWide = s_scoreLogDirectory;
 	scoreLogFileNameWide += std::wstring(scoreLog.GetFileName().begin(), scoreLog.GetFileName().end()); //STL string to STL wide string.
-	scoreLogFileNameWide += s_scoreLogExtension;
+	scoreLogFileNameWide += extension;
 
 	//STL wide string to Nestopia wide string.
 	String::Generic<wchar_t> scoreLogFileName(scoreLogFileNameWide.c_str(), scoreLogFileNameWide.length());
@@ -208,70 +288,205 @@ void Nestopia::RamAiApi::SaveLogToFile(const RamAi::ScoreLog &scoreLog, const Ra
 
 	try
 	{
-		//Open the file. We empty any existing file; this might be dangerous if it stops midway!
-		Io::File file(scoreLogPathString, Io::File::WRITE | Io::File::EMPTY);
+		outFile = std::make_unique<Io::File>(scoreLogPathString, Io::File::DUMP);
+	}
+	catch (...)
+	{
+		RamAi::Debug::OutLine("Error opening log file for iteration " + std::to_string(scoreLog.GetCurrentIteration()), RamAi::Colour::Red);
+		return false;
+	}
 
-		static const size_t rowSize = 256;
-		char rowData[rowSize];
+	const Io::File *file = outFile.get();
 
-		bool hasWrittenHeader = false;
+	outWriter = std::make_unique<RamAi::ScoreLogWriter>([file](const char *data, const size_t size)
+	{
+		file->Write(data, static_cast<uint>(size));
+	});
 
-		for (auto it = scoreLog.GetItems().cbegin(); it != scoreLog.GetItems().cend(); ++it)
-		{
-			//Write the header.
-			if (!hasWrittenHeader)
-			{
-				const std::string itemHeadings = std::move(it->GetItemHeadings(tree));
-				strcpy_s(rowData, rowSize, itemHeadings.c_str());
+	return true;
+}
+
+void Nestopia::RamAiApi::InitialiseMetrics()
+{
+	m_metricsWriter.reset();
+
+	const float metricsFileInterval = RamAi::AiSettings::GetData().metricsFileInterval;
 
-				file.WriteSome(rowData, itemHeadings.length());
+	if (metricsFileInterval <= 0.0f)
+	{
+		return;
+	}
 
-				hasWrittenHeader = true;
-			}
+	//The file is in the Prometheus text format, so it can be picked up by a textfile collector or read as it is.
+	const std::wstring metricsPath = GetLogDirectoryFilePath(s_metricsFileName);
 
-			//Write the item values.
-			const std::string itemValues = std::move(it->GetItemValues());
-			strcpy_s(rowData, rowSize, itemValues.c_str());
+	RamAi::MetricsWriter::WriteHandleSignature writeHandle = std::bind(&RamAiApi::WriteFileAtomically, metricsPath, std::placeholders::_1, std::placeholders::_2);
+	const std::chrono::milliseconds interval(static_cast<long long>(metricsFileInterval * 1000.0f));
 
-			file.WriteSome(rowData, itemValues.length());
-		}
+	m_metricsWriter = std::make_unique<RamAi::MetricsWriter>(writeHandle, interval);
+}
+
+std::wstring Nestopia::RamAiApi::GetLogDirectoryFilePath(const std::wstring &fileName)
+{
+	//Create the directory to store logs first.
+	{
+		String::Generic<wchar_t> scoreLogDirectory(s_scoreLogDirectory.c_str(), s_scoreLogDirectory.length());
+		Path scoreLogDirectoryPath = Application::Instance::GetExePath(scoreLogDirectory);
+
+		BOOL createdDirectory = ::CreateDirectory(scoreLogDirectoryPath.Ptr(), NULL);
+
+		//It will fail if the directory already exists, but that's okay. Assert on any other error.
+		assert(createdDirectory || ::GetLastError() == ERROR_ALREADY_EXISTS);
+	}
+
+	const std::wstring fileNameWide = s_scoreLogDirectory + fileName;
+	String::Generic<wchar_t> fileNameString(fileNameWide.c_str(), fileNameWide.length());
+
+	Path filePath = Application::Instance::GetExePath(fileNameString);
+	return std::wstring(filePath.Ptr(), filePath.Length());
+}
+
+void Nestopia::RamAiApi::WriteTraceFile()
+{
+#ifdef RAMAI_TRACE
+	//This runs from the destructor too, so a failed write is reported rather than thrown.
+	try
+	{
+		std::string trace;
+		RamAi::Trace::AppendChromeTrace(trace);
+
+		WriteFileAtomically(GetLogDirectoryFilePath(s_traceFileName), trace.data(), trace.size());
 	}
 	catch (...)
 	{
-		RamAi::Debug::OutLine("Error saving log file for iteration " + std::to_string(scoreLog.GetCurrentIteration()), RamAi::Colour::Red);
+		RamAi::Debug::OutLine("Couldn't write the trace file.", RamAi::Colour::Red);
 	}
+#endif
 }
 
-void Nestopia::RamAiApi::StartRecording(const RamAi::ScoreLog &scoreLog)
+#ifdef NST_TRACE
+Nes::Core::qword NST_CALLBACK Nestopia::RamAiApi::BeginCoreTrace()
 {
-	//Reset the emulator.
-	Nes::Result result = Nes::Machine(m_emulator).Reset(false);
-	assert(NES_SUCCEEDED(result));
+	return RamAi::Trace::Now();
+}
 
-	//Create the directory to store movie files first.
+void NST_CALLBACK Nestopia::RamAiApi::EndCoreTrace(const char *name, const Nes::Core::qword start)
+{
+	RamAi::Trace::Record(name, start);
+}
+#endif
+
+void Nestopia::RamAiApi::InitialiseTreeCheckpoints(const RamAi::GameSettings &gameDetails)
+{
+	if (RamAi::AiSettings::GetData().checkpointFrequency == 0)
 	{
-		String::Generic<wchar_t> movieFileDirectory(s_movieFileDirectory.c_str(), s_movieFileDirectory.length());
-		Path movieFileDirectoryPath = Application::Instance::GetExePath(movieFileDirectory);
+		return;
+	}
 
-		BOOL createdDirectory = ::CreateDirectory(movieFileDirectoryPath.Ptr(), NULL);
+	//Create the directory to store checkpoints first.
+	{
+		String::Generic<wchar_t> checkpointDirectory(s_checkpointDirectory.c_str(), s_checkpointDirectory.length());
+		Path checkpointDirectoryPath = Application::Instance::GetExePath(checkpointDirectory);
+
+		BOOL createdDirectory = ::CreateDirectory(checkpointDirectoryPath.Ptr(), NULL);
 
 		//It will fail if the directory already exists, but that's okay. Assert on any other error.
 		assert(createdDirectory || ::GetLastError() == ERROR_ALREADY_EXISTS);
 	}
 
-	//Get the path to save the file to.
-	std::string movieFileNameShort = scoreLog.GetFileName() + " it" + std::to_string(scoreLog.GetCurrentIteration());
+	//Checkpoints are named after the game rather than the session, so the next session can pick them up.
+	std::wstring checkpointFileNameWide = s_checkpointDirectory;
+	checkpointFileNameWide += std::wstring(gameDetails.gameName.begin(), gameDetails.gameName.end()); //STL string to STL wide string.
 
-	std::wstring movieFileNameWide = s_movieFileDirectory;
-	movieFileNameWide += std::wstring(movieFileNameShort.begin(), movieFileNameShort.end()); //STL string to STL wide string.
-	movieFileNameWide += s_movieFileExtension;
+	String::Generic<wchar_t> checkpointFileName(checkpointFileNameWide.c_str(), checkpointFileNameWide.length());
+	Path checkpointPath = Application::Instance::GetExePath(checkpointFileName);
 
-	//STL wide string to Nestopia wide string.
-	String::Generic<wchar_t> movieFileName(movieFileNameWide.c_str(), movieFileNameWide.length());
+	const std::wstring tablePath = std::wstring(checkpointPath.Ptr(), checkpointPath.Length()) + s_checkpointTableExtension;
+	const std::wstring blobPath = std::wstring(checkpointPath.Ptr(), checkpointPath.Length()) + s_checkpointBlobExtension;
 
-	//Nestopia file path to Nestopia wide string.
-	Path movieFilePath = Application::Instance::GetExePath(movieFileName);
-	String::Generic<wchar_t> movieFilePathString(movieFilePath.Ptr(), movieFilePath.Length());
+	//Both handles are called from the checkpoint's thread.
+	RamAi::TreeCheckpoint::WriteTableHandleSignature writeTableHandle = std::bind(&RamAiApi::WriteFileAtomically, tablePath, std::placeholders::_1, std::placeholders::_2);
+
+	RamAi::TreeCheckpoint::WriteBlobHandleSignature writeBlobHandle = [this](const uint64_t offset, const char *data, const size_t size)
+	{
+		m_checkpointBlobFile->WriteAt(offset, data, size);
+	};
+
+	//The image database's hash of the loaded ROM, which includes any patch applied to it.
+	uint64_t romHash = 0;
+
+	if (const Nes::Cartridge::Profile *profile = Nes::Cartridge(m_emulator).GetProfile())
+	{
+		const Nes::dword crc = profile->hash.GetCrc32();
+
+		romHash = RamAi::TreeCheckpoint::CalculateHash(profile->hash.GetSha1(), sizeof(Nes::dword) * Nes::Cartridge::Profile::Hash::SHA1_WORD_LENGTH);
+		romHash = RamAi::TreeCheckpoint::CalculateHash(&crc, sizeof(crc), romHash);
+	}
+
+	if (!RamAi::Api::EnableTreeCheckpoints(writeTableHandle, writeBlobHandle, romHash))
+	{
+		return;
+	}
+
+	//Resume from the last checkpoint if there is one. The tree copies what it needs, so the views are closed straight after.
+	//The blob is mapped a window at a time, as it can grow larger than the address space.
+	bool resumed = false;
+
+	{
+		MappedFile table(tablePath);
+		MappedFile blob(blobPath);
+
+		const uint8_t *tableData = (table.GetSize() <= SIZE_MAX) ? table.GetView(0, static_cast<size_t>(table.GetSize())) : nullptr;
+
+		RamAi::TreeCheckpoint::ReadBlobHandleSignature readBlobHandle = [&blob](const uint64_t offset, const size_t size)
+		{
+			return blob.GetView(offset, size);
+		};
+
+		resumed = tableData && RamAi::Api::ResumeTreeCheckpoint(tableData, static_cast<size_t>(table.GetSize()), blob.GetSize(), readBlobHandle);
+	}
+
+	//Savestates the resumed table refers to are kept; anything after them is written over.
+	try
+	{
+		m_checkpointBlobFile = std::make_unique<BlobFile>(blobPath, resumed);
+	}
+	catch (...)
+	{
+		RamAi::Debug::OutLine("Error opening checkpoint file - the search tree will not be checkpointed.", RamAi::Colour::Red);
+
+		RamAi::Api::DisableTreeCheckpoints();
+		m_checkpointBlobFile.reset();
+	}
+}
+
+void Nestopia::RamAiApi::WriteFileAtomically(const std::wstring &path, const char *data, const size_t size)
+{
+	//Write the new file beside the old one and swap it in, so a crash or a reader never sees a half-written file.
+	const std::wstring temporaryPath = path + s_temporaryExtension;
+
+	{
+		String::Generic<wchar_t> temporaryPathString(temporaryPath.c_str(), temporaryPath.length());
+
+		Io::File file(temporaryPathString, Io::File::DUMP);
+		file.Write(data, static_cast<uint>(size));
+	}
+
+	if (!::MoveFileEx(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		throw Io::File::ERR_WRITE;
+	}
+}
+
+void Nestopia::RamAiApi::StartRecording(const RamAi::ScoreLog &scoreLog)
+{
+	//Reset the emulator.
+	Nes::Result result = Nes::Machine(m_emulator).Reset(false);
+	assert(NES_SUCCEEDED(result));
+
+	//Get the path to save the file to.
+	const std::wstring movieFilePath = CreateMovieFilePath(scoreLog);
+	String::Generic<wchar_t> movieFilePathString(movieFilePath.c_str(), movieFilePath.length());
 
 	try
 	{
@@ -303,6 +518,56 @@ void Nestopia::RamAiApi::FinishRecording()
 	}
 }
 
+void Nestopia::RamAiApi::RecordMovie(const RamAi::ScoreLog &scoreLog, std::vector<RamAi::ButtonSet> &&inputs)
+{
+	if (!m_movieRecorder)
+	{
+		return;
+	}
+
+	if (m_movieRecorder->PopRecordFailed())
+	{
+		RamAi::Debug::OutLine("Error recording movie before iteration " + std::to_string(scoreLog.GetCurrentIteration()), RamAi::Colour::Red);
+	}
+
+	std::vector<uint> buttons;
+	buttons.reserve(inputs.size());
+
+	for (auto it = inputs.cbegin(); it != inputs.cend(); ++it)
+	{
+		buttons.push_back(it->GetBitfield().GetValue());
+	}
+
+	m_movieRecorder->Record(CreateMovieFilePath(scoreLog), std::move(buttons));
+}
+
+std::wstring Nestopia::RamAiApi::CreateMovieFilePath(const RamAi::ScoreLog &scoreLog) const
+{
+	//Create the directory to store movie files first.
+	{
+		String::Generic<wchar_t> movieFileDirectory(s_movieFileDirectory.c_str(), s_movieFileDirectory.length());
+		Path movieFileDirectoryPath = Application::Instance::GetExePath(movieFileDirectory);
+
+		BOOL createdDirectory = ::CreateDirectory(movieFileDirectoryPath.Ptr(), NULL);
+
+		//It will fail if the directory already exists, but that's okay. Assert on any other error.
+		assert(createdDirectory || ::GetLastError() == ERROR_ALREADY_EXISTS);
+	}
+
+	std::string movieFileNameShort = scoreLog.GetFileName() + " it" + std::to_string(scoreLog.GetCurrentIteration());
+
+	std::wstring movieFileNameWide = s_movieFileDirectory;
+	movieFileNameWide += std::wstring(movieFileNameShort.begin(), movieFileNameShort.end()); //STL string to STL wide string.
+	movieFileNameWide += s_movieFileExtension;
+
+	//STL wide string to Nestopia wide string.
+	String::Generic<wchar_t> movieFileName(movieFileNameWide.c_str(), movieFileNameWide.length());
+
+	//Nestopia file path to STL wide string.
+	Path movieFilePath = Application::Instance::GetExePath(movieFileName);
+	return std::wstring(movieFilePath.Ptr(), movieFilePath.Length());
+}
+
 void Nestopia::RamAiApi::EnableTurbo(const bool turboOn)
 {
 	if (turboOn)
@@ -320,6 +585,141 @@ RamAi::Ram Nestopia::RamAiApi::NstRamToRamAiRam(const Nes::byte *ramBytes)
 	return RamAi::Ram(ramBytes, Nes::Core::Cpu::RAM_SIZE);
 }
 
+Nestopia::RamAiApi::MappedFile::MappedFile(const std::wstring &path)
+	: m_file(INVALID_HANDLE_VALUE)
+	, m_mapping(NULL)
+	, m_size(0)
+	, m_view(nullptr)
+	, m_viewOffset(0)
+	, m_viewSize(0)
+{
+	m_file = ::CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	//Empty files can't be mapped.
+	if (!::GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		return;
+	}
+
+	m_mapping = ::CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+	if (m_mapping)
+	{
+		m_size = static_cast<uint64_t>(fileSize.QuadPart);
+	}
+}
+
+Nestopia::RamAiApi::MappedFile::~MappedFile()
+{
+	CloseView();
+
+	if (m_mapping)
+	{
+		::CloseHandle(m_mapping);
+	}
+
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		::CloseHandle(m_file);
+	}
+}
+
+const uint8_t *Nestopia::RamAiApi::MappedFile::GetView(const uint64_t offset, const size_t size)
+{
+	if (!m_mapping || offset > m_size || size > m_size - offset)
+	{
+		return nullptr;
+	}
+
+	if (m_view && offset >= m_viewOffset && offset + size <= m_viewOffset + m_viewSize)
+	{
+		return m_view + (offset - m_viewOffset);
+	}
+
+	CloseView();
+
+	//Views have to start on the allocation granularity. A window is mapped around the bytes, so nearby reads reuse it.
+	SYSTEM_INFO systemInfo;
+	::GetSystemInfo(&systemInfo);
+
+	const uint64_t viewOffset = offset - (offset % systemInfo.dwAllocationGranularity);
+	const uint64_t viewEnd = std::min(m_size, std::max(offset + size, viewOffset + s_windowSize));
+
+	if (viewEnd - viewOffset > SIZE_MAX)
+	{
+		return nullptr;
+	}
+
+	const size_t viewSize = static_cast<size_t>(viewEnd - viewOffset);
+	m_view = static_cast<const uint8_t*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, static_cast<DWORD>(viewOffset >> 32), static_cast<DWORD>(viewOffset), viewSize));
+
+	if (!m_view)
+	{
+		return nullptr;
+	}
+
+	m_viewOffset = viewOffset;
+	m_viewSize = viewSize;
+
+	return m_view + (offset - m_viewOffset);
+}
+
+void Nestopia::RamAiApi::MappedFile::CloseView()
+{
+	if (m_view)
+	{
+		::UnmapViewOfFile(m_view);
+		m_view = nullptr;
+	}
+}
+
+Nestopia::RamAiApi::BlobFile::BlobFile(const std::wstring &path, const bool keepContents)
+{
+	m_file = ::CreateFile(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, keepContents ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		throw Io::File::ERR_OPEN;
+	}
+}
+
+Nestopia::RamAiApi::BlobFile::~BlobFile()
+{
+	::CloseHandle(m_file);
+}
+
+void Nestopia::RamAiApi::BlobFile::WriteAt(uint64_t offset, const char *data, size_t size)
+{
+	//The handle is synchronous, so each write happens at the overlapped offset and finishes before WriteFile returns.
+	while (size > 0)
+	{
+		OVERLAPPED overlapped;
+		std::memset(&overlapped, 0, sizeof(overlapped));
+
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		const DWORD length = static_cast<DWORD>(std::min<size_t>(size, Io::File::MAX_SIZE));
+		DWORD written = 0;
+
+		if (!::WriteFile(m_file, data, length, &written, &overlapped) || written == 0)
+		{
+			throw Io::File::ERR_WRITE;
+		}
+
+		offset += written;
+		data += written;
+		size -= written;
+	}
+}
+
 Nestopia::RamAiApi::SpecsContainer::SpecsContainer()
 {
 	using Nes::Core::Input::Controllers;
@@ -343,5 +743,13 @@ const std::wstring Nestopia::RamAiApi::s_aiSettingsFileName = L"aiSettings.xml";
 const std::wstring Nestopia::RamAiApi::s_settingsExtension = L".xml";
 const std::wstring Nestopia::RamAiApi::s_scoreLogDirectory = L"RamAiLogs\\";
 const std::wstring Nestopia::RamAiApi::s_scoreLogExtension = L".csv";
+const std::wstring Nestopia::RamAiApi::s_scoreLogSpillExtension = L".bin";
+const std::wstring Nestopia::RamAiApi::s_bestPathExtension = L".path";
 const std::wstring Nestopia::RamAiApi::s_movieFileDirectory = L"RamAiMovies\\";
-const std::wstring Nestopia::RamAiApi::s_movieFileExtension = L".nsv";
\ No newline at end of file
+const std::wstring Nestopia::RamAiApi::s_movieFileExtension = L".nsv";
+const std::wstring Nestopia::RamAiApi::s_metricsFileName = L"metrics.prom";
+const std::wstring Nestopia::RamAiApi::s_traceFileName = L"trace.json";
+const std::wstring Nestopia::RamAiApi::s_checkpointDirectory = L"RamAiCheckpoints\\";
+const std::wstring Nestopia::RamAiApi::s_checkpointTableExtension = L".tree";
+const std::wstring Nestopia::RamAiApi::s_checkpointBlobExtension = L".blob";
+const std::wstring Nestopia::RamAiApi::s_temporaryExtension = L".tmp";
\ No newline at end of file
@@ -28,6 +28,10 @@
 #pragma once
 
 #include "../../../RamAi/Source/Api.h"
+#include "../../../RamAi/Source/MetricsWriter.h"
+#include "../../../RamAi/Source/MonteCarlo/TreeCheckpoint.h"
+#include "../../../RamAi/Source/Score/ScoreLogWriter.h"
+#include "NstRamAiMovieRecorder.h"
 #include "../NstIoFile.hpp"
 #include "../NstIoStream.hpp"
 #include "../NstManagerEmulator.hpp"
@@ -46,7 +50,7 @@ namespace Nes
 
 namespace Nestopia
 {
-	class RamAiApi : public RamAi::Api
+	class RamAiApi : public RamAi::Api, private RamAi::EmulatorBackend
 	{
 	public:
 		RamAiApi(Managers::Emulator &emulator);
@@ -58,7 +62,9 @@ namespace Nestopia
 
 	public:
 		//Initialises the game, passing in the right callbacks.
-		void InitialiseGame(const RamAi::GameSettings &gameDetails);
+		//The image and its patch are loaded again so that movies can be recorded on a separate emulator.
+		void InitialiseGame(const RamAi::GameSettings &gameDetails, const Collection::Buffer &image, const Collection::Buffer &patch,
+			const bool bypassPatchValidation, const Nes::Machine::FavoredSystem favoredSystem);
 
 		//Takes the emulator's RAM state and sets the relevant inputs.
 		void CalculateInput(const Nes::byte *ramBytes, Nes::Core::Input::Controllers *const input);
@@ -66,21 +72,41 @@ namespace Nestopia
 	public:
 		void ImportAiSettings();
 
+		//Writes the recent trace events to RamAiLogs\trace.json, if the trace was compiled in with RAMAI_TRACE.
+		//Open it in chrome://tracing or Perfetto. Failures are logged, never thrown.
+		void WriteTraceFile();
+
 		//This interface isn't great, but whatever.
 		void ImportGameSettings(RamAi::GameSettings &gameSettings, const Path &path, const std::wstring &gameName);
 
 	private:
-		//ISavestateInteractable implementation.
-		RamAi::Savestate SaveState();
-		RamAi::Savestate BufferToSavestate(const Collection::Buffer &buffer);
+		//EmulatorBackend implementation.
+		virtual bool SaveInto(RamAi::Savestate &savestate) override;
+		virtual void LoadFrom(const uint8_t *data, const size_t size) override;
+
+		virtual void StartRecording(const RamAi::ScoreLog &scoreLog) override;
+		virtual void FinishRecording() override;
 
-		void LoadState(const RamAi::Savestate &savestate);
-		Collection::Buffer SavestateToBuffer(const RamAi::Savestate &savestate);
+		virtual bool CanRecordMovies() const override	{ return m_movieRecorder != nullptr; }
+		virtual void RecordMovie(const RamAi::ScoreLog &scoreLog, std::vector<RamAi::ButtonSet> &&inputs) override;
 
 		void SaveLogToFile(const RamAi::ScoreLog &scoreLog, const RamAi::MonteCarloTreeBase &tree);
+		void SpillLogToFile(const RamAi::ScoreLog &scoreLog, const size_t firstItemIndex, const size_t numberOfItems);
+		void SaveBestPath(const RamAi::ScoreLog &scoreLog, const std::string &record);
+
+		bool OpenLogFile(const RamAi::ScoreLog &scoreLog, const std::wstring &extension, std::unique_ptr<Io::File> &outFile, std::unique_ptr<RamAi::ScoreLogWriter> &outWriter);
+
+		void InitialiseMetrics();
+		static std::wstring GetLogDirectoryFilePath(const std::wstring &fileName);
+		void InitialiseTreeCheckpoints(const RamAi::GameSettings &gameDetails);
+		static void WriteFileAtomically(const std::wstring &path, const char *data, const size_t size);
+
+#ifdef NST_TRACE
+		static Nes::Core::qword NST_CALLBACK BeginCoreTrace();
+		static void NST_CALLBACK EndCoreTrace(const char *name, const Nes::Core::qword start);
+#endif
 
-		void StartRecording(const RamAi::ScoreLog &scoreLog);
-		void FinishRecording();
+		std::wstring CreateMovieFilePath(const RamAi::ScoreLog &scoreLog) const;
 
 	private:
 		void EnableTurbo(const bool turboOn);
@@ -91,10 +117,88 @@ namespace Nestopia
 		Managers::Emulator &m_emulator;
 
 		bool m_allowHumanOverride;
+
+		//Savestates are written into this first. It's kept between saves so it isn't regrown every time.
+		Collection::Buffer m_saveStateBuffer;
 		
 		std::unique_ptr<Io::File> m_movieFile;
 		std::unique_ptr<Io::Stream::InOut> m_movieFileStream;
 
+		std::unique_ptr<RamAiMovieRecorder> m_movieRecorder;
+
+		//The writer appends to the file from its own thread, so it must be destroyed first.
+		std::unique_ptr<Io::File> m_scoreLogFile;
+		std::unique_ptr<RamAi::ScoreLogWriter> m_scoreLogWriter;
+
+		//Items that no longer fit in memory go to a binary file next to the log.
+		std::unique_ptr<Io::File> m_scoreLogSpillFile;
+		std::unique_ptr<RamAi::ScoreLogWriter> m_scoreLogSpillWriter;
+		std::string m_scoreLogSpillBuffer;
+
+		//Each change of the best path is appended as a compact action sequence record.
+		std::unique_ptr<Io::File> m_bestPathFile;
+		std::unique_ptr<RamAi::ScoreLogWriter> m_bestPathWriter;
+
+		//Rewrites the metrics file every few seconds, if enabled.
+		std::unique_ptr<RamAi::MetricsWriter> m_metricsWriter;
+
+	private:
+		//A read-only mapping of a file, viewed a window at a time so files larger than the address space can be read.
+		class MappedFile
+		{
+		public:
+			MappedFile(const std::wstring &path);
+			MappedFile(const MappedFile &other) = delete;
+			~MappedFile();
+
+		public:
+			MappedFile &operator= (const MappedFile &other) = delete;
+
+		public:
+			uint64_t GetSize() const			{ return m_size; }
+
+			//Returns the bytes at the offset, or null if they're outside the file or can't be mapped.
+			//The pointer is valid until the next call.
+			const uint8_t *GetView(const uint64_t offset, const size_t size);
+
+		private:
+			void CloseView();
+
+		private:
+			static const size_t s_windowSize = 64 * 1024 * 1024;
+
+			HANDLE m_file;
+			HANDLE m_mapping;
+			uint64_t m_size;
+
+			const uint8_t *m_view;
+			uint64_t m_viewOffset;
+			size_t m_viewSize;
+		};
+
+		//A file that's written at given 64-bit offsets, which Io::File can't seek to.
+		class BlobFile
+		{
+		public:
+			//Throws Io::File::ERR_OPEN if the file can't be opened. It's emptied unless it's being resumed.
+			BlobFile(const std::wstring &path, const bool keepContents);
+			BlobFile(const BlobFile &other) = delete;
+			~BlobFile();
+
+		public:
+			BlobFile &operator= (const BlobFile &other) = delete;
+
+		public:
+			//Throws Io::File::ERR_WRITE if the bytes couldn't all be written.
+			void WriteAt(const uint64_t offset, const char *data, const size_t size);
+
+		private:
+			HANDLE m_file;
+		};
+
+		//Savestates are written to this by the checkpoint's thread, so checkpoints must be disabled before it's closed.
+		std::unique_ptr<BlobFile> m_checkpointBlobFile;
+
 	private:
 		//Container used to initialise the specs with the right values.
 		class SpecsContainer
@@ -116,8 +220,16 @@ namespace Nestopia
 		static const std::wstring s_settingsExtension;
 		static const std::wstring s_scoreLogDirectory;
 		static const std::wstring s_scoreLogExtension;
+		static const std::wstring s_scoreLogSpillExtension;
+		static const std::wstring s_bestPathExtension;
 		static const std::wstring s_movieFileDirectory;
 		static const std::wstring s_movieFileExtension;
+		static const std::wstring s_metricsFileName;
+		static const std::wstring s_traceFileName;
+		static const std::wstring s_checkpointDirectory;
+		static const std::wstring s_checkpointTableExtension;
+		static const std::wstring s_checkpointBlobExtension;
+		static const std::wstring s_temporaryExtension;
 	};
 };
 
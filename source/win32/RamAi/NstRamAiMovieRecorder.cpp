@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "NstRamAiMovieRecorder.h"
+
+#include "../../core/api/NstApiCartridge.hpp"
+#include "../../core/api/NstApiInput.hpp"
+#include "../../core/api/NstApiMovie.hpp"
+#include "../../core/api/NstApiUser.hpp"
+#include "../NstIoFile.hpp"
+#include "../NstIoStream.hpp"
+
+
+namespace
+{
+	thread_local bool s_isRecorderThread = false;
+}
+
+Nestopia::RamAiMovieRecorder::RamAiMovieRecorder(const Collection::Buffer &image, const Collection::Buffer &patch, const bool bypassPatchValidation,
+	const Nes::Machine::FavoredSystem favoredSystem, const Nes::Machine::Mode mode)
+	: m_loaded(false)
+	, m_recording(false)
+	, m_recordFailed(false)
+	, m_stopping(false)
+{
+	//Loading raises machine and input events meant for the main emulator, so they're held back as the AVI converter does.
+	Nes::Machine::EventCallback machineEventFunc;
+	Nes::Input::ControllerCallback controllerFunc;
+	Nes::Input::AdapterCallback adapterFunc;
+	Nes::Cartridge::ChooseProfileCallback chooseProfileFunc;
+	void *machineEventData, *controllerData, *adapterData, *chooseProfileData;
+
+	Nes::Machine::eventCallback.Get(machineEventFunc, machineEventData);
+	Nes::Input::controllerCallback.Get(controllerFunc, controllerData);
+	Nes::Input::adapterCallback.Get(adapterFunc, adapterData);
+	Nes::Cartridge::chooseProfileCallback.Get(chooseProfileFunc, chooseProfileData);
+
+	Nes::Machine::eventCallback.Unset();
+	Nes::Input::controllerCallback.Unset();
+	Nes::Input::adapterCallback.Unset();
+	Nes::Cartridge::chooseProfileCallback.Unset();
+
+	{
+		Nes::Machine machine(m_emulator);
+		Io::Stream::In imageStream(image);
+
+		if (patch.Size())
+		{
+			//A patched image left unpatched here would be played from different code, and the movie would desync.
+			Io::Stream::In patchStream(patch);
+			Nes::Machine::Patch machinePatch(patchStream, bypassPatchValidation);
+
+			//A patch that fails is only warned about by the main emulator, so it's ignored here too.
+			m_loaded = NES_SUCCEEDED(machine.Load(imageStream, favoredSystem, machinePatch));
+		}
+		else
+		{
+			m_loaded = NES_SUCCEEDED(machine.Load(imageStream, favoredSystem));
+		}
+
+		if (m_loaded)
+		{
+			machine.SetMode(mode);
+			Nes::Input(m_emulator).ConnectController(0, Nes::Input::PAD1);
+		}
+	}
+
+	Nes::Machine::eventCallback.Set(machineEventFunc, machineEventData);
+	Nes::Input::controllerCallback.Set(controllerFunc, controllerData);
+	Nes::Input::adapterCallback.Set(adapterFunc, adapterData);
+	Nes::Cartridge::chooseProfileCallback.Set(chooseProfileFunc, chooseProfileData);
+
+	m_thread = std::thread(&RamAiMovieRecorder::ThreadMain, this);
+}
+
+Nestopia::RamAiMovieRecorder::~RamAiMovieRecorder()
+{
+	//Queued movies are still recorded before the thread exits.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_queuedCondition.notify_one();
+	m_thread.join();
+}
+
+void Nestopia::RamAiMovieRecorder::Record(const std::wstring &path, std::vector<uint> &&buttons)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_jobs.push_back(Job());
+		m_jobs.back().path = path;
+		m_jobs.back().buttons = std::move(buttons);
+	}
+
+	m_queuedCondition.notify_one();
+}
+
+void Nestopia::RamAiMovieRecorder::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_recordedCondition.wait(lock, [this]() { return m_jobs.empty() && !m_recording; });
+}
+
+bool Nestopia::RamAiMovieRecorder::PopRecordFailed()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const bool recordFailed = m_recordFailed;
+	m_recordFailed = false;
+
+	return recordFailed;
+}
+
+bool Nestopia::RamAiMovieRecorder::IsRecorderThread()
+{
+	return s_isRecorderThread;
+}
+
+void Nestopia::RamAiMovieRecorder::ThreadMain()
+{
+	s_isRecorderThread = true;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_queuedCondition.wait(lock, [this]() { return !m_jobs.empty() || m_stopping; });
+
+		if (m_jobs.empty())
+		{
+			break;
+		}
+
+		Job job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		m_recording = true;
+
+		lock.unlock();
+
+		const bool recorded = RecordMovie(job);
+
+		lock.lock();
+
+		m_recording = false;
+		m_recordFailed = m_recordFailed || !recorded;
+
+		m_recordedCondition.notify_all();
+	}
+
+	lock.unlock();
+
+	//Unloading would save the battery over the game's own, so it's done here where the frontend ignores it.
+	Nes::Machine(m_emulator).Unload();
+}
+
+bool Nestopia::RamAiMovieRecorder::RecordMovie(const Job &job)
+{
+	Nes::Machine machine(m_emulator);
+
+	if (!m_loaded)
+	{
+		return false;
+	}
+
+	//Every movie starts from power-on, as the search did.
+	if (NES_FAILED(machine.Power(false)) || NES_FAILED(machine.Power(true)))
+	{
+		return false;
+	}
+
+	bool recorded = true;
+
+	try
+	{
+		String::Generic<wchar_t> pathString(job.path.c_str(), job.path.length());
+
+		Io::File file(pathString, Io::File::WRITE | Io::File::EMPTY);
+		Io::Stream::InOut stream(file);
+
+		if (NES_FAILED(Nes::Movie(m_emulator).Record(stream, Nes::Movie::CLEAN)))
+		{
+			return false;
+		}
+
+		//There's nothing to see or hear, so only the machine itself is run.
+		Nes::Input::Controllers controllers;
+
+		for (auto it = job.buttons.cbegin(); it != job.buttons.cend() && recorded; ++it)
+		{
+			controllers.pad[0].buttons = *it;
+			recorded = NES_SUCCEEDED(m_emulator.Execute(NULL, NULL, &controllers));
+		}
+
+		//Stopping writes the end of the movie, so it has to happen while the file is still open.
+		Nes::Movie(m_emulator).Stop();
+	}
+	catch (...)
+	{
+		//Only opening the file throws, which is before recording starts.
+		recorded = false;
+	}
+
+	return recorded;
+}
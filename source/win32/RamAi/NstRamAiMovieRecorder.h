@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////////////
+//
+// Nestopia - NES/Famicom emulator written in C++
+//
+// Copyright (C) 2015 Sean Latham
+//
+// This file is part of Nestopia.
+//
+// Nestopia is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Nestopia is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Nestopia; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NST_RAM_AI_MOVIE_RECORDER_H
+#define NST_RAM_AI_MOVIE_RECORDER_H
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../NstManagerEmulator.hpp"
+
+namespace Nestopia
+{
+	//Records movies on a separate emulator from its own thread, so the search doesn't stop while the best path is replayed.
+	//The core's callbacks are shared by every emulator, so the frontend's handlers ignore anything raised on the recorder's thread.
+	class RamAiMovieRecorder
+	{
+	public:
+		//Loads the image with the same patch as the main emulator. This is done on the calling thread,
+		//with the frontend's callbacks held back except for file loading, so the game's battery is loaded as usual.
+		RamAiMovieRecorder(const Collection::Buffer &image, const Collection::Buffer &patch, const bool bypassPatchValidation,
+			const Nes::Machine::FavoredSystem favoredSystem, const Nes::Machine::Mode mode);
+		RamAiMovieRecorder(const RamAiMovieRecorder &other) = delete;
+		~RamAiMovieRecorder();
+
+	public:
+		RamAiMovieRecorder &operator= (const RamAiMovieRecorder &other) = delete;
+
+	public:
+		//Queues a movie of the given pad 1 buttons, one per frame, played from power-on.
+		void Record(const std::wstring &path, std::vector<uint> &&buttons);
+
+		//Blocks until every queued movie has been recorded.
+		void Flush();
+
+		//Returns true if a movie has failed to record since the last call.
+		bool PopRecordFailed();
+
+		//Returns true if called from a recorder's thread, whose emulator events must not reach the frontend.
+		static bool IsRecorderThread();
+
+	private:
+		struct Job
+		{
+			std::wstring path;
+			std::vector<uint> buttons;
+		};
+
+	private:
+		void ThreadMain();
+		bool RecordMovie(const Job &job);
+
+	private:
+		//Only touched by the recorder's thread once it has started.
+		Nes::Emulator m_emulator;
+		bool m_loaded;
+
+		std::deque<Job> m_jobs;
+
+		std::mutex m_mutex;
+		std::condition_variable m_queuedCondition;
+		std::condition_variable m_recordedCondition;
+		bool m_recording;
+		bool m_recordFailed;
+		bool m_stopping;
+
+		std::thread m_thread;
+	};
+};
+
+#endif